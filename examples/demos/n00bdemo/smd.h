@@ -17,8 +17,27 @@ typedef struct {
 	SVECTOR			*p_verts;
 	SVECTOR			*p_norms;
 	void			*p_prims;
+	void			*p_packets;			// Only if flags & SMD_FLAG_PACKETS
 } SMD;
 
+#define SMD_FLAG_PACKETS	0x4
+
+typedef struct {
+	union {
+		unsigned int	offset;			// Offset of the SMD in the file
+		SMD				*smd;			// Pointer set by smlInitData()
+	};
+	unsigned int		max_z;			// Farthest Z this LOD is drawn at
+} SML_LOD;
+
+typedef struct {
+	char			id[3];
+	unsigned char	version;
+	unsigned short	n_lods;
+	unsigned short	reserved;
+	SML_LOD			lods[];
+} SML;
+
 typedef struct {
 	unsigned char type:2;
 	unsigned char l_type:2;
@@ -58,8 +77,14 @@ void scSetClipRect(int x0, int y0, int x1, int y1);
 SMD *smdInitData(void *data);
 void smdSetBaseTPage(unsigned short tpage);
 
+SML *smlInitData(void *data);
+SMD *smlSelectLOD(SML *sml, int z);
+int smlGetDepth(void);
+SMD *smlSelectLODGte(SML *sml);
+
 char *smdSortModel(SC_OT *ot, char* pribuff, SMD *smd);
 char *smdSortModelFlat(u_long *ot, char* pribuff, SMD *smd);
+char *smdSortModelBaked(SC_OT *ot, char* pribuff, SMD *smd);
 
 void smdSetCelTex(unsigned short tpage, unsigned short clut);
 void smdSetCelParam(int udiv, int vdiv, unsigned int col);
@@ -24,6 +24,14 @@ smdInitData:
 	sw		$a2, SMD_HEAD_PNORMS($a0)
 	sw		$a3, SMD_HEAD_PPRIMS($a0)
 	
+	lhu		$v1, SMD_HEAD_FLAG($a0)		# Initialize packet template pointer
+	lw		$a1, SMD_HEAD_PPACKETS($a0)
+	andi	$v1, SMD_FLAG_PACKETS
+	beqz	$v1, .no_packets
+	addu	$a1, $a0
+	sw		$a1, SMD_HEAD_PPACKETS($a0)
+	
+.no_packets:
 	jr		$ra
 	move	$v0, $a0
 	
@@ -0,0 +1,156 @@
+#include <sys/types.h>
+#include <psxgpu.h>
+#include <psxgte.h>
+#include <inline_c.h>
+#include "smd.h"
+
+/*
+ * Renderer for SMD files with pre-built GPU packets (smxlink -pk). Each
+ * primitive has a packet template with everything but the screen coordinates
+ * already filled in, so instead of building packets from the primitive data
+ * this renderer copies the template, then only patches the coordinates, the
+ * colors of lit primitives and the OT link.
+ *
+ * Templates are laid out as a word holding the byte offsets of the XY fields
+ * of each vertex within the packet, followed by the packet itself (starting
+ * with its tag, whose length field gives the packet's size).
+ */
+
+#define CLIP_LEFT	1
+#define CLIP_RIGHT	2
+#define CLIP_TOP	4
+#define CLIP_BOTTOM	8
+
+// Set by scSetClipRect() (x0,y0,x1,y1)
+extern short _sc_clip[4];
+
+static int clip_code(u_long xy) {
+
+	int x = (short)(xy&0xffff);
+	int y = ((int)xy)>>16;
+	int code = 0;
+
+	if( x < _sc_clip[0] )
+		code |= CLIP_LEFT;
+	if( x > _sc_clip[2] )
+		code |= CLIP_RIGHT;
+	if( y < _sc_clip[1] )
+		code |= CLIP_TOP;
+	if( y > _sc_clip[3] )
+		code |= CLIP_BOTTOM;
+
+	return code;
+
+}
+
+char *smdSortModelBaked(SC_OT *ot, char* pribuff, SMD *smd) {
+
+	u_long			*pri = (u_long*)smd->p_prims;
+	u_long			*pkt = (u_long*)smd->p_packets;
+	SVECTOR			*verts = smd->p_verts;
+	SVECTOR			*norms = smd->p_norms;
+
+	u_long			id, *dst;
+	unsigned short	*idx;
+	unsigned char	*xy;
+	int				i, count, len, flg, otz, c0, c1, c2, c3;
+
+	while( (id = *pri) ) {
+
+		idx	= (unsigned short*)(pri+1);
+		xy	= (unsigned char*)pkt;
+		len	= pkt[1]>>24;
+
+		// Step to the next primitive and template ahead of time
+		pri += (id>>24)>>2;
+		pkt += len+2;
+
+		gte_ldv3( &verts[idx[0]], &verts[idx[1]], &verts[idx[2]] );
+		gte_rtpt();
+		gte_stflg( &flg );
+
+		if( flg < 0 )
+			continue;
+
+		// Backface culling, unless the primitive is double sided
+		gte_nclip();
+		gte_stopz( &i );
+
+		if( !(id&(1<<12)) && (i < 0) )
+			continue;
+
+		// Copy the template, which is word aligned in both buffers
+		dst = (u_long*)pribuff;
+
+		for( i=0; i<=len; i++ )
+			dst[i] = ((u_long*)xy)[i+1];
+
+		count = ((id&0x3) == 2) ? 4 : 3;
+
+		if( count == 4 ) {
+
+			gte_stsxy0( pribuff+xy[0] );
+			gte_ldv0( &verts[idx[3]] );
+			gte_rtps();
+			gte_stflg( &flg );
+
+			if( flg < 0 )
+				continue;
+
+			gte_stsxy3( pribuff+xy[1], pribuff+xy[2], pribuff+xy[3] );
+			gte_avsz4();
+
+		} else {
+
+			gte_stsxy3( pribuff+xy[0], pribuff+xy[1], pribuff+xy[2] );
+			gte_avsz3();
+
+		}
+
+		gte_stotz( &otz );
+
+		otz = (otz>>ot->zdiv)-ot->zoff;
+
+		if( (otz <= 0) || (otz >= ot->otlen) )
+			continue;
+
+		// Skip the primitive if an off-screen side is shared by all vertices
+		c0 = clip_code( *(u_long*)(pribuff+xy[0]) );
+		c1 = clip_code( *(u_long*)(pribuff+xy[1]) );
+		c2 = clip_code( *(u_long*)(pribuff+xy[2]) );
+		c3 = (count == 4) ? clip_code( *(u_long*)(pribuff+xy[3]) ) : c0;
+
+		if( c0&c1&c2&c3 )
+			continue;
+
+		// Lighting, using the material color in the template as input
+		switch( (id>>2)&0x3 ) {
+			case 1:		// Flat
+				gte_ldv0( &norms[idx[4]] );
+				gte_ldrgb( pribuff+xy[0]-4 );
+				gte_nccs();
+				gte_strgb( pribuff+xy[0]-4 );
+				break;
+
+			case 2:		// Smooth
+				gte_ldv3( &norms[idx[4]], &norms[idx[5]], &norms[idx[6]] );
+				gte_ldrgb( pribuff+xy[0]-4 );
+				gte_ncct();
+				gte_strgb3( pribuff+xy[0]-4, pribuff+xy[1]-4, pribuff+xy[2]-4 );
+
+				if( count == 4 ) {
+					gte_ldv0( &norms[idx[7]] );
+					gte_nccs();
+					gte_strgb( pribuff+xy[3]-4 );
+				}
+				break;
+		}
+
+		addPrim( ot->ot+otz, pribuff );
+		pribuff += (len+1)<<2;
+
+	}
+
+	return pribuff;
+
+}
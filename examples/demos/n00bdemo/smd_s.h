@@ -12,6 +12,9 @@
 .set SMD_HEAD_PNORMS,	16
 .set SMD_HEAD_PPRIMS,	20
 .set SMD_HEAD_SIZE,		24
+.set SMD_HEAD_PPACKETS,	24		# Only if SMD_FLAG_PACKETS is set
+
+.set SMD_FLAG_PACKETS,	4
 
 .set POLYF3_tag,		0
 .set POLYF3_tpage,		4
@@ -0,0 +1,64 @@
+#include <sys/types.h>
+#include <psxgte.h>
+#include <inline_c.h>
+#include "smd.h"
+
+/*
+ * Level of detail helpers for SML files generated by smxlink -lod, which hold
+ * several SMD models sorted from most to least detailed along with the
+ * farthest depth each one should be drawn at.
+ */
+
+SML *smlInitData(void *data) {
+	
+	SML *sml = (SML*)data;
+	int i;
+	
+	for( i=0; i<sml->n_lods; i++ ) {
+		
+		// Convert the LOD offsets into pointers so they can be used directly
+		sml->lods[i].smd = (SMD*)(((char*)data)+sml->lods[i].offset);
+		smdInitData( sml->lods[i].smd );
+		
+	}
+	
+	return sml;
+	
+}
+
+SMD *smlSelectLOD(SML *sml, int z) {
+	
+	SML_LOD *lod = sml->lods;
+	int i;
+	
+	for( i=1; i<sml->n_lods; i++, lod++ ) {
+		
+		if( (unsigned int)z <= lod->max_z )
+			break;
+		
+	}
+	
+	return lod->smd;
+	
+}
+
+int smlGetDepth(void) {
+	
+	SVECTOR origin = { 0, 0, 0, 0 };
+	int z;
+	
+	// Project the model's origin using the currently set rotation and
+	// translation matrices and take its screen Z
+	gte_ldv0( &origin );
+	gte_rtps();
+	gte_stsz( &z );
+	
+	return z;
+	
+}
+
+SMD *smlSelectLODGte(SML *sml) {
+	
+	return smlSelectLOD( sml, smlGetDepth() );
+	
+}
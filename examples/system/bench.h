@@ -0,0 +1,80 @@
+/*
+ * PSn00bSDK benchmark example helpers
+ * (C) 2022 PSn00bSDK contributors - MPL licensed
+ *
+ * Timing and random number generation shared by the benchmark examples in this
+ * directory (cppbench, fpbench, printbench and strbench), which include this
+ * header directly. It can be used from both C and C++.
+ *
+ * Timings are obtained using root counter 2 clocked at 1/8 of the CPU clock,
+ * with interrupts disabled. Each benchmark is run BENCH_RUNS times and the
+ * fastest run is reported, minus the overhead of an empty loop measured
+ * beforehand by calling bench_calibrate(). As the counter is 16 bits wide, a
+ * single run must take less than 524288 cycles (about 15 ms).
+ */
+
+#ifndef __BENCH_H
+#define __BENCH_H
+
+#include <stdint.h>
+#include <psxapi.h>
+#include <hwregs_c.h>
+
+#ifndef BENCH_RUNS
+#define BENCH_RUNS 8
+#endif
+
+/* Random number generator */
+
+static uint32_t _bench_seed     = 12345;
+static uint32_t _bench_overhead = 0;
+
+// Returns a pseudorandom 32-bit value. The state is a linear congruential
+// generator, whose low bits have a very short period; they are mixed with the
+// high bits so that the result can be used with % or truncated to a byte.
+static inline uint32_t bench_random(void) {
+	_bench_seed = _bench_seed * 1103515245 + 12345;
+	return _bench_seed ^ (_bench_seed >> 16);
+}
+
+/* Timing */
+
+// Returns the number of CPU cycles taken by the fastest of BENCH_RUNS calls to
+// the given function, without subtracting the loop overhead.
+static inline uint32_t bench_measure_raw(void (*func)(void)) {
+	uint32_t best = UINT32_MAX;
+
+	for (int i = 0; i < BENCH_RUNS; i++) {
+		EnterCriticalSection();
+
+		// Writing to the control register resets the counter. Mode 0x0200
+		// selects the CPU clock divided by 8 as source for root counter 2.
+		TIMER_CTRL(2) = 0x0200;
+		func();
+		uint32_t ticks = TIMER_VALUE(2) & 0xffff;
+
+		ExitCriticalSection();
+
+		if (ticks < best)
+			best = ticks;
+	}
+
+	return best * 8;
+}
+
+// Measures the given function (which should run the same loop as the
+// benchmarks, without doing any actual work) and stores the result as the
+// overhead to be subtracted by bench_measure().
+static inline void bench_calibrate(void (*empty_func)(void)) {
+	_bench_overhead = bench_measure_raw(empty_func);
+}
+
+// Returns the number of CPU cycles taken by the given function, minus the
+// overhead measured by bench_calibrate().
+static inline uint32_t bench_measure(void (*func)(void)) {
+	uint32_t cycles = bench_measure_raw(func);
+
+	return (cycles > _bench_overhead) ? (cycles - _bench_overhead) : 0;
+}
+
+#endif
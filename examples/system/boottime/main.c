@@ -0,0 +1,97 @@
+/*
+ * PSn00bSDK startup time measurement example
+ * (C) 2022 PSn00bSDK contributors - MPL licensed
+ *
+ * This example measures how long the startup code takes to initialize the
+ * executable, from the moment the BIOS jumps to its entry point to the moment
+ * main() is called. Root counters 1 and 2 are reset by a custom _start()
+ * function (see start.s) and read back by a high-priority constructor (which
+ * runs after BSS is cleared, the heap is set up and arguments are parsed) and
+ * at the beginning of main(). The program also has a large BSS section, to
+ * show how long clearing it takes, and constructors with different priorities
+ * to show that they are called in the correct order. Results are printed to
+ * the TTY.
+ *
+ * Counter 2 is clocked at 1/8 of the CPU clock and wraps around after about 15
+ * milliseconds, so counter 1 (which counts scanlines) is used for longer
+ * periods instead.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <psxgpu.h>
+#include <hwregs_c.h>
+
+#define BSS_SIZE		0x40000
+#define HBLANK_CYCLES	2153 // CPU cycles per scanline (NTSC)
+
+/* Timing helpers */
+
+typedef struct {
+	uint16_t hblanks, ticks;
+} Timestamp;
+
+static inline void get_timestamp(Timestamp *ts) {
+	ts->ticks   = TIMER_VALUE(2);
+	ts->hblanks = TIMER_VALUE(1);
+}
+
+static uint32_t to_cycles(const Timestamp *ts) {
+	// Counter 2 wraps around after 65536 * 8 cycles, i.e. around 243
+	// scanlines.
+	if (ts->hblanks < 240)
+		return ts->ticks * 8;
+	else
+		return ts->hblanks * HBLANK_CYCLES;
+}
+
+static void print_timestamp(const char *name, const Timestamp *ts) {
+	uint32_t cycles = to_cycles(ts);
+
+	// The CPU runs at 33.8688 MHz, i.e. roughly 33.9 cycles per microsecond.
+	printf("%-24s %9d cycles (%d us)\n", name, cycles, cycles * 10 / 339);
+}
+
+/* Constructors */
+
+static uint8_t   large_buffer[BSS_SIZE];
+static Timestamp ctor_time;
+static int       ctor_order[3], ctor_count;
+
+static void __attribute__((constructor(101))) first_ctor(void) {
+	get_timestamp(&ctor_time);
+	ctor_order[ctor_count++] = 101;
+}
+
+static void __attribute__((constructor(200))) second_ctor(void) {
+	ctor_order[ctor_count++] = 200;
+}
+
+static void __attribute__((constructor)) last_ctor(void) {
+	ctor_order[ctor_count++] = 65535;
+}
+
+/* Main */
+
+int main(int argc, const char *argv[]) {
+	Timestamp main_time;
+	get_timestamp(&main_time);
+
+	ResetGraph(0);
+
+	printf("\nStartup time measurement\n");
+	print_timestamp("_start() -> constructors", &ctor_time);
+	print_timestamp("_start() -> main()", &main_time);
+
+	printf("BSS size: %d bytes (%s)\n", sizeof(large_buffer), large_buffer[0] ? "not cleared" : "cleared");
+	printf("Constructor order: %d, %d, %d\n", ctor_order[0], ctor_order[1], ctor_order[2]);
+
+	printf("%d argument(s):\n", argc);
+	for (int i = 0; i < argc; i++)
+		printf("  argv[%d] = \"%s\"\n", i, argv[i]);
+
+	for (;;)
+		__asm__ volatile("");
+
+	return 0;
+}
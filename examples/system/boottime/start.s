@@ -0,0 +1,28 @@
+# PSn00bSDK startup time measurement example
+# (C) 2022 PSn00bSDK contributors - MPL licensed
+#
+# This file overrides the SDK's default (weak) _start() trampoline in order to
+# reset root counters 1 and 2 as soon as the executable is started, before BSS
+# is cleared and any other initialization is done.
+
+.set noreorder
+
+.include "hwregs_a.inc"
+
+.section .text._start
+.global _start
+.type _start, @function
+_start:
+	# Writing to a counter's control register also resets its value. Counter 1
+	# is set to count horizontal blanking periods, while counter 2 counts CPU
+	# cycles divided by 8. $a0 and $a1 must be preserved as they are passed
+	# through to _start_inner().
+	lui   $t0, IOBASE
+	li    $t1, 0x0100
+	sw    $t1, TIMER1_CTRL($t0)
+	li    $t1, 0x0200
+	sw    $t1, TIMER2_CTRL($t0)
+
+	la    $gp, _gp
+	j     _start_inner
+	nop
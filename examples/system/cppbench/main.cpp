@@ -0,0 +1,440 @@
+/*
+ * PSn00bSDK C++ utility library benchmark
+ * (C) 2022 PSn00bSDK contributors - MPL licensed
+ *
+ * This program compares the containers and callable wrapper provided by the
+ * util/ C++ headers against hand-written C-style equivalents (plain arrays
+ * with a counter, masked ring buffer indices, a linear probing hash table, a
+ * manually linked list and function pointers), printing the average number of
+ * CPU cycles per operation and the size of each data structure to the TTY.
+ * The C++ versions should be on par with their C counterparts, as all util/
+ * classes are fully inlined templates.
+ *
+ * The last two benchmarks build GPU primitives and link them into an ordering
+ * table, once using the psxgpu.h macros (in the same way as the cppdemo
+ * example) and once using the primitive templates in util/gpu.hpp. Both write
+ * to the same buffers, so the resulting packets must be identical.
+ *
+ * See bench.h in the parent directory for how timings are obtained.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <psxgpu.h>
+#include <util/containers.hpp>
+#include <util/function.hpp>
+#include <util/gpu.hpp>
+#include "../bench.h"
+
+#define ITERATIONS	128
+
+// All benchmarks store their result here to prevent GCC from optimizing away
+// the operations being benchmarked.
+static volatile uint32_t result;
+
+static uint32_t keys[ITERATIONS];
+
+/* Vector */
+
+struct CVector {
+	uint32_t items[ITERATIONS];
+	size_t   count;
+};
+
+static CVector                            c_vector;
+static util::Vector<uint32_t, ITERATIONS> cpp_vector;
+
+static void bench_c_vector(void) {
+	c_vector.count = 0;
+
+	for (int i = 0; i < ITERATIONS; i++) {
+		if (c_vector.count < ITERATIONS)
+			c_vector.items[c_vector.count++] = keys[i];
+	}
+
+	uint32_t sum = 0;
+
+	for (size_t i = 0; i < c_vector.count; i++)
+		sum += c_vector.items[i];
+
+	result = sum;
+}
+
+static void bench_cpp_vector(void) {
+	cpp_vector.clear();
+
+	for (int i = 0; i < ITERATIONS; i++)
+		cpp_vector.push(keys[i]);
+
+	uint32_t sum = 0;
+
+	for (auto item : cpp_vector)
+		sum += item;
+
+	result = sum;
+}
+
+/* Ring buffer */
+
+#define RING_SIZE 16
+
+struct CRing {
+	uint32_t items[RING_SIZE];
+	size_t   head, tail;
+};
+
+static CRing                                 c_ring;
+static util::RingBuffer<uint32_t, RING_SIZE> cpp_ring;
+
+static void bench_c_ring(void) {
+	uint32_t sum = 0;
+
+	c_ring.head = 0;
+	c_ring.tail = 0;
+
+	for (int i = 0; i < ITERATIONS; i++) {
+		if ((c_ring.tail - c_ring.head) < RING_SIZE)
+			c_ring.items[(c_ring.tail++) % RING_SIZE] = keys[i];
+		if ((c_ring.tail - c_ring.head) >= (RING_SIZE / 2))
+			sum += c_ring.items[(c_ring.head++) % RING_SIZE];
+	}
+
+	result = sum;
+}
+
+static void bench_cpp_ring(void) {
+	uint32_t sum = 0, value;
+
+	cpp_ring.clear();
+
+	for (int i = 0; i < ITERATIONS; i++) {
+		cpp_ring.push(keys[i]);
+		if (cpp_ring.size() >= (RING_SIZE / 2)) {
+			cpp_ring.pop(&value);
+			sum += value;
+		}
+	}
+
+	result = sum;
+}
+
+/* Hash map */
+
+#define MAP_SIZE 256
+
+struct CMapEntry {
+	uint32_t key, value;
+	uint8_t  used;
+};
+
+static CMapEntry                                   c_map[MAP_SIZE];
+static util::HashMap<uint32_t, uint32_t, MAP_SIZE> cpp_map;
+
+static CMapEntry *c_map_find(uint32_t key, int insert) {
+	uint32_t hash  = key * 0x9e3779b9;
+	size_t   index = (hash ^ (hash >> 16)) % MAP_SIZE;
+
+	for (int i = 0; i < MAP_SIZE; i++, index = (index + 1) % MAP_SIZE) {
+		CMapEntry *entry = &c_map[index];
+
+		if (!entry->used)
+			return insert ? entry : 0;
+		if (entry->key == key)
+			return entry;
+	}
+
+	return 0;
+}
+
+static void bench_c_map(void) {
+	for (int i = 0; i < MAP_SIZE; i++)
+		c_map[i].used = 0;
+
+	for (int i = 0; i < ITERATIONS; i++) {
+		CMapEntry *entry = c_map_find(keys[i], 1);
+
+		if (entry) {
+			entry->key   = keys[i];
+			entry->value = i;
+			entry->used  = 1;
+		}
+	}
+
+	uint32_t sum = 0;
+
+	for (int i = 0; i < ITERATIONS; i++)
+		sum += c_map_find(keys[i], 0)->value;
+
+	result = sum;
+}
+
+static void bench_cpp_map(void) {
+	cpp_map.clear();
+
+	for (int i = 0; i < ITERATIONS; i++)
+		cpp_map.set(keys[i], i);
+
+	uint32_t sum = 0;
+
+	for (int i = 0; i < ITERATIONS; i++)
+		sum += *cpp_map.get(keys[i]);
+
+	result = sum;
+}
+
+/* Linked list */
+
+struct CNode {
+	CNode    *prev, *next;
+	uint32_t value;
+};
+
+struct CppNode : public util::ListNode<CppNode> {
+	uint32_t value;
+};
+
+static CNode                        c_nodes[ITERATIONS];
+static CNode                        *c_head, *c_tail;
+static CppNode                      cpp_nodes[ITERATIONS];
+static util::IntrusiveList<CppNode> cpp_list;
+
+static void bench_c_list(void) {
+	c_head = 0;
+	c_tail = 0;
+
+	for (int i = 0; i < ITERATIONS; i++) {
+		CNode *node = &c_nodes[i];
+
+		node->value = keys[i];
+		node->prev  = c_tail;
+		node->next  = 0;
+
+		if (c_tail)
+			c_tail->next = node;
+		else
+			c_head = node;
+
+		c_tail = node;
+	}
+
+	uint32_t sum = 0;
+
+	for (CNode *node = c_head; node; node = node->next)
+		sum += node->value;
+
+	result = sum;
+}
+
+static void bench_cpp_list(void) {
+	cpp_list.clear();
+
+	for (int i = 0; i < ITERATIONS; i++) {
+		cpp_nodes[i].value = keys[i];
+		cpp_list.pushBack(&cpp_nodes[i]);
+	}
+
+	uint32_t sum = 0;
+
+	for (auto &node : cpp_list)
+		sum += node.value;
+
+	result = sum;
+}
+
+/* Callables */
+
+static uint32_t _accumulator;
+
+static void add_value(uint32_t value) {
+	_accumulator += value;
+}
+
+static void (*volatile c_callback)(uint32_t) = &add_value;
+static util::Function<void(uint32_t)> cpp_callback;
+
+static void bench_c_callback(void) {
+	_accumulator = 0;
+
+	for (int i = 0; i < ITERATIONS; i++)
+		c_callback(keys[i]);
+
+	result = _accumulator;
+}
+
+static void bench_cpp_callback(void) {
+	_accumulator = 0;
+
+	for (int i = 0; i < ITERATIONS; i++)
+		cpp_callback(keys[i]);
+
+	result = _accumulator;
+}
+
+/* GPU primitives */
+
+#define OT_LENGTH 8
+
+static uint32_t ot[OT_LENGTH];
+static uint32_t packets[ITERATIONS * sizeof(POLY_FT4) / 4];
+
+static uint32_t packet_checksum(void) {
+	uint32_t sum = 0;
+
+	for (size_t i = 0; i < (sizeof(packets) / 4); i++)
+		sum = (sum << 1 | sum >> 31) ^ packets[i];
+	for (int i = 0; i < OT_LENGTH; i++)
+		sum = (sum << 1 | sum >> 31) ^ ot[i];
+
+	return sum;
+}
+
+static void bench_c_tile(void) {
+	TILE *tile = (TILE *) packets;
+
+	ClearOTagR(ot, OT_LENGTH);
+
+	for (int i = 0; i < ITERATIONS; i++, tile++) {
+		setTile(tile);
+		setXY0(tile, keys[i] % 256, 32);
+		setWH(tile, 128, 128);
+		setRGB0(tile, 255, 255, 0);
+		addPrim(&ot[i % OT_LENGTH], tile);
+	}
+}
+
+static void bench_cpp_tile(void) {
+	auto tile = reinterpret_cast<util::gpu::Tile<> *>(packets);
+
+	ClearOTagR(ot, OT_LENGTH);
+
+	for (int i = 0; i < ITERATIONS; i++, tile++) {
+		tile->color(255, 255, 0);
+		tile->xy(keys[i] % 256, 32);
+		tile->size(128, 128);
+		util::gpu::insert(&ot[i % OT_LENGTH], tile);
+	}
+}
+
+static void bench_c_quad(void) {
+	POLY_FT4 *quad = (POLY_FT4 *) packets;
+
+	ClearOTagR(ot, OT_LENGTH);
+
+	for (int i = 0; i < ITERATIONS; i++, quad++) {
+		setPolyFT4(quad);
+		setRGB0(quad, 128, 128, 128);
+		setXYWH(quad, keys[i] % 256, (keys[i] >> 8) % 128, 64, 64);
+		setUVWH(quad, 0, 0, 63, 63);
+		setClut(quad, 0, 480);
+		setTPage(quad, 0, 0, 640, 0);
+		addPrim(&ot[i % OT_LENGTH], quad);
+	}
+}
+
+static void bench_cpp_quad(void) {
+	auto quad = reinterpret_cast<util::gpu::PolyFT4<> *>(packets);
+
+	ClearOTagR(ot, OT_LENGTH);
+
+	for (int i = 0; i < ITERATIONS; i++, quad++) {
+		quad->color(128, 128, 128);
+		quad->rect(keys[i] % 256, (keys[i] >> 8) % 128, 64, 64);
+		quad->texture(
+			util::gpu::tpage(0, 0, 640, 0), util::gpu::clut(0, 480),
+			0, 0, 63, 63
+		);
+		util::gpu::insert(&ot[i % OT_LENGTH], quad);
+	}
+}
+
+static void bench_empty(void) {
+	for (int i = 0; i < ITERATIONS; i++)
+		result = keys[i];
+}
+
+/* Benchmark list */
+
+struct Benchmark {
+	const char *name;
+	void       (*c_func)(void);
+	void       (*cpp_func)(void);
+	size_t     c_size, cpp_size;
+};
+
+static const Benchmark benchmarks[] = {
+	{
+		"vector push+iterate", &bench_c_vector, &bench_cpp_vector,
+		sizeof(c_vector), sizeof(cpp_vector)
+	}, {
+		"ring push+pop", &bench_c_ring, &bench_cpp_ring,
+		sizeof(c_ring), sizeof(cpp_ring)
+	}, {
+		"hash map set+get", &bench_c_map, &bench_cpp_map,
+		sizeof(c_map), sizeof(cpp_map)
+	}, {
+		"list push+iterate", &bench_c_list, &bench_cpp_list,
+		sizeof(c_nodes) + sizeof(c_head) * 2, sizeof(cpp_nodes) + sizeof(cpp_list)
+	}, {
+		"callback call", &bench_c_callback, &bench_cpp_callback,
+		sizeof(c_callback), sizeof(cpp_callback)
+	}, {
+		"GPU tile", &bench_c_tile, &bench_cpp_tile,
+		sizeof(TILE), sizeof(util::gpu::Tile<>)
+	}, {
+		"GPU textured quad", &bench_c_quad, &bench_cpp_quad,
+		sizeof(POLY_FT4), sizeof(util::gpu::PolyFT4<>)
+	},
+	{ nullptr, nullptr, nullptr, 0, 0 }
+};
+
+/* Main */
+
+int main(int argc, const char* argv[]) {
+	ResetGraph(0);
+
+	// Generate unique keys. Multiplying by an odd constant is a bijection, so
+	// no two keys are the same.
+	for (int i = 0; i < ITERATIONS; i++)
+		keys[i] = (i + 1) * 0x2545f491;
+
+	cpp_callback = [](uint32_t value) {
+		_accumulator += value;
+	};
+
+	printf("\nC++ utility library benchmark, %d iterations\n", ITERATIONS);
+	printf(
+		"%-20s %8s %8s %8s %8s\n",
+		"Benchmark", "C cyc", "C++ cyc", "C size", "C++ size"
+	);
+
+	bench_calibrate(&bench_empty);
+
+	for (const Benchmark *bench = benchmarks; bench->name; bench++) {
+		// The psxgpu.h macros leave padding fields in primitives untouched,
+		// so the buffer must be cleared for the packets to match.
+		memset(packets, 0, sizeof(packets));
+
+		// The GPU benchmarks leave their output in the packet buffer rather
+		// than in the result variable, so it is included in the comparison.
+		uint32_t c_cycles   = bench_measure(bench->c_func);
+		uint32_t c_result   = result ^ packet_checksum();
+		uint32_t cpp_cycles = bench_measure(bench->cpp_func);
+		uint32_t cpp_result = result ^ packet_checksum();
+
+		printf(
+			"%-20s %8d %8d %8d %8d%s\n",
+			bench->name,
+			c_cycles / ITERATIONS,
+			cpp_cycles / ITERATIONS,
+			bench->c_size,
+			bench->cpp_size,
+			(c_result == cpp_result) ? "" : " (MISMATCH)"
+		);
+	}
+
+	for (;;)
+		__asm__ volatile("");
+
+	return 0;
+}
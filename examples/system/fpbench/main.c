@@ -0,0 +1,158 @@
+/*
+ * PSn00bSDK soft-float and fixed-point benchmark
+ * (C) 2022 PSn00bSDK contributors - MPL licensed
+ *
+ * This program measures the average number of CPU cycles taken by common
+ * floating-point operations (which are emulated in software, as the PS1 has no
+ * FPU), 64-bit integer multiplication and division, and the equivalent 16.16
+ * fixed-point operations provided by fixed.h. Results are printed to the TTY.
+ *
+ * The example is built twice: fpbench.exe uses the optimized soft-float and
+ * 64-bit arithmetic functions that ship with PSn00bSDK's libc, while
+ * fpbench_libgcc.exe is linked with libgcc before libc (see CMakeLists.txt) and
+ * thus uses GCC's generic implementations. Both versions print a checksum of
+ * all results, which should match as both are IEEE 754 compliant.
+ *
+ * See bench.h in the parent directory for how timings are obtained.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <psxgpu.h>
+#include <fixed.h>
+#include "../bench.h"
+
+#define ITERATIONS	128
+
+#ifdef USE_LIBGCC
+#define VARIANT_NAME "libgcc"
+#else
+#define VARIANT_NAME "PSn00bSDK libc"
+#endif
+
+/* Input and output buffers */
+
+static float   float_a[ITERATIONS], float_b[ITERATIONS];
+static int32_t int_a[ITERATIONS];
+static int64_t long_a[ITERATIONS], long_b[ITERATIONS];
+static fix16_t fix_a[ITERATIONS], fix_b[ITERATIONS];
+
+// The outputs are declared volatile to prevent GCC from optimizing away the
+// operations being benchmarked.
+static volatile float   float_out[ITERATIONS];
+static volatile int32_t int_out[ITERATIONS];
+static volatile int64_t long_out[ITERATIONS];
+
+static void init_inputs(void) {
+	for (int i = 0; i < ITERATIONS; i++) {
+		// Generate nonzero values in the -1000 to 1000 range.
+		int32_t x = (int32_t) (bench_random() % 2000000) - 1000000;
+		int32_t y = (int32_t) (bench_random() % 2000000) - 1000000;
+
+		x |= 1;
+		y |= 1;
+
+		float_a[i] = (float) x / 1000.0f;
+		float_b[i] = (float) y / 1000.0f;
+		int_a[i]   = x;
+		long_a[i]  = ((int64_t) x << 24) ^ bench_random();
+		long_b[i]  = ((int64_t) y << (bench_random() % 24)) | 1;
+		fix_a[i]   = fix16_div(fix16_from_int(x), fix16_from_int(1000));
+		fix_b[i]   = fix16_div(fix16_from_int(y), fix16_from_int(1000));
+	}
+}
+
+/* Benchmarks */
+
+#define BENCHMARK(name, output, expr) \
+	static void bench_##name(void) { \
+		for (int i = 0; i < ITERATIONS; i++) \
+			output[i] = (expr); \
+	}
+
+BENCHMARK(empty,     int_out,   int_a[i])
+BENCHMARK(float_add, float_out, float_a[i] + float_b[i])
+BENCHMARK(float_sub, float_out, float_a[i] - float_b[i])
+BENCHMARK(float_mul, float_out, float_a[i] * float_b[i])
+BENCHMARK(float_div, float_out, float_a[i] / float_b[i])
+BENCHMARK(float_cmp, int_out,   float_a[i] < float_b[i])
+BENCHMARK(int_float, float_out, (float) int_a[i])
+BENCHMARK(float_int, int_out,   (int32_t) float_a[i])
+BENCHMARK(long_mul,  long_out,  long_a[i] * long_b[i])
+BENCHMARK(long_div,  long_out,  long_a[i] / long_b[i])
+BENCHMARK(long_mod,  long_out,  long_a[i] % long_b[i])
+BENCHMARK(fix16_mul, int_out,   fix16_mul(fix_a[i], fix_b[i]))
+BENCHMARK(fix16_div, int_out,   fix16_div(fix_a[i], fix_b[i]))
+BENCHMARK(fix16_muls, int_out,  fix16_muls(fix_a[i], fix_b[i]))
+
+typedef struct {
+	const char *name;
+	void       (*func)(void);
+} Benchmark;
+
+static const Benchmark benchmarks[] = {
+	{ "float add",            &bench_float_add },
+	{ "float sub",            &bench_float_sub },
+	{ "float mul",            &bench_float_mul },
+	{ "float div",            &bench_float_div },
+	{ "float compare",        &bench_float_cmp },
+	{ "int32 -> float",       &bench_int_float },
+	{ "float -> int32",       &bench_float_int },
+	{ "int64 mul",            &bench_long_mul },
+	{ "int64 div",            &bench_long_div },
+	{ "int64 mod",            &bench_long_mod },
+	{ "fix16 mul",            &bench_fix16_mul },
+	{ "fix16 div",            &bench_fix16_div },
+	{ "fix16 mul (saturate)", &bench_fix16_muls },
+	{ 0, 0 }
+};
+
+/* Checksum */
+
+static uint32_t checksum(void) {
+	uint32_t sum = 0;
+
+	for (int i = 0; i < ITERATIONS; i++) {
+		union {
+			float    f;
+			uint32_t u;
+		} value = { .f = float_out[i] };
+		int64_t long_value = long_out[i];
+
+		sum = (sum << 1 | sum >> 31) ^ value.u;
+		sum = (sum << 1 | sum >> 31) ^ (uint32_t) int_out[i];
+		sum = (sum << 1 | sum >> 31) ^ (uint32_t) long_value;
+		sum = (sum << 1 | sum >> 31) ^ (uint32_t) (long_value >> 32);
+	}
+
+	return sum;
+}
+
+/* Main */
+
+int main(int argc, const char* argv[]) {
+	ResetGraph(0);
+	init_inputs();
+
+	printf("\nSoft-float benchmark (%s), %d iterations\n", VARIANT_NAME, ITERATIONS);
+	printf("%-24s %10s\n", "Operation", "Cycles/op");
+
+	uint32_t sum = 0;
+
+	bench_calibrate(&bench_empty);
+
+	for (const Benchmark *bench = benchmarks; bench->name; bench++) {
+		uint32_t cycles = bench_measure(bench->func);
+
+		sum ^= checksum();
+
+		printf("%-24s %10d\n", bench->name, cycles / ITERATIONS);
+	}
+
+	printf("Checksum: %08x\n", sum);
+
+	for (;;)
+		__asm__ volatile("");
+
+	return 0;
+}
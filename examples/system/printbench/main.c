@@ -0,0 +1,151 @@
+/*
+ * PSn00bSDK printf benchmark
+ * (C) 2022 PSn00bSDK contributors - MPL licensed
+ *
+ * This program measures the average number of CPU cycles taken to format
+ * integers using sprintf() with various conversions and flags, as well as
+ * using vcbprintf() with a callback that discards the output (which shows the
+ * cost of formatting alone, without copying the result into a string).
+ * Results are printed to the TTY as cycles per formatted integer.
+ *
+ * For comparison, the last benchmark converts integers to decimal strings by
+ * repeatedly dividing them by 10, the way a naive itoa() would do. Each
+ * division takes 36 cycles on the R3000, which is what libc's printf engine
+ * avoids by converting two digits at a time using a multiplication instead.
+ *
+ * See bench.h in the parent directory for how timings are obtained.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <psxgpu.h>
+#include "../bench.h"
+
+#define ITERATIONS	64
+
+/* Inputs and outputs */
+
+static int32_t  small_values[ITERATIONS], large_values[ITERATIONS];
+static int64_t  long_values[ITERATIONS];
+static char     output[ITERATIONS][32];
+
+// All benchmarks store their result here to prevent GCC from optimizing away
+// the calls being benchmarked.
+static volatile int result;
+
+static void init_inputs(void) {
+	for (int i = 0; i < ITERATIONS; i++) {
+		small_values[i] = bench_random() % 100;
+		large_values[i] = (int32_t) bench_random();
+		long_values[i]  = ((int64_t) bench_random() << 32) | bench_random();
+	}
+}
+
+/* Output callbacks and reference conversion */
+
+static void null_sink(void *arg, const char *str, int length) {
+	*((int *) arg) += length;
+}
+
+static int null_printf(const char *fmt, ...) {
+	va_list ap;
+	int     length = 0;
+
+	va_start(ap, fmt);
+	vcbprintf(&null_sink, &length, fmt, ap);
+	va_end(ap);
+
+	return length;
+}
+
+static int naive_itoa(char *str, int32_t value) {
+	char     buffer[12];
+	char     *ptr = &buffer[sizeof(buffer)];
+	uint32_t abs  = (value < 0) ? -((uint32_t) value) : value;
+	int      length;
+
+	do {
+		*(--ptr) = '0' + (abs % 10);
+		abs     /= 10;
+	} while (abs);
+
+	if (value < 0)
+		*(--ptr) = '-';
+
+	length = &buffer[sizeof(buffer)] - ptr;
+
+	for (int i = 0; i < length; i++)
+		str[i] = ptr[i];
+
+	str[length] = 0;
+	return length;
+}
+
+/* Benchmarks */
+
+#define BENCHMARK(name, expr) \
+	static void bench_##name(void) { \
+		for (int i = 0; i < ITERATIONS; i++) \
+			result = (expr); \
+	}
+
+BENCHMARK(empty,       small_values[i])
+BENCHMARK(d_small,     sprintf(output[i], "%d", small_values[i]))
+BENCHMARK(d_large,     sprintf(output[i], "%d", large_values[i]))
+BENCHMARK(u_large,     sprintf(output[i], "%u", large_values[i]))
+BENCHMARK(d_padded,    sprintf(output[i], "%8d", small_values[i]))
+BENCHMARK(d_zero,      sprintf(output[i], "%+011d", large_values[i]))
+BENCHMARK(x_large,     sprintf(output[i], "%08x", large_values[i]))
+BENCHMARK(lld_large,   sprintf(output[i], "%lld", long_values[i]))
+BENCHMARK(d_three,     sprintf(output[i], "%d,%d,%d", small_values[i], large_values[i], small_values[i]))
+BENCHMARK(cb_d_large,  null_printf("%d", large_values[i]))
+BENCHMARK(naive_large, naive_itoa(output[i], large_values[i]))
+
+typedef struct {
+	const char *name;
+	void       (*func)(void);
+	int        count; // Number of integers formatted per iteration
+} Benchmark;
+
+static const Benchmark benchmarks[] = {
+	{ "%d (0-99)",            &bench_d_small,     1 },
+	{ "%d (32-bit)",          &bench_d_large,     1 },
+	{ "%u (32-bit)",          &bench_u_large,     1 },
+	{ "%8d (0-99)",           &bench_d_padded,    1 },
+	{ "%+011d (32-bit)",      &bench_d_zero,      1 },
+	{ "%08x (32-bit)",        &bench_x_large,     1 },
+	{ "%lld (64-bit)",        &bench_lld_large,   1 },
+	{ "%d,%d,%d",             &bench_d_three,     3 },
+	{ "vcbprintf %d",         &bench_cb_d_large,  1 },
+	{ "naive itoa (32-bit)",  &bench_naive_large, 1 },
+	{ 0, 0, 0 }
+};
+
+/* Main */
+
+int main(int argc, const char* argv[]) {
+	ResetGraph(0);
+	init_inputs();
+
+	printf("\nprintf benchmark, %d iterations\n", ITERATIONS);
+	printf("%-24s %10s  %s\n", "Format", "Cycles/int", "Sample output");
+
+	bench_calibrate(&bench_empty);
+
+	for (const Benchmark *bench = benchmarks; bench->name; bench++) {
+		uint32_t cycles = bench_measure(bench->func);
+
+		// The vcbprintf() benchmark does not write to the output buffers.
+		printf(
+			"%-24s %10d  %s\n",
+			bench->name,
+			cycles / (ITERATIONS * bench->count),
+			(bench->func == &bench_cb_d_large) ? "" : output[0]
+		);
+	}
+
+	for (;;)
+		__asm__ volatile("");
+
+	return 0;
+}
@@ -0,0 +1,541 @@
+/*
+ * PSn00bSDK string function test and benchmark
+ * (C) 2022 PSn00bSDK contributors - MPL licensed
+ *
+ * This program checks the string and memory functions provided by libc
+ * (several of which are written in assembly and process 4 bytes at a time)
+ * against simple byte-by-byte reference implementations, then compares their
+ * speed. Results are printed to the TTY.
+ *
+ * The test runs every function on all combinations of source and destination
+ * alignments, string lengths and positions of the first mismatching, matching
+ * or terminating character, including strings that are prefixes of each other.
+ * Output buffers are surrounded by a fill pattern to detect writes past the
+ * end of the string. Only the sign of comparison results is checked, as the
+ * standard does not define their magnitude.
+ *
+ * See bench.h in the parent directory for how timings are obtained.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <psxgpu.h>
+#include "../bench.h"
+
+#define MAX_LENGTH	40
+#define BUFFER_SIZE	512
+#define FILL_VALUE	0xa5
+
+#define ITERATIONS	16
+
+static int _sign(int value) {
+	return (value > 0) - (value < 0);
+}
+
+/* Reference implementations */
+
+// Loop distribution is disabled for the reference functions as GCC could
+// otherwise turn their loops back into calls to the libc functions.
+#define REFERENCE __attribute__((noinline, optimize("no-tree-loop-distribute-patterns")))
+
+static REFERENCE int ref_memcmp(const void *b1, const void *b2, int n) {
+	const uint8_t *p1 = b1, *p2 = b2;
+
+	for (; n > 0; n--, p1++, p2++) {
+		if (*p1 != *p2)
+			return *p1 - *p2;
+	}
+
+	return 0;
+}
+
+static REFERENCE void *ref_memchr(const void *s, int c, int n) {
+	const uint8_t *ptr = s;
+
+	for (; n > 0; n--, ptr++) {
+		if (*ptr == (uint8_t) c)
+			return (void *) ptr;
+	}
+
+	return NULL;
+}
+
+static REFERENCE int ref_strlen(const char *s) {
+	int len = 0;
+
+	while (s[len])
+		len++;
+
+	return len;
+}
+
+static REFERENCE int ref_strncmp(const char *s1, const char *s2, int n) {
+	for (; n > 0; n--, s1++, s2++) {
+		uint8_t a = *s1, b = *s2;
+
+		if (a != b)
+			return a - b;
+		if (!a)
+			break;
+	}
+
+	return 0;
+}
+
+static REFERENCE int ref_strcmp(const char *s1, const char *s2) {
+	return ref_strncmp(s1, s2, 0x7fffffff);
+}
+
+static REFERENCE char *ref_strncpy(char *dst, const char *src, int n) {
+	char *ptr = dst;
+
+	for (; (n > 0) && *src; n--)
+		*(ptr++) = *(src++);
+	for (; n > 0; n--)
+		*(ptr++) = 0;
+
+	return dst;
+}
+
+static REFERENCE char *ref_strcpy(char *dst, const char *src) {
+	char *ptr = dst;
+
+	while ((*(ptr++) = *(src++)))
+		;
+
+	return dst;
+}
+
+static REFERENCE char *ref_strncat(char *dst, const char *src, int n) {
+	char *ptr = dst + ref_strlen(dst);
+
+	for (; (n > 0) && *src; n--)
+		*(ptr++) = *(src++);
+
+	*ptr = 0;
+	return dst;
+}
+
+static REFERENCE char *ref_strchr(const char *s, int c) {
+	for (;; s++) {
+		if (*((const uint8_t *) s) == (uint8_t) c)
+			return (char *) s;
+		if (!*s)
+			return NULL;
+	}
+}
+
+static REFERENCE char *ref_strrchr(const char *s, int c) {
+	const char *last = NULL;
+
+	for (;; s++) {
+		if (*((const uint8_t *) s) == (uint8_t) c)
+			last = s;
+		if (!*s)
+			return (char *) last;
+	}
+}
+
+static REFERENCE char *ref_strpbrk(const char *s, const char *set) {
+	for (; *s; s++) {
+		if (ref_strchr(set, *s))
+			return (char *) s;
+	}
+
+	return NULL;
+}
+
+static REFERENCE size_t ref_strspn(const char *s, const char *set) {
+	size_t len = 0;
+
+	for (; s[len] && ref_strchr(set, s[len]); len++)
+		;
+
+	return len;
+}
+
+static REFERENCE size_t ref_strcspn(const char *s, const char *set) {
+	size_t len = 0;
+
+	for (; s[len] && !ref_strchr(set, s[len]); len++)
+		;
+
+	return len;
+}
+
+static REFERENCE char *ref_strstr(const char *big, const char *little) {
+	int len = ref_strlen(little);
+
+	for (; *big; big++) {
+		if (!ref_strncmp(big, little, len))
+			return (char *) big;
+	}
+
+	return len ? NULL : (char *) big;
+}
+
+/* Test */
+
+typedef enum {
+	TEST_MEMCMP,
+	TEST_MEMCHR,
+	TEST_STRLEN,
+	TEST_STRCMP,
+	TEST_STRNCMP,
+	TEST_STRCPY,
+	TEST_STRNCPY,
+	TEST_STRCAT,
+	TEST_STRNCAT,
+	TEST_STRCHR,
+	TEST_STRRCHR,
+	TEST_STRPBRK,
+	TEST_STRSPN,
+	TEST_STRCSPN,
+	TEST_STRSTR,
+	TEST_COUNT
+} TestID;
+
+static const char *const test_names[TEST_COUNT] = {
+	"memcmp",
+	"memchr",
+	"strlen",
+	"strcmp",
+	"strncmp",
+	"strcpy",
+	"strncpy",
+	"strcat",
+	"strncat",
+	"strchr",
+	"strrchr",
+	"strpbrk",
+	"strspn",
+	"strcspn",
+	"strstr"
+};
+
+static int test_failures[TEST_COUNT];
+
+// The characters strings are made of include the values most likely to
+// confuse the zero byte check used by the word loops, as well as a few
+// repeated letters so that substring searches find partial matches.
+static const uint8_t char_pool[] = {
+	'a', 'b', 'a', 'b', 'c', 0x01, 0x7f, 0x80, 0x81, 0xfe, 0xff
+};
+
+static uint8_t buffer_a[BUFFER_SIZE], buffer_b[BUFFER_SIZE];
+static uint8_t output_a[BUFFER_SIZE], output_b[BUFFER_SIZE];
+
+typedef struct {
+	int align_a, align_b, length, pos, prefix;
+} TestCase;
+
+static void check(TestID test, int ok, const TestCase *tc) {
+	if (ok)
+		return;
+
+	// Only print the first failure of each function.
+	if (!(test_failures[test]++))
+		printf(
+			"%s failed: align=%d,%d len=%d pos=%d prefix=%d\n",
+			test_names[test], tc->align_a, tc->align_b, tc->length, tc->pos,
+			tc->prefix
+		);
+}
+
+static void clear_outputs(void) {
+	memset(output_a, FILL_VALUE, BUFFER_SIZE);
+	memset(output_b, FILL_VALUE, BUFFER_SIZE);
+}
+
+static int compare_outputs(void *result_a, void *result_b) {
+	if ((uint8_t *) result_a - output_a != (uint8_t *) result_b - output_b)
+		return 0;
+
+	return !ref_memcmp(output_a, output_b, BUFFER_SIZE);
+}
+
+static void run_case(const TestCase *tc) {
+	char *a = (char *) &buffer_a[tc->align_a];
+	char *b = (char *) &buffer_b[tc->align_b];
+	int  len = tc->length, pos = tc->pos;
+
+	// Generate a random string and a copy of it that differs (or ends, if
+	// prefix is set) at the given position. Both are followed by garbage.
+	for (int i = 0; i < BUFFER_SIZE; i++) {
+		buffer_a[i] = bench_random();
+		buffer_b[i] = bench_random();
+	}
+	for (int i = 0; i < len; i++)
+		a[i] = char_pool[bench_random() % sizeof(char_pool)];
+
+	a[len] = 0;
+
+	for (int i = 0; i <= len; i++)
+		b[i] = a[i];
+
+	uint8_t c = 'z';
+
+	if (pos >= 0) {
+		c = a[pos];
+
+		if (tc->prefix)
+			b[pos] = 0;
+		else
+			b[pos] = (c == 'z') ? 'y' : 'z';
+	}
+
+	char set[4] = { c, char_pool[bench_random() % sizeof(char_pool)], 0, 0 };
+
+	/* Memory functions */
+
+	check(TEST_MEMCMP,
+		_sign(memcmp(a, b, len + 1)) == _sign(ref_memcmp(a, b, len + 1)), tc);
+	check(TEST_MEMCMP,
+		_sign(memcmp(b, a, len + 1)) == _sign(ref_memcmp(b, a, len + 1)), tc);
+	check(TEST_MEMCHR,
+		memchr(a, c, len) == ref_memchr(a, c, len), tc);
+	check(TEST_MEMCHR,
+		memchr(a, c | 0x100, len) == ref_memchr(a, c, len), tc);
+
+	/* Comparison and searching */
+
+	check(TEST_STRLEN, strlen(a) == ref_strlen(a), tc);
+	check(TEST_STRLEN, strlen(b) == ref_strlen(b), tc);
+	check(TEST_STRCMP, _sign(strcmp(a, b)) == _sign(ref_strcmp(a, b)), tc);
+	check(TEST_STRCMP, _sign(strcmp(b, a)) == _sign(ref_strcmp(b, a)), tc);
+
+	for (int n = (pos > 0) ? (pos - 1) : 0; n <= len + 1; n += (len / 2) + 1)
+		check(TEST_STRNCMP,
+			_sign(strncmp(a, b, n)) == _sign(ref_strncmp(a, b, n)), tc);
+
+	check(TEST_STRCHR, strchr(a, c) == ref_strchr(a, c), tc);
+	check(TEST_STRCHR, strchr(a, 0) == ref_strchr(a, 0), tc);
+	check(TEST_STRRCHR, strrchr(a, c) == ref_strrchr(a, c), tc);
+	check(TEST_STRPBRK, strpbrk(a, set) == ref_strpbrk(a, set), tc);
+	check(TEST_STRSPN, strspn(a, set) == ref_strspn(a, set), tc);
+	check(TEST_STRCSPN, strcspn(a, set) == ref_strcspn(a, set), tc);
+
+	// Search for a substring of a starting at the mismatch position, as well
+	// as for b itself (which is only found if it is a prefix of a).
+	if (pos >= 0) {
+		char needle[8];
+		int  needle_len = bench_random() % 6;
+
+		for (int i = 0; i < needle_len; i++)
+			needle[i] = a[(pos + i) % len];
+
+		needle[needle_len] = 0;
+		check(TEST_STRSTR, strstr(a, needle) == ref_strstr(a, needle), tc);
+	}
+
+	check(TEST_STRSTR, strstr(a, b) == ref_strstr(a, b), tc);
+
+	/* Copying */
+
+	// The output buffers are aligned like b, so the copy functions see the
+	// same relative alignment between source and destination as the
+	// comparison functions.
+	char *dst_a = (char *) &output_a[tc->align_b];
+	char *dst_b = (char *) &output_b[tc->align_b];
+
+	clear_outputs();
+	check(TEST_STRCPY,
+		compare_outputs(strcpy(dst_a, a), ref_strcpy(dst_b, a)), tc);
+
+	for (int n = (pos > 0) ? pos : 0; n <= len + 4; n += (len / 2) + 2) {
+		clear_outputs();
+		check(TEST_STRNCPY,
+			compare_outputs(strncpy(dst_a, a, n), ref_strncpy(dst_b, a, n)), tc);
+	}
+
+	// Concatenate a to a prefix of b, so that the destination string starts
+	// at a different alignment.
+	int split = (pos >= 0) ? pos : len;
+
+	clear_outputs();
+	ref_strncpy(dst_a, b, split);
+	ref_strncpy(dst_b, b, split);
+	dst_a[split] = 0;
+	dst_b[split] = 0;
+	check(TEST_STRCAT,
+		compare_outputs(strcat(dst_a, a), ref_strncat(dst_b, a, BUFFER_SIZE)), tc);
+
+	clear_outputs();
+	dst_a[0] = 0;
+	dst_b[0] = 0;
+	check(TEST_STRNCAT,
+		compare_outputs(strncat(dst_a, a, split), ref_strncat(dst_b, a, split)), tc);
+}
+
+static int run_tests(void) {
+	int cases = 0, failures = 0;
+
+	for (int align_a = 0; align_a < 4; align_a++) {
+		for (int align_b = 0; align_b < 4; align_b++) {
+			for (int len = 0; len <= MAX_LENGTH; len++) {
+				for (int pos = -1; pos < len; pos++) {
+					for (int prefix = 0; prefix < 2; prefix++) {
+						if ((pos < 0) && prefix)
+							continue;
+
+						TestCase tc = { align_a, align_b, len, pos, prefix };
+
+						run_case(&tc);
+						cases++;
+					}
+				}
+			}
+		}
+	}
+
+	printf("%-10s %10s\n", "Function", "Failures");
+
+	for (int i = 0; i < TEST_COUNT; i++) {
+		printf("%-10s %10d\n", test_names[i], test_failures[i]);
+		failures += test_failures[i];
+	}
+
+	printf("%d test cases, %d failures\n", cases, failures);
+	return failures;
+}
+
+/* Benchmarks */
+
+#define BENCH_SIZE	256
+
+// All benchmarks store their result here to prevent GCC from optimizing away
+// the calls being benchmarked.
+static volatile uint32_t result;
+
+static char bench_a[BENCH_SIZE + 4], bench_b[BENCH_SIZE + 4];
+static char bench_dst[BENCH_SIZE + 8];
+static char bench_needle[8];
+static int  bench_length;
+
+static void init_bench_strings(int length) {
+	// Use lowercase letters only, so that searching for 'z' always scans the
+	// whole string. The needle is the end of the string.
+	for (int i = 0; i < length; i++)
+		bench_a[i] = 'a' + (bench_random() % 25);
+
+	bench_a[length] = 0;
+	ref_strcpy(bench_b, bench_a);
+	ref_strcpy(bench_needle, &bench_a[length - 6]);
+
+	bench_length = length;
+}
+
+#define BENCHMARK(name, libc_expr, ref_expr) \
+	static void bench_libc_##name(void) { \
+		for (int i = 0; i < ITERATIONS; i++) \
+			result = (uint32_t) (libc_expr); \
+	} \
+	static void bench_ref_##name(void) { \
+		for (int i = 0; i < ITERATIONS; i++) \
+			result = (uint32_t) (ref_expr); \
+	}
+
+static void bench_empty(void) {
+	for (int i = 0; i < ITERATIONS; i++)
+		result = (uint32_t) bench_length;
+}
+
+BENCHMARK(memcmp,
+	memcmp(bench_a, bench_b, bench_length),
+	ref_memcmp(bench_a, bench_b, bench_length))
+BENCHMARK(memcmp_misaligned,
+	memcmp(&bench_a[1], &bench_b[2], bench_length - 2),
+	ref_memcmp(&bench_a[1], &bench_b[2], bench_length - 2))
+BENCHMARK(memchr,
+	memchr(bench_a, 'z', bench_length),
+	ref_memchr(bench_a, 'z', bench_length))
+BENCHMARK(strlen,
+	strlen(bench_a),
+	ref_strlen(bench_a))
+BENCHMARK(strcmp,
+	strcmp(bench_a, bench_b),
+	ref_strcmp(bench_a, bench_b))
+BENCHMARK(strncmp,
+	strncmp(bench_a, bench_b, bench_length),
+	ref_strncmp(bench_a, bench_b, bench_length))
+BENCHMARK(strcpy,
+	strcpy(bench_dst, bench_a),
+	ref_strcpy(bench_dst, bench_a))
+BENCHMARK(strcpy_misaligned,
+	strcpy(&bench_dst[1], bench_a),
+	ref_strcpy(&bench_dst[1], bench_a))
+BENCHMARK(strchr,
+	strchr(bench_a, 'z'),
+	ref_strchr(bench_a, 'z'))
+BENCHMARK(strrchr,
+	strrchr(bench_a, 'a'),
+	ref_strrchr(bench_a, 'a'))
+BENCHMARK(strstr,
+	strstr(bench_a, bench_needle),
+	ref_strstr(bench_a, bench_needle))
+
+typedef struct {
+	const char *name;
+	void       (*libc_func)(void);
+	void       (*ref_func)(void);
+} Benchmark;
+
+#define _ENTRY(name, func) { name, &bench_libc_##func, &bench_ref_##func }
+
+static const Benchmark benchmarks[] = {
+	_ENTRY("memcmp",              memcmp),
+	_ENTRY("memcmp (misaligned)", memcmp_misaligned),
+	_ENTRY("memchr",              memchr),
+	_ENTRY("strlen",              strlen),
+	_ENTRY("strcmp",              strcmp),
+	_ENTRY("strncmp",             strncmp),
+	_ENTRY("strcpy",              strcpy),
+	_ENTRY("strcpy (misaligned)", strcpy_misaligned),
+	_ENTRY("strchr",              strchr),
+	_ENTRY("strrchr",             strrchr),
+	_ENTRY("strstr",              strstr),
+	{ 0, 0, 0 }
+};
+
+static void run_benchmarks(int length) {
+	init_bench_strings(length);
+
+	printf("\n%d byte strings, %d iterations\n", length, ITERATIONS);
+	printf("%-20s %10s %10s\n", "Function", "libc cyc", "ref cyc");
+
+	bench_calibrate(&bench_empty);
+
+	for (const Benchmark *bench = benchmarks; bench->name; bench++) {
+		uint32_t libc_cycles = bench_measure(bench->libc_func);
+		uint32_t libc_result = result;
+		uint32_t ref_cycles  = bench_measure(bench->ref_func);
+		uint32_t ref_result  = result;
+
+		printf(
+			"%-20s %10d %10d%s\n",
+			bench->name,
+			libc_cycles / ITERATIONS,
+			ref_cycles / ITERATIONS,
+			(libc_result == ref_result) ? "" : " (MISMATCH)"
+		);
+	}
+}
+
+/* Main */
+
+int main(int argc, const char* argv[]) {
+	ResetGraph(0);
+
+	printf("\nString function test, lengths 0-%d\n", MAX_LENGTH);
+	run_tests();
+
+	printf("\nString function benchmark\n");
+	run_benchmarks(16);
+	run_benchmarks(BENCH_SIZE);
+
+	for (;;)
+		__asm__ volatile("");
+
+	return 0;
+}
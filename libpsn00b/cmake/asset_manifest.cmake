@@ -0,0 +1,57 @@
+# PSn00bSDK asset manifest generator
+# (C) 2022 PSn00bSDK contributors - MPL licensed
+
+# This script is run by the build rules generated by psn00bsdk_add_asset()
+# after all assets in a group have been cooked. It generates a C header listing
+# the size and hash of each cooked file, with LIST_FILE set to the path of a
+# generated script defining the group's name and files. The header is only
+# rewritten if its contents change, so source files including it are not
+# recompiled unless an asset was actually modified; the STAMP file is touched
+# instead to mark the command as done.
+
+cmake_minimum_required(VERSION 3.21)
+
+if(NOT DEFINED LIST_FILE OR NOT DEFINED STAMP)
+	message(FATAL_ERROR "This script is not meant to be invoked directly.")
+endif()
+
+include(${LIST_FILE})
+
+string(MAKE_C_IDENTIFIER ${ASSET_GROUP} _prefix)
+string(TOUPPER ${_prefix} _prefix)
+list(LENGTH ASSET_FILES _count)
+
+set(_defines "")
+set(_list    "")
+set(_index   0)
+
+foreach(_file IN LISTS ASSET_FILES)
+	cmake_path(RELATIVE_PATH _file BASE_DIRECTORY ${ASSET_BASE_DIRECTORY} OUTPUT_VARIABLE _name)
+	string(MAKE_C_IDENTIFIER ${_name} _id)
+	string(TOUPPER ${_id} _id)
+
+	file(SIZE ${_file} _size)
+	file(SHA1 ${_file} _hash)
+	string(SUBSTRING ${_hash} 0 8 _hash)
+
+	string(APPEND _defines "#define ${_prefix}_${_id}\t\t${_index}\n")
+	string(APPEND _defines "#define ${_prefix}_${_id}_SIZE\t${_size}\n")
+	string(APPEND _defines "#define ${_prefix}_${_id}_HASH\t0x${_hash}\n\n")
+	string(APPEND _list    " \\\n\tX(${_id}, \"${_name}\", ${_size}, 0x${_hash})")
+
+	math(EXPR _index "${_index} + 1")
+endforeach()
+
+file(
+	WRITE ${OUTPUT}.tmp
+	"/* Generated by psn00bsdk_add_asset(), do not edit */\n\n"
+	"#ifndef __${_prefix}_H\n"
+	"#define __${_prefix}_H\n\n"
+	"#define ${_prefix}_COUNT\t${_count}\n\n"
+	"${_defines}"
+	"#define ${_prefix}_LIST(X)${_list}\n\n"
+	"#endif\n"
+)
+file(COPY_FILE ${OUTPUT}.tmp ${OUTPUT} ONLY_IF_DIFFERENT)
+file(REMOVE ${OUTPUT}.tmp)
+file(TOUCH ${STAMP})
@@ -0,0 +1,77 @@
+# PSn00bSDK asset cooking script
+# (C) 2022 PSn00bSDK contributors - MPL licensed
+
+# This script is run by the build rules generated by psn00bsdk_add_asset(),
+# with COOK_FILE set to the path of a generated script defining the asset's
+# converter command line, inputs and outputs. The converter is only invoked if
+# the command line or the contents of any input (including the converter
+# itself) actually changed since the last successful run; otherwise only the
+# stamp file is touched and the outputs are left alone, so anything depending
+# on them is not rebuilt either.
+
+cmake_minimum_required(VERSION 3.21)
+
+if(NOT DEFINED COOK_FILE)
+	message(FATAL_ERROR "This script is not meant to be invoked directly.")
+endif()
+
+include(${COOK_FILE})
+
+## Hashing
+
+string(SHA1 _hash "${ASSET_COMMAND}")
+
+foreach(_input IN LISTS ASSET_INPUTS)
+	if(NOT EXISTS ${_input})
+		message(FATAL_ERROR "Failed to cook ${ASSET_NAME}, input file ${_input} does not exist.")
+	endif()
+
+	file(SHA1 ${_input} _input_hash)
+	string(SHA1 _hash "${_hash} ${_input_hash}")
+endforeach()
+
+set(_up_to_date OFF)
+if(EXISTS ${ASSET_STAMP})
+	file(READ ${ASSET_STAMP} _last_hash)
+
+	if(_last_hash STREQUAL _hash)
+		set(_up_to_date ON)
+	endif()
+endif()
+
+# Outputs deleted or never generated (e.g. after a failed run) must be cooked
+# again regardless of the hash.
+foreach(_output IN LISTS ASSET_OUTPUTS)
+	if(NOT EXISTS ${_output})
+		set(_up_to_date OFF)
+	endif()
+endforeach()
+
+if(_up_to_date)
+	message(VERBOSE "${ASSET_NAME} is up-to-date, skipping")
+	file(TOUCH ${ASSET_STAMP})
+	return()
+endif()
+
+## Cooking
+
+# The stamp is removed beforehand so a failed or interrupted run will not leave
+# a valid stamp behind.
+file(REMOVE ${ASSET_STAMP})
+
+execute_process(
+	COMMAND           ${ASSET_COMMAND}
+	WORKING_DIRECTORY ${ASSET_WORKING_DIRECTORY}
+	RESULT_VARIABLE   _result
+)
+if(NOT _result EQUAL 0)
+	message(FATAL_ERROR "Failed to cook ${ASSET_NAME}, converter returned ${_result}.")
+endif()
+
+foreach(_output IN LISTS ASSET_OUTPUTS)
+	if(NOT EXISTS ${_output})
+		message(FATAL_ERROR "Failed to cook ${ASSET_NAME}, converter did not generate ${_output}.")
+	endif()
+endforeach()
+
+file(WRITE ${ASSET_STAMP} ${_hash})
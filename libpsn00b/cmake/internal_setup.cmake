@@ -63,6 +63,23 @@ set(PSN00BSDK_EXECUTABLE_SUFFIX     ".exe")
 set(PSN00BSDK_SHARED_LIBRARY_SUFFIX ".dll")
 set(PSN00BSDK_SYMBOL_MAP_SUFFIX     ".map")
 
+set(PSN00BSDK_COMPRESS_EXECUTABLES OFF)
+
+define_property(
+	TARGET PROPERTY PSN00BSDK_ASSET_FILES
+	BRIEF_DOCS      "List of files generated by this asset target"
+	FULL_DOCS       "List of files (outputs and byproducts) generated by assets added to this target using psn00bsdk_add_asset()"
+)
+define_property(
+	TARGET PROPERTY PSN00BSDK_ASSET_MANIFEST
+	BRIEF_DOCS      "Path to the manifest header generated by this asset target"
+	FULL_DOCS       "Path to the C header listing the files generated by assets added to this target using psn00bsdk_add_asset()"
+)
+define_property(
+	TARGET PROPERTY PSN00BSDK_OVERLAYS
+	BRIEF_DOCS      "List of static overlays added to this executable"
+	FULL_DOCS       "List of static overlays added to this executable using psn00bsdk_add_overlay()"
+)
 define_property(
 	TARGET PROPERTY PSN00BSDK_TARGET_TYPE
 	BRIEF_DOCS      "Type of this target (EXECUTABLE_GPREL, EXECUTABLE_NOGPREL or SHARED_LIBRARY)"
@@ -93,6 +110,7 @@ find_program(ELF2CPE  elf2cpe  HINTS ${PSN00BSDK_TOOLS})
 find_program(SMXLINK  smxlink  HINTS ${PSN00BSDK_TOOLS})
 find_program(LZPACK   lzpack   HINTS ${PSN00BSDK_TOOLS})
 find_program(MKPSXISO mkpsxiso HINTS ${PSN00BSDK_TOOLS})
+find_program(TIMPACK  timpack  HINTS ${PSN00BSDK_TOOLS})
 
 ## libgcc
 
@@ -128,6 +146,29 @@ endif()
 
 ## Target helpers
 
+# libgcc is added to all targets by link_libraries(), which places it before
+# the SDK libraries on the linker command line. As libc provides optimized
+# replacements for some of libgcc's functions (soft-float arithmetic, 64-bit
+# multiplication and division), libgcc is instead removed from static libraries
+# and moved after all other libraries when linking executables and DLLs, so
+# that it is only used to resolve symbols not defined by any SDK library.
+function(_psn00bsdk_remove_libgcc name)
+	if(TARGET gcc)
+		get_target_property(_libs ${name} LINK_LIBRARIES)
+		list(REMOVE_ITEM _libs gcc)
+		set_target_properties(${name} PROPERTIES LINK_LIBRARIES "${_libs}")
+	endif()
+endfunction()
+
+function(_psn00bsdk_link_libraries name)
+	_psn00bsdk_remove_libgcc(${name})
+	target_link_libraries(${name} PRIVATE ${ARGN})
+
+	if(TARGET gcc)
+		target_link_libraries(${name} PRIVATE gcc)
+	endif()
+endfunction()
+
 function(psn00bsdk_add_executable name type)
 	string(TOUPPER ${type} _type)
 
@@ -145,10 +186,20 @@ function(psn00bsdk_add_executable name type)
 		message(FATAL_ERROR "Failed to locate elf2x. Check your PATH environment variable.")
 	endif()
 
+	if(PSN00BSDK_COMPRESS_EXECUTABLES)
+		set(_elf2x_flags -q -c)
+	else()
+		set(_elf2x_flags -q)
+	endif()
+
 	add_executable       (${name} ${ARGN})
 	set_target_properties(${name} PROPERTIES PSN00BSDK_TARGET_TYPE ${_type})
-	target_link_libraries(${name} PRIVATE ${PSN00BSDK_EXECUTABLE_LINK_LIBRARIES})
-	target_link_options  (${name} PRIVATE -T$<SHELL_PATH:${PSN00BSDK_LDSCRIPTS}/exe.ld>)
+	_psn00bsdk_link_libraries(${name} ${PSN00BSDK_EXECUTABLE_LINK_LIBRARIES})
+	target_link_options  (
+		${name} PRIVATE
+		-L$<SHELL_PATH:${PSN00BSDK_LDSCRIPTS}/default>
+		-T$<SHELL_PATH:${PSN00BSDK_LDSCRIPTS}/exe.ld>
+	)
 
 	# Add post-build steps to generate the .exe and symbol map once the
 	# executable is built.
@@ -159,7 +210,7 @@ function(psn00bsdk_add_executable name type)
 	add_custom_command(
 		TARGET ${name} POST_BUILD
 		COMMAND
-			${ELF2X} -q
+			${ELF2X} ${_elf2x_flags}
 			$<SHELL_PATH:$<TARGET_FILE:${name}>>
 			#$<SHELL_PATH:$<${_repl},${PSN00BSDK_EXECUTABLE_SUFFIX}>>
 			$<SHELL_PATH:${CMAKE_CURRENT_BINARY_DIR}/${name}${PSN00BSDK_EXECUTABLE_SUFFIX}>
@@ -176,16 +227,79 @@ function(psn00bsdk_add_executable name type)
 	)
 endfunction()
 
+# The function ordering file is included by exe.ld as text_order.ld, which the
+# linker looks up in the library search path. The file is copied to a
+# directory that is added to the search path ahead of the SDK's default (empty)
+# ordering file.
+function(psn00bsdk_target_text_order name path)
+	get_filename_component(_path ${path} ABSOLUTE)
+	set(_dir ${CMAKE_CURRENT_BINARY_DIR}/${name}_text_order)
+
+	configure_file(${_path} ${_dir}/text_order.ld COPYONLY)
+	target_link_options  (${name} BEFORE PRIVATE -L$<SHELL_PATH:${_dir}>)
+	set_property         (TARGET ${name} APPEND PROPERTY LINK_DEPENDS ${_dir}/text_order.ld)
+endfunction()
+
+# Each overlay is built as a static library named lib<target>_<overlay>.ovl.a,
+# whose sections exe.ld keeps out of the executable. The list of overlays is
+# written to overlays.ld, which exe.ld includes from the library search path
+# just like text_order.ld, and rewritten every time an overlay is added.
+function(psn00bsdk_add_overlay name overlay_name)
+	string(MAKE_C_IDENTIFIER ${overlay_name} _id)
+	set(_lib ${name}_${_id})
+	set(_dir ${CMAKE_CURRENT_BINARY_DIR}/${name}_overlays)
+
+	get_target_property(_type ${name} PSN00BSDK_TARGET_TYPE)
+	if(NOT _type MATCHES "^EXECUTABLE_")
+		message(FATAL_ERROR "Overlays can only be added to executables created using psn00bsdk_add_executable()")
+	endif()
+
+	add_library          (${_lib} STATIC ${ARGN})
+	set_target_properties(${_lib} PROPERTIES PSN00BSDK_TARGET_TYPE ${_type} SUFFIX .ovl.a)
+	_psn00bsdk_remove_libgcc(${_lib})
+	target_link_libraries(${_lib} PRIVATE ${PSN00BSDK_EXECUTABLE_LINK_LIBRARIES})
+	target_link_libraries(${name} PRIVATE ${_lib})
+
+	get_target_property(_overlays ${name} PSN00BSDK_OVERLAYS)
+	if(NOT _overlays)
+		set(_overlays "")
+
+		target_link_options(${name} BEFORE PRIVATE -L$<SHELL_PATH:${_dir}>)
+		set_property       (TARGET ${name} APPEND PROPERTY LINK_DEPENDS ${_dir}/overlays.ld)
+	endif()
+
+	list(APPEND _overlays ${_id})
+	set_target_properties(${name} PROPERTIES PSN00BSDK_OVERLAYS "${_overlays}")
+
+	set(_sections ".text .text.* .rodata .rodata.* .data .data.* .bss .bss.* COMMON")
+	set(_script "")
+	foreach(_overlay IN LISTS _overlays)
+		string(APPEND _script "\t.overlay.${_overlay} {\n")
+		string(APPEND _script "\t\t*lib${name}_${_overlay}.ovl.a:*(${_sections})\n")
+		string(APPEND _script "\t}\n")
+	endforeach()
+
+	# NOCROSSREFS makes the linker reject references between overlays, as only
+	# one of them can be loaded at a time.
+	file(
+		CONFIGURE
+		OUTPUT  ${_dir}/overlays.ld
+		CONTENT "/* Generated by psn00bsdk_add_overlay(), do not edit */\n\nOVERLAY : NOCROSSREFS {\n${_script}} > APP_RAM\n"
+		NEWLINE_STYLE LF
+	)
+endfunction()
+
 function(psn00bsdk_add_library name type)
 	string(TOUPPER ${type} _type)
 
 	if(_type MATCHES "^(STATIC|OBJECT)$")
 		add_library          (${name} ${_type} ${ARGN})
+		_psn00bsdk_remove_libgcc(${name})
 		#target_link_libraries(${name} PRIVATE psn00bsdk)
 	elseif(_type MATCHES "^(SHARED|MODULE)$")
 		add_library          (${name} ${_type} ${ARGN})
 		set_target_properties(${name} PROPERTIES PSN00BSDK_TARGET_TYPE SHARED_LIBRARY)
-		target_link_libraries(${name} PRIVATE ${PSN00BSDK_SHARED_LIBRARY_LINK_LIBRARIES})
+		_psn00bsdk_link_libraries(${name} ${PSN00BSDK_SHARED_LIBRARY_LINK_LIBRARIES})
 		target_link_options  (${name} PRIVATE -T$<SHELL_PATH:${PSN00BSDK_LDSCRIPTS}/dll.ld>)
 
 		# Add a post-build step to dump the DLL's raw contents into a new file
@@ -291,3 +405,212 @@ function(psn00bsdk_add_cd_image name image_name config_file)
 		${ARGN}
 	)
 endfunction()
+
+## Asset cooking helpers
+
+function(psn00bsdk_add_asset_type type)
+	cmake_parse_arguments(PARSE_ARGV 1 _arg "" "SUFFIX" "COMMAND")
+	string(TOUPPER ${type} _type)
+
+	if(NOT _arg_COMMAND)
+		message(FATAL_ERROR "No converter command specified for ${_type} assets")
+	endif()
+
+	set_property(GLOBAL PROPERTY PSN00BSDK_ASSET_TYPE_${_type}_COMMAND ${_arg_COMMAND})
+	set_property(GLOBAL PROPERTY PSN00BSDK_ASSET_TYPE_${_type}_SUFFIX  "${_arg_SUFFIX}")
+endfunction()
+
+# Each asset gets its own custom command, allowing the generator to run as many
+# converters in parallel as there are jobs. The command's only declared output
+# is a stamp file holding a hash of the converter's inputs and command line;
+# the actual outputs are byproducts, so that (with Ninja) nothing depending on
+# them is rebuilt if cook_asset.cmake finds the hash unchanged and skips the
+# converter. All assets in a target are then listed in a manifest header.
+function(psn00bsdk_add_asset name type input)
+	cmake_parse_arguments(PARSE_ARGV 3 _arg "" "OUTPUT" "BYPRODUCTS;OPTIONS;DEPENDS")
+	string(TOUPPER ${type} _type)
+
+	get_property(_command GLOBAL PROPERTY PSN00BSDK_ASSET_TYPE_${_type}_COMMAND)
+	get_property(_suffix  GLOBAL PROPERTY PSN00BSDK_ASSET_TYPE_${_type}_SUFFIX)
+	if(NOT _command)
+		message(FATAL_ERROR "Unknown asset type ${_type}, use psn00bsdk_add_asset_type() to define it")
+	endif()
+
+	# As with mkpsxiso, missing converters are only an error if they are used.
+	list(GET _command 0 _tool)
+	if(_tool MATCHES "-NOTFOUND$")
+		message(FATAL_ERROR "Failed to locate the converter for ${_type} assets (${_tool}). If it wasn't installed alongside the SDK, check your PATH environment variable.")
+	endif()
+
+	# The input can also be a target (e.g. an executable to be converted using
+	# elf2x), in which case its output file is used.
+	if(TARGET ${input})
+		set(_input   $<TARGET_FILE:${input}>)
+		set(_depends ${input})
+		set(_hashed  "")
+		set(_base    ${input})
+	else()
+		cmake_path(ABSOLUTE_PATH input OUTPUT_VARIABLE _input)
+		set(_depends ${_input})
+		set(_hashed  "")
+		cmake_path(GET _input FILENAME _base)
+
+		if(_suffix)
+			cmake_path(GET _input STEM LAST_ONLY _base)
+		endif()
+	endif()
+
+	if(_arg_OUTPUT)
+		set(_output ${_arg_OUTPUT})
+	else()
+		set(_output ${_base}${_suffix})
+	endif()
+	cmake_path(ABSOLUTE_PATH _output BASE_DIRECTORY ${CMAKE_CURRENT_BINARY_DIR})
+	cmake_path(GET _output PARENT_PATH _output_dir)
+	file(MAKE_DIRECTORY ${_output_dir})
+
+	set(_outputs ${_output})
+	foreach(_file IN LISTS _arg_BYPRODUCTS)
+		cmake_path(ABSOLUTE_PATH _file BASE_DIRECTORY ${CMAKE_CURRENT_BINARY_DIR})
+		list(APPEND _outputs ${_file})
+	endforeach()
+
+	foreach(_file IN LISTS _arg_DEPENDS)
+		if(TARGET ${_file})
+			list(APPEND _depends ${_file})
+		else()
+			cmake_path(ABSOLUTE_PATH _file)
+			list(APPEND _depends ${_file})
+			list(APPEND _hashed  ${_file})
+		endif()
+	endforeach()
+
+	# Hash the converter's executable as well (if it's a file rather than a
+	# command looked up in PATH), so that updating it recooks everything.
+	if(IS_ABSOLUTE ${_tool} AND EXISTS ${_tool} AND NOT _tool STREQUAL CMAKE_COMMAND)
+		list(APPEND _depends ${_tool})
+		list(APPEND _hashed  ${_tool})
+	endif()
+
+	list(PREPEND _hashed ${_input})
+
+	set(_args "")
+	foreach(_arg IN LISTS _command)
+		if(_arg STREQUAL "<OPTIONS>")
+			list(APPEND _args ${_arg_OPTIONS})
+		else()
+			string(REPLACE "<INPUT>"      "${_input}"      _arg "${_arg}")
+			string(REPLACE "<OUTPUT>"     "${_output}"     _arg "${_arg}")
+			string(REPLACE "<OUTPUT_DIR>" "${_output_dir}" _arg "${_arg}")
+			list(APPEND _args "${_arg}")
+		endif()
+	endforeach()
+
+	cmake_path(RELATIVE_PATH _output BASE_DIRECTORY ${CMAKE_CURRENT_BINARY_DIR} OUTPUT_VARIABLE _name)
+	string(MAKE_C_IDENTIFIER ${_name} _id)
+
+	set(_dir       ${CMAKE_CURRENT_BINARY_DIR}/${name}_assets)
+	set(_stamp     ${_dir}/${_id}.stamp)
+	set(_cook_file ${_dir}/${_id}.cmake)
+	set(_list_file ${_dir}/assets.cmake)
+	set(_header    ${_dir}/${name}.h)
+	set(_manifest  ${_dir}/${name}.h.stamp)
+
+	# The cook file is generated rather than configured in order to evaluate
+	# any generator expression in the input path.
+	file(
+		GENERATE
+		OUTPUT  ${_cook_file}
+		CONTENT "# Generated by psn00bsdk_add_asset(), do not edit\n\nset(ASSET_NAME [==[${_name}]==])\nset(ASSET_COMMAND [==[${_args}]==])\nset(ASSET_INPUTS [==[${_hashed}]==])\nset(ASSET_OUTPUTS [==[${_outputs}]==])\nset(ASSET_STAMP [==[${_stamp}]==])\nset(ASSET_WORKING_DIRECTORY [==[${_output_dir}]==])\n"
+	)
+
+	add_custom_command(
+		OUTPUT     ${_stamp}
+		BYPRODUCTS ${_outputs}
+		COMMAND    ${CMAKE_COMMAND} -DCOOK_FILE=${_cook_file} -P ${CMAKE_CURRENT_FUNCTION_LIST_DIR}/cook_asset.cmake
+		DEPENDS    ${_depends} ${_cook_file} ${CMAKE_CURRENT_FUNCTION_LIST_DIR}/cook_asset.cmake
+		COMMENT    "Cooking ${_name}"
+		VERBATIM
+	)
+
+	# The first asset added creates the target and the command to generate the
+	# manifest, which every subsequent asset is then appended to. As with the
+	# assets themselves, the command's output is a stamp and the header is a
+	# byproduct, which asset_manifest.cmake only rewrites if its contents
+	# changed; this way source files including it are not recompiled whenever
+	# an asset's stamp is touched.
+	if(NOT TARGET ${name})
+		add_custom_target(${name} ALL DEPENDS ${_manifest})
+		set_target_properties(${name} PROPERTIES PSN00BSDK_ASSET_FILES "" PSN00BSDK_ASSET_MANIFEST ${_header})
+
+		add_custom_command(
+			OUTPUT     ${_manifest}
+			BYPRODUCTS ${_header}
+			COMMAND    ${CMAKE_COMMAND} -DLIST_FILE=${_list_file} -DOUTPUT=${_header} -DSTAMP=${_manifest} -P ${CMAKE_CURRENT_FUNCTION_LIST_DIR}/asset_manifest.cmake
+			DEPENDS    ${_list_file} ${CMAKE_CURRENT_FUNCTION_LIST_DIR}/asset_manifest.cmake
+			COMMENT    "Generating asset manifest for ${name}"
+			VERBATIM
+		)
+	endif()
+
+	get_target_property(_files ${name} PSN00BSDK_ASSET_FILES)
+	list(APPEND _files ${_outputs})
+	set_target_properties(${name} PROPERTIES PSN00BSDK_ASSET_FILES "${_files}")
+
+	add_custom_command(OUTPUT ${_manifest} APPEND DEPENDS ${_stamp})
+
+	file(
+		CONFIGURE
+		OUTPUT  ${_list_file}
+		CONTENT "# Generated by psn00bsdk_add_asset(), do not edit\n\nset(ASSET_GROUP ${name})\nset(ASSET_FILES [==[${_files}]==])\nset(ASSET_BASE_DIRECTORY [==[${CMAKE_CURRENT_BINARY_DIR}]==])\n"
+		@ONLY
+		NEWLINE_STYLE LF
+	)
+endfunction()
+
+function(psn00bsdk_add_assets name type)
+	cmake_parse_arguments(PARSE_ARGV 2 _arg "" "" "OPTIONS;DEPENDS")
+
+	foreach(_input IN LISTS _arg_UNPARSED_ARGUMENTS)
+		psn00bsdk_add_asset(
+			${name} ${type} ${_input}
+			OPTIONS ${_arg_OPTIONS}
+			DEPENDS ${_arg_DEPENDS}
+		)
+	endforeach()
+endfunction()
+
+function(psn00bsdk_target_assets name asset_target)
+	get_target_property(_header ${asset_target} PSN00BSDK_ASSET_MANIFEST)
+	if(NOT _header)
+		message(FATAL_ERROR "${asset_target} is not an asset target created using psn00bsdk_add_asset()")
+	endif()
+
+	cmake_path(GET _header PARENT_PATH _dir)
+
+	add_dependencies          (${name} ${asset_target})
+	target_include_directories(${name} PRIVATE ${_dir})
+endfunction()
+
+## Built-in asset types
+
+psn00bsdk_add_asset_type(
+	COPY
+	COMMAND ${CMAKE_COMMAND} -E copy <INPUT> <OUTPUT>
+)
+psn00bsdk_add_asset_type(
+	SMD SUFFIX .smd
+	COMMAND ${SMXLINK} <OPTIONS> -o <OUTPUT> <INPUT>
+)
+psn00bsdk_add_asset_type(
+	LZP SUFFIX .lzp
+	COMMAND ${LZPACK} -y <OPTIONS> <INPUT>
+)
+psn00bsdk_add_asset_type(
+	TIM_ATLAS SUFFIX .xml
+	COMMAND ${TIMPACK} -o <OUTPUT_DIR> -l <OUTPUT> <OPTIONS> <INPUT>
+)
+psn00bsdk_add_asset_type(
+	EXE SUFFIX .exe
+	COMMAND ${ELF2X} -q <OPTIONS> <INPUT> <OUTPUT>
+)
@@ -0,0 +1,128 @@
+/*
+ * PSn00bSDK fixed-point math library
+ * (C) 2022 PSn00bSDK contributors - MPL licensed
+ */
+
+/**
+ * @file fixed.h
+ * @brief Fixed-point math library header
+ *
+ * @details This header provides inline functions for working with signed
+ * 32-bit fixed-point values in two formats: fix16_t (16.16, suitable for
+ * general purpose math) and fix12_t (20.12, the format used by the GTE and by
+ * psxgte.h, where 4096 = 1.0). As the PS1 has no FPU, these are much faster
+ * than the equivalent float operations, which are emulated in software.
+ *
+ * The same set of functions is defined for both formats, prefixed with fix16_
+ * and fix12_ respectively:
+ *
+ * - from_int(), to_int() (rounds towards negative infinity) and round()
+ *   (rounds to the nearest integer) for conversion from/to integers;
+ * - mul() and div(), which use a 64-bit intermediate result to preserve
+ *   precision (multiplication compiles to a single mult instruction);
+ * - adds(), subs() and muls(), which saturate to the minimum/maximum value
+ *   rather than wrapping around on overflow;
+ * - abs(), min(), max() and clamp().
+ *
+ * Addition and subtraction without saturation can be performed using the
+ * regular + and - operators. The FIX16() and FIX12() macros can be used to
+ * convert floating-point constants at compile time, without pulling in any
+ * software float code (as long as they are only passed constants).
+ *
+ * Division goes through libgcc's 64-bit division function (__divdi3), which
+ * PSn00bSDK replaces with an implementation using the hardware divider
+ * whenever possible. Dividing by zero triggers a break exception.
+ */
+
+#ifndef __FIXED_H
+#define __FIXED_H
+
+#include <stdint.h>
+
+/* Types and constants */
+
+typedef int32_t fix16_t;
+typedef int32_t fix12_t;
+
+#define FIX16_ONE	(1 << 16)
+#define FIX16_MAX	INT32_MAX
+#define FIX16_MIN	INT32_MIN
+
+#define FIX12_ONE	(1 << 12)
+#define FIX12_MAX	INT32_MAX
+#define FIX12_MIN	INT32_MIN
+
+#define FIX16(x)	((fix16_t) ((x) * 65536.0 + (((x) >= 0) ? 0.5 : -0.5)))
+#define FIX12(x)	((fix12_t) ((x) * 4096.0  + (((x) >= 0) ? 0.5 : -0.5)))
+
+/* Inline functions */
+
+static inline int32_t _fixed_saturate(int64_t value) {
+	if (value > INT32_MAX)
+		return INT32_MAX;
+	if (value < INT32_MIN)
+		return INT32_MIN;
+
+	return (int32_t) value;
+}
+
+#define _DEFINE_FIXED_FUNCTIONS(type, prefix, bits) \
+	static inline type prefix##_from_int(int value) { \
+		return (type) (value * (1 << (bits))); \
+	} \
+	static inline int prefix##_to_int(type value) { \
+		return value >> (bits); \
+	} \
+	static inline int prefix##_round(type value) { \
+		return (value + (1 << ((bits) - 1))) >> (bits); \
+	} \
+	static inline type prefix##_mul(type a, type b) { \
+		return (type) (((int64_t) a * (int64_t) b) >> (bits)); \
+	} \
+	static inline type prefix##_div(type a, type b) { \
+		return (type) (((int64_t) a << (bits)) / b); \
+	} \
+	static inline type prefix##_adds(type a, type b) { \
+		int32_t result; \
+		if (__builtin_add_overflow(a, b, &result)) \
+			return (a < 0) ? INT32_MIN : INT32_MAX; \
+		return result; \
+	} \
+	static inline type prefix##_subs(type a, type b) { \
+		int32_t result; \
+		if (__builtin_sub_overflow(a, b, &result)) \
+			return (a < 0) ? INT32_MIN : INT32_MAX; \
+		return result; \
+	} \
+	static inline type prefix##_muls(type a, type b) { \
+		return _fixed_saturate(((int64_t) a * (int64_t) b) >> (bits)); \
+	} \
+	static inline type prefix##_abs(type value) { \
+		return (value < 0) ? -value : value; \
+	} \
+	static inline type prefix##_min(type a, type b) { \
+		return (a < b) ? a : b; \
+	} \
+	static inline type prefix##_max(type a, type b) { \
+		return (a > b) ? a : b; \
+	} \
+	static inline type prefix##_clamp(type value, type low, type high) { \
+		return (value < low) ? low : ((value > high) ? high : value); \
+	}
+
+_DEFINE_FIXED_FUNCTIONS(fix16_t, fix16, 16)
+_DEFINE_FIXED_FUNCTIONS(fix12_t, fix12, 12)
+
+#undef _DEFINE_FIXED_FUNCTIONS
+
+/* Format conversion */
+
+static inline fix16_t fix12_to_fix16(fix12_t value) {
+	return _fixed_saturate((int64_t) value << 4);
+}
+
+static inline fix12_t fix16_to_fix12(fix16_t value) {
+	return value >> 4;
+}
+
+#endif
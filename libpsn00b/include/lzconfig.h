@@ -44,6 +44,20 @@
 #define LZP_USE_MALLOC		FALSE
 
 
+/* Set to TRUE to make lzpUnpackFile() verify the CRC32 of each compressed
+ * entry before decompressing it, or FALSE to skip the check entirely. If left
+ * undefined the check is only performed in debug builds (when NDEBUG is not
+ * defined), as it costs an additional pass over the compressed data.
+ */
+#ifndef LZP_CRC_CHECK
+#ifdef NDEBUG
+#define LZP_CRC_CHECK		FALSE
+#else
+#define LZP_CRC_CHECK		TRUE
+#endif
+#endif
+
+
 /* Hash table sizes (in power-of-two multiple units)
  *
  * These define only affect lzCompress().
@@ -791,6 +791,33 @@ int CdIsoError(void);
  */
 int CdLoadSession(int session);
 
+/**
+ * @brief Loads a static overlay from the CD-ROM
+ *
+ * @details Locates the specified overlay file on the CD-ROM file system and
+ * reads it into the executable's overlay region (the area between the
+ * __overlay_start and __overlay_end symbols defined by the linker script),
+ * then flushes the instruction cache. Overlay files are generated by elf2x
+ * for executables built with static overlays (see psn00bsdk_add_overlay() in
+ * the CMake reference); their functions and variables can be accessed
+ * directly once loaded, just like the ones in the main executable.
+ *
+ * Loading an overlay replaces the one previously loaded, so this function
+ * shall not be called from code belonging to an overlay and no pointers to
+ * an overlay's functions or data shall be kept around after it is replaced.
+ * Global variables in overlays are initialized every time the overlay is
+ * loaded. Global constructors in overlays are not supported.
+ *
+ * This function blocks until the overlay has been read.
+ *
+ * @param filename Path and name of overlay file (e.g. "\BATTLE.OVL;1")
+ * @return Size of the overlay file, or -1 if the file was not found, it
+ * doesn't fit in the overlay region or a read error occurred.
+ *
+ * @see CdSearchFile()
+ */
+int CdLoadOverlay(const char *filename);
+
 #ifdef __cplusplus
 }
 #endif
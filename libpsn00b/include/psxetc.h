@@ -16,6 +16,8 @@
 #ifndef __PSXETC_H
 #define __PSXETC_H
 
+#include <stdint.h>
+
 /* IRQ and DMA channel definitions */
 
 typedef enum _IRQ_Channel {
@@ -200,6 +202,125 @@ void RestartCallback(void);
  */
 void StopCallback(void);
 
+/**
+ * @brief Returns the number of counters needed to profile the executable.
+ *
+ * @details Returns the length of the counter array that must be passed to
+ * ProfStart() in order to cover the executable's entire text section with
+ * counters each covering (1 << shift) bytes. Using a shift value of 4 (i.e.
+ * 16 bytes per counter) is usually enough to attribute samples to functions.
+ *
+ * @param shift
+ * @return Number of counters
+ *
+ * @see ProfStart()
+ */
+int ProfGetLength(int shift);
+
+/**
+ * @brief Enables call stack sampling.
+ *
+ * @details Sets up a ring buffer the profiler will store the call stack of
+ * each sample into, in addition to incrementing the counters passed to
+ * ProfStart(). Each entry in the ring takes up depth words and holds the
+ * interrupted PC followed by up to (depth - 1) return addresses, innermost
+ * first. Entries are removed from the ring as they are dumped by ProfDump() or
+ * ProfSave(); if the ring fills up, new samples are counted but their stacks
+ * are dropped. Passing a null pointer disables stack sampling.
+ *
+ * Stacks are recovered by scanning the code for function prologues, as MIPS
+ * stack frames are not linked through the frame pointer. This is reasonably
+ * fast, but still makes each sample take several microseconds, so the
+ * sampling rate should be kept lower than when only collecting counters. The
+ * unwinder gives up on functions whose prologue is more than 4 KB above the
+ * sampled address, as well as on code outside of the executable's text
+ * section (BIOS functions, interrupt handlers and DLLs).
+ *
+ * This function shall be called before ProfStart().
+ *
+ * @param ring Array of (length * depth) words or NULL
+ * @param length Number of entries in the ring (one is always left unused)
+ * @param depth Maximum number of addresses per entry (1-16)
+ * @return 0 or -1 if the profiler is running or the depth is invalid
+ *
+ * @see ProfStart(), ProfDump()
+ */
+int ProfSetStacks(uint32_t *ring, int length, int depth);
+
+/**
+ * @brief Starts the sampling profiler.
+ *
+ * @details Configures the specified root counter (0-2) to fire an interrupt
+ * the given number of times per second. Each time the interrupt fires, the
+ * address of the code that was being executed is looked up in the
+ * executable's text section and the corresponding counter in the provided
+ * array is incremented (counters saturate at 65535). Samples that fall outside
+ * of the text section (e.g. in the BIOS or in DLLs) are only counted in the
+ * total. The array is cleared by this function. A null array may be passed
+ * if only call stacks are needed (see ProfSetStacks()).
+ *
+ * Timers 0 and 1 are clocked from the CPU clock and support rates of 517 Hz or
+ * higher, while timer 2 is clocked at 1/8 of the CPU clock and supports rates
+ * of 65 Hz or higher. The timer and its interrupt callback shall not be used
+ * by the program while the profiler is running; the previously registered
+ * callback is restored by ProfStop().
+ *
+ * The collected samples can be printed to the TTY using ProfDump() and turned
+ * into a function ordering file for the linker, which groups frequently
+ * executed functions together to reduce instruction cache misses, by the
+ * psxprof tool.
+ *
+ * @param counters Array of counters to use
+ * @param length Number of counters in the array (see ProfGetLength())
+ * @param shift Log2 of the number of bytes covered by each counter
+ * @param timer Root counter to use (0-2)
+ * @param rate Sampling rate in Hz
+ * @return 0 or -1 if the profiler is already running or the rate is invalid
+ *
+ * @see ProfStop(), ProfDump()
+ */
+int ProfStart(uint16_t *counters, int length, int shift, int timer, int rate);
+
+/**
+ * @brief Stops the sampling profiler.
+ *
+ * @details Stops collecting samples and restores the interrupt callback that
+ * was registered for the timer before ProfStart() was called. Any samples
+ * collected so far can still be dumped using ProfDump() or ProfSave().
+ *
+ * @see ProfStart()
+ */
+void ProfStop(void);
+
+/**
+ * @brief Prints the profiler's counters and call stacks to the TTY.
+ *
+ * @details Prints the sampling parameters, all non-zero counters and all call
+ * stacks in the ring as lines prefixed with "@prof", which can be extracted
+ * from a TTY log (e.g. captured from an emulator or through the serial port
+ * after calling AddSIO()) by the psxprof tool. Counters and stacks are
+ * cleared once printed, so this function can be called periodically (e.g.
+ * once per second) to stream samples to the host while the profiler is
+ * running. psxprof merges all dumps found in a log.
+ *
+ * @see ProfStart(), ProfSave()
+ */
+void ProfDump(void);
+
+/**
+ * @brief Writes the profiler's counters and call stacks to a file.
+ *
+ * @details Equivalent to ProfDump(), but writes the dump to a file previously
+ * opened for writing using open(). The data is written in 128-byte blocks
+ * (with the last one padded with spaces) so it can be saved to a memory card
+ * file directly.
+ *
+ * @param fd
+ *
+ * @see ProfDump()
+ */
+void ProfSave(int fd);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,239 @@
+/*
+ * PSn00bSDK pseudo-random number generators
+ * (C) 2022 PSn00bSDK contributors - MPL licensed
+ */
+
+/**
+ * @file random.h
+ * @brief Pseudo-random number generator library header
+ *
+ * @details This header provides two fast, reentrant pseudo-random number
+ * generators as an alternative to rand(), which uses a single global 15-bit
+ * linear congruential generator:
+ *
+ * - Xorshift32 (Marsaglia's xorshift with a 32-bit state) only uses shifts and
+ *   XORs and is the fastest option. Its output passes most basic statistical
+ *   tests and is more than adequate for particles and visual effects.
+ * - Xoroshiro64 (xoroshiro64* by Blackman and Vigna) has a 64-bit state and a
+ *   much better quality output, at the cost of a multiplication per value.
+ *   The lowest bits of its output are slightly weaker than the upper ones,
+ *   which is not an issue when using the _range() functions.
+ *
+ * All generators keep their state in a struct rather than a global variable,
+ * so different subsystems (or threads) can use independent generators. The
+ * _next() and _range() functions are inline, while the _fill() and
+ * _fill_range() functions are implemented in assembly and generate several
+ * values per loop iteration, which makes them suitable for initializing large
+ * arrays (e.g. particle systems) in bulk.
+ *
+ * rand() itself is left unchanged for compatibility with existing code (and
+ * with the sequences it produces for a given seed). Its output is the lowest
+ * 15 bits of the LCG state, which are of poor quality; any code that relies on
+ * the randomness of individual bits should use these generators instead.
+ *
+ * The _range() functions return a value in the 0 to range - 1 range by taking
+ * the upper 32 bits of the product of a random value and the range, rather
+ * than using the much slower modulo operator. For ranges that are not powers
+ * of two the result is very slightly biased (by at most range / 2^32).
+ */
+
+#ifndef __RANDOM_H
+#define __RANDOM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Structure definitions */
+
+typedef struct _Xorshift32 {
+	uint32_t state;
+} Xorshift32;
+
+typedef struct _Xoroshiro64 {
+	uint32_t state[2];
+} Xoroshiro64;
+
+/* Inline functions */
+
+static inline uint32_t _random_rotl(uint32_t value, int shift) {
+	return (value << shift) | (value >> (32 - shift));
+}
+
+// Scrambles a seed value so that similar seeds (e.g. 1, 2, 3...) produce
+// unrelated sequences. This is the finalizer of MurmurHash3.
+static inline uint32_t _random_mix(uint32_t value) {
+	value ^= value >> 16;
+	value *= 0x85ebca6b;
+	value ^= value >> 13;
+	value *= 0xc2b2ae35;
+	value ^= value >> 16;
+
+	return value;
+}
+
+/**
+ * @brief Initializes a xorshift32 generator.
+ *
+ * @details Sets up the generator's state from the given seed. Any seed value
+ * (including zero) can be used.
+ *
+ * @param rng
+ * @param seed
+ */
+static inline void xorshift32_seed(Xorshift32 *rng, uint32_t seed) {
+	// The state must never be zero, as the generator would get stuck.
+	seed       = _random_mix(seed);
+	rng->state = seed ? seed : 0x6d2b79f5;
+}
+
+/**
+ * @brief Returns the next 32-bit value from a xorshift32 generator.
+ *
+ * @param rng
+ * @return Random value (never zero)
+ */
+static inline uint32_t xorshift32_next(Xorshift32 *rng) {
+	uint32_t value = rng->state;
+
+	value ^= value << 13;
+	value ^= value >> 17;
+	value ^= value << 5;
+
+	rng->state = value;
+	return value;
+}
+
+/**
+ * @brief Returns a random value in the 0 to range - 1 range from a xorshift32
+ * generator.
+ *
+ * @param rng
+ * @param range Number of possible values (returns 0 if zero)
+ * @return Random value
+ */
+static inline uint32_t xorshift32_range(Xorshift32 *rng, uint32_t range) {
+	return (uint32_t) (((uint64_t) xorshift32_next(rng) * range) >> 32);
+}
+
+/**
+ * @brief Initializes a xoroshiro64* generator.
+ *
+ * @details Sets up the generator's state from the given seed. Any seed value
+ * (including zero) can be used.
+ *
+ * @param rng
+ * @param seed
+ */
+static inline void xoroshiro64_seed(Xoroshiro64 *rng, uint32_t seed) {
+	rng->state[0] = _random_mix(seed);
+	rng->state[1] = _random_mix(seed ^ 0x9e3779b9);
+
+	// The state must never be all zeroes.
+	if (!(rng->state[0] | rng->state[1]))
+		rng->state[0] = 0x6d2b79f5;
+}
+
+/**
+ * @brief Returns the next 32-bit value from a xoroshiro64* generator.
+ *
+ * @param rng
+ * @return Random value
+ */
+static inline uint32_t xoroshiro64_next(Xoroshiro64 *rng) {
+	uint32_t s0     = rng->state[0];
+	uint32_t s1     = rng->state[1] ^ s0;
+	uint32_t result = s0 * 0x9e3779bb;
+
+	rng->state[0] = _random_rotl(s0, 26) ^ s1 ^ (s1 << 9);
+	rng->state[1] = _random_rotl(s1, 13);
+
+	return result;
+}
+
+/**
+ * @brief Returns a random value in the 0 to range - 1 range from a
+ * xoroshiro64* generator.
+ *
+ * @param rng
+ * @param range Number of possible values (returns 0 if zero)
+ * @return Random value
+ */
+static inline uint32_t xoroshiro64_range(Xoroshiro64 *rng, uint32_t range) {
+	return (uint32_t) (((uint64_t) xoroshiro64_next(rng) * range) >> 32);
+}
+
+/* Public API */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Fills an array with random 32-bit values from a xorshift32
+ * generator.
+ *
+ * @details Produces the same values as calling xorshift32_next() count times,
+ * but is considerably faster for large arrays.
+ *
+ * @param rng
+ * @param output
+ * @param count Number of values to generate
+ */
+void xorshift32_fill(Xorshift32 *rng, uint32_t *output, size_t count);
+
+/**
+ * @brief Fills an array with random values in the 0 to range - 1 range from a
+ * xorshift32 generator.
+ *
+ * @details Produces the same values as calling xorshift32_range() count
+ * times, but is considerably faster for large arrays.
+ *
+ * @param rng
+ * @param output
+ * @param count Number of values to generate
+ * @param range Number of possible values
+ */
+void xorshift32_fill_range(
+	Xorshift32 *rng,
+	uint32_t   *output,
+	size_t     count,
+	uint32_t   range
+);
+
+/**
+ * @brief Fills an array with random 32-bit values from a xoroshiro64*
+ * generator.
+ *
+ * @details Produces the same values as calling xoroshiro64_next() count
+ * times, but is considerably faster for large arrays.
+ *
+ * @param rng
+ * @param output
+ * @param count Number of values to generate
+ */
+void xoroshiro64_fill(Xoroshiro64 *rng, uint32_t *output, size_t count);
+
+/**
+ * @brief Fills an array with random values in the 0 to range - 1 range from a
+ * xoroshiro64* generator.
+ *
+ * @details Produces the same values as calling xoroshiro64_range() count
+ * times, but is considerably faster for large arrays.
+ *
+ * @param rng
+ * @param output
+ * @param count Number of values to generate
+ * @param range Number of possible values
+ */
+void xoroshiro64_fill_range(
+	Xoroshiro64 *rng,
+	uint32_t    *output,
+	size_t      count,
+	uint32_t    range
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -15,6 +15,10 @@
 #define false 0
 #endif
 
+#ifndef EOF
+#define EOF -1
+#endif
+
 // BIOS seek modes
 #ifndef SEEK_SET
 #define SEEK_SET	0
@@ -50,7 +54,16 @@ extern void puts(const char *__s);
 extern int getchar(void);
 extern void putchar(int __c);
 
+// Callback used by vcbprintf() and cbprintf() to output formatted text, which
+// is passed in runs of characters (not null-terminated).
+#ifndef _PRINTF_SINK_T
+#define _PRINTF_SINK_T
+typedef void (*printf_sink_t)(void *arg, const char *str, int length);
+#endif
+
 // The following functions do not use the BIOS
+int vcbprintf(printf_sink_t sink, void *arg, const char *fmt, va_list ap);
+int cbprintf(printf_sink_t sink, void *arg, const char *fmt, ...);
 int vsnprintf(char *string, unsigned int size, const char *fmt, va_list ap);
 int vsprintf(char *string, const char *fmt, va_list ap);
 int sprintf(char *string, const char *fmt, ...);
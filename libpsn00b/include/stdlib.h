@@ -22,6 +22,19 @@ typedef struct _HeapUsage {
 	size_t alloc_max;	// Maximum amount of memory ever allocated
 } HeapUsage;
 
+typedef struct _HeapAllocation {
+	void		*ptr;		// Pointer returned by malloc()
+	size_t		size;		// Requested size in bytes
+	void		*caller;	// Address malloc() was called from
+	const char	*tag;		// Tag set using SetHeapTag() at allocation time
+} HeapAllocation;
+
+// Same as the callback type used by vcbprintf() (see stdio.h).
+#ifndef _PRINTF_SINK_T
+#define _PRINTF_SINK_T
+typedef void (*printf_sink_t)(void *arg, const char *str, int length);
+#endif
+
 /* API */
 
 #ifdef __cplusplus
@@ -33,6 +46,9 @@ extern const char	**__argv;
 
 void abort(void);
 
+// rand() returns the lowest 15 bits of a global linear congruential generator,
+// whose lower bits have very short periods (bit 0 alternates between 0 and 1).
+// Use the generators in random.h instead if better quality output is needed.
 int rand(void);
 void srand(int seed);
 
@@ -41,6 +57,8 @@ long labs(long i);
 
 long strtol(const char *nptr, char **endptr, int base);
 long long strtoll(const char *nptr, char **endptr, int base);
+unsigned long strtoul(const char *nptr, char **endptr, int base);
+unsigned long long strtoull(const char *nptr, char **endptr, int base);
 float strtof(const char *nptr, char **endptr);
 double strtod(const char *nptr, char **endptr);
 long double strtold(const char *nptr, char **endptr);
@@ -51,6 +69,13 @@ void *sbrk(ptrdiff_t incr);
 void TrackHeapUsage(ptrdiff_t alloc_incr);
 void GetHeapUsage(HeapUsage *usage);
 
+// Heap debugging functions, only functional if libc was built with
+// PSN00BSDK_LIBC_DEBUG_HEAP enabled
+const char *SetHeapTag(const char *tag);
+int CheckHeap(void);
+int GetHeapAllocations(HeapAllocation *allocs, int max_count);
+void DumpHeapAllocations(printf_sink_t sink, void *arg);
+
 void *malloc(size_t size);
 void *calloc(size_t num, size_t size);
 void *realloc(void *ptr, size_t size);
@@ -6,6 +6,8 @@
 #ifndef __STRING_H
 #define __STRING_H
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -14,6 +16,9 @@ int strcmp(const char *dst , const char *src);
 int strncmp(const char *dst , const char *src , int len);
 char *strpbrk(const char *dst , const char *src);
 char *strtok(char *s , char *set);
+char *strtok_r(char *s, const char *delim, char **saveptr);
+size_t strspn(const char *s, const char *charset);
+size_t strcspn(const char *s, const char *charset);
 char *strstr(const char *big , const char *little);
 
 char *strcat(char *s , const char *append);
@@ -30,6 +35,11 @@ void *memcpy(void *dst , const void *src , int n);
 void *memset(void *dst , char c , int n);
 int memcmp(const void *b1 , const void *b2 , int n);
 
+// Non-standard zero-allocation tokenizer: finds the next token in the buffer
+// between *ptr and end, returns its length (0 if none is left) and advances
+// *ptr past it. The buffer is not modified nor required to be null-terminated.
+int strntok(const char **ptr, const char *end, const char *delim, const char **token);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,289 @@
+/*
+ * PSn00bSDK C++ utility library
+ * (C) 2022 PSn00bSDK contributors - MPL licensed
+ */
+
+/**
+ * @file util/base.hpp
+ * @brief C++ utility library base header
+ *
+ * @details This header is included by all other util/ headers and provides
+ * the building blocks they share: minimal replacements for std::move(),
+ * std::forward() and the few type traits required (as PSn00bSDK does not
+ * ship a C++ standard library), the Span class, the storage helper used by
+ * containers and two simple allocators.
+ *
+ * The util/ library is header-only, requires C++17 and does not use
+ * exceptions, RTTI or the heap unless explicitly asked to. All containers come
+ * in two flavors selected by their capacity template argument:
+ *
+ * - if a nonzero capacity is given, the elements are stored inline within the
+ *   container object itself (which can then be placed in a global variable or
+ *   on the stack);
+ * - if the capacity is util::DYNAMIC, the container is initially empty and its
+ *   storage must be provided later, either by passing a buffer to setBuffer()
+ *   or by calling allocate() with an allocator. Storage is obtained once and
+ *   never grown, so there is no heap churn. The container does not own the
+ *   buffer; release() must be called with the same allocator to free it.
+ *
+ * An allocator is any object with allocate(size, alignment) and
+ * deallocate(ptr) methods. HeapAllocator wraps malloc() and free(), while
+ * ArenaAllocator hands out memory from a fixed buffer and can only be reset as
+ * a whole, which is ideal for per-level or per-frame data.
+ */
+
+#ifndef __UTIL_BASE_HPP
+#define __UTIL_BASE_HPP
+
+#ifndef __cplusplus
+#error "util/ headers can only be used from C++ code"
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+// Placement new is defined in libc (cpp_support.cpp), as there is no <new>.
+void *operator new(size_t size, void *ptr) noexcept;
+
+namespace util {
+
+/* Type traits and utilities */
+
+template<typename T> struct RemoveReference      { using Type = T; };
+template<typename T> struct RemoveReference<T &>  { using Type = T; };
+template<typename T> struct RemoveReference<T &&> { using Type = T; };
+
+template<typename T> struct RemoveConst          { using Type = T; };
+template<typename T> struct RemoveConst<const T> { using Type = T; };
+
+template<typename T> using Decay =
+	typename RemoveConst<typename RemoveReference<T>::Type>::Type;
+
+template<typename A, typename B> struct IsSame       { static constexpr bool VALUE = false; };
+template<typename A>             struct IsSame<A, A> { static constexpr bool VALUE = true; };
+
+template<bool C, typename T = void> struct EnableIf          {};
+template<typename T>                struct EnableIf<true, T> { using Type = T; };
+
+template<typename T> constexpr typename RemoveReference<T>::Type &&move(T &&value) noexcept {
+	return static_cast<typename RemoveReference<T>::Type &&>(value);
+}
+
+template<typename T> constexpr T &&forward(typename RemoveReference<T>::Type &value) noexcept {
+	return static_cast<T &&>(value);
+}
+
+template<typename T> constexpr T &&forward(typename RemoveReference<T>::Type &&value) noexcept {
+	return static_cast<T &&>(value);
+}
+
+template<typename T> inline void swap(T &a, T &b) {
+	T temp = move(a);
+
+	a = move(b);
+	b = move(temp);
+}
+
+template<typename T> constexpr const T &min(const T &a, const T &b) {
+	return (a < b) ? a : b;
+}
+
+template<typename T> constexpr const T &max(const T &a, const T &b) {
+	return (a > b) ? a : b;
+}
+
+constexpr bool isPowerOf2(size_t value) {
+	return value && !(value & (value - 1));
+}
+
+constexpr size_t alignUp(size_t value, size_t alignment) {
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+/* Span class */
+
+/**
+ * @brief Non-owning view of a contiguous array of elements.
+ *
+ * @details Equivalent to C++20's std::span with a dynamic extent. A span can
+ * be constructed from a pointer and a length, from a C array or from any
+ * object with data() and size() methods (including all util:: containers that
+ * store their elements contiguously).
+ */
+template<typename T> class Span {
+private:
+	T      *_data;
+	size_t _size;
+
+public:
+	constexpr Span(void)
+	: _data(nullptr), _size(0) {}
+	constexpr Span(T *data, size_t size)
+	: _data(data), _size(size) {}
+	template<size_t N> constexpr Span(T (&array)[N])
+	: _data(array), _size(N) {}
+	template<
+		typename C,
+		typename = decltype(static_cast<C *>(nullptr)->data())
+	> constexpr Span(C &container)
+	: _data(container.data()), _size(container.size()) {}
+
+	constexpr T *data(void) const {
+		return _data;
+	}
+	constexpr size_t size(void) const {
+		return _size;
+	}
+	constexpr size_t sizeBytes(void) const {
+		return _size * sizeof(T);
+	}
+	constexpr bool empty(void) const {
+		return !_size;
+	}
+
+	constexpr T &operator[](size_t index) const {
+		return _data[index];
+	}
+	constexpr T *begin(void) const {
+		return _data;
+	}
+	constexpr T *end(void) const {
+		return &_data[_size];
+	}
+
+	constexpr Span first(size_t count) const {
+		return Span(_data, count);
+	}
+	constexpr Span last(size_t count) const {
+		return Span(&_data[_size - count], count);
+	}
+	constexpr Span subspan(size_t offset, size_t count) const {
+		return Span(&_data[offset], count);
+	}
+	constexpr Span subspan(size_t offset) const {
+		return Span(&_data[offset], _size - offset);
+	}
+};
+
+/* Allocators */
+
+/**
+ * @brief Allocator that forwards requests to malloc() and free().
+ */
+class HeapAllocator {
+public:
+	void *allocate(size_t size, size_t alignment) {
+		// malloc() always returns 8-byte aligned blocks.
+		return (alignment <= 8) ? malloc(size) : nullptr;
+	}
+	void deallocate(void *ptr) {
+		free(ptr);
+	}
+};
+
+/**
+ * @brief Linear allocator operating on a fixed-size buffer.
+ *
+ * @details Allocations are carved out of the buffer sequentially and cannot be
+ * freed individually; deallocate() does nothing and reset() releases all
+ * allocations at once. Any objects placed in the arena must be destroyed (or
+ * the containers using it released) before calling reset().
+ */
+class ArenaAllocator {
+private:
+	uint8_t *_buffer;
+	size_t  _size, _offset;
+
+public:
+	ArenaAllocator(void *buffer, size_t size)
+	: _buffer(reinterpret_cast<uint8_t *>(buffer)), _size(size), _offset(0) {}
+
+	void *allocate(size_t size, size_t alignment) {
+		uintptr_t base  = reinterpret_cast<uintptr_t>(_buffer);
+		size_t    start = alignUp(base + _offset, alignment) - base;
+
+		if ((start + size) > _size)
+			return nullptr;
+
+		_offset = start + size;
+		return &_buffer[start];
+	}
+	void deallocate(void *) {}
+
+	void reset(void) {
+		_offset = 0;
+	}
+	size_t getUsed(void) const {
+		return _offset;
+	}
+	size_t getFree(void) const {
+		return _size - _offset;
+	}
+};
+
+/* Container storage */
+
+constexpr size_t DYNAMIC = 0;
+
+/**
+ * @brief Uninitialized storage for up to N objects of type T.
+ *
+ * @details Used internally by containers. Objects are neither constructed nor
+ * destroyed by this class. The DYNAMIC specialization holds a pointer to an
+ * externally provided buffer instead.
+ */
+template<typename T, size_t N> class Storage {
+private:
+	alignas(T) uint8_t _data[sizeof(T) * N];
+
+public:
+	T *get(void) {
+		return reinterpret_cast<T *>(_data);
+	}
+	const T *get(void) const {
+		return reinterpret_cast<const T *>(_data);
+	}
+	constexpr size_t capacity(void) const {
+		return N;
+	}
+};
+
+template<typename T> class Storage<T, DYNAMIC> {
+private:
+	T      *_data;
+	size_t _capacity;
+
+public:
+	constexpr Storage(void)
+	: _data(nullptr), _capacity(0) {}
+
+	T *get(void) {
+		return _data;
+	}
+	const T *get(void) const {
+		return _data;
+	}
+	constexpr size_t capacity(void) const {
+		return _capacity;
+	}
+
+	void setBuffer(void *buffer, size_t capacity) {
+		_data     = reinterpret_cast<T *>(buffer);
+		_capacity = buffer ? capacity : 0;
+	}
+	template<typename A> bool allocate(A &allocator, size_t capacity) {
+		setBuffer(allocator.allocate(sizeof(T) * capacity, alignof(T)), capacity);
+		return (_data != nullptr);
+	}
+	template<typename A> void release(A &allocator) {
+		if (_data)
+			allocator.deallocate(_data);
+
+		setBuffer(nullptr, 0);
+	}
+};
+
+}
+
+#endif
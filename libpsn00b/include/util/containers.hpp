@@ -0,0 +1,826 @@
+/*
+ * PSn00bSDK C++ utility library
+ * (C) 2022 PSn00bSDK contributors - MPL licensed
+ */
+
+/**
+ * @file util/containers.hpp
+ * @brief C++ utility library container header
+ *
+ * @details This header provides allocation-free replacements for the most
+ * commonly used standard containers:
+ *
+ * - Vector, a fixed-capacity array with std::vector-like methods;
+ * - RingBuffer, a FIFO queue whose capacity must be a power of two;
+ * - HashMap, an open-addressing hash table with linear probing whose capacity
+ *   must also be a power of two;
+ * - IntrusiveList, a doubly-linked list of objects inheriting from ListNode,
+ *   which never allocates as the links are stored in the objects themselves.
+ *
+ * See util/base.hpp for an explanation of inline vs. DYNAMIC capacity. None of
+ * the containers can grow; methods that add elements return false or nullptr
+ * when the container is full, rather than throwing an exception. Containers
+ * are not copyable, but their contents can be accessed through a Span or
+ * iterated over.
+ */
+
+#ifndef __UTIL_CONTAINERS_HPP
+#define __UTIL_CONTAINERS_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <util/base.hpp>
+
+namespace util {
+
+/* Vector class */
+
+/**
+ * @brief Fixed-capacity array of elements stored contiguously.
+ */
+template<typename T, size_t N = DYNAMIC> class Vector {
+private:
+	Storage<T, N> _storage;
+	size_t        _size;
+
+public:
+	Vector(void)
+	: _size(0) {}
+	~Vector(void) {
+		clear();
+	}
+
+	Vector(const Vector &) = delete;
+	Vector &operator=(const Vector &) = delete;
+
+	void setBuffer(void *buffer, size_t capacity) {
+		clear();
+		_storage.setBuffer(buffer, capacity);
+	}
+	template<typename A> bool allocate(A &allocator, size_t capacity) {
+		clear();
+		return _storage.allocate(allocator, capacity);
+	}
+	template<typename A> void release(A &allocator) {
+		clear();
+		_storage.release(allocator);
+	}
+
+	T *data(void) {
+		return _storage.get();
+	}
+	const T *data(void) const {
+		return _storage.get();
+	}
+	size_t size(void) const {
+		return _size;
+	}
+	size_t capacity(void) const {
+		return _storage.capacity();
+	}
+	bool empty(void) const {
+		return !_size;
+	}
+	bool full(void) const {
+		return (_size >= _storage.capacity());
+	}
+
+	T &operator[](size_t index) {
+		return data()[index];
+	}
+	const T &operator[](size_t index) const {
+		return data()[index];
+	}
+	T *begin(void) {
+		return data();
+	}
+	T *end(void) {
+		return &data()[_size];
+	}
+	const T *begin(void) const {
+		return data();
+	}
+	const T *end(void) const {
+		return &data()[_size];
+	}
+	T &front(void) {
+		return data()[0];
+	}
+	T &back(void) {
+		return data()[_size - 1];
+	}
+
+	/**
+	 * @brief Constructs a new element at the end of the vector.
+	 *
+	 * @return Pointer to the new element, or nullptr if the vector is full
+	 */
+	template<typename... A> T *emplace(A &&...args) {
+		if (full())
+			return nullptr;
+
+		return new(&data()[_size++]) T(forward<A>(args)...);
+	}
+	T *push(const T &value) {
+		return emplace(value);
+	}
+	T *push(T &&value) {
+		return emplace(move(value));
+	}
+
+	/**
+	 * @brief Removes the last element, optionally moving it to the given
+	 * location first.
+	 *
+	 * @return False if the vector is empty
+	 */
+	bool pop(T *output = nullptr) {
+		if (!_size)
+			return false;
+
+		T &last = data()[--_size];
+
+		if (output)
+			*output = move(last);
+
+		last.~T();
+		return true;
+	}
+
+	/**
+	 * @brief Inserts a new element at the given index, shifting all following
+	 * elements.
+	 *
+	 * @return Pointer to the new element, or nullptr if the vector is full
+	 */
+	T *insert(size_t index, const T &value) {
+		if (full() || (index > _size))
+			return nullptr;
+		if (index == _size)
+			return emplace(value);
+
+		T *items = data();
+
+		new(&items[_size]) T(move(items[_size - 1]));
+		for (size_t i = _size - 1; i > index; i--)
+			items[i] = move(items[i - 1]);
+
+		_size++;
+		items[index] = value;
+		return &items[index];
+	}
+
+	/**
+	 * @brief Removes the element at the given index, preserving the order of
+	 * the remaining elements.
+	 */
+	void remove(size_t index) {
+		T *items = data();
+
+		for (size_t i = index + 1; i < _size; i++)
+			items[i - 1] = move(items[i]);
+
+		items[--_size].~T();
+	}
+
+	/**
+	 * @brief Removes the element at the given index in constant time by moving
+	 * the last element in its place. The order of elements is not preserved.
+	 */
+	void removeSwap(size_t index) {
+		T *items = data();
+
+		if (index != --_size)
+			items[index] = move(items[_size]);
+
+		items[_size].~T();
+	}
+
+	void clear(void) {
+		T *items = data();
+
+		for (size_t i = 0; i < _size; i++)
+			items[i].~T();
+
+		_size = 0;
+	}
+};
+
+/* Ring buffer class */
+
+/**
+ * @brief Fixed-capacity FIFO queue.
+ *
+ * @details Elements are pushed to the back and popped from the front. The
+ * read and write counters wrap around freely and are masked when indexing, so
+ * the capacity must be a power of two (this is checked at compile time for
+ * inline buffers, and by setBuffer()/allocate() for DYNAMIC ones).
+ *
+ * Each counter is only modified by one side, so a ring buffer can be safely
+ * shared between an interrupt handler (pushing) and the main loop (popping)
+ * provided that elements are trivially copyable.
+ */
+template<typename T, size_t N = DYNAMIC> class RingBuffer {
+	static_assert((N == DYNAMIC) || isPowerOf2(N), "capacity must be a power of two");
+
+private:
+	Storage<T, N>   _storage;
+	volatile size_t _head, _tail;
+
+	T *_get(size_t counter) {
+		return &_storage.get()[counter & (_storage.capacity() - 1)];
+	}
+
+public:
+	RingBuffer(void)
+	: _head(0), _tail(0) {}
+	~RingBuffer(void) {
+		clear();
+	}
+
+	RingBuffer(const RingBuffer &) = delete;
+	RingBuffer &operator=(const RingBuffer &) = delete;
+
+	bool setBuffer(void *buffer, size_t capacity) {
+		clear();
+		if (!isPowerOf2(capacity))
+			return false;
+
+		_storage.setBuffer(buffer, capacity);
+		return true;
+	}
+	template<typename A> bool allocate(A &allocator, size_t capacity) {
+		clear();
+		if (!isPowerOf2(capacity))
+			return false;
+
+		return _storage.allocate(allocator, capacity);
+	}
+	template<typename A> void release(A &allocator) {
+		clear();
+		_storage.release(allocator);
+	}
+
+	size_t size(void) const {
+		return _tail - _head;
+	}
+	size_t capacity(void) const {
+		return _storage.capacity();
+	}
+	bool empty(void) const {
+		return (_tail == _head);
+	}
+	bool full(void) const {
+		return ((_tail - _head) >= _storage.capacity());
+	}
+
+	/**
+	 * @brief Returns a reference to the given element, counting from the
+	 * oldest one (index 0 is the front of the queue).
+	 */
+	T &operator[](size_t index) {
+		return *_get(_head + index);
+	}
+	T &front(void) {
+		return *_get(_head);
+	}
+	T &back(void) {
+		return *_get(_tail - 1);
+	}
+
+	/**
+	 * @brief Constructs a new element at the back of the queue.
+	 *
+	 * @return Pointer to the new element, or nullptr if the queue is full
+	 */
+	template<typename... A> T *emplace(A &&...args) {
+		if (full())
+			return nullptr;
+
+		T *item = new(_get(_tail)) T(forward<A>(args)...);
+		_tail   = _tail + 1;
+		return item;
+	}
+	T *push(const T &value) {
+		return emplace(value);
+	}
+	T *push(T &&value) {
+		return emplace(move(value));
+	}
+
+	/**
+	 * @brief Removes the element at the front of the queue, optionally moving
+	 * it to the given location first.
+	 *
+	 * @return False if the queue is empty
+	 */
+	bool pop(T *output = nullptr) {
+		if (empty())
+			return false;
+
+		T *item = _get(_head);
+
+		if (output)
+			*output = move(*item);
+
+		item->~T();
+		_head = _head + 1;
+		return true;
+	}
+
+	void clear(void) {
+		while (pop())
+			continue;
+
+		_head = 0;
+		_tail = 0;
+	}
+};
+
+/* Hash map class */
+
+/**
+ * @brief Hashing and comparison functions for HashMap keys.
+ *
+ * @details The default implementation works with integers, enums and
+ * pointers. A specialization for C strings (const char *) is also provided,
+ * which hashes and compares the strings' contents; the strings themselves are
+ * not copied and must outlive the map. Other key types require a custom
+ * specialization.
+ */
+template<typename K> struct HashTraits {
+	static uint32_t hash(const K &key) {
+		// Fibonacci hashing; the upper bits (which depend on all bits of the
+		// key) are folded into the lower ones, which are used as index.
+		uint32_t value = uint32_t(uintptr_t(key)) * 0x9e3779b9;
+		return value ^ (value >> 16);
+	}
+	static bool equal(const K &a, const K &b) {
+		return (a == b);
+	}
+};
+
+template<> struct HashTraits<const char *> {
+	static uint32_t hash(const char *key) {
+		// 32-bit FNV-1a hash
+		uint32_t value = 0x811c9dc5;
+
+		for (; *key; key++)
+			value = (value ^ uint8_t(*key)) * 0x01000193;
+
+		return value;
+	}
+	static bool equal(const char *a, const char *b) {
+		return !strcmp(a, b);
+	}
+};
+
+/**
+ * @brief Hash table mapping keys to values, with a fixed number of slots.
+ *
+ * @details Uses open addressing with linear probing. Removed entries leave a
+ * "tombstone" behind, which is reused by later insertions; clear() gets rid
+ * of all tombstones. Lookups are fastest when the map is kept under 75% full.
+ *
+ * Pointers returned by get() and set() remain valid until the entry is
+ * removed or the map is cleared, as entries are never moved.
+ */
+template<typename K, typename V, size_t N = DYNAMIC, typename H = HashTraits<K>> class HashMap {
+	static_assert((N == DYNAMIC) || isPowerOf2(N), "capacity must be a power of two");
+
+private:
+	enum SlotState : uint8_t {
+		EMPTY   = 0,
+		USED    = 1,
+		REMOVED = 2
+	};
+
+	struct Slot {
+		alignas(K) uint8_t key[sizeof(K)];
+		alignas(V) uint8_t value[sizeof(V)];
+		SlotState          state;
+
+		K &getKey(void) {
+			return *reinterpret_cast<K *>(key);
+		}
+		V &getValue(void) {
+			return *reinterpret_cast<V *>(value);
+		}
+	};
+
+	Storage<Slot, N> _storage;
+	size_t           _size;
+
+	void _reset(void) {
+		Slot *slots = _storage.get();
+
+		for (size_t i = 0; i < _storage.capacity(); i++)
+			slots[i].state = EMPTY;
+
+		_size = 0;
+	}
+
+	// Returns the slot holding the given key, or nullptr if not found. If
+	// insert is set, the first empty or removed slot in the probe sequence is
+	// returned instead when the key is not found.
+	Slot *_find(const K &key, bool insert) {
+		Slot   *slots   = _storage.get();
+		Slot   *free    = nullptr;
+		size_t capacity = _storage.capacity();
+		size_t mask     = capacity - 1;
+		size_t index    = H::hash(key) & mask;
+
+		for (size_t i = 0; i < capacity; i++, index = (index + 1) & mask) {
+			Slot *slot = &slots[index];
+
+			if (slot->state == EMPTY)
+				return insert ? (free ? free : slot) : nullptr;
+			if (slot->state == REMOVED) {
+				if (!free)
+					free = slot;
+			} else if (H::equal(slot->getKey(), key)) {
+				return slot;
+			}
+		}
+
+		return insert ? free : nullptr;
+	}
+
+public:
+	HashMap(void)
+	: _size(0) {
+		_reset();
+	}
+	~HashMap(void) {
+		clear();
+	}
+
+	HashMap(const HashMap &) = delete;
+	HashMap &operator=(const HashMap &) = delete;
+
+	bool setBuffer(void *buffer, size_t capacity) {
+		clear();
+		if (!isPowerOf2(capacity))
+			return false;
+
+		_storage.setBuffer(buffer, capacity);
+		_reset();
+		return true;
+	}
+	template<typename A> bool allocate(A &allocator, size_t capacity) {
+		clear();
+		if (!isPowerOf2(capacity))
+			return false;
+
+		bool success = _storage.allocate(allocator, capacity);
+		_reset();
+		return success;
+	}
+	template<typename A> void release(A &allocator) {
+		clear();
+		_storage.release(allocator);
+	}
+
+	/**
+	 * @brief Returns the number of bytes of storage required by a DYNAMIC map
+	 * with the given capacity.
+	 */
+	static constexpr size_t getBufferSize(size_t capacity) {
+		return sizeof(Slot) * capacity;
+	}
+
+	size_t size(void) const {
+		return _size;
+	}
+	size_t capacity(void) const {
+		return _storage.capacity();
+	}
+	bool empty(void) const {
+		return !_size;
+	}
+
+	/**
+	 * @brief Looks up a key.
+	 *
+	 * @return Pointer to the associated value, or nullptr if not found
+	 */
+	V *get(const K &key) {
+		if (!_size)
+			return nullptr;
+
+		Slot *slot = _find(key, false);
+		return slot ? &slot->getValue() : nullptr;
+	}
+	bool contains(const K &key) {
+		return (get(key) != nullptr);
+	}
+
+	/**
+	 * @brief Constructs a value for the given key if not already present.
+	 *
+	 * @details If the key is already in the map, its value is left untouched
+	 * and returned.
+	 *
+	 * @return Pointer to the value, or nullptr if the map is full
+	 */
+	template<typename... A> V *emplace(const K &key, A &&...args) {
+		Slot *slot = _find(key, true);
+
+		if (!slot)
+			return nullptr;
+		if (slot->state == USED)
+			return &slot->getValue();
+
+		new(slot->key) K(key);
+		new(slot->value) V(forward<A>(args)...);
+		slot->state = USED;
+		_size++;
+
+		return &slot->getValue();
+	}
+
+	/**
+	 * @brief Inserts a key or replaces the value associated with it.
+	 *
+	 * @return Pointer to the value, or nullptr if the map is full
+	 */
+	V *set(const K &key, const V &value) {
+		Slot *slot = _find(key, true);
+
+		if (!slot)
+			return nullptr;
+		if (slot->state == USED) {
+			slot->getValue() = value;
+			return &slot->getValue();
+		}
+
+		new(slot->key) K(key);
+		new(slot->value) V(value);
+		slot->state = USED;
+		_size++;
+
+		return &slot->getValue();
+	}
+
+	/**
+	 * @brief Removes a key and its associated value.
+	 *
+	 * @return False if the key was not found
+	 */
+	bool remove(const K &key) {
+		if (!_size)
+			return false;
+
+		Slot *slot = _find(key, false);
+
+		if (!slot)
+			return false;
+
+		slot->getKey().~K();
+		slot->getValue().~V();
+		slot->state = REMOVED;
+		_size--;
+
+		return true;
+	}
+
+	/**
+	 * @brief Calls the given function for each entry in the map, passing the
+	 * key and a reference to the value. Entries are visited in no particular
+	 * order and must not be added or removed while iterating.
+	 */
+	template<typename F> void forEach(F &&func) {
+		Slot *slots = _storage.get();
+
+		for (size_t i = 0; i < _storage.capacity(); i++) {
+			if (slots[i].state == USED)
+				func(slots[i].getKey(), slots[i].getValue());
+		}
+	}
+
+	void clear(void) {
+		Slot *slots = _storage.get();
+
+		for (size_t i = 0; _size && (i < _storage.capacity()); i++) {
+			if (slots[i].state == USED) {
+				slots[i].getKey().~K();
+				slots[i].getValue().~V();
+				_size--;
+			}
+		}
+
+		_reset();
+	}
+};
+
+/* Intrusive list class */
+
+template<typename T, typename Tag> class IntrusiveList;
+
+/**
+ * @brief Base class for objects that can be linked into an IntrusiveList.
+ *
+ * @details An object can be in multiple lists at the same time by inheriting
+ * from ListNode multiple times with different tag types, e.g.
+ * `class Actor : public ListNode<Actor, AllTag>, public ListNode<Actor, DrawTag>`.
+ * An object can only be in one list per tag at a time.
+ */
+template<typename T, typename Tag = void> class ListNode {
+	friend class IntrusiveList<T, Tag>;
+
+private:
+	ListNode *_prev, *_next;
+
+public:
+	constexpr ListNode(void)
+	: _prev(nullptr), _next(nullptr) {}
+
+	ListNode(const ListNode &) = delete;
+	ListNode &operator=(const ListNode &) = delete;
+};
+
+/**
+ * @brief Doubly-linked list of objects inheriting from ListNode.
+ *
+ * @details The list does not own the objects linked into it; they must be
+ * removed from the list before being destroyed. All operations except size()
+ * take constant time.
+ */
+template<typename T, typename Tag = void> class IntrusiveList {
+private:
+	using Node = ListNode<T, Tag>;
+
+	Node *_head, *_tail;
+
+	static T *_toObject(Node *node) {
+		return static_cast<T *>(node);
+	}
+
+public:
+	class Iterator {
+	private:
+		Node *_node;
+
+	public:
+		constexpr Iterator(Node *node)
+		: _node(node) {}
+
+		T &operator*(void) const {
+			return *_toObject(_node);
+		}
+		T *operator->(void) const {
+			return _toObject(_node);
+		}
+		Iterator &operator++(void) {
+			_node = _node->_next;
+			return *this;
+		}
+		bool operator==(const Iterator &other) const {
+			return (_node == other._node);
+		}
+		bool operator!=(const Iterator &other) const {
+			return (_node != other._node);
+		}
+	};
+
+	constexpr IntrusiveList(void)
+	: _head(nullptr), _tail(nullptr) {}
+
+	IntrusiveList(const IntrusiveList &) = delete;
+	IntrusiveList &operator=(const IntrusiveList &) = delete;
+
+	bool empty(void) const {
+		return !_head;
+	}
+	size_t size(void) const {
+		size_t count = 0;
+
+		for (Node *node = _head; node; node = node->_next)
+			count++;
+
+		return count;
+	}
+
+	T *front(void) {
+		return _head ? _toObject(_head) : nullptr;
+	}
+	T *back(void) {
+		return _tail ? _toObject(_tail) : nullptr;
+	}
+	static T *next(T *item) {
+		Node *node = static_cast<Node *>(item)->_next;
+		return node ? _toObject(node) : nullptr;
+	}
+	static T *prev(T *item) {
+		Node *node = static_cast<Node *>(item)->_prev;
+		return node ? _toObject(node) : nullptr;
+	}
+
+	Iterator begin(void) {
+		return Iterator(_head);
+	}
+	Iterator end(void) {
+		return Iterator(nullptr);
+	}
+
+	void pushFront(T *item) {
+		Node *node = static_cast<Node *>(item);
+
+		node->_prev = nullptr;
+		node->_next = _head;
+
+		if (_head)
+			_head->_prev = node;
+		else
+			_tail = node;
+
+		_head = node;
+	}
+	void pushBack(T *item) {
+		Node *node = static_cast<Node *>(item);
+
+		node->_prev = _tail;
+		node->_next = nullptr;
+
+		if (_tail)
+			_tail->_next = node;
+		else
+			_head = node;
+
+		_tail = node;
+	}
+
+	/**
+	 * @brief Links an item right after another item already in the list (or at
+	 * the front of the list if position is nullptr).
+	 */
+	void insertAfter(T *position, T *item) {
+		if (!position) {
+			pushFront(item);
+			return;
+		}
+
+		Node *prev = static_cast<Node *>(position);
+		Node *node = static_cast<Node *>(item);
+
+		node->_prev = prev;
+		node->_next = prev->_next;
+
+		if (prev->_next)
+			prev->_next->_prev = node;
+		else
+			_tail = node;
+
+		prev->_next = node;
+	}
+
+	/**
+	 * @brief Unlinks an item, which must currently be in this list.
+	 */
+	void remove(T *item) {
+		Node *node = static_cast<Node *>(item);
+
+		if (node->_prev)
+			node->_prev->_next = node->_next;
+		else
+			_head = node->_next;
+
+		if (node->_next)
+			node->_next->_prev = node->_prev;
+		else
+			_tail = node->_prev;
+
+		node->_prev = nullptr;
+		node->_next = nullptr;
+	}
+
+	T *popFront(void) {
+		T *item = front();
+
+		if (item)
+			remove(item);
+
+		return item;
+	}
+	T *popBack(void) {
+		T *item = back();
+
+		if (item)
+			remove(item);
+
+		return item;
+	}
+
+	/**
+	 * @brief Unlinks all items from the list.
+	 */
+	void clear(void) {
+		while (popFront())
+			continue;
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,165 @@
+/*
+ * PSn00bSDK C++ utility library
+ * (C) 2022 PSn00bSDK contributors - MPL licensed
+ */
+
+/**
+ * @file util/fixed.hpp
+ * @brief C++ utility library fixed-point header
+ *
+ * @details This header provides Fixed, a signed 32-bit fixed-point type with
+ * overloaded operators, and the Fix16 (16.16) and Fix12 (20.12, used by the
+ * GTE) aliases. It follows the same conventions as fixed.h (multiplication and
+ * division use a 64-bit intermediate, conversion to integers rounds towards
+ * negative infinity) and raw values can be freely exchanged with fix16_t and
+ * fix12_t through raw() and fromRaw().
+ *
+ * All operations are constexpr, so fixed-point constants and lookup tables can
+ * be computed entirely at compile time. fromFloat() must only be used with
+ * constant arguments, as calling it at runtime would pull in soft-float code.
+ */
+
+#ifndef __UTIL_FIXED_HPP
+#define __UTIL_FIXED_HPP
+
+#include <stdint.h>
+#include <util/base.hpp>
+
+namespace util {
+
+template<int BITS> class Fixed {
+	static_assert((BITS > 0) && (BITS < 31), "invalid number of fractional bits");
+
+private:
+	int32_t _value;
+
+	struct RawTag {};
+	constexpr Fixed(int32_t value, RawTag)
+	: _value(value) {}
+
+public:
+	static constexpr int32_t ONE = 1 << BITS;
+
+	constexpr Fixed(void)
+	: _value(0) {}
+	constexpr Fixed(int value)
+	: _value(value * ONE) {}
+
+	/**
+	 * @brief Converts a value from another fixed-point format, truncating
+	 * (but not saturating) it if the format has fewer fractional bits.
+	 */
+	template<int OTHER> constexpr explicit Fixed(Fixed<OTHER> other)
+	: _value(
+		(OTHER > BITS)
+			? (other.raw() >> ((OTHER > BITS) ? (OTHER - BITS) : 0))
+			: (other.raw() * (1 << ((BITS > OTHER) ? (BITS - OTHER) : 0)))
+	) {}
+
+	static constexpr Fixed fromRaw(int32_t value) {
+		return Fixed(value, RawTag());
+	}
+	static constexpr Fixed fromFloat(double value) {
+		return Fixed(int32_t(value * ONE + ((value >= 0) ? 0.5 : -0.5)), RawTag());
+	}
+	static constexpr Fixed fromRatio(int numerator, int denominator) {
+		return Fixed(int32_t(int64_t(numerator) * (int64_t(1) << BITS) / denominator), RawTag());
+	}
+
+	constexpr int32_t raw(void) const {
+		return _value;
+	}
+	constexpr int toInt(void) const {
+		return _value >> BITS;
+	}
+	constexpr int round(void) const {
+		return (_value + (ONE >> 1)) >> BITS;
+	}
+	constexpr Fixed abs(void) const {
+		return Fixed((_value < 0) ? -_value : _value, RawTag());
+	}
+
+	/* Arithmetic operators */
+
+	constexpr Fixed operator-(void) const {
+		return Fixed(-_value, RawTag());
+	}
+	constexpr Fixed operator+(Fixed other) const {
+		return Fixed(_value + other._value, RawTag());
+	}
+	constexpr Fixed operator-(Fixed other) const {
+		return Fixed(_value - other._value, RawTag());
+	}
+	constexpr Fixed operator*(Fixed other) const {
+		return Fixed(int32_t((int64_t(_value) * other._value) >> BITS), RawTag());
+	}
+	constexpr Fixed operator/(Fixed other) const {
+		return Fixed(int32_t(int64_t(_value) * (int64_t(1) << BITS) / other._value), RawTag());
+	}
+
+	// Multiplying or dividing by an integer does not require a 64-bit
+	// intermediate result.
+	constexpr Fixed operator*(int other) const {
+		return Fixed(_value * other, RawTag());
+	}
+	constexpr Fixed operator/(int other) const {
+		return Fixed(_value / other, RawTag());
+	}
+	constexpr Fixed operator>>(int shift) const {
+		return Fixed(_value >> shift, RawTag());
+	}
+	constexpr Fixed operator<<(int shift) const {
+		return Fixed(_value * (int32_t(1) << shift), RawTag());
+	}
+
+	constexpr Fixed &operator+=(Fixed other) {
+		_value += other._value;
+		return *this;
+	}
+	constexpr Fixed &operator-=(Fixed other) {
+		_value -= other._value;
+		return *this;
+	}
+	constexpr Fixed &operator*=(Fixed other) {
+		return *this = *this * other;
+	}
+	constexpr Fixed &operator/=(Fixed other) {
+		return *this = *this / other;
+	}
+	constexpr Fixed &operator*=(int other) {
+		_value *= other;
+		return *this;
+	}
+	constexpr Fixed &operator/=(int other) {
+		_value /= other;
+		return *this;
+	}
+
+	/* Comparison operators */
+
+	constexpr bool operator==(Fixed other) const {
+		return (_value == other._value);
+	}
+	constexpr bool operator!=(Fixed other) const {
+		return (_value != other._value);
+	}
+	constexpr bool operator<(Fixed other) const {
+		return (_value < other._value);
+	}
+	constexpr bool operator<=(Fixed other) const {
+		return (_value <= other._value);
+	}
+	constexpr bool operator>(Fixed other) const {
+		return (_value > other._value);
+	}
+	constexpr bool operator>=(Fixed other) const {
+		return (_value >= other._value);
+	}
+};
+
+using Fix16 = Fixed<16>;
+using Fix12 = Fixed<12>;
+
+}
+
+#endif
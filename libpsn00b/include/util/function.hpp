@@ -0,0 +1,129 @@
+/*
+ * PSn00bSDK C++ utility library
+ * (C) 2022 PSn00bSDK contributors - MPL licensed
+ */
+
+/**
+ * @file util/function.hpp
+ * @brief C++ utility library callable wrapper header
+ *
+ * @details This header provides Function, a replacement for std::function
+ * that never allocates. Any callable object (function pointer, lambda or
+ * functor) can be stored in a Function as long as it fits in the wrapper's
+ * inline buffer, whose size is a template argument (8 bytes by default,
+ * enough for a lambda capturing two pointers). Larger callables are rejected
+ * at compile time rather than silently spilled to the heap.
+ *
+ * Calling an empty Function is undefined; use operator bool to check whether
+ * a callable has been assigned.
+ */
+
+#ifndef __UTIL_FUNCTION_HPP
+#define __UTIL_FUNCTION_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <util/base.hpp>
+
+namespace util {
+
+template<typename S, size_t SIZE = 8> class Function;
+
+/**
+ * @brief Type-erased wrapper for a callable object with the given signature.
+ */
+template<typename R, typename... A, size_t SIZE> class Function<R(A...), SIZE> {
+private:
+	enum Operation {
+		COPY    = 0,
+		DESTROY = 1
+	};
+
+	using Invoker = R (*)(void *callable, A... args);
+	using Manager = void (*)(Operation op, void *dest, const void *src);
+
+	alignas(8) uint8_t _buffer[SIZE];
+	Invoker            _invoke;
+	Manager            _manage;
+
+	template<typename F> static R _invokeImpl(void *callable, A... args) {
+		return (*reinterpret_cast<F *>(callable))(forward<A>(args)...);
+	}
+	template<typename F> static void _manageImpl(
+		Operation  op,
+		void       *dest,
+		const void *src
+	) {
+		if (op == COPY)
+			new(dest) F(*reinterpret_cast<const F *>(src));
+		else
+			reinterpret_cast<F *>(dest)->~F();
+	}
+
+	void _copyFrom(const Function &other) {
+		_invoke = other._invoke;
+		_manage = other._manage;
+
+		if (_manage)
+			_manage(COPY, _buffer, other._buffer);
+	}
+
+public:
+	constexpr Function(void)
+	: _buffer{}, _invoke(nullptr), _manage(nullptr) {}
+	constexpr Function(decltype(nullptr))
+	: _buffer{}, _invoke(nullptr), _manage(nullptr) {}
+
+	template<
+		typename F,
+		typename = typename EnableIf<!IsSame<Decay<F>, Function>::VALUE>::Type
+	> Function(F &&callable) {
+		using T = Decay<F>;
+
+		static_assert(sizeof(T) <= SIZE, "callable too large, increase the buffer size");
+		static_assert(alignof(T) <= 8, "callable alignment not supported");
+
+		new(_buffer) T(forward<F>(callable));
+		_invoke = &_invokeImpl<T>;
+		_manage = &_manageImpl<T>;
+	}
+
+	Function(const Function &other) {
+		_copyFrom(other);
+	}
+	~Function(void) {
+		reset();
+	}
+
+	Function &operator=(const Function &other) {
+		if (this != &other) {
+			reset();
+			_copyFrom(other);
+		}
+
+		return *this;
+	}
+	Function &operator=(decltype(nullptr)) {
+		reset();
+		return *this;
+	}
+
+	void reset(void) {
+		if (_manage)
+			_manage(DESTROY, _buffer, nullptr);
+
+		_invoke = nullptr;
+		_manage = nullptr;
+	}
+
+	explicit operator bool(void) const {
+		return (_invoke != nullptr);
+	}
+	R operator()(A... args) const {
+		return _invoke(const_cast<uint8_t *>(_buffer), forward<A>(args)...);
+	}
+};
+
+}
+
+#endif
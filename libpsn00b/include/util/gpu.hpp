@@ -0,0 +1,463 @@
+/*
+ * PSn00bSDK C++ utility library
+ * (C) 2022 PSn00bSDK contributors - MPL licensed
+ */
+
+/**
+ * @file util/gpu.hpp
+ * @brief C++ utility library GPU primitive header
+ *
+ * @details This header provides a type-safe C++ alternative to the primitive
+ * structures and macros in psxgpu.h. Each primitive type is a template whose
+ * GPU command code and packet length are computed at compile time from its
+ * parameters (vertex count, texturing, shading and the SEMI_TRANS and
+ * RAW_TEXTURE flags), so there is no separate initialization step: the
+ * command code is written together with the primitive's color, and the length
+ * together with the link address when the primitive is inserted into an
+ * ordering table.
+ *
+ * Setters write entire 32-bit words whenever this is cheaper than writing
+ * individual fields, i.e. when the values are compile-time constants or are
+ * already packed (such as the screen coordinates returned by the GTE, or
+ * colors passed as a single 0xBBGGRR value). Otherwise they fall back to
+ * halfword or byte stores, which are faster than packing values at runtime.
+ * insert() replaces addPrim() and sets both the link and the length of a
+ * primitive with a single store, rather than the read-modify-write sequences
+ * generated by the P_TAG bitfield macros.
+ *
+ * Primitives have the same layout as the corresponding psxgpu.h structures
+ * (e.g. PolyFT4<> and POLY_FT4) and can be mixed freely with them in the same
+ * ordering table. Setting the color is mandatory as it also writes the
+ * command code; for primitives using RAW_TEXTURE, color() can be called with
+ * no arguments.
+ */
+
+#ifndef __UTIL_GPU_HPP
+#define __UTIL_GPU_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <psxgpu.h>
+#include <util/base.hpp>
+
+namespace util::gpu {
+
+/* Packing helpers */
+
+static constexpr uint32_t SEMI_TRANS  = 1 << 1;
+static constexpr uint32_t RAW_TEXTURE = 1 << 0;
+
+constexpr uint32_t rgb(uint8_t r, uint8_t g, uint8_t b) {
+	return r | (g << 8) | (b << 16);
+}
+constexpr uint32_t xy(int x, int y) {
+	return (uint32_t(x) & 0xffff) | (uint32_t(y) << 16);
+}
+constexpr uint32_t uv(uint8_t u, uint8_t v) {
+	return u | (v << 8);
+}
+constexpr uint16_t tpage(int tp, int abr, int x, int y) {
+	return getTPage(tp, abr, x, y);
+}
+constexpr uint16_t clut(int x, int y) {
+	return getClut(x, y);
+}
+
+typedef uint8_t  __attribute__((may_alias)) _Byte;
+typedef uint16_t __attribute__((may_alias)) _Half;
+
+static inline void _writeHalves(uint32_t &word, int low, int high) {
+	if (__builtin_constant_p(low) && __builtin_constant_p(high)) {
+		word = xy(low, high);
+	} else {
+		reinterpret_cast<_Half *>(&word)[0] = low;
+		reinterpret_cast<_Half *>(&word)[1] = high;
+	}
+}
+
+static inline void _writeColor(
+	uint32_t &word,
+	uint8_t  r,
+	uint8_t  g,
+	uint8_t  b,
+	uint8_t  code
+) {
+	if (__builtin_constant_p(r) && __builtin_constant_p(g) && __builtin_constant_p(b)) {
+		word = rgb(r, g, b) | (uint32_t(code) << 24);
+	} else {
+		reinterpret_cast<_Byte *>(&word)[0] = r;
+		reinterpret_cast<_Byte *>(&word)[1] = g;
+		reinterpret_cast<_Byte *>(&word)[2] = b;
+		reinterpret_cast<_Byte *>(&word)[3] = code;
+	}
+}
+
+/* Base primitive class */
+
+/**
+ * @brief Base class for all primitives, holding the tag and the command words
+ * and providing the color setters. CODE is the GPU command code, LENGTH the
+ * number of command words.
+ */
+template<uint8_t CODE, size_t LENGTH> class Primitive {
+public:
+	static constexpr uint8_t  COMMAND_CODE = CODE;
+	static constexpr size_t   WORDS        = LENGTH;
+	static constexpr uint32_t TAG          = LENGTH << 24;
+
+	uint32_t tag;
+	uint32_t data[LENGTH];
+
+	/**
+	 * @brief Sets the primitive's color (or the color of the first vertex)
+	 * and command code. The color is packed as 0xBBGGRR.
+	 */
+	void color(uint32_t value) {
+		data[0] = value | (uint32_t(CODE) << 24);
+	}
+	void color(uint8_t r, uint8_t g, uint8_t b) {
+		_writeColor(data[0], r, g, b, CODE);
+	}
+	void color(void) {
+		data[0] = 0x808080 | (uint32_t(CODE) << 24);
+	}
+};
+
+/* Polygon primitives */
+
+/**
+ * @brief Flat or Gouraud shaded, optionally textured triangle or quad.
+ *
+ * @details Use the PolyF3, PolyFT4, PolyGT3 (etc.) aliases rather than this
+ * template directly. Vertex data is laid out as follows, with the color of
+ * each vertex only present in Gouraud shaded primitives and the first color
+ * sharing a word with the command code:
+ *
+ * | Word        | Contents                |
+ * | :---------- | :---------------------- |
+ * | color       | 0xBBGGRR (first: code)  |
+ * | xy          | X in the lower halfword |
+ * | uv (+ attr) | UV, then CLUT or TPAGE  |
+ */
+template<size_t N, bool TEXTURED, bool GOURAUD, uint32_t FLAGS = 0> class Polygon
+: public Primitive<
+	0x20 | ((N == 4) ? 0x08 : 0) | (TEXTURED ? 0x04 : 0) | (GOURAUD ? 0x10 : 0) | FLAGS,
+	(GOURAUD ? 0 : 1) + N * (1 + TEXTURED + GOURAUD)
+> {
+	static_assert((N == 3) || (N == 4), "polygons must have 3 or 4 vertices");
+	static_assert(TEXTURED || !(FLAGS & RAW_TEXTURE), "RAW_TEXTURE requires texturing");
+
+private:
+	static constexpr size_t STRIDE = 1 + TEXTURED + GOURAUD;
+
+	static constexpr size_t _xyIndex(size_t index) {
+		return index * STRIDE + 1;
+	}
+	static constexpr size_t _uvIndex(size_t index) {
+		return index * STRIDE + 2;
+	}
+
+public:
+	/**
+	 * @brief Sets the color of a vertex (Gouraud shaded polygons only).
+	 */
+	void vertexColor(size_t index, uint32_t value) {
+		static_assert(GOURAUD, "vertexColor() requires Gouraud shading");
+
+		if (!index)
+			this->color(value);
+		else
+			this->data[index * STRIDE] = value;
+	}
+	void vertexColor(size_t index, uint8_t r, uint8_t g, uint8_t b) {
+		static_assert(GOURAUD, "vertexColor() requires Gouraud shading");
+
+		if (!index)
+			this->color(r, g, b);
+		else
+			_writeColor(this->data[index * STRIDE], r, g, b, 0);
+	}
+
+	/**
+	 * @brief Sets the screen coordinates of a vertex. The packed variant
+	 * takes a value in the format stored by the GTE's SXY registers.
+	 */
+	void xy(size_t index, int x, int y) {
+		_writeHalves(this->data[_xyIndex(index)], x, y);
+	}
+	void xy(size_t index, uint32_t packed) {
+		this->data[_xyIndex(index)] = packed;
+	}
+
+	/**
+	 * @brief Sets the coordinates of all vertices of a quad so that it covers
+	 * the given rectangle (the equivalent of setXYWH()).
+	 */
+	void rect(int x, int y, int w, int h) {
+		static_assert(N == 4, "rect() requires a quad");
+
+		xy(0, x,     y);
+		xy(1, x + w, y);
+		xy(2, x,     y + h);
+		xy(3, x + w, y + h);
+	}
+
+	/**
+	 * @brief Sets the texture coordinates of a vertex (textured polygons
+	 * only), leaving the CLUT and texture page untouched.
+	 */
+	void uv(size_t index, uint8_t u, uint8_t v) {
+		static_assert(TEXTURED, "uv() requires texturing");
+
+		reinterpret_cast<_Half *>(&this->data[_uvIndex(index)])[0] = util::gpu::uv(u, v);
+	}
+	void clut(uint16_t value) {
+		static_assert(TEXTURED, "clut() requires texturing");
+
+		reinterpret_cast<_Half *>(&this->data[_uvIndex(0)])[1] = value;
+	}
+	void tpage(uint16_t value) {
+		static_assert(TEXTURED, "tpage() requires texturing");
+
+		reinterpret_cast<_Half *>(&this->data[_uvIndex(1)])[1] = value;
+	}
+
+	/**
+	 * @brief Sets the texture page, CLUT and texture coordinates of a quad so
+	 * that it maps the given rectangle of the texture page (the equivalent of
+	 * setUVWH(), setClut() and setTPage()). Each word is written at once.
+	 */
+	void texture(uint16_t page, uint16_t palette, uint8_t u, uint8_t v, uint8_t w, uint8_t h) {
+		static_assert(TEXTURED && (N == 4), "texture() requires a textured quad");
+
+		this->data[_uvIndex(0)] = util::gpu::uv(u,     v)     | (palette << 16);
+		this->data[_uvIndex(1)] = util::gpu::uv(u + w, v)     | (page << 16);
+		this->data[_uvIndex(2)] = util::gpu::uv(u,     v + h);
+		this->data[_uvIndex(3)] = util::gpu::uv(u + w, v + h);
+	}
+};
+
+template<uint32_t F = 0> using PolyF3  = Polygon<3, false, false, F>;
+template<uint32_t F = 0> using PolyF4  = Polygon<4, false, false, F>;
+template<uint32_t F = 0> using PolyFT3 = Polygon<3, true,  false, F>;
+template<uint32_t F = 0> using PolyFT4 = Polygon<4, true,  false, F>;
+template<uint32_t F = 0> using PolyG3  = Polygon<3, false, true,  F>;
+template<uint32_t F = 0> using PolyG4  = Polygon<4, false, true,  F>;
+template<uint32_t F = 0> using PolyGT3 = Polygon<3, true,  true,  F>;
+template<uint32_t F = 0> using PolyGT4 = Polygon<4, true,  true,  F>;
+
+/* Rectangle primitives */
+
+/**
+ * @brief Untextured (tile) or textured (sprite) rectangle. SIZE can be 1 (for
+ * tiles only), 8 or 16 for fixed-size rectangles, or 0 for a variable size.
+ */
+template<int SIZE, bool TEXTURED, uint32_t FLAGS = 0> class Rectangle
+: public Primitive<
+	0x60 |
+		((SIZE == 1) ? 0x08 : (SIZE == 8) ? 0x10 : (SIZE == 16) ? 0x18 : 0) |
+		(TEXTURED ? 0x04 : 0) |
+		FLAGS,
+	2 + TEXTURED + !SIZE
+> {
+	static_assert(
+		!SIZE || (SIZE == 8) || (SIZE == 16) || ((SIZE == 1) && !TEXTURED),
+		"invalid rectangle size"
+	);
+	static_assert(TEXTURED || !(FLAGS & RAW_TEXTURE), "RAW_TEXTURE requires texturing");
+
+public:
+	void xy(int x, int y) {
+		_writeHalves(this->data[1], x, y);
+	}
+	void xy(uint32_t packed) {
+		this->data[1] = packed;
+	}
+
+	/**
+	 * @brief Sets the texture coordinates and CLUT (sprites only). The
+	 * texture page must be set separately using a DrawTPage primitive.
+	 */
+	void uv(uint8_t u, uint8_t v, uint16_t palette) {
+		static_assert(TEXTURED, "uv() requires texturing");
+
+		this->data[2] = util::gpu::uv(u, v) | (palette << 16);
+	}
+
+	void size(int w, int h) {
+		static_assert(!SIZE, "size() requires a variable size rectangle");
+
+		_writeHalves(this->data[2 + TEXTURED], w, h);
+	}
+};
+
+template<uint32_t F = 0> using Tile     = Rectangle<0,  false, F>;
+template<uint32_t F = 0> using Tile1    = Rectangle<1,  false, F>;
+template<uint32_t F = 0> using Tile8    = Rectangle<8,  false, F>;
+template<uint32_t F = 0> using Tile16   = Rectangle<16, false, F>;
+template<uint32_t F = 0> using Sprite   = Rectangle<0,  true,  F>;
+template<uint32_t F = 0> using Sprite8  = Rectangle<8,  true,  F>;
+template<uint32_t F = 0> using Sprite16 = Rectangle<16, true,  F>;
+
+/* Line primitives */
+
+/**
+ * @brief Flat or Gouraud shaded single line segment.
+ */
+template<bool GOURAUD, uint32_t FLAGS = 0> class Line
+: public Primitive<0x40 | (GOURAUD ? 0x10 : 0) | FLAGS, 3 + GOURAUD> {
+	static_assert(!(FLAGS & RAW_TEXTURE), "lines cannot be textured");
+
+public:
+	void vertexColor(size_t index, uint32_t value) {
+		static_assert(GOURAUD, "vertexColor() requires Gouraud shading");
+
+		if (!index)
+			this->color(value);
+		else
+			this->data[2] = value;
+	}
+
+	void xy(size_t index, int x, int y) {
+		_writeHalves(this->data[index * (1 + GOURAUD) + 1], x, y);
+	}
+	void xy(size_t index, uint32_t packed) {
+		this->data[index * (1 + GOURAUD) + 1] = packed;
+	}
+};
+
+template<uint32_t F = 0> using LineF2 = Line<false, F>;
+template<uint32_t F = 0> using LineG2 = Line<true,  F>;
+
+/* Other primitives */
+
+/**
+ * @brief VRAM fill command. The X coordinate and width are rounded to
+ * multiples of 16 pixels by the GPU, and the fill ignores the drawing area and
+ * offset.
+ */
+class Fill : public Primitive<0x02, 3> {
+public:
+	void rect(int x, int y, int w, int h) {
+		_writeHalves(data[1], x, y);
+		_writeHalves(data[2], w, h);
+	}
+};
+
+/**
+ * @brief Draw mode (texture page) setting command, the equivalent of
+ * DR_TPAGE and setDrawTPage().
+ */
+class DrawTPage {
+public:
+	static constexpr size_t   WORDS = 1;
+	static constexpr uint32_t TAG   = WORDS << 24;
+
+	uint32_t tag;
+	uint32_t data[WORDS];
+
+	void set(uint16_t page, bool dither = false, bool drawDisplay = false) {
+		data[0] = 0xe1000000 | page | (dither << 9) | (drawDisplay << 10);
+	}
+};
+
+static_assert(sizeof(PolyF3<>)  == sizeof(POLY_F3),  "PolyF3 size mismatch");
+static_assert(sizeof(PolyF4<>)  == sizeof(POLY_F4),  "PolyF4 size mismatch");
+static_assert(sizeof(PolyFT3<>) == sizeof(POLY_FT3), "PolyFT3 size mismatch");
+static_assert(sizeof(PolyFT4<>) == sizeof(POLY_FT4), "PolyFT4 size mismatch");
+static_assert(sizeof(PolyG3<>)  == sizeof(POLY_G3),  "PolyG3 size mismatch");
+static_assert(sizeof(PolyG4<>)  == sizeof(POLY_G4),  "PolyG4 size mismatch");
+static_assert(sizeof(PolyGT3<>) == sizeof(POLY_GT3), "PolyGT3 size mismatch");
+static_assert(sizeof(PolyGT4<>) == sizeof(POLY_GT4), "PolyGT4 size mismatch");
+static_assert(sizeof(Tile<>)    == sizeof(TILE),     "Tile size mismatch");
+static_assert(sizeof(Tile16<>)  == sizeof(TILE_16),  "Tile16 size mismatch");
+static_assert(sizeof(Sprite<>)  == sizeof(SPRT),     "Sprite size mismatch");
+static_assert(sizeof(Sprite8<>) == sizeof(SPRT_8),   "Sprite8 size mismatch");
+static_assert(sizeof(LineF2<>)  == sizeof(LINE_F2),  "LineF2 size mismatch");
+static_assert(sizeof(LineG2<>)  == sizeof(LINE_G2),  "LineG2 size mismatch");
+static_assert(sizeof(Fill)      == sizeof(FILL),     "Fill size mismatch");
+static_assert(sizeof(DrawTPage) == sizeof(DR_TPAGE), "DrawTPage size mismatch");
+
+/* Ordering table and packet buffer */
+
+/**
+ * @brief Links a primitive into an ordering table entry (cleared by
+ * ClearOTag() or ClearOTagR()), setting its length at the same time. This is
+ * the typed equivalent of addPrim().
+ */
+template<typename P> static inline void insert(uint32_t *entry, P *prim) {
+	// Ordering table entries always have a length of zero, so the current
+	// link can be used as is.
+	prim->tag = P::TAG | *entry;
+	*entry    = uint32_t(reinterpret_cast<uintptr_t>(prim)) & 0xffffff;
+}
+
+/**
+ * @brief Reverse ordering table of N entries. Primitives inserted with a
+ * higher Z index are drawn first.
+ */
+template<size_t N> class OrderingTable {
+private:
+	uint32_t _entries[N];
+
+public:
+	void clear(void) {
+		ClearOTagR(_entries, N);
+	}
+	template<typename P> void insert(size_t z, P *prim) {
+		util::gpu::insert(&_entries[z], prim);
+	}
+	uint32_t *operator[](size_t z) {
+		return &_entries[z];
+	}
+	const uint32_t *head(void) const {
+		return &_entries[N - 1];
+	}
+	void draw(void) const {
+		DrawOTag(head());
+	}
+};
+
+/**
+ * @brief Linear buffer of SIZE bytes that primitives can be allocated from.
+ * Each frame's primitives should be allocated from a different buffer than the
+ * one currently being drawn by the GPU.
+ */
+template<size_t SIZE> class PacketBuffer {
+	static_assert(!(SIZE % 4), "size must be a multiple of 4 bytes");
+
+private:
+	uint32_t _data[SIZE / 4];
+	uint32_t *_next;
+
+public:
+	PacketBuffer(void)
+	: _next(_data) {}
+
+	/**
+	 * @brief Allocates an uninitialized primitive.
+	 *
+	 * @return Pointer to the primitive, or nullptr if the buffer is full
+	 */
+	template<typename P> P *allocate(void) {
+		uint32_t *next = _next + sizeof(P) / 4;
+
+		if (next > &_data[SIZE / 4])
+			return nullptr;
+
+		P *prim = reinterpret_cast<P *>(_next);
+		_next   = next;
+		return prim;
+	}
+
+	void reset(void) {
+		_next = _data;
+	}
+	size_t getUsed(void) const {
+		return (_next - _data) * 4;
+	}
+};
+
+}
+
+#endif
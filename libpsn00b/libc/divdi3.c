@@ -0,0 +1,111 @@
+/*
+ * PSn00bSDK 64-bit division functions
+ * (C) 2022 PSn00bSDK contributors - MPL licensed
+ *
+ * These replace libgcc's 64-bit division and modulo functions, which GCC emits
+ * calls to for any division involving long long operands. The most common
+ * cases (64-bit values that actually fit into 32 bits, or divisors that fit
+ * into 16 bits) are handled using the R3000's 32-bit hardware divider, falling
+ * back to a shift-and-subtract loop otherwise. Division by zero triggers a
+ * break exception, just like regular 32-bit division does.
+ *
+ * This file must not contain any 64-bit divisions or multiplications, as they
+ * would result in calls to the very functions defined here.
+ */
+
+#include <stdint.h>
+
+/* Internal helpers */
+
+static uint64_t _udivmod(uint64_t num, uint64_t den, uint64_t *rem) {
+	uint32_t num_hi = (uint32_t) (num >> 32), num_lo = (uint32_t) num;
+	uint32_t den_hi = (uint32_t) (den >> 32), den_lo = (uint32_t) den;
+
+	if (!den_hi) {
+		// 32-bit by 32-bit division.
+		if (!num_hi) {
+			*rem = num_lo % den_lo;
+			return num_lo / den_lo;
+		}
+
+		// 64-bit by 16-bit division, performed as long division using 16-bit
+		// "digits" so that each step fits into the hardware divider.
+		if (den_lo <= 0xffff) {
+			uint32_t q_hi = num_hi / den_lo;
+			uint32_t r    = num_hi % den_lo;
+
+			uint32_t t     = (r << 16) | (num_lo >> 16);
+			uint32_t q_mid = t / den_lo;
+			r              = t % den_lo;
+
+			t             = (r << 16) | (num_lo & 0xffff);
+			uint32_t q_lo = t / den_lo;
+			*rem          = t % den_lo;
+
+			return ((uint64_t) q_hi << 32) | (q_mid << 16) | q_lo;
+		}
+	}
+
+	if (den > num) {
+		*rem = num;
+		return 0;
+	}
+
+	// Generic shift-and-subtract division. The divisor is first aligned with
+	// the dividend so the loop only runs once per quotient bit.
+	uint64_t bit  = 1;
+	uint64_t quot = 0;
+
+	while (!(den >> 63) && ((den << 1) <= num)) {
+		den <<= 1;
+		bit <<= 1;
+	}
+
+	for (; bit; den >>= 1, bit >>= 1) {
+		if (num >= den) {
+			num  -= den;
+			quot |= bit;
+		}
+	}
+
+	*rem = num;
+	return quot;
+}
+
+/* Public API */
+
+uint64_t __udivdi3(uint64_t a, uint64_t b) {
+	uint64_t rem;
+
+	return _udivmod(a, b, &rem);
+}
+
+uint64_t __umoddi3(uint64_t a, uint64_t b) {
+	uint64_t rem;
+
+	_udivmod(a, b, &rem);
+	return rem;
+}
+
+int64_t __divdi3(int64_t a, int64_t b) {
+	uint64_t rem;
+	uint64_t quot = _udivmod(
+		(a < 0) ? -((uint64_t) a) : a,
+		(b < 0) ? -((uint64_t) b) : b,
+		&rem
+	);
+
+	return ((a < 0) != (b < 0)) ? -quot : quot;
+}
+
+int64_t __moddi3(int64_t a, int64_t b) {
+	uint64_t rem;
+
+	_udivmod(
+		(a < 0) ? -((uint64_t) a) : a,
+		(b < 0) ? -((uint64_t) b) : b,
+		&rem
+	);
+
+	return (a < 0) ? -rem : rem;
+}
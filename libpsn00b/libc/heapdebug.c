@@ -0,0 +1,340 @@
+/*
+ * PSn00bSDK heap debugging layer
+ * (C) 2022 PSn00bSDK contributors - MPL licensed
+ *
+ * This layer is only built if libpsn00b is configured with
+ * PSN00BSDK_LIBC_DEBUG_HEAP enabled, which defines DEBUG_HEAP. In that case
+ * the allocator in malloc.c is renamed and wrapped by the functions below,
+ * which add an 8-byte header and a 4-byte trailing guard word to each
+ * allocation and record its address, size, caller and tag in a fixed-size
+ * side table. The header holds a guard word and the allocation's index in the
+ * table, so looking up an allocation never requires a search and malloc() and
+ * free() only have a small constant overhead.
+ *
+ * free() and realloc() validate both guard words and the table entry before
+ * releasing a block, so overruns, double frees and invalid pointers are
+ * reported (and the block left alone) rather than silently corrupting the
+ * heap. Allocations made once the table is full are still guarded but not
+ * tracked.
+ *
+ * If the debug heap is disabled, the API functions are still available but do
+ * nothing.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#ifdef DEBUG_HEAP
+
+#ifndef DEBUG_HEAP_MAX_ALLOCS
+#define DEBUG_HEAP_MAX_ALLOCS 1024
+#endif
+
+#define HEAD_GUARD	0xa110c8ed
+#define FREED_GUARD	0xf4eed000
+#define TAIL_GUARD	0xb0a710ad
+#define UNTRACKED	0xffffffff
+
+/* Private types */
+
+typedef struct _DebugHeader {
+	uint32_t index, guard;
+} DebugHeader;
+
+// Defined in malloc.c
+void *_heap_malloc(size_t size);
+void *_heap_realloc(void *ptr, size_t size);
+void _heap_free(void *ptr);
+
+/* Internal globals */
+
+static HeapAllocation	_allocs[DEBUG_HEAP_MAX_ALLOCS];
+static uint16_t			_free_indices[DEBUG_HEAP_MAX_ALLOCS];
+static uint16_t			_sort_buffer[DEBUG_HEAP_MAX_ALLOCS];
+static int				_free_count = -1, _untracked_count;
+
+static const char		*_current_tag;
+
+/* Helpers */
+
+static inline DebugHeader *_get_header(void *ptr) {
+	return (DebugHeader *) ((uintptr_t) ptr - sizeof(DebugHeader));
+}
+
+static inline void _set_tail_guard(void *ptr, size_t size) {
+	uint32_t guard = TAIL_GUARD;
+
+	// The guard is not necessarily aligned.
+	__builtin_memcpy((void *) ((uintptr_t) ptr + size), &guard, 4);
+}
+
+static inline int _check_tail_guard(void *ptr, size_t size) {
+	uint32_t guard;
+
+	__builtin_memcpy(&guard, (void *) ((uintptr_t) ptr + size), 4);
+	return (guard == TAIL_GUARD);
+}
+
+static void _init_table(void) {
+	for (int i = 0; i < DEBUG_HEAP_MAX_ALLOCS; i++)
+		_free_indices[i] = DEBUG_HEAP_MAX_ALLOCS - 1 - i;
+
+	_free_count = DEBUG_HEAP_MAX_ALLOCS;
+}
+
+static void _report(const char *error, void *ptr, void *caller) {
+	printf("heap: %s (ptr=%08x, caller=%08x)\n", error, (uint32_t) ptr, (uint32_t) caller);
+}
+
+// Returns the allocation's table entry (or a dummy entry for untracked
+// allocations), or NULL after reporting an error if the pointer is invalid or
+// the block has been corrupted.
+static HeapAllocation *_validate(void *ptr, void *caller) {
+	static HeapAllocation untracked;
+
+	DebugHeader *header = _get_header(ptr);
+
+	if (header->guard == FREED_GUARD) {
+		_report("double free", ptr, caller);
+		return 0;
+	}
+	if (header->guard != HEAD_GUARD) {
+		_report("invalid pointer or header overwritten", ptr, caller);
+		return 0;
+	}
+
+	HeapAllocation *alloc;
+
+	if (header->index == UNTRACKED) {
+		// Untracked allocations have no size information, so the tail guard
+		// can't be checked.
+		alloc       = &untracked;
+		alloc->ptr  = ptr;
+		alloc->size = 0;
+		return alloc;
+	}
+	if (header->index >= DEBUG_HEAP_MAX_ALLOCS) {
+		_report("header overwritten", ptr, caller);
+		return 0;
+	}
+
+	alloc = &_allocs[header->index];
+
+	if (alloc->ptr != ptr) {
+		_report("header overwritten", ptr, caller);
+		return 0;
+	}
+	if (!_check_tail_guard(ptr, alloc->size)) {
+		_report("buffer overrun", ptr, alloc->caller);
+		return 0;
+	}
+
+	return alloc;
+}
+
+static void *_debug_malloc(size_t size, void *caller) {
+	if (!size)
+		return 0;
+	if (_free_count < 0)
+		_init_table();
+
+	DebugHeader *header = _heap_malloc(sizeof(DebugHeader) + size + 4);
+	if (!header)
+		return 0;
+
+	void *ptr     = (void *) &header[1];
+	header->guard = HEAD_GUARD;
+
+	if (_free_count) {
+		uint32_t       index = _free_indices[--_free_count];
+		HeapAllocation *alloc = &_allocs[index];
+
+		alloc->ptr    = ptr;
+		alloc->size   = size;
+		alloc->caller = caller;
+		alloc->tag    = _current_tag;
+		header->index = index;
+	} else {
+		header->index = UNTRACKED;
+		_untracked_count++;
+	}
+
+	_set_tail_guard(ptr, size);
+	return ptr;
+}
+
+/* Allocator wrappers */
+
+void *malloc(size_t size) {
+	return _debug_malloc(size, __builtin_return_address(0));
+}
+
+void *calloc(size_t num, size_t size) {
+	return _debug_malloc(num * size, __builtin_return_address(0));
+}
+
+void *realloc(void *ptr, size_t size) {
+	void *caller = __builtin_return_address(0);
+
+	if (!ptr)
+		return _debug_malloc(size, caller);
+	if (!size) {
+		free(ptr);
+		return 0;
+	}
+
+	HeapAllocation *alloc = _validate(ptr, caller);
+	if (!alloc)
+		return 0;
+
+	DebugHeader *header = _heap_realloc(
+		_get_header(ptr),
+		sizeof(DebugHeader) + size + 4
+	);
+	if (!header)
+		return 0;
+
+	ptr = (void *) &header[1];
+
+	if (header->index != UNTRACKED) {
+		alloc->ptr    = ptr;
+		alloc->size   = size;
+		alloc->caller = caller;
+	}
+
+	_set_tail_guard(ptr, size);
+	return ptr;
+}
+
+void free(void *ptr) {
+	if (!ptr)
+		return;
+
+	HeapAllocation *alloc = _validate(ptr, __builtin_return_address(0));
+	if (!alloc)
+		return;
+
+	DebugHeader *header = _get_header(ptr);
+
+	if (header->index == UNTRACKED) {
+		_untracked_count--;
+	} else {
+		alloc->ptr = 0;
+		_free_indices[_free_count++] = header->index;
+	}
+
+	header->guard = FREED_GUARD;
+	_heap_free(header);
+}
+
+/* Public API */
+
+const char *SetHeapTag(const char *tag) {
+	const char *old_tag = _current_tag;
+
+	_current_tag = tag;
+	return old_tag;
+}
+
+int CheckHeap(void) {
+	int errors = 0;
+
+	if (_free_count < 0)
+		return 0;
+
+	for (int i = 0; i < DEBUG_HEAP_MAX_ALLOCS; i++) {
+		HeapAllocation *alloc = &_allocs[i];
+
+		if (alloc->ptr && !_validate(alloc->ptr, alloc->caller))
+			errors++;
+	}
+
+	return errors;
+}
+
+int GetHeapAllocations(HeapAllocation *allocs, int max_count) {
+	if (_free_count < 0)
+		return 0;
+
+	// Gather the indices of all live allocations and sort them by size (in
+	// descending order) using a shell sort.
+	int count = 0;
+
+	for (int i = 0; i < DEBUG_HEAP_MAX_ALLOCS; i++) {
+		if (_allocs[i].ptr)
+			_sort_buffer[count++] = i;
+	}
+
+	for (int gap = count / 2; gap; gap /= 2) {
+		for (int i = gap; i < count; i++) {
+			uint16_t index = _sort_buffer[i];
+			size_t   size  = _allocs[index].size;
+			int      j     = i;
+
+			for (; (j >= gap) && (_allocs[_sort_buffer[j - gap]].size < size); j -= gap)
+				_sort_buffer[j] = _sort_buffer[j - gap];
+
+			_sort_buffer[j] = index;
+		}
+	}
+
+	for (int i = 0; (i < count) && (i < max_count); i++)
+		allocs[i] = _allocs[_sort_buffer[i]];
+
+	return count;
+}
+
+static void _print_sink(void *arg, const char *str, int length) {
+	for (; length; length--)
+		putchar(*(str++));
+}
+
+void DumpHeapAllocations(printf_sink_t sink, void *arg) {
+	if (!sink)
+		sink = &_print_sink;
+
+	// Reuse the sorted index buffer rather than copying the whole table.
+	int    count = GetHeapAllocations(0, 0);
+	size_t total = 0;
+
+	cbprintf(sink, arg, "heap: %d live allocations\n", count);
+	cbprintf(sink, arg, "heap: %-8s %-8s %8s %s\n", "ptr", "caller", "size", "tag");
+
+	for (int i = 0; i < count; i++) {
+		const HeapAllocation *alloc = &_allocs[_sort_buffer[i]];
+
+		total += alloc->size;
+		cbprintf(
+			sink, arg, "heap: %08x %08x %8d %s\n",
+			(uint32_t) alloc->ptr, (uint32_t) alloc->caller, alloc->size,
+			alloc->tag ? alloc->tag : "-"
+		);
+	}
+
+	cbprintf(sink, arg, "heap: %d bytes total", total);
+	if (_untracked_count)
+		cbprintf(sink, arg, ", %d untracked allocations", _untracked_count);
+
+	cbprintf(sink, arg, "\n");
+}
+
+#else
+
+/* Public API (debug heap disabled) */
+
+const char *SetHeapTag(const char *tag) {
+	return 0;
+}
+
+int CheckHeap(void) {
+	return 0;
+}
+
+int GetHeapAllocations(HeapAllocation *allocs, int max_count) {
+	return -1;
+}
+
+void DumpHeapAllocations(printf_sink_t sink, void *arg) {}
+
+#endif
@@ -11,6 +11,10 @@
  * override malloc()/realloc()/free() while using the default heap manager.
  * Custom allocators should call TrackHeapUsage() to let the heap manager know
  * how much memory is allocated at a given time.
+ *
+ * If libpsn00b is configured with PSN00BSDK_LIBC_DEBUG_HEAP enabled, the
+ * allocator functions are renamed and wrapped by the debug layer in
+ * heapdebug.c. Heap usage then includes the debug layer's overhead.
  */
 
 #include <stddef.h>
@@ -19,6 +23,18 @@
 
 #define _align(x, n) (((x) + ((n) - 1)) & ~((n) - 1))
 
+#ifdef DEBUG_HEAP
+#define malloc	_heap_malloc
+#define calloc	_heap_calloc
+#define realloc	_heap_realloc
+#define free	_heap_free
+
+void *_heap_malloc(size_t size);
+void *_heap_calloc(size_t num, size_t size);
+void *_heap_realloc(void *ptr, size_t size);
+void _heap_free(void *ptr);
+#endif
+
 /* Private types */
 
 typedef struct _BlockHeader {
@@ -120,7 +136,7 @@ __attribute__((weak)) void *malloc(size_t size) {
 		_alloc_head = new;
 		_alloc_tail = new;
 
-		TrackHeapUsage(size);
+		TrackHeapUsage(new->size);
 		return ptr;
 	}
 
@@ -139,7 +155,7 @@ __attribute__((weak)) void *malloc(size_t size) {
 		_alloc_head->prev = new;
 		_alloc_head       = new;
 
-		TrackHeapUsage(size);
+		TrackHeapUsage(new->size);
 		return ptr;
 	}
 
@@ -157,7 +173,7 @@ __attribute__((weak)) void *malloc(size_t size) {
 		(new->next)->prev = new;
 		prev->next        = new;
 
-		TrackHeapUsage(size);
+		TrackHeapUsage(new->size);
 		return ptr;
 	}
 
@@ -175,7 +191,7 @@ __attribute__((weak)) void *malloc(size_t size) {
 	_alloc_tail->next = new;
 	_alloc_tail       = new;
 
-	TrackHeapUsage(size);
+	TrackHeapUsage(new->size);
 	return ptr;
 }
 
@@ -196,7 +212,7 @@ __attribute__((weak)) void *realloc(void *ptr, size_t size) {
 
 	// New memory block shorter?
 	if (prev->size >= _size) {
-		TrackHeapUsage(size - prev->size);
+		TrackHeapUsage(_size - prev->size);
 		prev->size = _size;
 
 		if (!prev->next)
@@ -211,14 +227,14 @@ __attribute__((weak)) void *realloc(void *ptr, size_t size) {
 		if (!new)
 			return 0;
 
-		TrackHeapUsage(size - prev->size);
+		TrackHeapUsage(_size - prev->size);
 		prev->size = _size;
 		return ptr;
 	}
 
 	// Do we have free memory after it?
 	if (((prev->next)->ptr - ptr) > _size) {
-		TrackHeapUsage(size - prev->size);
+		TrackHeapUsage(_size - prev->size);
 		prev->size = _size;
 		return ptr;
 	}
@@ -239,9 +255,10 @@ __attribute__((weak)) void free(void *ptr) {
 
 	// First block; bumping head ahead.
 	if (ptr == _alloc_head->ptr) {
-		size_t size = _alloc_head->size;
-		size       += (uintptr_t) _alloc_head->ptr - (uintptr_t) _alloc_head;
-		_alloc_head = _alloc_head->next;
+		size_t alloc_size = _alloc_head->size;
+		size_t size       = alloc_size;
+		size             += (uintptr_t) _alloc_head->ptr - (uintptr_t) _alloc_head;
+		_alloc_head       = _alloc_head->next;
 
 		if (_alloc_head) {
 			_alloc_head->prev = 0;
@@ -250,7 +267,7 @@ __attribute__((weak)) void free(void *ptr) {
 			sbrk(-size);
 		}
 
-		TrackHeapUsage(-(_alloc_head->size));
+		TrackHeapUsage(-alloc_size);
 		return;
 	}
 
@@ -0,0 +1,86 @@
+# PSn00bSDK optimized memchr
+# (C) 2022 PSn00bSDK contributors - MPL licensed
+
+.set noreorder
+
+.section .text.memchr
+.global memchr
+.type memchr, @function
+memchr:
+	blez  $a2, .Lnot_found
+	andi  $a1, 0xff
+
+	# Check the first 0-3 bytes one at a time until the pointer is aligned.
+.Lalign_loop:
+	andi  $t0, $a0, 3
+	beqz  $t0, .Lword_setup
+	nop
+
+	lbu   $t0, 0($a0)
+	addiu $a2, -1
+	beq   $t0, $a1, .Lfound
+	nop
+	bnez  $a2, .Lalign_loop
+	addiu $a0, 1
+
+	jr    $ra
+	move  $v0, $0
+
+.Lword_setup:
+	sll   $t1, $a1, 8 # mask = ch | (ch << 8) | (ch << 16) | (ch << 24)
+	or    $t1, $a1
+	sll   $t0, $t1, 16
+	or    $t1, $t0
+	lui   $t8, 0x0101 # ones = 0x01010101
+	ori   $t8, 0x0101
+	sll   $t9, $t8, 7 # highs = 0x80808080
+
+	# Split the remaining length into a number of whole words and 0-3 trailing
+	# bytes.
+	srl   $t3, $a2, 2
+	beqz  $t3, .Lbyte_loop
+	andi  $a2, 3
+
+.Lword_loop:
+	# Read 4 bytes at a time and XOR them with the mask, so that any matching
+	# byte becomes zero, until a word containing a match is found. A word has
+	# a zero byte if ((word - ones) & ~word & highs) is nonzero.
+	lw    $t0, 0($a0)
+	addiu $t3, -1
+	xor   $t0, $t1
+	subu  $t2, $t0, $t8
+	nor   $t0, $t0, $0
+	and   $t2, $t0
+	and   $t2, $t9
+	bnez  $t2, .Lword_found
+	addiu $a0, 4
+	bnez  $t3, .Lword_loop
+	nop
+
+	b     .Lbyte_loop
+	nop
+
+.Lword_found:
+	# Go back to the beginning of the word and find the matching byte within
+	# it.
+	addiu $a0, -4
+	li    $a2, 4
+
+.Lbyte_loop:
+	blez  $a2, .Lnot_found
+	nop
+
+	lbu   $t0, 0($a0)
+	addiu $a2, -1
+	beq   $t0, $a1, .Lfound
+	nop
+	b     .Lbyte_loop
+	addiu $a0, 1
+
+.Lfound:
+	jr    $ra
+	move  $v0, $a0
+
+.Lnot_found:
+	jr    $ra
+	move  $v0, $0
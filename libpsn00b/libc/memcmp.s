@@ -1,31 +1,99 @@
-# High speed ASM memcmp implementation by Lameguy64
+# PSn00bSDK optimized memcmp
+# (C) 2022 PSn00bSDK contributors - MPL licensed
+# Replaces the original high speed ASM memcmp implementation by Lameguy64
 #
-# Part of PSn00bSDK
+# Compares 4 bytes at a time once the first buffer's pointer is aligned. The
+# second buffer is read using lwl/lwr if it is not aligned as well. When two
+# words differ, the pointers are rewound and the differing byte is located
+# using the byte loop, so the result is the same as comparing one byte at a
+# time (the difference between the first mismatching bytes, as unsigned
+# chars).
 
 .set noreorder
 
-.section .text
-
-# Arguments:
-#	a0 - buffer 1 address
-#	a1 - buffer 2 address
-#	a2 - bytes to compare
+.section .text.memcmp
 .global memcmp
 .type memcmp, @function
 memcmp:
-	blez	$a2, .Lexit
-	addi	$a2, -1
-	lbu		$v0, 0($a0)
-	lbu		$v1, 0($a1)
-	addiu	$a0, 1
-	bne		$v0, $v1, .Lmismatch
-	addiu	$a1, 1
-	b		memcmp
+	# Skip the word loops entirely for short buffers, as there is no gain.
+	blez  $a2, .Lequal
+	sltiu $t0, $a2, 8
+	bnez  $t0, .Lbyte_loop
+	negu  $t0, $a0
+
+	# Compare the first 0-3 bytes one at a time until the first pointer is
+	# aligned.
+	andi  $t0, 3
+	beqz  $t0, .Lword_setup
+	subu  $a2, $t0
+
+.Lalign_loop:
+	lbu   $t1, 0($a0)
+	lbu   $t2, 0($a1)
+	addiu $t0, -1
+	bne   $t1, $t2, .Lmismatch
+	addiu $a0, 1
+	bnez  $t0, .Lalign_loop
+	addiu $a1, 1
+
+.Lword_setup:
+	# Split the remaining length into a number of whole words (at least one,
+	# as the length was 8 or more) and 0-3 trailing bytes.
+	andi  $t0, $a2, 3
+	subu  $t3, $a2, $t0
+	addu  $t3, $a0 # end = a0 + (length & ~3)
+	andi  $t1, $a1, 3
+	bnez  $t1, .Lunaligned_loop
+	move  $a2, $t0
+
+.Laligned_loop:
+	lw    $t1, 0($a0)
+	lw    $t2, 0($a1)
+	addiu $a0, 4
+	bne   $t1, $t2, .Lword_mismatch
+	addiu $a1, 4
+	bne   $a0, $t3, .Laligned_loop
+	nop
+
+	b     .Lbyte_check
+	nop
+
+.Lunaligned_loop:
+	lwr   $t2, 0($a1)
+	lwl   $t2, 3($a1)
+	lw    $t1, 0($a0)
+	addiu $a0, 4
+	bne   $t1, $t2, .Lword_mismatch
+	addiu $a1, 4
+	bne   $a0, $t3, .Lunaligned_loop
 	nop
+
+	b     .Lbyte_check
+	nop
+
+.Lword_mismatch:
+	# Go back to the beginning of the mismatching word and find the first
+	# differing byte within it.
+	addiu $a0, -4
+	addiu $a1, -4
+	li    $a2, 4
+
+.Lbyte_loop:
+	lbu   $t1, 0($a0)
+	lbu   $t2, 0($a1)
+	addiu $a2, -1
+	bne   $t1, $t2, .Lmismatch
+	addiu $a0, 1
+	addiu $a1, 1
+
+.Lbyte_check:
+	bnez  $a2, .Lbyte_loop
+	nop
+
+.Lequal:
+	jr    $ra
+	move  $v0, $0
+
 .Lmismatch:
-	jr		$ra
-	sub		$v0, $v1
-.Lexit:
-	jr		$ra
-	move	$v0, $0
-	
\ No newline at end of file
+	jr    $ra
+	subu  $v0, $t1, $t2
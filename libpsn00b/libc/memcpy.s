@@ -4,7 +4,7 @@
 
 .set noreorder
 
-.section .text
+.section .text.memcpy
 
 # Arguments: 
 #	a0 - destination address
@@ -1,6 +1,6 @@
 .set noreorder
 
-.section .text
+.section .text.memmove
 
 # Arguments
 #	a0 - destination address
@@ -0,0 +1,40 @@
+# PSn00bSDK optimized 64-bit multiplication
+# (C) 2022 PSn00bSDK contributors - MPL licensed
+#
+# Replaces libgcc's __muldi3, which is written in C and performs four 32x32-bit
+# multiplications. Only the low 64 bits of the product are returned, so the
+# product of the upper halves can be skipped entirely and the cross products
+# only need their low 32 bits. If both operands fit into 32 bits, a single
+# multiplication is performed.
+
+.set noreorder
+
+.section .text.__muldi3
+.global __muldi3
+.type __muldi3, @function
+__muldi3:
+	or    $t0, $a1, $a3
+	bnez  $t0, .Lfull
+	nop
+
+	multu $a0, $a2
+	mflo  $v0
+	jr    $ra
+	mfhi  $v1
+
+.Lfull:
+	# Note that the R3000 requires at least two instructions between a mflo or
+	# mfhi and the next multiplication.
+	multu $a0, $a3 # cross = (a.lo * b.hi) + (a.hi * b.lo)
+	mflo  $t0
+	nop
+	nop
+	multu $a1, $a2
+	mflo  $t1
+	addu  $t0, $t1
+	nop
+	multu $a0, $a2 # result = (a.lo * b.lo) + (cross << 32)
+	mflo  $v0
+	mfhi  $v1
+	jr    $ra
+	addu  $v1, $t0
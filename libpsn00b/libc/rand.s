@@ -1,9 +1,7 @@
 .set noreorder
 .set noat
 
-.section .text
-
-
+.section .text.rand
 .global rand
 .type rand, @function
 rand:
@@ -22,6 +20,7 @@ rand:
 	andi	$v0, 0x7fff
 	
 
+.section .text.srand
 .global srand
 .type srand, @function
 srand:
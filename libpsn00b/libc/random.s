@@ -0,0 +1,171 @@
+# PSn00bSDK optimized pseudo-random number generator fill functions
+# (C) 2022 PSn00bSDK contributors - MPL licensed
+#
+# These functions generate the same sequences as the inline functions in
+# random.h. The generator's state is kept in registers for the entire loop and
+# only written back at the end. Multiplications are issued as early as possible
+# so that the generator's state update can be computed while the R3000's
+# multiplier is busy.
+
+.set noreorder
+
+# Advances a xorshift32 state stored in a register.
+.macro XORSHIFT32 state, tmp
+	sll   \tmp, \state, 13
+	xor   \state, \tmp
+	srl   \tmp, \state, 17
+	xor   \state, \tmp
+	sll   \tmp, \state, 5
+	xor   \state, \tmp
+.endm
+
+## Xorshift32
+
+.section .text.xorshift32_fill
+.global xorshift32_fill
+.type xorshift32_fill, @function
+xorshift32_fill:
+	lw    $v0, 0($a0)
+	srl   $t1, $a2, 2 # blocks = count / 4
+	beqz  $t1, .Lxs_fill_tail
+	andi  $a2, 3 # count %= 4
+
+	# Generate 4 values per iteration.
+.Lxs_fill_loop:
+	XORSHIFT32 $v0, $t0
+	sw    $v0, 0($a1)
+	XORSHIFT32 $v0, $t0
+	sw    $v0, 4($a1)
+	XORSHIFT32 $v0, $t0
+	sw    $v0, 8($a1)
+	XORSHIFT32 $v0, $t0
+	addiu $t1, -1
+	sw    $v0, 12($a1)
+	bnez  $t1, .Lxs_fill_loop
+	addiu $a1, 16
+
+.Lxs_fill_tail:
+	beqz  $a2, .Lxs_fill_done
+	nop
+
+.Lxs_fill_tail_loop:
+	XORSHIFT32 $v0, $t0
+	addiu $a2, -1
+	sw    $v0, 0($a1)
+	bnez  $a2, .Lxs_fill_tail_loop
+	addiu $a1, 4
+
+.Lxs_fill_done:
+	jr    $ra
+	sw    $v0, 0($a0)
+
+.section .text.xorshift32_fill_range
+.global xorshift32_fill_range
+.type xorshift32_fill_range, @function
+xorshift32_fill_range:
+	lw    $v0, 0($a0)
+	beqz  $a2, .Lxs_range_return
+	nop
+
+	XORSHIFT32 $v0, $t0
+
+.Lxs_range_loop:
+	# Compute the next value while the current one is being multiplied by the
+	# range. The state is saved beforehand as the next value might not be
+	# used.
+	multu $v0, $a3 # output = (value * range) >> 32
+	move  $v1, $v0
+	XORSHIFT32 $v0, $t0
+	addiu $a2, -1
+	mfhi  $t1
+	sw    $t1, 0($a1)
+	bnez  $a2, .Lxs_range_loop
+	addiu $a1, 4
+
+	sw    $v1, 0($a0)
+
+.Lxs_range_return:
+	jr    $ra
+	nop
+
+## Xoroshiro64*
+
+.section .text.xoroshiro64_fill
+.global xoroshiro64_fill
+.type xoroshiro64_fill, @function
+xoroshiro64_fill:
+	lw    $t0, 0($a0) # s0
+	lw    $t1, 4($a0) # s1
+	beqz  $a2, .Lxr_fill_return
+	lui   $t2, 0x9e37
+	ori   $t2, 0x79bb
+
+.Lxr_fill_loop:
+	multu $t0, $t2 # output = s0 * 0x9e3779bb
+
+	xor   $t1, $t0 # s1 ^= s0
+	sll   $t3, $t0, 26 # s0 = rotl(s0, 26) ^ s1 ^ (s1 << 9)
+	srl   $t4, $t0, 6
+	or    $t3, $t4
+	xor   $t3, $t1
+	sll   $t4, $t1, 9
+	xor   $t0, $t3, $t4
+	sll   $t3, $t1, 13 # s1 = rotl(s1, 13)
+	srl   $t4, $t1, 19
+	or    $t1, $t3, $t4
+
+	addiu $a2, -1
+	mflo  $t5
+	sw    $t5, 0($a1)
+	bnez  $a2, .Lxr_fill_loop
+	addiu $a1, 4
+
+	sw    $t0, 0($a0)
+	sw    $t1, 4($a0)
+
+.Lxr_fill_return:
+	jr    $ra
+	nop
+
+.section .text.xoroshiro64_fill_range
+.global xoroshiro64_fill_range
+.type xoroshiro64_fill_range, @function
+xoroshiro64_fill_range:
+	lw    $t0, 0($a0) # s0
+	lw    $t1, 4($a0) # s1
+	beqz  $a2, .Lxr_range_return
+	lui   $t2, 0x9e37
+	ori   $t2, 0x79bb
+
+.Lxr_range_loop:
+	# The state update is split in two halves, each of which is computed
+	# while one of the two multiplications is in progress.
+	multu $t0, $t2 # value = s0 * 0x9e3779bb
+
+	xor   $t1, $t0 # s1 ^= s0
+	sll   $t3, $t0, 26 # s0 = rotl(s0, 26) ^ s1 ^ (s1 << 9)
+	srl   $t4, $t0, 6
+	or    $t3, $t4
+	xor   $t3, $t1
+
+	mflo  $t5
+	sll   $t4, $t1, 9
+	xor   $t0, $t3, $t4
+	multu $t5, $a3 # output = (value * range) >> 32
+
+	sll   $t3, $t1, 13 # s1 = rotl(s1, 13)
+	srl   $t4, $t1, 19
+	or    $t1, $t3, $t4
+
+	addiu $a2, -1
+	mfhi  $t5
+	sw    $t5, 0($a1)
+	bnez  $a2, .Lxr_range_loop
+	addiu $a1, 4
+
+	sw    $t0, 0($a0)
+	sw    $t1, 4($a0)
+
+.Lxr_range_return:
+	jr    $ra
+	nop
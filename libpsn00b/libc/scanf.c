@@ -1,432 +1,380 @@
-// vsscanf
-// Programmed by Giuseppe Gatta, 2011
-// Inherited from PSXSDK C library
-
-#include <stdio.h>
+/*
+ * PSn00bSDK scanf implementation
+ * (C) 2022 PSn00bSDK contributors - MPL licensed
+ * Based on the vsscanf implementation programmed by Giuseppe Gatta (2011),
+ * inherited from the PSXSDK C library
+ *
+ * vsscanf() parses values directly from the input string instead of copying
+ * each field into a temporary buffer first, and no global state is used, so
+ * all functions are reentrant. Integer conversions go through the same
+ * _parse_integer() function used by strtol() (see strtol.c), which avoids
+ * 64-bit arithmetic unless the value being parsed does not fit into 32 bits.
+ *
+ * Floating-point conversions (%f, %e, %g) are only built if libpsn00b is
+ * configured with PSN00BSDK_LIBC_FLOAT enabled, which defines ALLOW_FLOAT.
+ * Formats without them never call into software float code.
+ */
+
+#include <stdint.h>
 #include <stdarg.h>
+#include <stdio.h>
 #include <stdlib.h>
-#include <string.h>
-#include <strings.h>
 
-// Uncomment to enable support for %f.
-//#define ALLOW_FLOAT
+#define FIELD_WIDTH_ANY	UINT32_MAX
+#define FLOAT_BUFFER	64
+
+typedef enum {
+	SIZE_CHAR,
+	SIZE_SHORT,
+	SIZE_INT,
+	SIZE_LONG,
+	SIZE_LONG_LONG
+} ArgSize;
+
+// Defined in strtol.c
+const char *_parse_integer(
+	const char *str,
+	uint32_t   max_length,
+	int        base,
+	uint64_t   *value,
+	int        *negative
+);
+
+/* Helpers */
+
+static inline int _is_space(int c) {
+	return (c == ' ') || ((uint32_t) (c - '\t') < 5);
+}
 
-char libc_vsscanf_buf[512];
-char libc_vsscanf_allow[256];
+static void _store_integer(void *ptr, ArgSize size, uint64_t value) {
+	switch (size) {
+		case SIZE_CHAR:
+			*((uint8_t *) ptr) = (uint8_t) value;
+			break;
 
-enum
-{
-	elem_skip_space = 1,
-};
+		case SIZE_SHORT:
+			*((uint16_t *) ptr) = (uint16_t) value;
+			break;
 
-int libc_vsscanf_get_element(char *dst, const char *src, int flag, int s)
-{
-	int i;
-	const char *osrc = src;
+		case SIZE_INT:
+		case SIZE_LONG:
+			*((uint32_t *) ptr) = (uint32_t) value;
+			break;
 
-	if(flag & elem_skip_space)
-	{
-		while(*src == ' ')
-			src++;
+		case SIZE_LONG_LONG:
+			*((uint64_t *) ptr) = value;
+			break;
 	}
+}
 
-	for(i=0;i<s;i++)
-	{
-		if((flag & elem_skip_space) && *src == ' ')
-			break;
+// Parses a %[ scanset into a 256-bit map and returns a pointer to its closing
+// bracket, or NULL if the format string ends before it.
+static const char *_parse_scanset(const char *format, uint32_t *set) {
+	int invert = (*format == '^');
+	if (invert)
+		format++;
 
-		if(*src != 0)
-			*(dst++) = *(src++);
-		else
-			break;
+	for (int i = 0; i < 8; i++)
+		set[i] = 0;
+
+	// A closing bracket right after the opening one (or the caret) is part of
+	// the set rather than the end of it.
+	const char *start = format;
+
+	for (; *format && ((*format != ']') || (format == start)); format++) {
+		uint8_t first = *format, last = first;
+
+		if ((format[1] == '-') && format[2] && (format[2] != ']')) {
+			last    = format[2];
+			format += 2;
+		}
+
+		for (uint32_t c = first; c <= last; c++)
+			set[c / 32] |= 1U << (c % 32);
 	}
 
-	*dst = 0;
+	if (!*format)
+		return 0;
+
+	if (invert) {
+		for (int i = 0; i < 8; i++)
+			set[i] = ~set[i];
+	}
 
-	return src - osrc;
+	// Never match the null terminator, even if the set is inverted.
+	set[0] &= ~1;
+	return format;
 }
 
-enum
-{
-	scanf_s_char, scanf_s_short, scanf_s_int,
-	scanf_s_long,
-	scanf_s_long_long
-};
-
-int vsscanf(const char *str, const char *format, va_list ap)
-{
-	int fp = 0;
-	int sp = 0;
-	int conv = 0;
-	int sz = scanf_s_int; // size for numbers defaults to 32-bit
-	int i,x,y,z, h;
-	int suppress = 0;
-	int neg = 0;
-	int fsz = 512;
-	int def_fsz = 1;
-	int exspace = 0;
-	int alt = 0;
-	int r = 0;
-	int exit_loop=0;
-	int sp2,sp3;
-	char *ep;
-	long long buf;
-	double fbuf;
-
-
-	while(format[fp] && str[sp] && !exit_loop)
-	{
-		if(conv)
-		{
-			switch(format[fp])
-			{
-				case '%': // Percent, assignment does not occur
-					conv = 0;
-				break;
-				
-				case 'h': // Halve size
-					sz--;
-				break;
+/* Main scanf code */
 
-				case 'l': // Double size
-					sz++;
-				break;
+int vsscanf(const char *str, const char *format, va_list ap) {
+	const char *start = str;
+	int        count  = 0;
 
-				case '*': // Suppress
-					suppress = 1;
-				break;
+	for (; *format; format++) {
+		char c = *format;
 
-				case ' ': // Explicit space
-					exspace = 1;
-				break;
+		// Any whitespace in the format string matches any amount of
+		// whitespace in the input, including none.
+		if (_is_space(c)) {
+			while (_is_space(*str))
+				str++;
 
-				case '#': // Alternate format
-					alt = 1;
+			continue;
+		}
+
+		if (c != '%') {
+			if (*str != c)
 				break;
 
-				case '0' ... '9': // '0' ... '9' is a GNU C extension!
-					if(def_fsz)
-					{
-						def_fsz = 0;
-						fsz = 0;
-					}
+			str++;
+			continue;
+		}
 
-					fsz *= 10;
-					fsz+=format[fp]-'0';
+		c = *(++format);
 
-					if(fsz > 512)
-						fsz = 512; // 512 is the maximum.
-				break;
-				
-				case '@': // Binary. Non-standard extension
-					libc_vsscanf_get_element(libc_vsscanf_buf, &str[sp], elem_skip_space, fsz);
-					buf = strtoll(libc_vsscanf_buf, &ep, 2);
-					sp += ep - libc_vsscanf_buf;
-
-					if(!suppress)
-					{
-						switch(sz)
-						{
-							case scanf_s_char: *(va_arg(ap, signed char*)) = (signed char)buf;break;
-							case scanf_s_short: *(va_arg(ap, short*)) = (short)buf; break;
-							case scanf_s_int: *(va_arg(ap, int*)) = (int)buf; break;
-							case scanf_s_long: *(va_arg(ap, long*)) = (long)buf; break;
-							case scanf_s_long_long: *(va_arg(ap, long long*)) = buf; break;
-						}
-						r++;
-					}
-
-					conv = 0;
-				break;
+		int      suppress = (c == '*');
+		uint32_t width    = 0;
+		ArgSize  size     = SIZE_INT;
 
-				case 'D':
-					sz++;
-				case 'd': // Decimal
-				case 'u':
-					libc_vsscanf_get_element(libc_vsscanf_buf, &str[sp], elem_skip_space, fsz);
-					buf = strtoll(libc_vsscanf_buf, &ep, 10);
-					sp += ep - libc_vsscanf_buf;
-
-					if(!suppress)
-					{
-						switch(sz)
-						{
-							case scanf_s_char: *(va_arg(ap, signed char*)) = (signed char)buf;break;
-							case scanf_s_short: *(va_arg(ap, short*)) = (short)buf; break;
-							case scanf_s_int: *(va_arg(ap, int*)) = (int)buf; break;
-							case scanf_s_long: *(va_arg(ap, long*)) = (long)buf; break;
-							case scanf_s_long_long: *(va_arg(ap, long long*)) = buf; break;
-						}
-						r++;
-					}
-
-					conv = 0;
-				break;
+		if (suppress)
+			c = *(++format);
+
+		for (; (c >= '0') && (c <= '9'); c = *(++format))
+			width = width * 10 + (c - '0');
+
+		if (!width)
+			width = FIELD_WIDTH_ANY;
 
-				case 's': // String
-					sp += libc_vsscanf_get_element(libc_vsscanf_buf, &str[sp], elem_skip_space, fsz);
+		switch (c) {
+			case 'h':
+				size = SIZE_SHORT;
+				c    = *(++format);
 
-					if(!suppress)
-					{
-						strcpy(va_arg(ap, char*), libc_vsscanf_buf);
-						r++;
-					}
-					
-					conv = 0;
+				if (c == 'h') {
+					size = SIZE_CHAR;
+					c    = *(++format);
+				}
 				break;
 
-				case 'c': 
-					if(def_fsz)
-						fsz = 1;
+			case 'l':
+				size = SIZE_LONG;
+				c    = *(++format);
 
-					sp += (i = libc_vsscanf_get_element(libc_vsscanf_buf, &str[sp], (exspace ? elem_skip_space : 0), fsz));
-					if(!suppress)
-					{
-						memcpy(va_arg(ap, char*), libc_vsscanf_buf, (fsz>i)?i:fsz);
-						r++;
-					}
+				if (c == 'l') {
+					size = SIZE_LONG_LONG;
+					c    = *(++format);
+				}
 				break;
 
-				case 'n':
-					if(!suppress)
-					{
-						*(va_arg(ap, int*)) = sp;
-						r++;
-					}
+			case 'L': // Also accepted for integers, same as ll
+			case 'q':
+			case 'j':
+				size = SIZE_LONG_LONG;
+				c    = *(++format);
 				break;
 
-				case 'p':
-				case 'x':
-				case 'X':
-					libc_vsscanf_get_element(libc_vsscanf_buf, &str[sp], elem_skip_space, fsz);
-					buf = strtoll(libc_vsscanf_buf, &ep, 16);
-					sp += ep - libc_vsscanf_buf;
-
-					if(!suppress)
-					{
-						switch(sz)
-						{
-							case scanf_s_char: *(va_arg(ap, unsigned char*)) = (unsigned char)buf; break;
-							case scanf_s_short:	*(va_arg(ap, unsigned short*)) = (unsigned short)buf;	break;
-							case scanf_s_int: *(va_arg(ap, unsigned int*)) = (unsigned int)buf; break;
-							case scanf_s_long: *(va_arg(ap, unsigned long*)) = (unsigned long)buf; break;
-							case scanf_s_long_long:	*(va_arg(ap, unsigned long long*)) = (unsigned long long)buf; break;
-						}
-						r++;
-					}
-
-					conv = 0;
+			case 'z':
+			case 't':
+				c = *(++format);
 				break;
+		}
+
+		if (!c)
+			break;
+
+		// All conversions except %c, %[ and %n skip leading whitespace. Running
+		// out of input at this point is an input failure rather than a
+		// matching failure, which must be reported as EOF if no conversion was
+		// performed yet.
+		if ((c != 'c') && (c != '[') && (c != 'n')) {
+			while (_is_space(*str))
+				str++;
+		}
+		if (!*str && (c != 'n'))
+			return count ? count : EOF;
+
+		int base;
+
+		switch (c) {
+			case '%':
+				if (*str != '%')
+					return count;
+
+				str++;
+				continue;
+
+			case 'n':
+				if (!suppress)
+					_store_integer(va_arg(ap, void *), size, str - start);
 
-				case 'O':
-					sz++;
-				case 'o': // Octal integer
-					libc_vsscanf_get_element(libc_vsscanf_buf, &str[sp], elem_skip_space, fsz);
-					buf = strtoll(libc_vsscanf_buf, &ep, 8);
-					sp += ep - libc_vsscanf_buf;
-
-					if(!suppress)
-					{
-						switch(sz)
-						{
-							case scanf_s_char: *(va_arg(ap, unsigned char*)) = (unsigned char)buf;break;
-							case scanf_s_short: *(va_arg(ap, unsigned short*)) = (unsigned short)buf; break;
-							case scanf_s_int: *(va_arg(ap, unsigned int*)) = (unsigned int)buf;break;
-							case scanf_s_long: *(va_arg(ap, unsigned long*)) = (unsigned long)buf; break;
-							case scanf_s_long_long: *(va_arg(ap, unsigned long long*)) = (unsigned long long)buf;break;
-						}
-						r++;
-					}
-
-					conv = 0;
+				continue;
+
+			case 'D':
+				size = SIZE_LONG;
+				// Fall through
+			case 'd':
+			case 'u':
+				base = 10;
 				break;
 
-				case 'i':
-					libc_vsscanf_get_element(libc_vsscanf_buf, &str[sp], elem_skip_space, fsz);
+			case 'i':
+				base = 0;
+				break;
 
-					if(libc_vsscanf_buf[0] == '0')
-					{
-						if(libc_vsscanf_buf[1] == 'x' || libc_vsscanf_buf[1] == 'X')
-							i = 16;
-						else
-							i = 8;
-					}
-					else
-						i = 10;
-
-					buf = strtoll(libc_vsscanf_buf, &ep, i);
-					sp += ep - libc_vsscanf_buf;
-
-					if(!suppress)
-					{
-						switch(sz)
-						{
-							case scanf_s_char: *(va_arg(ap, signed char*)) = (signed char)buf; break;
-							case scanf_s_short: *(va_arg(ap, short*)) = (short)buf; break;
-							case scanf_s_int: *(va_arg(ap,  int*)) = (int)buf; break;
-							case scanf_s_long: *(va_arg(ap, long*)) = (long)buf; break;
-							case scanf_s_long_long: *(va_arg(ap, long long*)) = (long long)buf; break;
-						}
-						r++;
-					}
-
-					conv = 0;
+			case 'O':
+				size = SIZE_LONG;
+				// Fall through
+			case 'o':
+				base = 8;
 				break;
 
-				case '[':
-					i=0;
-					x=0; // Exclusion?
-					h=0; // Hyphen?
-
-					fp++;
-					i++;
-
-					while(format[fp])
-					{
-						if(format[fp] == '^' && i==1)
-						{
-							memset(libc_vsscanf_allow, 1, 256);
-							x = 1;
-							fp++; i++; continue;
-						}
-
-						if(x)
-						{
-							if(format[fp] == ']' && i>=3)
-								break;
-						}
-						else
-						{
-							if(format[fp] == ']' && i>=2)
-								break;
-						}
-
-						if(format[fp] == '-')
-						{
-							if(format[fp+1] != ']')
-								y = 1;
-							else
-								libc_vsscanf_allow['-'] = x^1;
-						}
-						else
-						{
-							if(y == 1)
-							{
-								if(format[fp] < format[fp-2])
-									libc_vsscanf_allow[format[fp]] = x^1;
-								else
-									for(z = format[fp-2]; z <= format[fp]; z++)
-										libc_vsscanf_allow[z] = x^1;
-									
-								y = 0;
-
-								//printf("%s all chars from %c to %c\n", x?"Excluding":"Including",format[fp-2], format[fp]);
-							}
-							else
-								libc_vsscanf_allow[format[fp]] = x^1;
-						}
-
-						fp++;
-						i++;
-					}
-
-// Now as we know what our character set is, let's get data from the string
-	/*				puts("Character set:");
-
-					for(y=0;y<16;y++)
-					{
-						for(x=0;x<16;x++)
-							if(libc_vsscanf_allow[(y*16) + x])
-								putchar((y*16)+x);
-							else
-								putchar('*');
-				
-						putchar('\n');
-					}
-        */
-					i = 0;
-
-					while(libc_vsscanf_allow[str[sp]] && i<512)
-						libc_vsscanf_buf[i++] = str[sp++];
-					
-					libc_vsscanf_buf[i] = 0;
-
-					if(!suppress)
-					{
-						strcpy(va_arg(ap, char*), libc_vsscanf_buf);
-						r++;
-					}
+			case 'p':
+			case 'x':
+			case 'X':
+				base = 16;
 				break;
 
-#ifdef ALLOW_FLOAT
-				case 'f': // Floating point number
-					libc_vsscanf_get_element(libc_vsscanf_buf, &str[sp], elem_skip_space, fsz);
-					fbuf = strtod(libc_vsscanf_buf, &ep);
-					sp += ep - libc_vsscanf_buf;
-
-					if(!suppress)
-					{
-						switch(sz)
-						{
-							case scanf_s_char:
-							case scanf_s_short:
-							case scanf_s_int: 
-								*(va_arg(ap, float*)) = (float)fbuf;
-							break;
-
-							case scanf_s_long: 
-							case scanf_s_long_long:
-								*(va_arg(ap, double*)) = fbuf;
-							break;
-						}
-						r++;
-					}
-
-					conv = 0;
+			case '@': // Non-standard extension, parses binary integers
+				base = 2;
 				break;
-#endif
 
+			case 's': {
+				char *dst = suppress ? 0 : va_arg(ap, char *);
+
+				for (; *str && !_is_space(*str) && width; width--, str++) {
+					if (dst)
+						*(dst++) = *str;
+				}
+
+				if (dst) {
+					*dst = 0;
+					count++;
+				}
+				continue;
 			}
-		}
-		else
-		{
-			if(format[fp] == '%')
-			{
-				conv = 1;
-				neg = 0;
-				suppress = 0;
-				sz = scanf_s_int;
-				fsz = 512;
-				def_fsz = 1;
-				exspace = 0;
-				alt = 0;
-				bzero(libc_vsscanf_allow, 256);
-				//chset = 0;
+
+			case 'c': {
+				char *dst = suppress ? 0 : va_arg(ap, char *);
+
+				if (width == FIELD_WIDTH_ANY)
+					width = 1;
+
+				for (; width; width--, str++) {
+					if (!*str)
+						return count ? count : EOF;
+					if (dst)
+						*(dst++) = *str;
+				}
+
+				if (dst)
+					count++;
+				continue;
 			}
-			else if(format[fp] != ' ')
-			{
-				if(format[fp] != str[sp])
-					exit_loop=1;
 
-				sp++;
+			case '[': {
+				uint32_t set[8];
+
+				format = _parse_scanset(format + 1, set);
+				if (!format)
+					return count;
+
+				char       *dst = suppress ? 0 : va_arg(ap, char *);
+				const char *ptr = str;
+
+				for (; width; width--, ptr++) {
+					uint8_t ch = *ptr;
+
+					if (!(set[ch / 32] & (1U << (ch % 32))))
+						break;
+					if (dst)
+						*(dst++) = ch;
+				}
+
+				if (ptr == str)
+					return count;
+
+				str = ptr;
+				if (dst) {
+					*dst = 0;
+					count++;
+				}
+				continue;
 			}
 
+#ifdef ALLOW_FLOAT
+			case 'a':
+			case 'A':
+			case 'e':
+			case 'E':
+			case 'f':
+			case 'F':
+			case 'g':
+			case 'G': {
+				// strtod() has no length limit, so the field must be copied
+				// into a buffer if a width was specified.
+				char       buffer[FLOAT_BUFFER];
+				const char *field = str;
+				char       *end;
+
+				if (width < FLOAT_BUFFER) {
+					uint32_t i = 0;
+
+					for (; (i < width) && str[i]; i++)
+						buffer[i] = str[i];
+
+					buffer[i] = 0;
+					field     = buffer;
+				}
+
+				double value = strtod(field, &end);
+				if (end == field)
+					return count;
+
+				str += end - field;
+
+				if (!suppress) {
+					if (size == SIZE_LONG)
+						*va_arg(ap, double *) = value;
+					else if (size == SIZE_LONG_LONG)
+						*va_arg(ap, long double *) = value;
+					else
+						*va_arg(ap, float *) = (float) value;
+
+					count++;
+				}
+				continue;
+			}
+#endif
+
+			default:
+				return count;
 		}
 
-		fp++;
+		// Integer conversion
+		uint64_t value;
+		int      negative;
+
+		str = _parse_integer(str, width, base, &value, &negative);
+		if (!str)
+			return count;
+
+		if (!suppress) {
+			_store_integer(va_arg(ap, void *), size, negative ? -value : value);
+			count++;
+		}
 	}
 
-	return r;
+	return count;
 }
 
-int sscanf(const char *str, const char *fmt, ...)
-{
-	int r;
+int sscanf(const char *str, const char *fmt, ...) {
 	va_list ap;
 
 	va_start(ap, fmt);
-	r = vsscanf(str, fmt, ap);
-
+	int r = vsscanf(str, fmt, ap);
 	va_end(ap);
+
 	return r;
 }
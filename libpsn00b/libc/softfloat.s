@@ -0,0 +1,644 @@
+# PSn00bSDK optimized single-precision soft-float routines
+# (C) 2022 PSn00bSDK contributors - MPL licensed
+#
+# These replace libgcc's generic soft-float implementations of the operations
+# GCC emits calls to for float arithmetic, comparisons and conversions. Results
+# are IEEE 754 compliant (round to nearest even, with full denormal support);
+# NaNs are never propagated as-is, the default MIPS "legacy" quiet NaN is
+# returned instead. Double-precision operations are still provided by libgcc.
+#
+# Internally, finite values are unpacked into a sign ($t0), a biased exponent
+# ($t1) and a 32-bit mantissa ($t2) with the leading 1 in bit 31 and rounding
+# bits in the lower 8 bits, then passed to _sf_round_pack.
+
+.set noreorder
+
+# Shifts a nonzero register left until its MSB is set (binary search, as the
+# R3000 has no count leading zeroes instruction) and subtracts the number of
+# bits shifted from another register.
+.macro NORMALIZE reg, exp, tmp
+	srl   \tmp, \reg, 16
+	bnez  \tmp, 1f
+	sll   \tmp, \reg, 16
+	move  \reg, \tmp
+	addiu \exp, -16
+1:
+	srl   \tmp, \reg, 24
+	bnez  \tmp, 2f
+	sll   \tmp, \reg, 8
+	move  \reg, \tmp
+	addiu \exp, -8
+2:
+	srl   \tmp, \reg, 28
+	bnez  \tmp, 3f
+	sll   \tmp, \reg, 4
+	move  \reg, \tmp
+	addiu \exp, -4
+3:
+	srl   \tmp, \reg, 30
+	bnez  \tmp, 4f
+	sll   \tmp, \reg, 2
+	move  \reg, \tmp
+	addiu \exp, -2
+4:
+	bltz  \reg, 5f
+	sll   \tmp, \reg, 1
+	move  \reg, \tmp
+	addiu \exp, -1
+5:
+.endm
+
+## Rounding and packing
+
+.section .text._sf_round_pack
+.type _sf_round_pack, @function
+_sf_round_pack:
+	# Inputs: $t0 = sign, $t1 = biased exponent, $t2 = normalized mantissa.
+	slti  $t3, $t1, 0xff
+	beqz  $t3, _sf_inf
+	nop
+	blez  $t1, .Ldenormal
+	srl   $t3, $t2, 8
+
+.Lround:
+	# Round to nearest even by adding 0x7f (plus one if the result would be
+	# odd) to the rounding bits and carrying into the mantissa. If the mantissa
+	# overflows into bit 24, adding it to the exponent field will increment the
+	# exponent as expected (and turn the largest finite value into infinity).
+	andi  $t4, $t2, 0xff
+	andi  $t5, $t3, 1
+	addu  $t4, $t5
+	addiu $t4, 0x7f
+	srl   $t4, 8
+	addu  $t3, $t4
+
+	addiu $t1, -1
+	sll   $t1, 23
+	addu  $v0, $t1, $t3
+	jr    $ra
+	or    $v0, $t0
+
+.Ldenormal:
+	# Shift the mantissa right by (1 - exponent) bits and set the exponent to
+	# 1, collapsing any bits shifted out into a sticky bit. The leading 1 ends
+	# up below bit 23 so the exponent field will be 0 after packing, unless
+	# rounding carries into bit 23.
+	li    $t4, 1
+	subu  $t5, $t4, $t1
+	move  $t1, $t4
+	sltiu $t6, $t5, 32
+	beqz  $t6, .Lflush
+	srlv  $t6, $t2, $t5
+	sllv  $t7, $t6, $t5
+	sltu  $t7, $t7, $t2
+	or    $t2, $t6, $t7
+	b     .Lround
+	srl   $t3, $t2, 8
+
+.Lflush:
+	li    $t2, 1
+	b     .Lround
+	move  $t3, $0
+
+.type _sf_inf, @function
+_sf_inf:
+	lui   $v0, 0x7f80
+	jr    $ra
+	or    $v0, $t0
+
+.type _sf_nan, @function
+_sf_nan:
+	lui   $v0, 0x7fbf
+	jr    $ra
+	ori   $v0, 0xffff
+
+## Addition and subtraction
+
+.section .text.__subsf3
+.global __subsf3
+.type __subsf3, @function
+__subsf3:
+	lui   $t9, 0x8000
+	j     __addsf3
+	xor   $a1, $t9
+
+.section .text.__addsf3
+.global __addsf3
+.type __addsf3, @function
+__addsf3:
+	# Swap the operands if needed so that abs(a) >= abs(b). This also ensures
+	# any NaN ends up in a.
+	sll   $t5, $a0, 1
+	sll   $t6, $a1, 1
+	sltu  $t7, $t5, $t6
+	beqz  $t7, .Ladd_sorted
+	lui   $t9, 0x8000
+
+	move  $t7, $a0
+	move  $a0, $a1
+	move  $a1, $t7
+	move  $t7, $t5
+	move  $t5, $t6
+	move  $t6, $t7
+
+.Ladd_sorted:
+	srl   $t1, $t5, 24
+	srl   $t3, $t6, 24
+	li    $t8, 0xff
+	beq   $t1, $t8, .Ladd_special
+	and   $t0, $a0, $t9
+
+	# Unpack the mantissas with the leading 1 in bit 30 (leaving room for a
+	# carry) and 7 guard bits. Denormals have no leading 1 and an exponent of
+	# 1 rather than 0.
+	sll   $t2, $a0, 9
+	srl   $t2, 2
+	sltu  $t7, $0, $t1
+	xori  $t8, $t7, 1
+	addu  $t1, $t8
+	sll   $t7, 30
+	or    $t2, $t7
+
+	sll   $t4, $a1, 9
+	srl   $t4, 2
+	sltu  $t7, $0, $t3
+	xori  $t8, $t7, 1
+	addu  $t3, $t8
+	sll   $t7, 30
+	or    $t4, $t7
+
+	# Align b's mantissa to a's exponent, setting the LSB if any bits were
+	# shifted out. Shifts by 32 or more bits leave only the sticky bit.
+	subu  $t5, $t1, $t3
+	sltiu $t6, $t5, 32
+	beqz  $t6, .Ladd_tiny
+	srlv  $t6, $t4, $t5
+	sllv  $t7, $t6, $t5
+	sltu  $t7, $t7, $t4
+	or    $t4, $t6, $t7
+
+.Ladd_aligned:
+	xor   $t6, $a0, $a1
+	bltz  $t6, .Ladd_subtract
+	addiu $t1, 1
+
+	addu  $t2, $t4
+	beqz  $t2, .Ladd_zero
+	nop
+
+.Ladd_normalize:
+	NORMALIZE $t2, $t1, $t6
+	j     _sf_round_pack
+	nop
+
+.Ladd_subtract:
+	subu  $t2, $t4
+	bnez  $t2, .Ladd_normalize
+	nop
+
+	# x - x is always +0 when rounding to nearest.
+	jr    $ra
+	move  $v0, $0
+
+.Ladd_zero:
+	jr    $ra
+	move  $v0, $t0
+
+.Ladd_tiny:
+	b     .Ladd_aligned
+	sltu  $t4, $0, $t4
+
+.Ladd_special:
+	# a is infinity or NaN (and b may be either as well). inf - inf is NaN,
+	# anything else involving infinities returns the infinity.
+	lui   $t7, 0xff00
+	bne   $t5, $t7, .Ladd_nan
+	xor   $t8, $a0, $a1
+	bne   $t6, $t7, .Ladd_return_a
+	nop
+	bltz  $t8, .Ladd_nan
+	nop
+
+.Ladd_return_a:
+	jr    $ra
+	move  $v0, $a0
+
+.Ladd_nan:
+	j     _sf_nan
+	nop
+
+## Multiplication
+
+.section .text.__mulsf3
+.global __mulsf3
+.type __mulsf3, @function
+__mulsf3:
+	xor   $t0, $a0, $a1
+	lui   $t9, 0x8000
+	and   $t0, $t9
+	srl   $t1, $a0, 23
+	andi  $t1, 0xff
+	srl   $t3, $a1, 23
+	andi  $t3, 0xff
+	li    $t8, 0xff
+	beq   $t1, $t8, .Lmul_special
+	sll   $t2, $a0, 8
+	beq   $t3, $t8, .Lmul_special
+	sll   $t4, $a1, 8
+
+	# Unpack the mantissas with the leading 1 in bit 31, normalizing
+	# denormals. Multiplying them yields a 64-bit product whose upper half has
+	# either bit 31 or 30 set.
+	beqz  $t1, .Lmul_a_denormal
+	nop
+	or    $t2, $t9
+.Lmul_a_done:
+	beqz  $t3, .Lmul_b_denormal
+	nop
+	or    $t4, $t9
+.Lmul_b_done:
+	multu $t2, $t4
+	addu  $t1, $t3
+	addiu $t1, -126
+	mfhi  $t2
+	mflo  $t5
+	bltz  $t2, .Lmul_sticky
+	srl   $t6, $t5, 31
+
+	sll   $t2, 1
+	or    $t2, $t6
+	sll   $t5, 1
+	addiu $t1, -1
+
+.Lmul_sticky:
+	sltu  $t5, $0, $t5
+	j     _sf_round_pack
+	or    $t2, $t5
+
+.Lmul_a_denormal:
+	beqz  $t2, .Lmul_zero
+	li    $t1, 1
+	NORMALIZE $t2, $t1, $t6
+	b     .Lmul_a_done
+	nop
+
+.Lmul_b_denormal:
+	beqz  $t4, .Lmul_zero
+	li    $t3, 1
+	NORMALIZE $t4, $t3, $t6
+	b     .Lmul_b_done
+	nop
+
+.Lmul_zero:
+	jr    $ra
+	move  $v0, $t0
+
+.Lmul_special:
+	# At least one operand is infinity or NaN. NaN * x and inf * 0 are NaN,
+	# inf * x is infinity.
+	sll   $t5, $a0, 1
+	sll   $t6, $a1, 1
+	lui   $t7, 0xff00
+	sltu  $t8, $t7, $t5
+	bnez  $t8, .Lmul_nan
+	sltu  $t8, $t7, $t6
+	bnez  $t8, .Lmul_nan
+	nop
+	beqz  $t5, .Lmul_nan
+	nop
+	beqz  $t6, .Lmul_nan
+	nop
+	j     _sf_inf
+	nop
+
+.Lmul_nan:
+	j     _sf_nan
+	nop
+
+## Division
+
+.section .text.__divsf3
+.global __divsf3
+.type __divsf3, @function
+__divsf3:
+	xor   $t0, $a0, $a1
+	lui   $t9, 0x8000
+	and   $t0, $t9
+	srl   $t1, $a0, 23
+	andi  $t1, 0xff
+	srl   $t3, $a1, 23
+	andi  $t3, 0xff
+	li    $t8, 0xff
+	beq   $t1, $t8, .Ldiv_special
+	sll   $t2, $a0, 8
+	beq   $t3, $t8, .Ldiv_special
+	sll   $t4, $a1, 8
+
+	beqz  $t1, .Ldiv_a_denormal
+	nop
+	or    $t2, $t9
+.Ldiv_a_done:
+	beqz  $t3, .Ldiv_b_denormal
+	nop
+	or    $t4, $t9
+.Ldiv_b_done:
+	# Move the mantissas down to bits 0-23 and make sure a's mantissa is
+	# greater than or equal to b's (by doubling it if necessary), so that
+	# their quotient is in the 1-2 range.
+	srl   $t2, 8
+	srl   $t4, 8
+	subu  $t1, $t3
+	sltu  $t5, $t2, $t4
+	beqz  $t5, .Ldiv_start
+	addiu $t1, 127
+
+	sll   $t2, 1
+	addiu $t1, -1
+
+.Ldiv_start:
+	# Compute 24 quotient bits as three 8-bit long division steps using the
+	# hardware divider, then derive the rounding bits from the remainder.
+	sll   $t2, 7
+	divu  $zero, $t2, $t4
+	mflo  $t5
+	mfhi  $t2
+	sll   $t5, 8
+	sll   $t2, 8
+	divu  $zero, $t2, $t4
+	mflo  $t6
+	mfhi  $t2
+	or    $t5, $t6
+	sll   $t5, 8
+	sll   $t2, 8
+	divu  $zero, $t2, $t4
+	mflo  $t6
+	mfhi  $t2
+	or    $t5, $t6
+
+	# The remaining quotient bits are 1/2 or more if twice the remainder is
+	# at least the divisor, and nonzero if the remainder is nonzero (the
+	# sticky bit is set in the former case if there is anything past 1/2).
+	sll   $t2, 1
+	sltu  $t6, $t2, $t4
+	xori  $t6, 1
+	subu  $t7, $t2, $t4
+	bnez  $t6, .Ldiv_half
+	sll   $t6, 7
+	move  $t7, $t2
+.Ldiv_half:
+	sltu  $t7, $0, $t7
+	sll   $t2, $t5, 8
+	or    $t2, $t6
+	j     _sf_round_pack
+	or    $t2, $t7
+
+.Ldiv_a_denormal:
+	beqz  $t2, .Ldiv_a_zero
+	li    $t1, 1
+	NORMALIZE $t2, $t1, $t6
+	b     .Ldiv_a_done
+	nop
+
+.Ldiv_b_denormal:
+	beqz  $t4, .Ldiv_by_zero
+	li    $t3, 1
+	NORMALIZE $t4, $t3, $t6
+	b     .Ldiv_b_done
+	nop
+
+.Ldiv_a_zero:
+	# 0 / 0 is NaN, 0 / x is zero.
+	sll   $t6, $a1, 1
+	beqz  $t6, .Ldiv_nan
+	nop
+	jr    $ra
+	move  $v0, $t0
+
+.Ldiv_by_zero:
+	j     _sf_inf
+	nop
+
+.Ldiv_special:
+	# At least one operand is infinity or NaN. NaN / x, x / NaN and inf / inf
+	# are NaN, inf / x is infinity and x / inf is zero.
+	sll   $t5, $a0, 1
+	sll   $t6, $a1, 1
+	lui   $t7, 0xff00
+	sltu  $t8, $t7, $t5
+	bnez  $t8, .Ldiv_nan
+	sltu  $t8, $t7, $t6
+	bnez  $t8, .Ldiv_nan
+	nop
+	bne   $t5, $t7, .Ldiv_return_zero
+	nop
+	beq   $t6, $t7, .Ldiv_nan
+	nop
+	j     _sf_inf
+	nop
+
+.Ldiv_return_zero:
+	jr    $ra
+	move  $v0, $t0
+
+.Ldiv_nan:
+	j     _sf_nan
+	nop
+
+## Negation
+
+.section .text.__negsf2
+.global __negsf2
+.type __negsf2, @function
+__negsf2:
+	lui   $t0, 0x8000
+	jr    $ra
+	xor   $v0, $a0, $t0
+
+## Comparisons
+
+# GCC expects __eqsf2/__nesf2 to return zero if the operands are equal,
+# __ltsf2/__lesf2 to return a value less than/less than or equal to zero if
+# a < b or a <= b respectively and __gtsf2/__gesf2 to return a value greater
+# than/greater than or equal to zero if a > b or a >= b. All of them must
+# return a value that makes the comparison false if either operand is NaN.
+
+.section .text._sf_compare
+.type _sf_compare, @function
+_sf_compare:
+	# Inputs: $a0, $a1 = operands, $v1 = value to return if unordered.
+	sll   $t0, $a0, 1
+	sll   $t1, $a1, 1
+	lui   $t2, 0xff00
+	sltu  $t3, $t2, $t0
+	bnez  $t3, .Lunordered
+	sltu  $t3, $t2, $t1
+	bnez  $t3, .Lunordered
+	or    $t3, $t0, $t1
+	beqz  $t3, .Lequal
+
+	# Flip all bits but the sign of negative values, so that the ordering of
+	# floats matches the ordering of the same bits as signed integers.
+	sra   $t0, $a0, 31
+	srl   $t0, 1
+	xor   $t0, $a0
+	sra   $t1, $a1, 31
+	srl   $t1, 1
+	xor   $t1, $a1
+	slt   $v0, $t1, $t0
+	slt   $t2, $t0, $t1
+	jr    $ra
+	subu  $v0, $t2
+
+.Lequal:
+	jr    $ra
+	move  $v0, $0
+
+.Lunordered:
+	jr    $ra
+	move  $v0, $v1
+
+.section .text.__eqsf2
+.global __eqsf2
+.global __nesf2
+.type __eqsf2, @function
+.type __nesf2, @function
+__eqsf2:
+__nesf2:
+	j     _sf_compare
+	li    $v1, 1
+
+.section .text.__lesf2
+.global __lesf2
+.global __ltsf2
+.type __lesf2, @function
+.type __ltsf2, @function
+__lesf2:
+__ltsf2:
+	j     _sf_compare
+	li    $v1, 1
+
+.section .text.__gesf2
+.global __gesf2
+.global __gtsf2
+.type __gesf2, @function
+.type __gtsf2, @function
+__gesf2:
+__gtsf2:
+	j     _sf_compare
+	li    $v1, -1
+
+.section .text.__unordsf2
+.global __unordsf2
+.type __unordsf2, @function
+__unordsf2:
+	sll   $t0, $a0, 1
+	sll   $t1, $a1, 1
+	lui   $t2, 0xff00
+	sltu  $t0, $t2, $t0
+	sltu  $t1, $t2, $t1
+	jr    $ra
+	or    $v0, $t0, $t1
+
+## Integer to float conversion
+
+.section .text.__floatsisf
+.global __floatsisf
+.type __floatsisf, @function
+__floatsisf:
+	beqz  $a0, .Lint_zero
+	lui   $t0, 0x8000
+	and   $t0, $a0
+	bgez  $a0, .Lint_positive
+	move  $t2, $a0
+	negu  $t2, $a0
+.Lint_positive:
+	li    $t1, 127 + 31
+	NORMALIZE $t2, $t1, $t3
+	j     _sf_round_pack
+	nop
+
+.Lint_zero:
+	jr    $ra
+	move  $v0, $0
+
+.section .text.__floatunsisf
+.global __floatunsisf
+.type __floatunsisf, @function
+__floatunsisf:
+	beqz  $a0, .Luint_zero
+	move  $t0, $0
+	move  $t2, $a0
+	li    $t1, 127 + 31
+	NORMALIZE $t2, $t1, $t3
+	j     _sf_round_pack
+	nop
+
+.Luint_zero:
+	jr    $ra
+	move  $v0, $0
+
+## Float to integer conversion
+
+# Values are truncated towards zero. Out-of-range values (including NaNs and
+# infinities) are saturated to the minimum or maximum integer value.
+
+.section .text.__fixsfsi
+.global __fixsfsi
+.type __fixsfsi, @function
+__fixsfsi:
+	srl   $t1, $a0, 23
+	andi  $t1, 0xff
+	addiu $t1, -127
+	bltz  $t1, .Lfix_zero
+	sltiu $t2, $t1, 31
+	beqz  $t2, .Lfix_overflow
+	li    $t2, 31
+
+	sll   $t3, $a0, 8
+	lui   $t4, 0x8000
+	or    $t3, $t4
+	subu  $t2, $t1
+	bgez  $a0, .Lfix_return
+	srlv  $v0, $t3, $t2
+	negu  $v0, $v0
+.Lfix_return:
+	jr    $ra
+	nop
+
+.Lfix_zero:
+	jr    $ra
+	move  $v0, $0
+
+.Lfix_overflow:
+	lui   $v0, 0x8000
+	bltz  $a0, .Lfix_return
+	nop
+	jr    $ra
+	addiu $v0, -1
+
+.section .text.__fixunssfsi
+.global __fixunssfsi
+.type __fixunssfsi, @function
+__fixunssfsi:
+	bltz  $a0, .Lufix_zero
+	srl   $t1, $a0, 23
+	addiu $t1, -127
+	bltz  $t1, .Lufix_zero
+	sltiu $t2, $t1, 32
+	beqz  $t2, .Lufix_overflow
+	li    $t2, 31
+
+	sll   $t3, $a0, 8
+	lui   $t4, 0x8000
+	or    $t3, $t4
+	subu  $t2, $t1
+	jr    $ra
+	srlv  $v0, $t3, $t2
+
+.Lufix_zero:
+	jr    $ra
+	move  $v0, $0
+
+.Lufix_overflow:
+	jr    $ra
+	li    $v0, -1
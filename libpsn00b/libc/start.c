@@ -16,36 +16,47 @@
 int			__argc;
 const char	**__argv;
 
-#define ARGC_MAX 16
+#define ARGC_MAX		16
+#define ARG_STRING_MAX	128
 
-static const char	*_argv_buffer[ARGC_MAX];
-static char			_arg_string_buffer[132];
+static const char	*_argv_buffer[ARGC_MAX + 1];
+static char			_arg_string_buffer[ARG_STRING_MAX + 1];
 
 static void _parse_kernel_args(void) {
 	// Copy the argument string from kernel memory into a private buffer (which
-	// won't be cleared or deallocated) and trim it at the first newline.
-	memset(_arg_string_buffer, 0, 132);
-	strncpy(_arg_string_buffer, KERNEL_ARG_STRING, 128);
+	// won't be cleared or deallocated), trimming it at the first newline and
+	// splitting it into space-separated arguments in a single pass.
+	const char *src = KERNEL_ARG_STRING;
+	char       *dst = _arg_string_buffer;
+	int        argc = 0, new_arg = 1;
 
-	for (char *ptr = _arg_string_buffer; *ptr; ptr++) {
-		if ((*ptr == '\r') || (*ptr == '\n')) {
-			*ptr = 0;
+	for (int i = 0; i < ARG_STRING_MAX; i++) {
+		char c = *(src++);
+
+		if (!c || (c == '\r') || (c == '\n'))
 			break;
+
+		if (c == ' ') {
+			*(dst++) = 0;
+			new_arg  = 1;
+			continue;
+		}
+		if (new_arg) {
+			if (argc >= ARGC_MAX)
+				break;
+
+			_argv_buffer[argc++] = dst;
+			new_arg              = 0;
 		}
+
+		*(dst++) = c;
 	}
 
+	*dst               = 0;
+	_argv_buffer[argc] = 0;
+
+	__argc = argc;
 	__argv = _argv_buffer;
-	for (__argc = 0; __argc < ARGC_MAX; __argc++) {
-		const char *ptr;
-		if (!__argc)
-			ptr = strtok(_arg_string_buffer, " ");
-		else
-			ptr = strtok(0, " ");
-
-		_argv_buffer[__argc] = ptr;
-		if (!ptr)
-			break;
-	}
 }
 
 /* Main */
@@ -55,11 +66,16 @@ static void _parse_kernel_args(void) {
 // way to turn them into pointers is to declare them as arrays, so here we go.
 extern uint8_t __text_start[];
 extern uint8_t __bss_start[];
+extern uint8_t __bss_end[];
 extern uint8_t _end[];
 //extern uint8_t _gp[];
 
-extern void (*__CTOR_LIST__[])(void);
-extern void (*__DTOR_LIST__[])(void);
+extern void (*__preinit_array_start[])(void);
+extern void (*__preinit_array_end[])(void);
+extern void (*__init_array_start[])(void);
+extern void (*__init_array_end[])(void);
+extern void (*__fini_array_start[])(void);
+extern void (*__fini_array_end[])(void);
 
 extern int main(int argc, const char* argv[]);
 
@@ -69,10 +85,11 @@ extern int main(int argc, const char* argv[]);
 void _start_inner(int32_t override_argc, const char **override_argv) {
 	//__asm__ volatile("la $gp, _gp;");
 
-	// Clear BSS 4 bytes at a time. BSS is always aligned to 4 bytes by the
-	// linker script.
-	for (uint32_t *i = (uint32_t *) __bss_start; i < (uint32_t *) _end; i++)
-		*i = 0;
+	// Clear BSS using memset(), which writes 16 bytes per iteration. BSS is
+	// always aligned to 4 bytes by the linker script. The overlay region (if
+	// any) between BSS and the end of the executable is left alone, as
+	// overlays are loaded into it later.
+	memset(__bss_start, 0, __bss_end - __bss_start);
 
 	// Initialize the heap and place it after the executable, assuming 2 MB of
 	// RAM. Note that InitHeap() can be called again in main().
@@ -86,16 +103,17 @@ void _start_inner(int32_t override_argc, const char **override_argv) {
 	}
 
 	// Call the global constructors (if any) to initialize global objects
-	// before calling main(). Constructors are put by the linker script in a
-	// length-prefixed array in reverse order.
-	for (uint32_t i = (uint32_t) __CTOR_LIST__[0]; i >= 1; i--)
-		__CTOR_LIST__[i]();
+	// before calling main(). The linker script sorts them by priority.
+	for (void (**ctor)(void) = __preinit_array_start; ctor < __preinit_array_end; ctor++)
+		(*ctor)();
+	for (void (**ctor)(void) = __init_array_start; ctor < __init_array_end; ctor++)
+		(*ctor)();
 
 	// Store main()'s return value into the kernel return value area (for child
 	// executables).
 	*KERNEL_RETURN_VALUE = main(__argc, __argv);
 
-	// Call global destructors (in forward order).
-	for (uint32_t i = 0; i < (uint32_t) __DTOR_LIST__[0]; i++)
-		__DTOR_LIST__[i + 1]();
+	// Call global destructors in reverse order.
+	for (void (**dtor)(void) = __fini_array_end; dtor > __fini_array_start;)
+		(*(--dtor))();
 }
@@ -0,0 +1,65 @@
+# PSn00bSDK optimized strcmp
+# (C) 2022 PSn00bSDK contributors - MPL licensed
+
+.set noreorder
+
+.section .text.strcmp
+.global strcmp
+.type strcmp, @function
+strcmp:
+	# Words can only be compared if both strings have the same alignment,
+	# otherwise fall back to comparing one byte at a time.
+	xor   $t0, $a0, $a1
+	andi  $t0, 3
+	bnez  $t0, .Lbyte_loop
+	lui   $t8, 0x0101 # ones = 0x01010101
+
+	ori   $t8, 0x0101
+	sll   $t9, $t8, 7 # highs = 0x80808080
+
+.Lalign_loop:
+	andi  $t0, $a0, 3
+	beqz  $t0, .Lword_loop
+	nop
+
+	lbu   $t0, 0($a0)
+	lbu   $t1, 0($a1)
+	addiu $a0, 1
+	beqz  $t0, .Lreturn
+	addiu $a1, 1
+	beq   $t0, $t1, .Lalign_loop
+	nop
+
+	jr    $ra
+	subu  $v0, $t0, $t1
+
+.Lword_loop:
+	# Compare 4 bytes at a time until the words differ or contain a null byte.
+	# In the former case the byte loop is used to find the first different
+	# byte, in the latter the strings are equal.
+	lw    $t0, 0($a0)
+	lw    $t1, 0($a1)
+	subu  $t2, $t0, $t8
+	bne   $t0, $t1, .Lbyte_loop
+	nor   $t3, $t0, $0
+	and   $t2, $t3
+	and   $t2, $t9
+	addiu $a0, 4
+	beqz  $t2, .Lword_loop
+	addiu $a1, 4
+
+	jr    $ra
+	move  $v0, $0
+
+.Lbyte_loop:
+	lbu   $t0, 0($a0)
+	lbu   $t1, 0($a1)
+	addiu $a0, 1
+	beqz  $t0, .Lreturn
+	addiu $a1, 1
+	beq   $t0, $t1, .Lbyte_loop
+	nop
+
+.Lreturn:
+	jr    $ra
+	subu  $v0, $t0, $t1
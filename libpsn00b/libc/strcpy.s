@@ -0,0 +1,60 @@
+# PSn00bSDK optimized strcpy
+# (C) 2022 PSn00bSDK contributors - MPL licensed
+
+.set noreorder
+
+.section .text.strcpy
+.global strcpy
+.type strcpy, @function
+strcpy:
+	# Words can only be copied if both buffers have the same alignment,
+	# otherwise fall back to copying one byte at a time.
+	xor   $t0, $a0, $a1
+	andi  $t0, 3
+	bnez  $t0, .Lbyte_loop
+	move  $v0, $a0 # return_value = dst
+
+	lui   $t8, 0x0101 # ones = 0x01010101
+	ori   $t8, 0x0101
+	sll   $t9, $t8, 7 # highs = 0x80808080
+
+.Lalign_loop:
+	andi  $t0, $a1, 3
+	beqz  $t0, .Lword_loop
+	nop
+
+	lbu   $t0, 0($a1)
+	addiu $a1, 1
+	sb    $t0, 0($a0)
+	bnez  $t0, .Lalign_loop
+	addiu $a0, 1
+
+	jr    $ra
+	nop
+
+.Lword_loop:
+	# Copy 4 bytes at a time until a word containing a null byte is found,
+	# then let the byte loop copy the last 1-4 bytes.
+	lw    $t0, 0($a1)
+	nop
+	subu  $t1, $t0, $t8
+	nor   $t2, $t0, $0
+	and   $t1, $t2
+	and   $t1, $t9
+	bnez  $t1, .Lbyte_loop
+	nop
+
+	sw    $t0, 0($a0)
+	addiu $a1, 4
+	b     .Lword_loop
+	addiu $a0, 4
+
+.Lbyte_loop:
+	lbu   $t0, 0($a1)
+	addiu $a1, 1
+	sb    $t0, 0($a0)
+	bnez  $t0, .Lbyte_loop
+	addiu $a0, 1
+
+	jr    $ra
+	nop
@@ -4,13 +4,12 @@
  * Inherited from PSXSDK C library
  */
 
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
-// Uncomment to enable strtod(), strtold() and strtof(). Note that these
-// functions use extremely slow software floats.
-//#define ALLOW_FLOAT
+// strtol() and other number parsing functions are in strtol.c.
 
 int tolower(int chr)
 {
@@ -22,293 +21,338 @@ int toupper(int chr)
     return (chr >='a' && chr<='z') ? (chr - 32) : (chr);    
 }
 
-// Need to be replaced with MIPS assembler equivalents
+/* Helpers */
 
-void *memchr(void *s , int c , int n)
-{
-	while(n--)
-	{
-		if(*((unsigned char*)s) == (unsigned char)c)
-			return s;
-		
-		s++;
-	}
-	
-	return NULL;
-}
+// Strings are scanned 4 bytes at a time where possible. _HAS_ZERO() is
+// nonzero if any byte in the given word is zero (the position of the first
+// set bit is not reliable, so matches are always located using a byte loop).
+typedef uint32_t __attribute__((may_alias)) _word_t;
 
-char *strncpy(char *dst, const char *src, int len)
+#define _ONES			0x01010101U
+#define _HAS_ZERO(x)	(((x) - _ONES) & ~(x) & (_ONES << 7))
+
+// Character sets (used by strpbrk(), strspn() and the tokenizers) are stored
+// as 256-bit maps, so that each character in the string is only checked once.
+// The null terminator is always added to the set.
+#define _IN_SET(set, c)	((set)[(c) / 32] & (1U << ((c) % 32)))
+
+static void _build_set(uint32_t *set, const char *chars)
 {
-	char *odst=dst;
+	set[0] = 1;
+	for (int i = 1; i < 8; i++)
+		set[i] = 0;
 
-	while(*src && len)
-	{
-		*(dst++) = *(src++);
-		len--;
+	for (; *chars; chars++) {
+		uint8_t c = *chars;
+		set[c / 32] |= 1U << (c % 32);
 	}
-	
-	*dst = 0;
-	
-	return odst;
 }
 
-char *strcpy(char *dst, const char *src)
+static int _strnlen(const char *str, int len)
 {
-	char *odst = dst;
+	const char *ptr = str;
 
-	while(*(dst++) = *(src++));
-	return odst;
+	for (; (len > 0) && *ptr; len--)
+		ptr++;
+
+	return ptr - str;
 }
 
-char *strcat(char *dst, const char *src)
+// Returns a pointer to the maximal suffix of the needle (as defined by the
+// Critical Factorization Theorem) using the given byte ordering, along with
+// the period of the suffix.
+static int _max_suffix(const uint8_t *needle, int len, int inverse, int *period)
 {
-	char *o=dst;
-	
-	while(*dst)
-		dst++;
-	
-	strcpy(dst, src);
-	
-	return o;
+	int i = -1, j = 0, k = 1, p = 1;
+
+	while ((j + k) < len) {
+		uint8_t a = needle[i + k], b = needle[j + k];
+
+		if (a == b) {
+			if (k == p) {
+				j += p;
+				k  = 1;
+			} else {
+				k++;
+			}
+		} else if (inverse ? (a < b) : (a > b)) {
+			j += k;
+			k  = 1;
+			p  = j - i;
+		} else {
+			i = j++;
+			k = p = 1;
+		}
+	}
+
+	*period = p;
+	return i;
 }
 
-char *strncat(char *s, const char *append, int len)
+/* Memory functions */
+
+// memchr(), memcmp(), memcpy(), memmove() and memset() are implemented in
+// assembly.
+
+/* String copying and concatenation */
+
+// strcpy() is implemented in assembly.
+
+char *strncpy(char *dst, const char *src, int len)
 {
-	char *o=s;
-	
-	while(*s)
-		s++;
-	
-	strncpy(s, append, len);
-	
-	return o;
+	char *ptr = dst;
+
+	for (; (len > 0) && *src; len--)
+		*(ptr++) = *(src++);
+
+	// The rest of the buffer is always zero-filled, as per the standard.
+	if (len > 0)
+		memset(ptr, 0, len);
+
+	return dst;
 }
 
-int strlen(const char *str)
+char *strcat(char *dst, const char *src)
 {
-	int i = 0;
-	while(*(str++))i++;
-	return i;
+	strcpy(dst + strlen(dst), src);
+	return dst;
 }
 
-char *strchr(const char *s, int c)
+char *strncat(char *dst, const char *src, int len)
 {
-	int x;
+	char *ptr = dst + strlen(dst);
 
-	for(x = 0; x <= strlen(s); x++)
-		if(s[x] == c) return (char*)&s[x];
+	for (; (len > 0) && *src; len--)
+		*(ptr++) = *(src++);
 
-	return NULL;
+	*ptr = 0;
+	return dst;
 }
 
-char *strrchr(const char *s, int c)
+/* String searching */
+
+// strlen() and strcmp() are implemented in assembly.
+
+int strncmp(const char *s1, const char *s2, int len)
 {
-	int x;
+	// If both strings have the same alignment, compare them a word at a time
+	// until either a mismatch or the end of a string is found, then let the
+	// byte loop find the exact position.
+	if (!(((uintptr_t) s1 ^ (uintptr_t) s2) % 4)) {
+		for (; (len > 0) && ((uintptr_t) s1 % 4); len--, s1++, s2++) {
+			uint8_t a = *s1, b = *s2;
+
+			if (a != b)
+				return a - b;
+			if (!a)
+				return 0;
+		}
 
-	for(x = strlen(s); x>=0; x--)
-		if(s[x] == c) return (char*)&s[x];
+		const _word_t *w1 = (const _word_t *) s1;
+		const _word_t *w2 = (const _word_t *) s2;
 
-	return NULL;
-}
+		for (; (len >= 4) && (*w1 == *w2) && !_HAS_ZERO(*w1); len -= 4) {
+			w1++;
+			w2++;
+		}
 
-char *strpbrk(const char *s, const char *charset)
-{
-	int x,y;
+		s1 = (const char *) w1;
+		s2 = (const char *) w2;
+	}
+
+	for (; len > 0; len--, s1++, s2++) {
+		uint8_t a = *s1, b = *s2;
 
-	for(x = 0; x < strlen(s); x++)
-		for(y = 0; y < strlen(charset); y++)
-			if(s[x] == charset[y]) return (char*)&s[x];
+		if (a != b)
+			return a - b;
+		if (!a)
+			break;
+	}
 
-	return NULL;
+	return 0;
 }
 
-char *strstr(const char *big, const char *little)
+char *strchr(const char *s, int c)
 {
-	int ls = strlen(little);
-	int bs = strlen(big);
-	int x;
+	c = (uint8_t) c;
 
-	if(ls == 0)
-		return (char*)big;
-	
-	if(ls > bs)
-		return NULL;
+	for (; (uintptr_t) s % 4; s++) {
+		if (*((const uint8_t *) s) == c)
+			return (char *) s;
+		if (!*s)
+			return NULL;
+	}
 
-	for(x = 0; x <= bs-ls; x++)
-		if(memcmp(little, &big[x], ls) == 0)
-			return (char*)&big[x];
+	// Skip words that contain neither the terminator nor the character.
+	const _word_t *ptr = (const _word_t *) s;
+	uint32_t      mask = ((uint32_t) (uint8_t) c) * _ONES;
 
-	return NULL;
-}
+	while (!_HAS_ZERO(*ptr) && !_HAS_ZERO(*ptr ^ mask))
+		ptr++;
 
-int strcmp(const char *s1, const char *s2)
-{
-	while((*s1) && (*s2) && (*s1 == *s2))
-	{
-		s1++;
-		s2++;
+	for (s = (const char *) ptr; *s; s++) {
+		if (*((const uint8_t *) s) == c)
+			return (char *) s;
 	}
 
-	return(*s1-*s2);
+	return c ? NULL : (char *) s;
 }
 
-int strncmp(const char *s1, const char *s2, int len)
+char *strrchr(const char *s, int c)
 {
-	int p = 0;
+	const char *last = NULL;
 
-	while(*s1 && *s2 && (*s1 == *s2) && p<len)
-	{
-		p++;
+	c = (uint8_t) c;
 
-		if(p<len)
-		{
-			s1++;
-			s2++;
-		}
+	for (;; s++) {
+		if (*((const uint8_t *) s) == c)
+			last = s;
+		if (!*s)
+			return (char *) last;
 	}
+}
+
+char *strpbrk(const char *s, const char *charset)
+{
+	uint32_t set[8];
+	_build_set(set, charset);
 
-	return *s1-*s2;
+	for (;; s++) {
+		uint8_t c = *s;
+
+		if (_IN_SET(set, c))
+			return c ? (char *) s : NULL;
+	}
 }
 
-// Requires a malloc implementation
-char *strdup(const char *str)
+size_t strspn(const char *s, const char *charset)
 {
-	char *ns = (void*)malloc(strlen(str) + 1);
+	uint32_t set[8];
+	_build_set(set, charset);
+	set[0] &= ~1;
 
-	if(ns == NULL)
-		return NULL;
-	
-	strcpy(ns, str);
-	return ns;
+	const char *ptr = s;
+	for (; _IN_SET(set, (uint8_t) *ptr); ptr++)
+		;
+
+	return ptr - s;
 }
 
-char *strndup(const char *str, int len)
+size_t strcspn(const char *s, const char *charset)
 {
-	int n=strlen(str);
-	char *ns = (void*)malloc((n+1)>len?len:(n+1));
+	uint32_t set[8];
+	_build_set(set, charset);
 
-	if(ns == NULL)
-		return NULL;
-	
-	strncpy(ns, str, (n+1)>len?len:(n+1));
-	return ns;
+	const char *ptr = s;
+	for (; !_IN_SET(set, (uint8_t) *ptr); ptr++)
+		;
+
+	return ptr - s;
 }
-	
-long long strtoll(const char *nptr, char **endptr, int base)
+
+// This is an implementation of the Two-Way algorithm (Crochemore and Perrin,
+// 1991), which runs in linear time and constant space. The needle is split in
+// two halves at its critical factorization; the right half is compared first
+// and a mismatch allows skipping ahead by the number of characters matched,
+// while a mismatch in the left half allows skipping by the needle's period.
+char *strstr(const char *big, const char *little)
 {
-	int r = 0;
-	int t = 0;
-	int n = 0;
-	
-	if(*nptr == '-')
-	{
-		nptr++;
-		n = 1;
-	}
+	const uint8_t *haystack = (const uint8_t *) big;
+	const uint8_t *needle   = (const uint8_t *) little;
 
-	if(base == 0)
-		if(*nptr == '0')
-			base = 8;
-		else
-			base = 10;
+	if (!needle[0])
+		return (char *) big;
+	if (!needle[1])
+		return strchr(big, needle[0]);
 
-	if(!(base >= 2 && base <= 36))
-		return 0;
+	int len = strlen(little);
 
-	if(base == 16 && *nptr == '0')
-	{
-		if(*(nptr+1) == 'x' || *(nptr+1) == 'X')
-			nptr+=2;
-	}
+	int period, inv_period;
+	int split     = _max_suffix(needle, len, 0, &period);
+	int inv_split = _max_suffix(needle, len, 1, &inv_period);
 
-	while(*nptr)
-	{
-		switch(*nptr)
-		{
-			case '0'...'9':
-				t = *nptr - '0';
-			break;
-			case 'a' ... 'z':
-				t = (*nptr - 'a') + 10;
-			break;
-			case 'A' ... 'Z':
-				t = (*nptr - 'A') + 10;
-			break;
-			default:
-				t = 1000;
-			break;
-		}
+	if (inv_split > split) {
+		split  = inv_split;
+		period = inv_period;
+	}
 
-		if(t>=base)
-			break;
+	// If the needle is periodic, the part of it known to match after shifting
+	// by the period (memory) does not have to be compared again.
+	int memory_len, memory = 0;
 
-		r*=base;
-		r+=t;
-		nptr++;
+	if (!memcmp(needle, needle + period, split + 1)) {
+		memory_len = len - period;
+	} else {
+		memory_len = 0;
+		period     = ((split > (len - split - 1)) ? split : (len - split - 1)) + 1;
 	}
 
-	if(endptr)*endptr = (char*)nptr;
-	return n?-r:r;
-}
+	// The end of the haystack is only looked for as far as needed, rather
+	// than calling strlen() on it beforehand.
+	const uint8_t *end = haystack;
 
-long strtol(const char *nptr, char **endptr, int base)
-{
-	return (long)strtoll(nptr, endptr, base);
-}
+	for (;;) {
+		if ((end - haystack) < len) {
+			int           grow = len | 63;
+			const uint8_t *ptr = memchr((void *) end, 0, grow);
 
-#ifdef ALLOW_FLOAT
+			if (ptr) {
+				end = ptr;
 
-double strtod(const char *nptr, char **endptr)
-{
-	char strbuf[64];
-	int x = 0;
-	int y;
-	double i=0, d=0;
-	int s=1;
+				if ((end - haystack) < len)
+					return NULL;
+			} else {
+				end += grow;
+			}
+		}
 
-	if(*nptr == '-')
-	{
-		nptr++;
-		s=-1;
-	}
+		int i = (split + 1 > memory) ? (split + 1) : memory;
 
-	while(*nptr >= '0' && *nptr <= '9' && x < 18)
-		strbuf[x++] = *(nptr++);
+		for (; (i < len) && (needle[i] == haystack[i]); i++);
 
-	strbuf[x] = 0;
+		if (i < len) {
+			haystack += i - split;
+			memory    = 0;
+			continue;
+		}
 
-	i = (double)strtoll(strbuf, NULL, 10);
+		for (i = split + 1; (i > memory) && (needle[i - 1] == haystack[i - 1]); i--);
 
-	if(*nptr == '.')
-	{
-		nptr++;
-		x = 0;
+		if (i <= memory)
+			return (char *) haystack;
 
-		while(*nptr >= '0' && *nptr <= '9' && x < 7)
-			strbuf[x++] = *(nptr++);
+		haystack += period;
+		memory    = memory_len;
+	}
+}
 
-		strbuf[x] = 0;
-		
-		if(endptr != NULL) *endptr = (char*)nptr;
+/* Memory allocation */
 
-		y=1;
+// Requires a malloc implementation
+char *strdup(const char *str)
+{
+	int  len = strlen(str) + 1;
+	char *ns = malloc(len);
 
-		for(x=0;x<strlen(strbuf);x++)
-			y*=10;
+	if (!ns)
+		return NULL;
 
-		d = (double)strtoll(strbuf, NULL, 10);
-		d /= y;
-	}
-	else
-	{
-		if(endptr != NULL)
-			*endptr = (char*)nptr;
-	}
-	
-	return (i + d)*s;
+	memcpy(ns, str, len);
+	return ns;
 }
 
-#endif
+char *strndup(const char *str, int len)
+{
+	int  n   = _strnlen(str, len);
+	char *ns = malloc(n + 1);
+
+	if (!ns)
+		return NULL;
+
+	memcpy(ns, str, n);
+	ns[n] = 0;
+	return ns;
+}
 
 /* implementation by Lameguy64, behaves like OpenWatcom's strtok() */
 /* BIOS strtok seemed either bugged, or designed for wide chars */
@@ -352,16 +396,56 @@ char *strtok( char *s1, char *s2 )
 	
 } /* strtok */
 
-#ifdef ALLOW_FLOAT
+/* Reentrant tokenizers */
 
-long double strtold(const char *nptr, char **endptr)
+char *strtok_r(char *s, const char *delim, char **saveptr)
 {
-	return (long double)strtod(nptr, endptr);
+	uint32_t set[8];
+	_build_set(set, delim);
+
+	if (!s)
+		s = *saveptr;
+
+	// Skip any leading delimiters, then find the end of the token and replace
+	// the delimiter after it (if any) with a null terminator.
+	for (set[0] &= ~1; _IN_SET(set, (uint8_t) *s); s++)
+		;
+
+	if (!*s) {
+		*saveptr = s;
+		return NULL;
+	}
+
+	char *end = s;
+	for (set[0] |= 1; !_IN_SET(set, (uint8_t) *end); end++)
+		;
+
+	if (*end)
+		*(end++) = 0;
+
+	*saveptr = end;
+	return s;
 }
 
-float strtof(const char *nptr, char **endptr)
+int strntok(const char **ptr, const char *end, const char *delim, const char **token)
 {
-	return (float)strtod(nptr, endptr);
-}
+	uint32_t set[8];
+	_build_set(set, delim);
+
+	// Unlike strtok_r() the input is never modified and scanning stops at the
+	// given end pointer, so this can be used on read-only buffers that are not
+	// null-terminated (such as files loaded into memory as-is). Null characters
+	// are treated as delimiters.
+	const char *s = *ptr;
 
-#endif
+	for (; (s < end) && _IN_SET(set, (uint8_t) *s); s++)
+		;
+
+	*token = s;
+
+	for (; (s < end) && !_IN_SET(set, (uint8_t) *s); s++)
+		;
+
+	*ptr = s;
+	return s - *token;
+}
@@ -0,0 +1,54 @@
+# PSn00bSDK optimized strlen
+# (C) 2022 PSn00bSDK contributors - MPL licensed
+
+.set noreorder
+
+.section .text.strlen
+.global strlen
+.type strlen, @function
+strlen:
+	# Check the first 0-3 bytes one at a time until the pointer is aligned.
+	move  $v0, $a0
+	lui   $t8, 0x0101 # ones = 0x01010101
+	ori   $t8, 0x0101
+	sll   $t9, $t8, 7 # highs = 0x80808080
+
+.Lalign_loop:
+	andi  $t0, $v0, 3
+	beqz  $t0, .Lword_loop
+	nop
+
+	lbu   $t0, 0($v0)
+	nop
+	bnez  $t0, .Lalign_loop
+	addiu $v0, 1
+
+	addiu $v0, -1
+	jr    $ra
+	subu  $v0, $a0 # return ptr - str
+
+.Lword_loop:
+	# Read 4 bytes at a time until a word containing a null byte is found, i.e.
+	# until ((word - ones) & ~word & (ones << 7)) is nonzero. Reading past the
+	# terminator is harmless as the word never crosses into another page.
+	lw    $t0, 0($v0)
+	nop
+	subu  $t1, $t0, $t8
+	nor   $t2, $t0, $0
+	and   $t1, $t2
+	and   $t1, $t9
+	beqz  $t1, .Lword_loop
+	addiu $v0, 4
+
+	# Find the null byte within the last word.
+	addiu $v0, -4
+
+.Lbyte_loop:
+	lbu   $t0, 0($v0)
+	nop
+	bnez  $t0, .Lbyte_loop
+	addiu $v0, 1
+
+	addiu $v0, -1
+	jr    $ra
+	subu  $v0, $a0
@@ -0,0 +1,316 @@
+/*
+ * PSn00bSDK number parsing functions
+ * (C) 2022 PSn00bSDK contributors - MPL licensed
+ *
+ * All integer parsing functions (including vsscanf()) are built around
+ * _parse_integer(), which accumulates digits into a 32-bit value and only
+ * switches to 64-bit arithmetic once the value is about to overflow. Decimal
+ * and hexadecimal digits are accumulated using shifts rather than
+ * multiplications, and the 64-bit path is implemented as a pair of 32x32-bit
+ * multiplications so libgcc's 64-bit multiplication and division routines are
+ * never pulled in. Out-of-range values are clamped as required by the C
+ * standard (errno is not set, as there is no errno).
+ *
+ * strtod() and friends are only built if libpsn00b is configured with
+ * PSN00BSDK_LIBC_FLOAT enabled, which defines ALLOW_FLOAT. They rely on
+ * software floats, but the mantissa is parsed as an integer and only converted
+ * to a float once, followed by at most one multiplication or division per set
+ * bit of the exponent.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Any value below this can be multiplied by any base up to 36 and have a digit
+// added to it without overflowing 32 bits.
+#define FAST_LIMIT ((0xffffffff - 35) / 36)
+
+/* Internal helpers */
+
+static inline uint32_t _digit_value(int c) {
+	if ((uint32_t) (c - '0') < 10)
+		return c - '0';
+
+	// Convert uppercase letters to lowercase by setting bit 5. This will also
+	// map some symbols to other symbols, which are rejected anyway.
+	c |= 0x20;
+	if ((uint32_t) (c - 'a') < 26)
+		return c - 'a' + 10;
+
+	return 36;
+}
+
+static inline int _is_space(int c) {
+	return (c == ' ') || ((uint32_t) (c - '\t') < 5);
+}
+
+// This function is also used by vsscanf(). It parses an optionally signed
+// integer spanning at most max_length characters (whitespace is not skipped)
+// and returns a pointer past its last character, or NULL if no digits were
+// found. The absolute value is returned separately from the sign, saturated to
+// UINT64_MAX if it does not fit into 64 bits.
+const char *_parse_integer(
+	const char *str,
+	uint32_t   max_length,
+	int        base,
+	uint64_t   *value,
+	int        *negative
+) {
+	*negative = 0;
+
+	if (max_length && ((*str == '-') || (*str == '+'))) {
+		*negative = (*str == '-');
+		str++;
+		max_length--;
+	}
+
+	// Skip the 0x prefix in base 16 and use it for base detection in base 0.
+	// The prefix must be followed by at least one valid digit, otherwise only
+	// the zero is parsed (e.g. "0xg" is 0 followed by "xg").
+	if (
+		((base == 0) || (base == 16)) &&
+		(max_length >= 3) &&
+		(str[0] == '0') &&
+		((str[1] | 0x20) == 'x') &&
+		(_digit_value(str[2]) < 16)
+	) {
+		str        += 2;
+		max_length -= 2;
+		base        = 16;
+	} else if (!base) {
+		base = (*str == '0') ? 8 : 10;
+	}
+
+	if ((base < 2) || (base > 36) || !max_length || (_digit_value(*str) >= base))
+		return 0;
+
+	uint32_t low = 0;
+
+	for (; max_length; str++, max_length--) {
+		uint32_t digit = _digit_value(*str);
+
+		if ((digit >= base) || (low > FAST_LIMIT))
+			break;
+
+		if (base == 10)
+			low = (low << 3) + (low << 1) + digit;
+		else if (base == 16)
+			low = (low << 4) | digit;
+		else
+			low = low * base + digit;
+	}
+
+	// Slow path for values that do not fit into 32 bits. Each step is split
+	// into two 32x32-bit multiplications, which also allows the carry out of
+	// the upper half to be used for overflow detection.
+	uint32_t high     = 0;
+	int      overflow = 0;
+
+	for (; max_length; str++, max_length--) {
+		uint32_t digit = _digit_value(*str);
+
+		if (digit >= base)
+			break;
+		if (overflow)
+			continue;
+
+		uint64_t new_low  = (uint64_t) low  * base + digit;
+		uint64_t new_high = (uint64_t) high * base + (uint32_t) (new_low >> 32);
+
+		low  = (uint32_t) new_low;
+		high = (uint32_t) new_high;
+
+		if (new_high >> 32)
+			overflow = 1;
+	}
+
+	*value = overflow ? UINT64_MAX : (((uint64_t) high << 32) | low);
+	return str;
+}
+
+static const char *_strtoint(
+	const char *nptr,
+	char       **endptr,
+	int        base,
+	uint64_t   *value,
+	int        *negative
+) {
+	const char *str = nptr;
+
+	while (_is_space(*str))
+		str++;
+
+	str = _parse_integer(str, UINT32_MAX, base, value, negative);
+
+	if (!str) {
+		*value    = 0;
+		*negative = 0;
+		str       = nptr;
+	}
+	if (endptr)
+		*endptr = (char *) str;
+
+	return str;
+}
+
+/* Integer parsing */
+
+long strtol(const char *nptr, char **endptr, int base) {
+	uint64_t value;
+	int      negative;
+
+	_strtoint(nptr, endptr, base, &value, &negative);
+
+	if (negative)
+		return (value >= 0x80000000) ? INT32_MIN : -((long) value);
+	else
+		return (value > INT32_MAX) ? INT32_MAX : ((long) value);
+}
+
+unsigned long strtoul(const char *nptr, char **endptr, int base) {
+	uint64_t value;
+	int      negative;
+
+	_strtoint(nptr, endptr, base, &value, &negative);
+
+	if (value > UINT32_MAX)
+		return UINT32_MAX;
+
+	return negative ? -((unsigned long) value) : ((unsigned long) value);
+}
+
+long long strtoll(const char *nptr, char **endptr, int base) {
+	uint64_t value;
+	int      negative;
+
+	_strtoint(nptr, endptr, base, &value, &negative);
+
+	if (negative)
+		return (value >= (1ULL << 63)) ? INT64_MIN : -((long long) value);
+	else
+		return (value > INT64_MAX) ? INT64_MAX : ((long long) value);
+}
+
+unsigned long long strtoull(const char *nptr, char **endptr, int base) {
+	uint64_t value;
+	int      negative;
+
+	_strtoint(nptr, endptr, base, &value, &negative);
+
+	if (value == UINT64_MAX)
+		return UINT64_MAX;
+
+	return negative ? -value : value;
+}
+
+/* Floating-point parsing */
+
+#ifdef ALLOW_FLOAT
+
+#define MAX_DIGITS 19 // Largest number of decimal digits that fits in 64 bits
+
+static const double _powers_of_ten[] = {
+	1e1, 1e2, 1e4, 1e8, 1e16, 1e32, 1e64, 1e128, 1e256
+};
+
+double strtod(const char *nptr, char **endptr) {
+	const char *str = nptr;
+
+	while (_is_space(*str))
+		str++;
+
+	int negative = (*str == '-');
+	if ((*str == '-') || (*str == '+'))
+		str++;
+
+	// Accumulate up to 19 significant digits into an integer, ignoring any
+	// further digits but keeping track of where the decimal point is.
+	uint64_t    mantissa = 0;
+	int         digits   = 0, exponent = 0, point = 0;
+	const char  *start   = str;
+
+	for (;; str++) {
+		uint32_t digit = *str - '0';
+
+		if (digit < 10) {
+			if (digits < MAX_DIGITS) {
+				if (mantissa || digit)
+					digits++;
+
+				mantissa = (mantissa << 3) + (mantissa << 1) + digit;
+				exponent -= point;
+			} else {
+				exponent += !point;
+			}
+		} else if ((*str == '.') && !point) {
+			point = 1;
+		} else {
+			break;
+		}
+	}
+
+	// Reject strings with no digits, such as "." or "-".
+	if ((str - start) <= point) {
+		if (endptr)
+			*endptr = (char *) nptr;
+
+		return 0.0;
+	}
+
+	if ((*str | 0x20) == 'e') {
+		const char *exp_str = str + 1;
+		int        exp_negative = (*exp_str == '-');
+
+		if ((*exp_str == '-') || (*exp_str == '+'))
+			exp_str++;
+
+		if ((uint32_t) (*exp_str - '0') < 10) {
+			int value = 0;
+
+			for (; (uint32_t) (*exp_str - '0') < 10; exp_str++) {
+				if (value < 10000)
+					value = value * 10 + (*exp_str - '0');
+			}
+
+			exponent += exp_negative ? -value : value;
+			str       = exp_str;
+		}
+	}
+
+	if (endptr)
+		*endptr = (char *) str;
+
+	double result = (double) mantissa;
+
+	if (mantissa) {
+		uint32_t abs_exponent = (exponent < 0) ? -exponent : exponent;
+		double   scale        = 1.0;
+
+		for (int i = 0; abs_exponent && (i < 9); i++, abs_exponent >>= 1) {
+			if (abs_exponent & 1)
+				scale *= _powers_of_ten[i];
+		}
+
+		// Exponents too large to be represented are clamped to infinity (or
+		// zero).
+		if (abs_exponent)
+			scale *= 1e256;
+
+		if (exponent < 0)
+			result /= scale;
+		else
+			result *= scale;
+	}
+
+	return negative ? -result : result;
+}
+
+long double strtold(const char *nptr, char **endptr) {
+	return (long double) strtod(nptr, endptr);
+}
+
+float strtof(const char *nptr, char **endptr) {
+	return (float) strtod(nptr, endptr);
+}
+
+#endif
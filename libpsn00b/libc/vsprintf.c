@@ -1,813 +1,633 @@
-/* printf.c
+/*
+ * PSn00bSDK printf engine
+ * (C) 2022 PSn00bSDK contributors - MPL licensed
+ * Originally inherited from the PSXSDK C library
  *
- * Inherited from the PSXSDK C library
+ * All printf-like functions are built around vcbprintf(), which parses the
+ * format string and passes the output to a callback in runs of characters
+ * (literal text between conversions, padding and converted values) rather
+ * than one character at a time. Integers are converted two digits at a time
+ * using multiplication by the reciprocal of 100 instead of a division, as the
+ * R3000's divider takes 36 cycles per division; 64-bit integers (%lld) are
+ * converted using shifts and additions to avoid pulling in libgcc's division
+ * routines. No global state is used, so all functions are reentrant.
+ *
+ * Floating-point support (%f) is only built if libpsn00b is configured with
+ * PSN00BSDK_LIBC_FLOAT enabled, which defines ALLOW_FLOAT. It relies on
+ * software floats and is thus extremely slow.
  */
 
+#include <stdint.h>
+#include <stdarg.h>
 #include <stdio.h>
-#include <stdlib.h>
 #include <string.h>
-#include <stdarg.h>
 
-// Uncomment to enable support for %f.
-//#define ALLOW_FLOAT
-
-#define SPRINTF_ALT_FLAG			(1<<0)
-#define SPRINTF_ZERO_FLAG			(1<<1)
-#define SPRINTF_NEGFIELD_FLAG			(1<<2)
-#define SPRINTF_SPACE_FLAG			(1<<3)
-#define SPRINTF_SIGN_FLAG			(1<<4)
-
-// sprintf() macros to calculate the real padding and to write it
-// these were made to not repeat the code in the function
-// they can only be used in sprintf()
-
-// sprintf macros START
-
-#define calculate_real_padding() \
-	y = 1; \
-	\
-	for(x=0;x<=19;x++) \
-	{ \
-		if(x == 0) \
-			pad_quantity--; \
-		else \
-		{ \
-			if(arg / y) \
-				pad_quantity--; \
-		} \
-	\
-		y *= 10; \
-	} \
-	\
-	if(pad_quantity < 0) pad_quantity = 0;
-
-/*#define calculate_real_padding_hex() \
-	for (x = 0; x < 8; x++) \
-	{ \
-		if(x == 0) \
-			pad_quantity--; \
-		else \
-		{ \
-		if((arg >> (x * 4)) & 0xf) \
-			pad_quantity--; \
-		} \
-	}*/
-	
-#define calculate_real_padding_hex() \
-	last = 0; \
-	for (x = 0; x < 8; x++) \
-		if((arg >> (x * 4)) & 0xf) \
-			last = x; \
-	\
-	pad_quantity = (pad_quantity - 1) - last; \
-	if(pad_quantity < 0) pad_quantity = 0;
-
-#define calculate_real_padding_bin() \
-	last = 0; \
-	for (x = 0; x < 32; x++) \
-		if((arg >> x) & 1) \
-			last = x; \
-	\
-	pad_quantity = (pad_quantity - 1) - last; \
-	if(pad_quantity < 0) pad_quantity = 0;
-
-#define write_padding() \
-	if(!(flags & SPRINTF_NEGFIELD_FLAG)) \
-		for(x = 0; x < pad_quantity; x++) \
-		{ \
-			if(flags & SPRINTF_ZERO_FLAG) \
-					put_in_string(string, ssz, '0', string_pos++); \
-			else \
-					put_in_string(string, ssz, ' ', string_pos++); \
-		}
+#define FLAG_LEFT		(1 << 0)
+#define FLAG_PLUS		(1 << 1)
+#define FLAG_SPACE		(1 << 2)
+#define FLAG_ALT		(1 << 3)
+#define FLAG_ZERO		(1 << 4)
+#define FLAG_PRECISION	(1 << 5)
+#define FLAG_UPPER		(1 << 6)
+
+#define BUFFER_SIZE		68 // Enough for a 64-bit integer in binary
+
+typedef enum {
+	SIZE_CHAR,
+	SIZE_SHORT,
+	SIZE_INT,
+	SIZE_LONG,
+	SIZE_LONG_LONG
+} ArgSize;
+
+typedef struct {
+	printf_sink_t sink;
+	void          *arg;
+	int           length;
+} Output;
+
+typedef struct {
+	char     *ptr;
+	uint32_t remaining;
+} StringSink;
+
+static const char _digit_pairs[] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+static const char _lower_digits[] = "0123456789abcdef";
+static const char _upper_digits[] = "0123456789ABCDEF";
+static const char _spaces[]       = "                ";
+static const char _zeros[]        = "0000000000000000";
+
+/* Output helpers */
+
+static void _output(Output *out, const char *str, int length) {
+	if (length <= 0)
+		return;
+
+	out->sink(out->arg, str, length);
+	out->length += length;
+}
+
+static void _pad(Output *out, const char *chars, int count) {
+	for (; count > 16; count -= 16)
+		_output(out, chars, 16);
+
+	_output(out, chars, count);
+}
+
+/* Integer conversion */
+
+// Both reciprocals are exact for any 32-bit value (the multiplication is
+// compiled to a single multu instruction).
+static inline uint32_t _div100(uint32_t value) {
+	return ((uint64_t) value * 0x51eb851f) >> 37;
+}
+
+static inline uint64_t _div10_64(uint64_t value) {
+	uint64_t quotient = (value >> 1) + (value >> 2);
 
-#define write_neg_padding() \
-	if(flags & SPRINTF_NEGFIELD_FLAG) \
-	{ \
-		for(x = 0; x < pad_quantity; x++) \
-			put_in_string(string, ssz, ' ', string_pos++);\
+	quotient += quotient >> 4;
+	quotient += quotient >> 8;
+	quotient += quotient >> 16;
+	quotient += quotient >> 32;
+	quotient >>= 3;
+
+	// The estimate above may be off by one, fix it up using the remainder.
+	uint32_t remainder = value - ((quotient << 3) + (quotient << 1));
+
+	return quotient + (remainder > 9);
+}
+
+// Writes the digits of the given value backwards from the end of the buffer
+// and returns a pointer to the first digit.
+static char *_convert_decimal(char *end, uint64_t value) {
+	while (value >> 32) {
+		uint64_t quotient = _div10_64(value);
+
+		*(--end) = '0' + (uint32_t) (value - ((quotient << 3) + (quotient << 1)));
+		value    = quotient;
 	}
 
-// sprintf macros END
-
-enum
-{
-	SPRINTF_SIZE_CHAR,
-	SPRINTF_SIZE_SHORT,
-	SPRINTF_SIZE_INT,
-	SPRINTF_SIZE_LONG,
-	SPRINTF_SIZE_LONG_LONG,
-};
-
-unsigned int get_arg_in_size(int size, unsigned long *arg, unsigned int check_sign)
-{
-	int s = 0;
-
-	switch(size)
-	{
-		case SPRINTF_SIZE_CHAR:
-			*arg &= 0xff;
-			
-			if(check_sign)
-			{
-				if(*arg & (1<<7))
-				{
-					*arg |= 0xffffff00;
-					*arg = ~(*arg - 1);
-					s = 1;
-				}
-			}
-		break;
-		case SPRINTF_SIZE_SHORT:
-			*arg &= 0xffff;
-			
-			if(check_sign)
-			{
-				if(*arg & (1<<15))
-				{
-					*arg |= 0xffff0000;
-					*arg = ~(*arg - 1);
-					s = 1;
-				}
-			}
-		break;
+	uint32_t low = value;
 
-// sizeof(long) == sizeof(int) on 32bit, so this will suffice for the psx
+	while (low >= 100) {
+		uint32_t    quotient = _div100(low);
+		const char *pair     = &_digit_pairs[(low - quotient * 100) * 2];
 
-		case SPRINTF_SIZE_INT:
-		case SPRINTF_SIZE_LONG:
-			*arg &= 0xffffffff;
+		end   -= 2;
+		end[0] = pair[0];
+		end[1] = pair[1];
+		low    = quotient;
+	}
 
-			if(check_sign)
-			{
-				if(*arg & (1<<31))
-				{
-					//*arg |= (long long)0xffffffff00000000;
-					*arg = ~(*arg - 1);
-					s = 1;
-				}
-			}
-		break;
+	if (low >= 10) {
+		end   -= 2;
+		end[0] = _digit_pairs[low * 2];
+		end[1] = _digit_pairs[low * 2 + 1];
+	} else {
+		*(--end) = '0' + low;
+	}
 
-		/*case SPRINTF_SIZE_LONG_LONG:
-			if(check_sign)
-			{
-				if(*arg & ((long long)1<<63))
-				{
-					*arg = ~(*arg - 1);
-					s = 1;
-				}
-			}
-		break;*/
+	return end;
+}
+
+static char *_convert_pow2(char *end, uint64_t value, int shift, const char *digits) {
+	uint32_t mask = (1 << shift) - 1;
+
+	while (value >> 32) {
+		*(--end) = digits[(uint32_t) value & mask];
+		value  >>= shift;
 	}
-	
-	return s;
-}	
-
-int put_in_string(char *string, unsigned int sz, char c, int pos)
-{
-	if(pos>=sz)
-		return 0;
-	else
-		string[pos] = c;
-		
-	return 1;
+
+	uint32_t low = value;
+
+	do {
+		*(--end) = digits[low & mask];
+		low    >>= shift;
+	} while (low);
+
+	return end;
 }
 
-int libc_ulltoa(unsigned long i, char *dst, int n)
-{
-	int x, y;
-	unsigned long a, b;
-	int empty_digit = 1;
-	int sp=0;
-	int n2=0;
-
-	for(x=20;x>=0;x--)
-	{
-		a = 1;
-		for(y = 0; y<x; y++)
-			a *= 10;
-
-		b = (i/a);
-					
-		if(b>=1)
-			empty_digit = 0;
-						
-		if(empty_digit == 0 || x == 0)
-		{	
-			i -= b*a;
-						
-			//put_in_string(string, ssz, b + '0', string_pos++);
-			if(n2!=n)
-			{
-				//printf("n2=%d\n",n2);
-				dst[sp++] = b + '0';
-				n2++;
-			}
-		}
+static void _format_int(
+	Output     *out,
+	uint64_t   value,
+	const char *prefix,
+	int        base,
+	int        flags,
+	int        width,
+	int        precision
+) {
+	char buffer[BUFFER_SIZE];
+	char *end = &buffer[BUFFER_SIZE];
+	char *digits;
+
+	if (!(flags & FLAG_PRECISION))
+		precision = 1;
+	else
+		flags &= ~FLAG_ZERO;
+
+	// As per the standard, a zero value with zero precision results in no
+	// digits being printed.
+	if (!value && !precision) {
+		digits = end;
+	} else if (base == 10) {
+		digits = _convert_decimal(end, value);
+	} else {
+		digits = _convert_pow2(
+			end,
+			value,
+			(base == 16) ? 4 : ((base == 8) ? 3 : 1),
+			(flags & FLAG_UPPER) ? _upper_digits : _lower_digits
+		);
 	}
 
-	if(n2!=n)dst[sp] = 0;
+	int length = end - digits;
+
+	// The alternate form of octal numbers forces a leading zero.
+	if ((base == 8) && (flags & FLAG_ALT) && (!length || (*digits != '0')))
+		precision = (precision > length) ? precision : (length + 1);
+
+	int zeros   = (precision > length) ? (precision - length) : 0;
+	int padding = width - (strlen(prefix) + zeros + length);
+
+	if ((flags & FLAG_ZERO) && (padding > 0)) {
+		zeros  += padding;
+		padding = 0;
+	}
+
+	if (!(flags & FLAG_LEFT))
+		_pad(out, _spaces, padding);
+
+	_output(out, prefix, strlen(prefix));
+	_pad(out, _zeros, zeros);
+	_output(out, digits, length);
 
-	return n2;
+	if (flags & FLAG_LEFT)
+		_pad(out, _spaces, padding);
 }
 
+static void _format_string(
+	Output     *out,
+	const char *str,
+	int        length,
+	int        flags,
+	int        width
+) {
+	if (!(flags & FLAG_LEFT))
+		_pad(out, _spaces, width - length);
+
+	_output(out, str, length);
+
+	if (flags & FLAG_LEFT)
+		_pad(out, _spaces, width - length);
+}
+
+/* Float conversion */
+
 #ifdef ALLOW_FLOAT
 
-void libc_float_to_string(float fl, char *dst, int n)
-{
-	unsigned int *p = (unsigned int*)&fl;
-	unsigned long long i = 0;
-	unsigned long long f = 0;
-	int e, m, s;
-	int x, y;
-	unsigned long long z;
-	
-	s = *p >> 31;
-
-	e = 	(*p >> 23) & 0xff;
-
-	m = *p & 0x7fffff;
-
-	if(e == 255 && m == 0) // Infinity
-	{
-		if(s) strncpy(dst, "-inf", n);
-		else strncpy(dst, "inf", n);
-	}else if(e == 255 && m != 0) // NaN
-	{
-		strncpy(dst, "nan", n);
+static void _format_float(
+	Output     *out,
+	double     value,
+	const char *prefix,
+	int        flags,
+	int        width,
+	int        precision
+) {
+	char buffer[24], fraction_buffer[24];
+	char *end            = &buffer[24];
+	int  fraction_length = 0;
+
+	if (!(flags & FLAG_PRECISION))
+		precision = 6;
+	if (precision > 20)
+		precision = 20;
+
+	if (value != value) {
+		_format_string(out, "nan", 3, flags, width);
+		return;
 	}
-	else
-	{
-		e -= 127;
-		m |= 1<<23;
 
+	// Scale down values that would not fit in a 64-bit integer (the digits
+	// lost this way are printed as zeros, as doubles are not that precise
+	// anyway).
+	int scale = 0;
+	for (; value >= 1.0e19; scale++) {
+		if (scale >= 309) {
+			_format_string(out, "inf", 3, flags, width);
+			return;
+		}
 
+		value /= 10.0;
+	}
 
-		for(x = 23; x >= 0; x--)
-		{
-			if(m & (1<<x))
-			{
-				if(e >= 0)
-				{
-					z = 1;
-					for(y=0;y<e;y++)
-						z*=2;
-			
-					i+=z;
-				}
-				else
-				{
-					z = 5000000000000000000;
-					for(y = 1; y < -e; y++) 
-						z /= 2;
+	// The fractional part is converted to 0.64 fixed point, which is exact for
+	// all but the smallest values, and its digits are extracted using integer
+	// multiplications by 10 so no rounding errors can accumulate.
+	uint64_t integer  = (uint64_t) value;
+	uint64_t fraction = (uint64_t) ((value - (double) integer) * 18446744073709551616.0);
 
-					f+=z;
-				}
-			}
-			e--;
-		}
+	if (precision || (flags & FLAG_ALT))
+		fraction_buffer[fraction_length++] = '.';
 
-		if(s && n)
-		{
-			*(dst++) = '-';
-			n--;
-		}
+	for (int i = 0; i < precision; i++) {
+		uint64_t low  = (uint64_t) (uint32_t) fraction * 10;
+		uint64_t high = (fraction >> 32) * 10 + (low >> 32);
 
-		x = libc_ulltoa(i, dst, n);
-		n-=x;
-		dst+=x;
-
-		if(n)
-		{
-			*(dst++) = '.';
-			n--;
-			if(n)
-			{
-				x = libc_ulltoa(f, dst, n<6?n:6);
-				n-=x;
-				dst+=x;
-
-				if(n)
-					*dst=0;
-			}
-		}
+		fraction = (high << 32) | (low & 0xffffffff);
+		fraction_buffer[fraction_length++] = '0' + (high >> 32);
 	}
-}
 
-void libc_double_to_string(double fl, char *dst, int n)
-{
-	unsigned long long *p = (unsigned long long *)&fl;
-	unsigned long long i = 0;
-	unsigned long long f = 0;
-	unsigned long long m, s;
-	long long e;
-	int x, y;
-	unsigned long long z;
-	
-	s = *p >> 63;
-
-	e = 	(*p >> 52) & 0x7ff;
-	//printf("%d\n", e);
-
-	m = *p & 0xfffffffffffff;
-
-	for(x=0;x<52;x++)
-		if(m&((unsigned long long)1<<(52-x))) putchar('1'); else putchar('0');	
-
-	if(e == 255 && m == 0) // Infinity
-	{
-		if(s) strncpy(dst, "-inf", n);
-		else strncpy(dst, "inf", n);
-	}else if(e == 255 && m != 0) // NaN
-	{
-		strncpy(dst, "nan", n);
+	// Round the last digit half to even, as glibc does, propagating the carry
+	// into the integer part if needed.
+	int last = precision ? (fraction_buffer[fraction_length - 1] - '0') : (int) (integer & 1);
+
+	if (
+		(fraction > 0x8000000000000000ULL) ||
+		((fraction == 0x8000000000000000ULL) && (last & 1))
+	) {
+		int i = fraction_length - 1;
+
+		for (; (i >= 0) && (fraction_buffer[i] == '9'); i--)
+			fraction_buffer[i] = '0';
+
+		if ((i >= 0) && (fraction_buffer[i] != '.'))
+			fraction_buffer[i]++;
+		else
+			integer++;
 	}
-	else
-	{
-		e -= 1023;
-		m |= (unsigned long long)1<<52;
-
-		for(x = 52; x >= 0; x--)
-		{
-			if(m & ((unsigned long long)1<<x))
-			{
-				if(e >= 0)
-				{
-					z = (long long)1<<e;
-			
-					i+=z;
-				}
-				else
-				{
-					z = 5000000000000000000;
-					z >>= -(e + 1);
 
-					f+=z;
-				}
-			}
-			e--;
+	char *digits = _convert_decimal(end, integer);
+
+	int length  = end - digits;
+	int padding = width - (strlen(prefix) + length + scale + fraction_length);
+
+	if (!(flags & (FLAG_LEFT | FLAG_ZERO)))
+		_pad(out, _spaces, padding);
+
+	_output(out, prefix, strlen(prefix));
+
+	if (flags & FLAG_ZERO)
+		_pad(out, _zeros, padding);
+
+	_output(out, digits, length);
+	_pad(out, _zeros, scale);
+	_output(out, fraction_buffer, fraction_length);
+
+	if (flags & FLAG_LEFT)
+		_pad(out, _spaces, padding);
+}
+
+#endif
+
+/* Format string parser */
+
+static int _parse_int(const char **fmt) {
+	int value = 0;
+
+	for (; (**fmt >= '0') && (**fmt <= '9'); (*fmt)++)
+		value = value * 10 + (**fmt - '0');
+
+	return value;
+}
+
+int vcbprintf(printf_sink_t sink, void *arg, const char *fmt, va_list ap) {
+	Output out;
+
+	out.sink   = sink;
+	out.arg    = arg;
+	out.length = 0;
+
+	for (;;) {
+		// Output any text up to the next conversion in a single call.
+		const char *start = fmt;
+
+		while (*fmt && (*fmt != '%'))
+			fmt++;
+
+		_output(&out, start, fmt - start);
+
+		if (!*(fmt++))
+			break;
+
+		int flags = 0, width = 0, precision = 0;
+
+		for (;; fmt++) {
+			if (*fmt == '-')
+				flags |= FLAG_LEFT;
+			else if (*fmt == '+')
+				flags |= FLAG_PLUS;
+			else if (*fmt == ' ')
+				flags |= FLAG_SPACE;
+			else if (*fmt == '#')
+				flags |= FLAG_ALT;
+			else if (*fmt == '0')
+				flags |= FLAG_ZERO;
+			else
+				break;
 		}
 
-		if(s && n)
-		{
-			*(dst++) = '-';
-			n--;
+		if (*fmt == '*') {
+			width = va_arg(ap, int);
+			fmt++;
+
+			if (width < 0) {
+				flags |= FLAG_LEFT;
+				width  = -width;
+			}
+		} else {
+			width = _parse_int(&fmt);
 		}
 
-		x = libc_ulltoa(i, dst, n);
-		n-=x;
-		dst+=x;
+		if (*fmt == '.') {
+			fmt++;
+
+			if (*fmt == '*') {
+				precision = va_arg(ap, int);
+				fmt++;
+			} else {
+				precision = _parse_int(&fmt);
+			}
 
-		if(n)
-		{
-			*(dst++) = '.';
-			n--;
-			if(n)
-				libc_ulltoa(f, dst, n<6?n:6);
+			if (precision >= 0)
+				flags |= FLAG_PRECISION;
 		}
-	}
-}
 
-char libc_sprintf_floatbuf[64];
+		if (flags & FLAG_LEFT)
+			flags &= ~FLAG_ZERO;
 
-#endif
+		// long, size_t, ptrdiff_t and intmax_t are all 32 bits wide.
+		ArgSize size = SIZE_INT;
 
-int vsnprintf(char *string, unsigned int size, const char *fmt, va_list ap)
-{
-	int string_pos,fmt_pos;
-	int l;
-	unsigned long arg;
-	unsigned char *argcp;
-	unsigned char *argcp_tmp;
-	int directive_coming = 0;
-	int alternate_form = 0;
-	int flags = 0;
-	int argsize = 2; // int
-	int x, y;
-	unsigned long a, b;
-	int empty_digit;
-	int ssz = size - 1;
-	int zero_flag_imp = 0;
-	int pad_quantity = 0;
-	int last;
-	
-	l = strlen(fmt);
-	
-	string_pos = 0;
-	
-	for(fmt_pos=0;fmt_pos<l;fmt_pos++)
-	{
-		if(directive_coming)
-		{
-			switch(fmt[fmt_pos])
-			{
-				case '%':
-					put_in_string(string, ssz, '%', string_pos++);
-					directive_coming = 0;
-				break;
-				case ' ':
-					flags |= SPRINTF_SPACE_FLAG;
-				break;
-				case '#': // Specify alternate form
-					flags |= SPRINTF_ALT_FLAG;
-				break;
-				case '+': // Specify sign in signed conversions
-					flags |= SPRINTF_SIGN_FLAG;
-				break;
-				case '0': // Padding with zeros...
-					if(zero_flag_imp == 0)
-					{
-						flags |= SPRINTF_ZERO_FLAG;
-						zero_flag_imp = 1;
-						//printf("Zero padding enabled!\n"); 
-					}
-					else
-					{
-						pad_quantity *= 10;
-						//printf("pad_quantity = %d\n", pad_quantity);
-					}	
-				break;
-				case '1' ... '9': // '...' cases are a GNU extension,
-				                  // but they simplify a lot 
-				                  
-				        pad_quantity *= 10;
-				        pad_quantity += fmt[fmt_pos] - '0';
-				        zero_flag_imp = 1;
-				        
-				        //printf("pad_quantity = %d\n", pad_quantity);
-				break;
-				case '-': // Negative field flag
-					if(flags & SPRINTF_ZERO_FLAG)
-						flags &= ~SPRINTF_ZERO_FLAG;
-				
-					flags |= SPRINTF_NEGFIELD_FLAG;
-				break;
-				case 'h': // Half argument size
-					if(argsize) argsize--;
-				break;
-				case 'l': // Double argument size
-					if(argsize < 2) argsize = 2;
-					//else if(argsize < SPRINTF_SIZE_LONG_LONG) argsize++;
-				break;
-				case 'd': // signed decimal
-				case 'i':
-					empty_digit = 1;
-				
-					//printf("argsize = %d\n", argsize);
-
-					//if(argsize < SPRINTF_SIZE_LONG_LONG)
-					arg = (unsigned long)va_arg(ap, unsigned long);
-					//else
-					//	arg = va_arg(ap, unsigned long);
-
-					if(get_arg_in_size(argsize, &arg, 1))
-					{
-						put_in_string(string, ssz, '-', string_pos++);
-						pad_quantity--;
-					}
-					else
-					{
-						if(flags & SPRINTF_SIGN_FLAG)
-						{
-							put_in_string(string, ssz, '+', string_pos++);
-							pad_quantity--;
-						}
-					}
-				
-					/* Calculate how much padding we have to write */
-					
-					/*y = 1;
-					
-					for(x=0;x<=9;x++)
-					{
-						if(x == 0)
-							pad_quantity--;
-						else
-						{
-							if(arg / y)
-								pad_quantity--;
-						}
-						
-						y *= 10;
-					}
-					if(pad_quantity < 0) pad_quantity = 0;*/
-
-					calculate_real_padding();
-					
-					//printf("Actual pad quantity = %d\n", pad_quantity);
-					
-					
-
-					/*if(!(flags & SPRINTF_NEGFIELD_FLAG))
-					{
-						for(x = 0; x < pad_quantity; x++)
-						{
-							if(flags & SPRINTF_ZERO_FLAG)
-								put_in_string(string, ssz, '0', string_pos++);
-							else
-								put_in_string(string, ssz, ' ', string_pos++);
-						}
-					}*/
-				
-					write_padding();
-
-					for(x=19;x>=0;x--)
-					{
-						a = 1;
-						for(y = 0; y<x; y++)
-							a *= 10;
-							
-						b = (arg/a);
-						
-						if(b>=1)
-							empty_digit = 0;
-						
-						if(empty_digit == 0 || x == 0)
-						{	
-							arg -= b*a;
-						
-							put_in_string(string, ssz, b + '0', string_pos++);
-						}
-					}
-					
-					/*if(flags & SPRINTF_NEGFIELD_FLAG)
-					{
-						for(x = 0; x < pad_quantity; x++)
-								put_in_string(string, ssz, ' ', string_pos++);
-					}*/
-					write_neg_padding();
-					
-					directive_coming = 0;
+		for (;; fmt++) {
+			if (*fmt == 'h')
+				size = (size == SIZE_SHORT) ? SIZE_CHAR : SIZE_SHORT;
+			else if (*fmt == 'l')
+				size = (size == SIZE_LONG) ? SIZE_LONG_LONG : SIZE_LONG;
+			else if ((*fmt != 'z') && (*fmt != 't') && (*fmt != 'j') && (*fmt != 'L'))
 				break;
-				case 'u': // unsigned decimal
-					empty_digit = 1;
-				
-					//if(argsize < SPRINTF_SIZE_LONG_LONG)
-					arg = (unsigned long)va_arg(ap, unsigned int);
-					//else
-					//arg = va_arg(ap, unsigned long long);
-				
-					get_arg_in_size(argsize, &arg, 0);
-				
-					calculate_real_padding();
-					write_padding();
-
-					for(x=19;x>=0;x--)
-					{
-						a = 1;
-						for(y = 0; y<x; y++)
-							a *= 10;
-						
-						
-							
-						b = (arg/a);
-						
-						if(b>=1)
-							empty_digit = 0;
-						
-						if(empty_digit == 0 || x == 0)
-						{	
-							arg -= b*a;
-						
-							put_in_string(string, ssz, b + '0', string_pos++);
-						}
-					}
-					
-					write_neg_padding();
-
-					directive_coming = 0;
-				break;		
-				case 'x': // Hexadecimal
-				case 'X': // Hexadecimal with big letters
-				case 'p': // Hexadecimal with small letters with '0x' prefix
-					empty_digit = 1;
-
-					//if(argsize < SPRINTF_SIZE_LONG_LONG)
-					arg = (unsigned long)va_arg(ap, unsigned int);
-					//else
-					//	arg = va_arg(ap, unsigned long int);
-
-					get_arg_in_size(argsize, &arg, 0);
-				
-					if(fmt_pos == 'p')
-						flags |= SPRINTF_ALT_FLAG;
-				
-					if(flags & SPRINTF_ALT_FLAG)
-					{
-						put_in_string(string, ssz, '0', string_pos++);
-						
-						if(fmt[fmt_pos] == 'X')
-							put_in_string(string, ssz, 'X', string_pos++);
-						else
-							put_in_string(string, ssz, 'x', string_pos++);
-					}
-				
-					calculate_real_padding_hex();
-					write_padding();
-
-					for(x=7;x>=0;x--)
-					{
-						y = arg >> (x << 2);
-						y &= 0xf;
-						
-						if(y>=1)
-							empty_digit = 0;
-						
-						if(empty_digit == 0 || x == 0)
-						{
-							if(y>=0 && y<=9)
-								put_in_string(string, ssz, y + '0', string_pos++);
-							else if(y>=0xA && y<=0xF)
-							{
-								if(fmt[fmt_pos] == 'X')
-									put_in_string(string, ssz, (y - 0xa) + 'A', string_pos++);
-								else
-									put_in_string(string, ssz, (y - 0xa) + 'a', string_pos++);
-							}
-						}
-					}
-				
-					write_neg_padding();
+		}
+
+		char       conversion = *(fmt++);
+		uint64_t   value;
+		const char *prefix = "";
+		int        base    = 10;
+
+		switch (conversion) {
+			case 'd':
+			case 'i':
+				if (size == SIZE_LONG_LONG) {
+					value = va_arg(ap, long long);
+				} else {
+					int32_t value32 = va_arg(ap, int);
+
+					if (size == SIZE_SHORT)
+						value32 = (int16_t) value32;
+					else if (size == SIZE_CHAR)
+						value32 = (int8_t) value32;
+
+					value = (int64_t) value32;
+				}
+
+				if ((int64_t) value < 0) {
+					value  = -value;
+					prefix = "-";
+				} else if (flags & FLAG_PLUS) {
+					prefix = "+";
+				} else if (flags & FLAG_SPACE) {
+					prefix = " ";
+				}
 
-					directive_coming = 0;
+				_format_int(&out, value, prefix, 10, flags, width, precision);
 				break;
-				case 'c': // character
-					arg = va_arg(ap, int);
-				
-					put_in_string(string, ssz, arg & 0xff, string_pos++);
-					
-					directive_coming = 0;
+
+			case 'X':
+				flags |= FLAG_UPPER;
+				//fallthrough
+			case 'x':
+				base = 16;
+				goto _unsigned;
+			case 'o':
+				base = 8;
+				goto _unsigned;
+			case '@': // Binary (non-standard)
+				base = 2;
+				//fallthrough
+			case 'u':
+			_unsigned:
+				if (size == SIZE_LONG_LONG) {
+					value = va_arg(ap, unsigned long long);
+				} else {
+					uint32_t value32 = va_arg(ap, unsigned int);
+
+					if (size == SIZE_SHORT)
+						value32 = (uint16_t) value32;
+					else if (size == SIZE_CHAR)
+						value32 = (uint8_t) value32;
+
+					value = value32;
+				}
+
+				if ((base == 16) && (flags & FLAG_ALT) && value)
+					prefix = (flags & FLAG_UPPER) ? "0X" : "0x";
+
+				_format_int(&out, value, prefix, base, flags, width, precision);
 				break;
-				case 's': // string
-					argcp = va_arg(ap, char *);
-					argcp_tmp = argcp;
-				
-					if(argcp == NULL)
-					{
-						// Non standard extension, but supported by Linux and the BSDs.
-					
-						put_in_string(string, ssz, '(', string_pos++);
-						put_in_string(string, ssz, 'n', string_pos++);
-						put_in_string(string, ssz, 'u', string_pos++);
-						put_in_string(string, ssz, 'l', string_pos++);
-						put_in_string(string, ssz, 'l', string_pos++);
-						put_in_string(string, ssz, ')', string_pos++);
-						
-						directive_coming = 0;
-						break;
-					}
-				
-					while(*argcp_tmp)
-					{
-						if(pad_quantity > 0) pad_quantity--;
-						argcp_tmp++;
-					}
-					
-					if(!(flags & SPRINTF_NEGFIELD_FLAG))
-					{
-						while(pad_quantity > 0)
-						{
-							put_in_string(string,ssz, ' ', string_pos++);
-							pad_quantity--;
-						}
-					}
-					
-					while(*argcp)
-					{
-						put_in_string(string, ssz, *argcp, string_pos++);
-						argcp++;
-					}
-					
-					if(flags & SPRINTF_NEGFIELD_FLAG)
-					{
-						while(pad_quantity > 0)
-						{
-							put_in_string(string,ssz, ' ', string_pos++);
-							pad_quantity--;
-						}
-					}
-						
-					directive_coming = 0;
+
+			case 'p':
+				value = (uint32_t) va_arg(ap, void *);
+
+				_format_int(&out, value, "0x", 16, flags, width, precision);
 				break;
-				case 'o': // Octal
-					empty_digit = 1;
-					
-					//if(argsize < SPRINTF_SIZE_LONG_LONG)
-					arg = (unsigned long)va_arg(ap, unsigned int);
-					//else
-					//	arg = va_arg(ap, unsigned long long);
-				
-					for(x=21;x>=0;x--)
-					{
-						y = arg >> (x * 3);
-						y &= 0x7;
-						
-						if(y>=1)
-							empty_digit = 0;
-						
-						if(empty_digit == 0 || x == 0)
-							put_in_string(string, ssz, y + '0', string_pos++);	
-					}
-				
-					directive_coming = 0;
+
+			case 'c':
+				{
+					char chr = va_arg(ap, int);
+
+					_format_string(&out, &chr, 1, flags, width);
+				}
 				break;
-				case '@': // Binary
-					empty_digit = 1;
-					
-					//if(argsize < SPRINTF_SIZE_LONG_LONG)
-					arg = (unsigned long)va_arg(ap, unsigned int);
-					//else
-					//	arg = va_arg(ap, unsigned long long);
-				
-					calculate_real_padding_bin();
-					write_padding();
-
-					for(x=31;x>=0;x--)
-					{
-						y = (arg >> x);
-						y &= 1;
-						
-						if(y>=1)
-							empty_digit = 0;
-						
-						if(empty_digit == 0 || x == 0)
-							put_in_string(string, ssz, y + '0', string_pos++);	
+
+			case 's':
+				{
+					const char *str = va_arg(ap, const char *);
+					int        length;
+
+					// Printing "(null)" is not standard, but is also done by
+					// most other C libraries.
+					if (!str)
+						str = "(null)";
+
+					if (flags & FLAG_PRECISION) {
+						const char *end = memchr((void *) str, 0, precision);
+						length          = end ? (end - str) : precision;
+					} else {
+						length = strlen(str);
 					}
-				
-					write_neg_padding();
-				
-					directive_coming = 0;
+
+					_format_string(&out, str, length, flags, width);
+				}
 				break;
 
 #ifdef ALLOW_FLOAT
-				case 'f':
-					libc_double_to_string(va_arg(ap, double), libc_sprintf_floatbuf, 64);
-					
-					for(x=0;libc_sprintf_floatbuf[x]!=0;x++)
-						put_in_string(string, ssz, libc_sprintf_floatbuf[x], string_pos++);
+			case 'F':
+			case 'f':
+				{
+					double fvalue = va_arg(ap, double);
+
+					// Check the sign bit rather than comparing against zero
+					// so that -0.0 (and values rounded to it) keep their sign.
+					if (__builtin_signbit(fvalue)) {
+						fvalue = -fvalue;
+						prefix = "-";
+					} else if (flags & FLAG_PLUS) {
+						prefix = "+";
+					} else if (flags & FLAG_SPACE) {
+						prefix = " ";
+					}
 
-					directive_coming = 0;
+					_format_float(&out, fvalue, prefix, flags, width, precision);
+				}
 				break;
 #endif
 
-				case 'n': // Number of characters written
-					*(va_arg(ap,unsigned int*)) = string_pos;
-					
-					directive_coming = 0;
+			case 'n':
+				*va_arg(ap, int *) = out.length;
+				break;
+
+			case '%':
+				_output(&out, "%", 1);
+				break;
+
+			case 0:
+				// Stop at a truncated conversion rather than reading past the
+				// end of the format string.
+				return out.length;
+
+			default:
+				// Unknown conversions are printed as-is.
+				_output(&out, &fmt[-1], 1);
 				break;
-			//	default
-			}
 		}
-		else
-		{
-			if(fmt[fmt_pos] == '%')
-			{
-				directive_coming = 1;
-				flags = 0;
-				argsize = 2;
-				pad_quantity = 0;
-				zero_flag_imp = 0;
-			}
-			else
-				put_in_string(string, ssz, fmt[fmt_pos], string_pos++);
-		}	
 	}
-	string[string_pos] = 0;
-	return string_pos;	
-}
 
-int vsprintf(char *string, const char *fmt, va_list ap)
-{
-	return vsnprintf(string, 0xffffffff, fmt, ap);
+	return out.length;
 }
 
-int sprintf(char *string, const char *fmt, ...)
-{
-	int r;
-
+int cbprintf(printf_sink_t sink, void *arg, const char *fmt, ...) {
 	va_list ap;
 
 	va_start(ap, fmt);
-
-	r = vsprintf(string, fmt, ap);
-	
+	int length = vcbprintf(sink, arg, fmt, ap);
 	va_end(ap);
-	
-	return r;
+
+	return length;
+}
+
+/* String output */
+
+static void _string_sink(void *arg, const char *str, int length) {
+	StringSink *sink = (StringSink *) arg;
+
+	if (length > sink->remaining)
+		length = sink->remaining;
+
+	if (length == 1)
+		*(sink->ptr) = *str;
+	else
+		memcpy(sink->ptr, str, length);
+
+	sink->ptr       += length;
+	sink->remaining -= length;
 }
 
-int snprintf(char *string, unsigned int size, const char *fmt, ...)
-{
-	int r;
+int vsnprintf(char *string, unsigned int size, const char *fmt, va_list ap) {
+	StringSink sink;
+
+	// Always leave room for the null terminator. As per the standard, the
+	// return value is the length of the whole string even if truncated.
+	sink.ptr       = string;
+	sink.remaining = size ? (size - 1) : 0;
+
+	int length = vcbprintf(&_string_sink, &sink, fmt, ap);
+
+	if (size)
+		*(sink.ptr) = 0;
 
+	return length;
+}
+
+int vsprintf(char *string, const char *fmt, va_list ap) {
+	return vsnprintf(string, 0x7fffffff, fmt, ap);
+}
+
+int sprintf(char *string, const char *fmt, ...) {
 	va_list ap;
 
 	va_start(ap, fmt);
+	int length = vsnprintf(string, 0x7fffffff, fmt, ap);
+	va_end(ap);
 
-	r = vsnprintf(string, size, fmt, ap);
-	
+	return length;
+}
+
+int snprintf(char *string, unsigned int size, const char *fmt, ...) {
+	va_list ap;
+
+	va_start(ap, fmt);
+	int length = vsnprintf(string, size, fmt, ap);
 	va_end(ap);
-	
-	return r;
+
+	return length;
 }
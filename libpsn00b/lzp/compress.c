@@ -1,11 +1,11 @@
 // Based on ilia muraviev's CRUSH compressor program which falls under public domain
 
 #include <string.h>
-#if LZP_USE_MALLOC == TRUE
-#include <stdlib.h>
-#endif
 
 #include "lzconfig.h"
+#if LZP_NO_COMPRESS == FALSE
+#include <stdlib.h>
+#endif
 #include "bit.h"
 #include "lzp.h"
 
@@ -108,12 +108,24 @@ int get_penalty(int a, int b) {
 
 int lzCompress(void* outBuff, const void* inBuff, int inSize, int level) {
 
+	return(lzCompressDict(outBuff, inBuff, inSize, NULL, 0, level));
+
+}
+
+int lzCompressDict(void* outBuff, const void* inBuff, int inSize, const void* dict, int dictSize, int level) {
+
 	#if LZP_USE_MALLOC == FALSE
 	int head[HASH1_SIZE+HASH2_SIZE];
 	int prev[W_SIZE];
 	#else
 	int* head = malloc(4*(HASH1_SIZE+HASH2_SIZE));
 	int* prev = malloc(4*W_SIZE);
+
+	if ((head == NULL) || (prev == NULL)) {
+		free(head);
+		free(prev);
+		return(LZP_ERR_NO_MEMORY);
+	}
 	#endif
 
 
@@ -134,11 +146,41 @@ int lzCompress(void* outBuff, const void* inBuff, int inSize, int level) {
 	int next_p;
 	int max_lazy;
 	int log;
+	int end;
 
+	unsigned char* dictBuff = NULL;
+
+
+	// If a dictionary is given, prepend it to the data so that the matcher can
+	// find strings in it (dictionary strings are indexed but never emitted).
+	if (dictSize > 0) {
+
+		dictBuff = malloc(dictSize+inSize+HASH2_LEN);
+
+		if (dictBuff == NULL) {
+			#if LZP_USE_MALLOC == TRUE
+			free(head);
+			free(prev);
+			#endif
+			return(LZP_ERR_NO_MEMORY);
+		}
+
+		memcpy(dictBuff, dict, dictSize);
+		memcpy(dictBuff+dictSize, inBuff, inSize);
+		memset(dictBuff+dictSize+inSize, 0, HASH2_LEN);
+
+		inPtr = dictBuff;
+
+	} else {
+
+		dictSize = 0;
+		inPtr = (unsigned char*)inBuff;
+
+	}
 
-	inPtr = (unsigned char*)inBuff;
 	outPtr = (unsigned char*)outBuff;
 	outBytes = 0;
+	end = dictSize+inSize;
 
 
 	for (i=0; i<HASH1_SIZE+HASH2_SIZE; ++i)
@@ -155,12 +197,25 @@ int lzCompress(void* outBuff, const void* inBuff, int inSize, int level) {
 	// Put window size value so that the compressed data will be independent of the compression settings
 	put_bits(5, lzHashParam.WindowSize);
 
-	while(p < inSize) {
+	while(p < dictSize) { // Insert dictionary strings
+
+		head[h1] = p;
+		prev[p&W_MASK] = head[h2+HASH1_SIZE];
+		head[h2+HASH1_SIZE] = p;
+
+		++p;
+
+		h1 = update_hash1(h1, inPtr[p+(HASH1_LEN-1)]);
+		h2 = update_hash2(h2, inPtr[p+(HASH2_LEN-1)]);
+
+	}
+
+	while(p < end) {
 
 		len = MIN_MATCH-1;
 		offset = W_SIZE;
 
-		max_match = get_min(MAX_MATCH, inSize-p);
+		max_match = get_min(MAX_MATCH, end-p);
 		limit = get_max(p-W_SIZE, 0);
 
 		if (head[h1] >= limit) {
@@ -324,6 +379,9 @@ int lzCompress(void* outBuff, const void* inBuff, int inSize, int level) {
 	free(prev);
 	#endif
 
+	if (dictBuff)
+		free(dictBuff);
+
 	return(outBytes);
 
 }
@@ -348,6 +406,12 @@ void lzResetHashSizes() {
 
 int lzDecompress(void* outBuff, const void* inBuff, int inSize) {
 
+	return(lzDecompressDict(outBuff, inBuff, inSize, NULL, 0));
+
+}
+
+int lzDecompressDict(void* outBuff, const void* inBuff, int inSize, const void* dict, int dictSize) {
+
 	int p=0;
 	int len;
 	int log;
@@ -385,8 +449,24 @@ int lzDecompress(void* outBuff, const void* inBuff, int inSize) {
 
 			s =~ (log>(windowSize-NUM_SLOTS) ? get_bits(log)+(1<<log) : get_bits(windowSize-(NUM_SLOTS-1)))+p;
 
-			if (s < 0)
-				return(LZP_ERR_DECOMPRESS);
+			if (s < 0) {
+
+				// Copy the part of the match that lies within the
+				// dictionary, then continue from the output
+				if (s < -dictSize)
+					return(LZP_ERR_DECOMPRESS);
+
+				len += MIN_MATCH;
+
+				for(; (s < 0) && len; len--)
+					outPtr[p++] = ((const unsigned char*)dict)[dictSize+(s++)];
+
+				while(len-- != 0)
+					outPtr[p++] = outPtr[s++];
+
+				continue;
+
+			}
 
 			outPtr[p++] = outPtr[s++];
 			outPtr[p++] = outPtr[s++];
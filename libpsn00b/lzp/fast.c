@@ -0,0 +1,367 @@
+// Byte-aligned LZ77 codec (LZ4-style sequence format)
+//
+// Stream layout:
+//   1 byte   LZP_FAST_ID
+//   then a sequence of:
+//     1 byte   token (upper nibble: literal count, lower nibble: match length-4)
+//     n bytes  literal count extension (only if upper nibble is 15)
+//     n bytes  literals
+//     2 bytes  match offset (little endian, 1-65535)
+//     n bytes  match length extension (only if lower nibble is 15)
+//
+// Length extensions are a run of 255 bytes terminated by a byte less than 255,
+// all of which are added to the nibble's value. The last sequence in a stream
+// may end after its literals, in which case it has no offset and match length.
+
+#include <stdint.h>
+#include <string.h>
+
+#include "lzconfig.h"
+#if LZP_NO_COMPRESS == FALSE
+#include <stdlib.h>
+#endif
+
+#include "fast.h"
+#include "lzp.h"
+
+
+#define FAST_W_BITS		16
+#define FAST_W_SIZE		(1<<FAST_W_BITS)
+#define FAST_W_MASK		(FAST_W_SIZE-1)
+#define FAST_MAX_OFFSET	(FAST_W_SIZE-1)
+
+// Reads a length extension (a run of 255 bytes terminated by a smaller byte)
+// and adds it to the given length.
+#define READ_LENGTH(in, len) { \
+	int _c; \
+	do { \
+		_c    = *((in)++); \
+		(len) += _c; \
+	} while(_c == 255); \
+}
+
+
+// Compression
+//
+
+#if LZP_NO_COMPRESS == FALSE
+
+// The fast codec's hash table is sized independently of lzconfig.h's
+// LZP_HASH2_SIZE, which can be as large as 24 bits and would place tens of MB
+// on the stack if LZP_USE_MALLOC is disabled.
+#define FAST_HASH_BITS	14
+#define FAST_HASH_SIZE	(1<<FAST_HASH_BITS)
+
+static uint32_t fast_hash(const uint8_t *ptr) {
+
+	uint32_t value = ptr[0]|(ptr[1]<<8)|(ptr[2]<<16)|((uint32_t)ptr[3]<<24);
+
+	return((value*2654435761u)>>(32-FAST_HASH_BITS));
+
+}
+
+static uint8_t *fast_put_length(uint8_t *out, int len) {
+
+	while(len >= 255) {
+		*(out++) = 255;
+		len -= 255;
+	}
+
+	*(out++) = len;
+
+	return(out);
+
+}
+
+static uint8_t *fast_put_sequence(
+	uint8_t *out, const uint8_t *lit, int litLen, int offset, int matchLen
+) {
+
+	uint8_t *token = out++;
+	int		mlen   = matchLen-FAST_MIN_MATCH;
+
+	*token = ((litLen < 15) ? litLen : 15)<<4;
+	if (litLen >= 15)
+		out = fast_put_length(out, litLen-15);
+
+	memcpy(out, lit, litLen);
+	out += litLen;
+
+	if (!matchLen)
+		return(out);
+
+	*(out++) = offset;
+	*(out++) = offset>>8;
+
+	*token |= (mlen < 15) ? mlen : 15;
+	if (mlen >= 15)
+		out = fast_put_length(out, mlen-15);
+
+	return(out);
+
+}
+
+static int fast_match_len(const uint8_t *a, const uint8_t *b, int max) {
+
+	int i = 0;
+
+	while((i < max) && (a[i] == b[i]))
+		i++;
+
+	return(i);
+
+}
+
+// Finds the longest match for the string at p by walking the hash chain.
+static int fast_find_match(
+	const uint8_t *in, int p, int inSize, const int *head, const int *prev,
+	int chain, int *offset
+) {
+
+	int len   = FAST_MIN_MATCH-1;
+	int limit = (p > FAST_MAX_OFFSET) ? (p-FAST_MAX_OFFSET) : 0;
+	int max   = inSize-p;
+	int s     = head[fast_hash(&in[p])];
+
+	while((chain-- != 0) && (s >= limit)) {
+
+		if (in[s+len] == in[p+len]) {
+
+			int i = fast_match_len(&in[s], &in[p], max);
+
+			if (i > len) {
+				len     = i;
+				*offset = p-s;
+
+				if (len == max)
+					break;
+			}
+
+		}
+
+		s = prev[s&FAST_W_MASK];
+
+	}
+
+	return(len);
+
+}
+
+int lzCompressFast(void* outBuff, const void* inBuff, int inSize, int level) {
+
+	return(lzCompressFastDict(outBuff, inBuff, inSize, NULL, 0, level));
+
+}
+
+int lzCompressFastDict(void* outBuff, const void* inBuff, int inSize, const void* dict, int dictSize, int level) {
+
+	#if LZP_USE_MALLOC == FALSE
+	int head[FAST_HASH_SIZE];
+	int prev[FAST_W_SIZE];
+	#else
+	int* head = malloc(4*FAST_HASH_SIZE);
+	int* prev = malloc(4*FAST_W_SIZE);
+
+	if ((head == NULL) || (prev == NULL)) {
+		free(head);
+		free(prev);
+		return(LZP_ERR_NO_MEMORY);
+	}
+	#endif
+
+	static const int max_chain[] = {1, 16, 256};
+
+	const uint8_t	*in  = (const uint8_t *)inBuff;
+	uint8_t			*out = (uint8_t *)outBuff;
+	uint8_t			*dictBuff = NULL;
+
+	int	p = 0, anchor;
+	int	i, len, offset, nextLen, nextOffset, end, last;
+
+	if (level < LZP_COMPRESS_FAST)
+		level = LZP_COMPRESS_FAST;
+	if (level > LZP_COMPRESS_MAX)
+		level = LZP_COMPRESS_MAX;
+
+	// If a dictionary is given, prepend it to the data so that the matcher can
+	// find strings in it (dictionary strings are indexed but never emitted).
+	if (dictSize > 0) {
+		dictBuff = malloc(dictSize+inSize);
+
+		if (dictBuff == NULL) {
+			#if LZP_USE_MALLOC == TRUE
+			free(head);
+			free(prev);
+			#endif
+			return(LZP_ERR_NO_MEMORY);
+		}
+
+		memcpy(dictBuff, dict, dictSize);
+		memcpy(dictBuff+dictSize, inBuff, inSize);
+
+		in = dictBuff;
+	} else {
+		dictSize = 0;
+	}
+
+	end		= dictSize+inSize;
+	last	= end-FAST_MIN_MATCH;
+	anchor	= dictSize;
+
+	for(i=0; i<FAST_HASH_SIZE; i++)
+		head[i] = -1;
+
+	for(; (p<dictSize) && (p<=last); p++) {
+		uint32_t h = fast_hash(&in[p]);
+
+		prev[p&FAST_W_MASK] = head[h];
+		head[h] = p;
+	}
+	p = dictSize;
+
+	*(out++) = LZP_FAST_ID;
+
+	while(p <= last) {
+
+		len = fast_find_match(
+			in, p, end, head, prev, max_chain[level], &offset
+		);
+
+		// Lazy matching: emit a literal instead if the string at the next
+		// position yields a longer match.
+		if ((level >= 2) && (len >= FAST_MIN_MATCH) && (p < last)) {
+
+			uint32_t h = fast_hash(&in[p]);
+
+			prev[p&FAST_W_MASK] = head[h];
+			head[h] = p;
+
+			nextLen = fast_find_match(
+				in, p+1, end, head, prev, max_chain[level], &nextOffset
+			);
+
+			head[h] = prev[p&FAST_W_MASK];
+
+			if (nextLen > len)
+				len = 0;
+
+		}
+
+		if (len < FAST_MIN_MATCH) {
+			len = 1;
+		} else {
+			out = fast_put_sequence(out, &in[anchor], p-anchor, offset, len);
+			anchor = p+len;
+		}
+
+		for(; len; len--, p++) {
+
+			if (p <= last) {
+				uint32_t h = fast_hash(&in[p]);
+
+				prev[p&FAST_W_MASK] = head[h];
+				head[h] = p;
+			}
+
+		}
+
+	}
+
+	if (anchor < end)
+		out = fast_put_sequence(out, &in[anchor], end-anchor, 0, 0);
+
+	#if LZP_USE_MALLOC == TRUE
+	free(head);
+	free(prev);
+	#endif
+
+	if (dictBuff)
+		free(dictBuff);
+
+	return(out-(uint8_t *)outBuff);
+
+}
+
+#endif // LZP_NO_COMPRESS
+
+
+// Decompression
+//
+
+int lzDecompressFast(void* outBuff, const void* inBuff, int inSize) {
+
+	return(lzDecompressFastDict(outBuff, inBuff, inSize, NULL, 0));
+
+}
+
+int lzDecompressFastDict(void* outBuff, const void* inBuff, int inSize, const void* dict, int dictSize) {
+
+	const uint8_t	*in    = (const uint8_t *)inBuff;
+	const uint8_t	*inEnd = in+inSize;
+	uint8_t			*out   = (uint8_t *)outBuff;
+	const uint8_t	*match;
+	int				token, len, count;
+
+	if (*(in++) != LZP_FAST_ID)
+		return(LZP_ERR_DECOMPRESS);
+
+	while(in < inEnd) {
+
+		token = *(in++);
+
+		// Copy literals
+		len = token>>4;
+		if (len == 15)
+			READ_LENGTH(in, len);
+
+		for(; len>=4; len-=4, in+=4, out+=4)
+			COPY_WORD(out, in);
+		for(; len; len--)
+			*(out++) = *(in++);
+
+		if (in >= inEnd)
+			break;
+
+		// Copy match
+		match = out-(in[0]|(in[1]<<8));
+		in   += 2;
+
+		len = token&15;
+		if (len == 15)
+			READ_LENGTH(in, len);
+		len += FAST_MIN_MATCH;
+
+		// Copy the part of the match that lies within the dictionary (which
+		// never overlaps the output), then continue from the output
+		if (match < (uint8_t *)outBuff) {
+			count = (uint8_t *)outBuff-match;
+			if (count > dictSize)
+				return(LZP_ERR_DECOMPRESS);
+
+			match = ((const uint8_t *)dict)+dictSize-count;
+			if (count > len)
+				count = len;
+
+			len -= count;
+			for(; count>=4; count-=4, match+=4, out+=4)
+				COPY_WORD(out, match);
+			for(; count; count--)
+				*(out++) = *(match++);
+
+			match = (uint8_t *)outBuff;
+		}
+
+		// Whole words can only be copied if the match doesn't overlap the
+		// word being written.
+		if ((out-match) >= 4) {
+			for(; len>=4; len-=4, match+=4, out+=4)
+				COPY_WORD(out, match);
+		}
+		for(; len; len--)
+			*(out++) = *(match++);
+
+	}
+
+	return(out-(uint8_t *)outBuff);
+
+}
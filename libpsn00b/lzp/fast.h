@@ -0,0 +1,21 @@
+#ifndef _LZP_FAST_H
+#define _LZP_FAST_H
+
+#include <stdint.h>
+#include <string.h>
+
+// Shared definitions for the byte-aligned codecs (fast.c and patch.c)
+
+#define FAST_MIN_MATCH	4
+
+// Word copies are done using unaligned loads and stores, which GCC compiles
+// into lwl/lwr and swl/swr pairs on MIPS.
+#ifdef __GNUC__
+typedef struct { uint32_t word; } __attribute__((packed)) _unaligned_word;
+#define COPY_WORD(dst, src) \
+	(((_unaligned_word *)(dst))->word = ((const _unaligned_word *)(src))->word)
+#else
+#define COPY_WORD(dst, src) memcpy((dst), (src), 4)
+#endif
+
+#endif // _LZP_FAST_H
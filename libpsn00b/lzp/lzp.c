@@ -1,7 +1,9 @@
 #include <stdio.h>
 #include <string.h>
 #include <ctype.h>
+#include <stdint.h>
 
+#include "lzconfig.h"
 #include "lzp.h"
 
 
@@ -65,24 +67,152 @@ int lzpFileSize(const LZP_HEAD* lzpack, int fileNum) {
 	return ((LZP_FILE*)(((const char*)lzpack)+sizeof(LZP_HEAD)))[fileNum].fileSize;
 }
 
+// Returns a pointer to the contents of an extension block (placed by lzpack
+// between the file entry table and the first file's data), or NULL if the
+// archive does not have it.
+static const char* find_block(const LZP_HEAD* lzpack, const char* id) {
+
+	const char* ptr;
+	const char* end;
+
+	// The blocks end where the first entry's data begins, so there is nothing
+	// to search (and no entry to read the offset from) in an empty archive.
+	if (lzpack->numFiles == 0)
+		return(NULL);
+
+	ptr = ((const char*)lzpack)+sizeof(LZP_HEAD)+sizeof(LZP_FILE)*lzpack->numFiles;
+	end = ((const char*)lzpack)+((const LZP_FILE*)(lzpack+1))->offset;
+
+	while((ptr+8) <= end) {
+
+		if (strncmp(id, ptr, 4) == 0)
+			return(ptr+4);
+
+		if (strncmp(LZP_MARGIN_ID, ptr, 4) == 0)
+			ptr += 4+4*lzpack->numFiles;
+		else if (strncmp(LZP_DICT_ID, ptr, 4) == 0)
+			ptr += 8+((*((const uint32_t*)(ptr+4))+3)&~3);
+		else
+			break;
+
+	}
+
+	return(NULL);
+
+}
+
+// Decompresses an entry's data, using the appropriate codec for the stream.
+static int unpack_data(void* buff, const LZP_HEAD* lzpack, const LZP_FILE* fileEntry, const uint8_t* packedData) {
+
+	const char*	dict = NULL;
+	int			dictSize = 0;
+	int			packedSize = fileEntry->packedSize;
+
+#if LZP_CRC_CHECK == TRUE
+	// Do a CRC32 check of the compressed data's integrity
+	if (lzCRC32(packedData, packedSize, LZP_CRC32_REMAINDER) != fileEntry->crc)
+		return(LZP_ERR_CRC_MISMATCH);
+#endif
+
+	// Streams compressed using the archive's dictionary are prefixed with an
+	// additional ID byte.
+	if (*packedData == LZP_DICT_STREAM_ID) {
+
+		dict = find_block(lzpack, LZP_DICT_ID);
+		if (!dict)
+			return(LZP_ERR_INVALID_PACK);
+
+		dictSize = *((const uint32_t*)dict);
+		dict += 4;
+
+		packedData++;
+		packedSize--;
+
+	}
+
+	if (*packedData == LZP_FAST_ID)
+		return(lzDecompressFastDict(buff, packedData, packedSize, dict, dictSize));
+
+	return(lzDecompressDict(buff, packedData, packedSize, dict, dictSize));
+
+}
+
 int lzpUnpackFile(void* buff, const LZP_HEAD* lzpack, int fileNum) {
 
 	LZP_FILE*	fileEntry = &((LZP_FILE*)(((const char*)lzpack)+sizeof(LZP_HEAD)))[fileNum];
-	int			unpackedSize;
 
 	// Check ID header
     if (strncmp("LZP", lzpack->id, 3) != 0)
         return(LZP_ERR_INVALID_PACK);
 
-	// Do a CRC16 check of the compressed data's integrity
-	if (lzCRC32(((const char*)lzpack)+fileEntry->offset, fileEntry->packedSize, LZP_CRC32_REMAINDER) != fileEntry->crc)
-		return(LZP_ERR_CRC_MISMATCH);
-
 	// Decompress data to the specified address
-	unpackedSize = lzDecompress(buff, ((const char*)lzpack)+fileEntry->offset, fileEntry->packedSize);
-	if (unpackedSize < 0)
-		return(unpackedSize);
+	return(unpack_data(buff, lzpack, fileEntry, ((const uint8_t*)lzpack)+fileEntry->offset));
+
+}
+
+// Returns the size of the sector-aligned region of the archive containing an
+// entry's compressed data, i.e. the amount of data that has to be loaded.
+static int load_size(const LZP_FILE* fileEntry, int sectorSize) {
+
+	int lead = fileEntry->offset%sectorSize;
+
+	return ((lead+fileEntry->packedSize+sectorSize-1)/sectorSize)*sectorSize;
+
+}
+
+int lzpFileInPlaceSize(const LZP_HEAD* lzpack, int fileNum, int sectorSize) {
+
+	const LZP_FILE*	fileEntry = lzpFileEntry(lzpack, fileNum);
+	const char*		table;
+	int				margin, loadSize, size;
+
+	if (!fileEntry || (sectorSize <= 0) || (sectorSize%4))
+		return 0;
+
+	// Use the margin computed by lzpack if the archive has a margin table,
+	// otherwise fall back to the worst-case margin.
+	table = find_block(lzpack, LZP_MARGIN_ID);
+
+	if (table)
+		margin = ((const uint32_t*)table)[fileNum];
+	else
+		margin = LZP_INPLACE_MARGIN(fileEntry->fileSize);
+
+	// The compressed data must start at least (fileSize+margin-packedSize)
+	// bytes into the buffer. As whole sectors are loaded at the end of the
+	// buffer, any data following the entry in its last sector has to fit as
+	// well; data preceding it in the first sector can overlap the output.
+	loadSize = load_size(fileEntry, sectorSize);
+	size     = fileEntry->fileSize+margin+
+		(loadSize-fileEntry->offset%sectorSize-fileEntry->packedSize);
+
+	if (size < loadSize)
+		size = loadSize;
+
+	return (size+3)&~3;
+
+}
+
+int lzpUnpackFileInPlace(void* buff, int buffSize, const LZP_HEAD* lzpack, int fileNum, int sectorSize) {
+
+	const LZP_FILE*	fileEntry = lzpFileEntry(lzpack, fileNum);
+	int				size = lzpFileInPlaceSize(lzpack, fileNum, sectorSize);
+	const uint8_t*	loadAddr;
+
+	if (!size)
+		return(LZP_ERR_INVALID_PACK);
+
+	// Only whole words are used, so that the load address is aligned.
+	buffSize &= ~3;
+
+	if (buffSize < size)
+		return(LZP_ERR_BUFFER_SIZE);
+
+	// The decompressors only ever read ahead of the output pointer, so data
+	// placed at the end of the buffer (with enough margin) is never
+	// overwritten before being read.
+	loadAddr = ((const uint8_t*)buff)+buffSize-load_size(fileEntry, sectorSize);
 
-	return(unpackedSize);
+	return(unpack_data(buff, lzpack, fileEntry, loadAddr+fileEntry->offset%sectorSize));
 
 }
@@ -44,6 +44,34 @@
 /*!	@}	*/
 
 
+/*!	\addtogroup fastCodec Fast Codec Definitions
+ *	@{
+ */
+//! First byte of any stream produced by lzCompressFast()
+#define LZP_FAST_ID			0x80
+//! Worst-case size of the output of lzCompressFast() for a given input size
+#define LZP_FAST_BOUND(size)	((size)+((size)/255)+16)
+//! First byte of any patch produced by lzCreatePatch()
+#define LZP_PATCH_ID		0xA0
+//! Worst-case size of the output of lzCreatePatch() for a given new file size
+#define LZP_PATCH_BOUND(size)	(LZP_FAST_BOUND(size)+13)
+/*!	@}	*/
+
+
+/*!	\addtogroup inPlace In-place Decompression Definitions
+ *	@{
+ */
+//! ID of the optional margin table lzpack places after the file entry table
+#define LZP_MARGIN_ID			"LZPM"
+//! ID of the optional dictionary block lzpack places after the file entry table
+#define LZP_DICT_ID				"LZPD"
+//! Prefix byte of archive entries compressed using the archive's dictionary
+#define LZP_DICT_STREAM_ID		0xE0
+//! Worst-case in-place decompression margin for data of the given original size
+#define LZP_INPLACE_MARGIN(size)	(((size)>>3)+16)
+/*!	@}	*/
+
+
 /*!	\addtogroup libraryErrorCodes Library Error Codes
  *	@{
  */
@@ -57,6 +85,12 @@
 #define LZP_ERR_NOTFOUND		-3
 //! CRC check mismatch (data corruption)
 #define LZP_ERR_CRC_MISMATCH	-4
+//! Patch was not created against the specified data
+#define LZP_ERR_PATCH_MISMATCH	-5
+//! Buffer too small for in-place decompression
+#define LZP_ERR_BUFFER_SIZE		-6
+//! Failed to allocate memory for the compressor's tables
+#define LZP_ERR_NO_MEMORY		-7
 /*! @} */
 
 
@@ -109,7 +143,8 @@ extern "C" {
  *	\param[in]	inSize		Size of data to compress in bytes.
  *	\param[in]	level		Compression level (see \ref compLevels).
  *
- *	\returns The size of the compressed data in bytes.
+ *	\returns The size of the compressed data in bytes, or LZP_ERR_NO_MEMORY if
+ *	memory could not be allocated.
  */
 int lzCompress(void* outBuff, const void* inBuff, int inSize, int level);
 
@@ -134,6 +169,149 @@ int lzDecompress(void* outBuff, const void* inBuff, int inSize);
 
 int lzDecompressLen(void* outBuff, int outSize, const void* inBuff, int inSize);
 
+/*! Compress a block of data using a preset dictionary.
+ *
+ *	\details Same as lzCompress(), but the sliding window is pre-filled with
+ *	the specified dictionary so that strings found in it can be referenced
+ *	from the very beginning of the data. This greatly improves the ratio of
+ *	small blocks sharing content with the dictionary. The data must be
+ *	decompressed using lzDecompressDict() with the same dictionary.
+ *
+ *	\param[out]	*outBuff	Pointer to buffer to store compressed data.
+ *	\param[in]	*inBuff		Pointer to data to compress.
+ *	\param[in]	inSize		Size of data to compress in bytes.
+ *	\param[in]	*dict		Pointer to dictionary (may be NULL).
+ *	\param[in]	dictSize	Size of dictionary in bytes.
+ *	\param[in]	level		Compression level (see \ref compLevels).
+ *
+ *	\returns The size of the compressed data in bytes, or LZP_ERR_NO_MEMORY if
+ *	memory could not be allocated.
+ */
+int lzCompressDict(void* outBuff, const void* inBuff, int inSize, const void* dict, int dictSize, int level);
+
+/*! Decompress a block of data compressed with lzCompressDict().
+ *
+ *	\param[out]	*outBuff	Pointer to buffer to store decompressed data.
+ *	\param[in]	*inBuff		Pointer to compressed data to decompress.
+ *	\param[in]	inSize		Compressed data size in bytes.
+ *	\param[in]	*dict		Pointer to dictionary (may be NULL).
+ *	\param[in]	dictSize	Size of dictionary in bytes.
+ *
+ *	\returns Size of decompressed data in bytes or LZP_ERR_DECOMPRESS if a
+ *	decompression error occurred.
+ */
+int lzDecompressDict(void* outBuff, const void* inBuff, int inSize, const void* dict, int dictSize);
+
+/*! Compress a block of data using the fast byte-aligned codec.
+ *
+ *	\details Compresses a block of data into a byte-aligned LZ77 stream, which
+ *	typically compresses 10-15% worse than lzCompress() but does not require
+ *	any bit I/O to decompress, making lzDecompressFast() several times faster
+ *	than lzDecompress(). The output buffer must be at least
+ *	LZP_FAST_BOUND(inSize) bytes long.
+ *
+ *	\param[out]	*outBuff	Pointer to buffer to store compressed data.
+ *	\param[in]	*inBuff		Pointer to data to compress.
+ *	\param[in]	inSize		Size of data to compress in bytes.
+ *	\param[in]	level		Compression level (see \ref compLevels), clamped to
+ *							the valid range.
+ *
+ *	\returns The size of the compressed data in bytes, or LZP_ERR_NO_MEMORY if
+ *	memory could not be allocated.
+ */
+int lzCompressFast(void* outBuff, const void* inBuff, int inSize, int level);
+
+/*! Decompress a block of data compressed with lzCompressFast().
+ *
+ *	\param[out]	*outBuff	Pointer to buffer to store decompressed data.
+ *	\param[in]	*inBuff		Pointer to compressed data to decompress.
+ *	\param[in]	inSize		Compressed data size in bytes.
+ *
+ *	\returns Size of decompressed data in bytes or LZP_ERR_DECOMPRESS if a
+ *	decompression error occurred.
+ */
+int lzDecompressFast(void* outBuff, const void* inBuff, int inSize);
+
+/*! Compress a block of data using the fast codec and a preset dictionary.
+ *
+ *	\details Same as lzCompressFast(), but the window is pre-filled with the
+ *	specified dictionary (see lzCompressDict()). Only the last 64 KB of the
+ *	dictionary can be referenced.
+ *
+ *	\param[out]	*outBuff	Pointer to buffer to store compressed data.
+ *	\param[in]	*inBuff		Pointer to data to compress.
+ *	\param[in]	inSize		Size of data to compress in bytes.
+ *	\param[in]	*dict		Pointer to dictionary (may be NULL).
+ *	\param[in]	dictSize	Size of dictionary in bytes.
+ *	\param[in]	level		Compression level (see \ref compLevels), clamped to
+ *							the valid range.
+ *
+ *	\returns The size of the compressed data in bytes, or LZP_ERR_NO_MEMORY if
+ *	memory could not be allocated.
+ */
+int lzCompressFastDict(void* outBuff, const void* inBuff, int inSize, const void* dict, int dictSize, int level);
+
+/*! Decompress a block of data compressed with lzCompressFastDict().
+ *
+ *	\param[out]	*outBuff	Pointer to buffer to store decompressed data.
+ *	\param[in]	*inBuff		Pointer to compressed data to decompress.
+ *	\param[in]	inSize		Compressed data size in bytes.
+ *	\param[in]	*dict		Pointer to dictionary (may be NULL).
+ *	\param[in]	dictSize	Size of dictionary in bytes.
+ *
+ *	\returns Size of decompressed data in bytes or LZP_ERR_DECOMPRESS if a
+ *	decompression error occurred.
+ */
+int lzDecompressFastDict(void* outBuff, const void* inBuff, int inSize, const void* dict, int dictSize);
+
+/*! Create a binary patch between two versions of a block of data.
+ *
+ *	\details Encodes the new version of the data as a byte-aligned LZ77
+ *	stream which uses the old version as a dictionary, so that regions left
+ *	unchanged (even if moved) take up only a few bytes. The resulting patch
+ *	can be applied to the old data using lzApplyPatch(). The output buffer
+ *	must be at least LZP_PATCH_BOUND(newSize) bytes long.
+ *
+ *	\param[out]	*outBuff	Pointer to buffer to store the patch.
+ *	\param[in]	*oldBuff	Pointer to the old version of the data.
+ *	\param[in]	oldSize		Size of the old version in bytes.
+ *	\param[in]	*newBuff	Pointer to the new version of the data.
+ *	\param[in]	newSize		Size of the new version in bytes.
+ *
+ *	\returns The size of the patch in bytes.
+ */
+int lzCreatePatch(void* outBuff, const void* oldBuff, int oldSize, const void* newBuff, int newSize);
+
+/*! Returns the size of the data produced by applying a patch.
+ *
+ *	\param[in]	*patchBuff	Pointer to patch created by lzCreatePatch().
+ *
+ *	\returns Size of the new version of the data in bytes or
+ *	LZP_ERR_DECOMPRESS if the buffer does not contain a valid patch.
+ */
+int lzPatchSize(const void* patchBuff);
+
+/*! Apply a patch created by lzCreatePatch().
+ *
+ *	\details Rebuilds the new version of the data from the old version and a
+ *	patch. The output buffer must be at least lzPatchSize() bytes long and
+ *	must not overlap the old data.
+ *
+ *	\note The size and CRC32 of the old data are always checked against the
+ *	ones stored in the patch, regardless of the LZP_CRC_CHECK setting.
+ *
+ *	\param[out]	*outBuff	Pointer to buffer to store the new version.
+ *	\param[in]	*oldBuff	Pointer to the old version of the data.
+ *	\param[in]	oldSize		Size of the old version in bytes.
+ *	\param[in]	*patchBuff	Pointer to patch.
+ *	\param[in]	patchSize	Size of the patch in bytes.
+ *
+ *	\returns Size of the new version of the data in bytes, LZP_ERR_DECOMPRESS
+ *	if the patch is corrupted or LZP_ERR_PATCH_MISMATCH if it was not created
+ *	against the specified data.
+ */
+int lzApplyPatch(void* outBuff, const void* oldBuff, int oldSize, const void* patchBuff, int patchSize);
+
 /*! Sets the sizes of hash tables for data compression.
  *
  *	\param[in]	window      Sliding window size.
@@ -208,10 +386,86 @@ const LZP_FILE* lzpFileEntry(const LZP_HEAD* lzpack, int fileNum);
  *	\param[in]	*lzpack	Pointer to LZP archive file.
  *	\param[in]	fileNum	File entry number of file to extract (you may use lzpSearchFile()).
  *
+ *	\details Entries compressed with either lzCompress() or lzCompressFast()
+ *	are supported, the codec is detected automatically.
+ *
+ *	\note The CRC32 of the compressed data is only verified if the library was
+ *	built with LZP_CRC_CHECK enabled (the default for debug builds, see
+ *	lzconfig.h).
+ *
  *	\returns Size of decompressed file in bytes or one of \ref libraryErrorCodes if an error occurred.
  */
 int lzpUnpackFile(void* buff, const LZP_HEAD* lzpack, int fileNum);
 
+/*! Returns the buffer size required to unpack a file in-place.
+ *
+ *	\details Returns the size of the buffer lzpUnpackFileInPlace() needs to
+ *	decompress the specified file over its own compressed data, when the
+ *	compressed data is loaded in units of sectorSize bytes. This is the
+ *	original size of the file plus a safety margin and room for any unrelated
+ *	data loaded along with the file's last sector, rounded up to a multiple
+ *	of 4 bytes. The margin computed by lzpack is used if the archive contains
+ *	one, otherwise LZP_INPLACE_MARGIN() is assumed.
+ *
+ *	Only the beginning of the archive, up to the first file's data (header,
+ *	file entry table and the margin and dictionary blocks following it), needs
+ *	to be loaded in memory.
+ *
+ *	\param[in]	*lzpack		Pointer to LZP archive header.
+ *	\param[in]	fileNum		File entry number.
+ *	\param[in]	sectorSize	Granularity the data is loaded with (2048 for
+ *							CD-ROM sectors, or 4 if it is copied from memory).
+ *							Must be a nonzero multiple of 4.
+ *
+ *	\returns Required buffer size in bytes, or 0 if an error occurred.
+ */
+int lzpFileInPlaceSize(const LZP_HEAD* lzpack, int fileNum, int sectorSize);
+
+/*! Unpacks a file from an LZP archive over its own compressed data.
+ *
+ *	\details Decompresses a file whose compressed data has been loaded at the
+ *	very end of the specified buffer, which must be word-aligned and at least
+ *	as large as the value returned by lzpFileInPlaceSize() for the same
+ *	sectorSize. The decompressed file is written starting from the beginning
+ *	of the buffer, removing the need for a separate buffer to hold the
+ *	compressed data.
+ *
+ *	As DMA transfers (including CdRead()) can only write whole sectors to
+ *	word-aligned addresses, the data is not loaded byte-exact. Instead, all
+ *	sectors of the archive containing the file's compressed data
+ *	(LZP_FILE.packedSize bytes starting at LZP_FILE.offset) must be loaded so
+ *	that the last one ends at the end of the buffer:
+ *
+ *	\code
+ *	const LZP_FILE* entry = lzpFileEntry(lzpack, fileNum);
+ *
+ *	int size  = lzpFileInPlaceSize(lzpack, fileNum, 2048);
+ *	int first = entry->offset / 2048;
+ *	int count = (entry->offset % 2048 + entry->packedSize + 2047) / 2048;
+ *
+ *	uint8_t *buff = malloc(size);
+ *
+ *	CdControl(CdlSetloc, CdIntToPos(archiveLBA + first, &pos), 0);
+ *	CdRead(count, (uint32_t *) &buff[size - count * 2048], CdlModeSpeed);
+ *	CdReadSync(0, 0);
+ *
+ *	lzpUnpackFileInPlace(buff, size, lzpack, fileNum, 2048);
+ *	\endcode
+ *
+ *	The same procedure applies with a sectorSize of 4 when copying the data
+ *	from an archive in memory, i.e. the words containing the file's data are
+ *	copied to the end of the buffer.
+ *
+ *	\param[in]	*buff		Pointer to buffer containing compressed data.
+ *	\param[in]	buffSize	Size of the buffer in bytes.
+ *	\param[in]	*lzpack		Pointer to LZP archive header.
+ *	\param[in]	fileNum		File entry number of file to extract.
+ *	\param[in]	sectorSize	Granularity the data was loaded with.
+ *
+ *	\returns Size of decompressed file in bytes or one of \ref libraryErrorCodes if an error occurred.
+ */
+int lzpUnpackFileInPlace(void* buff, int buffSize, const LZP_HEAD* lzpack, int fileNum, int sectorSize);
+
 /*!	@}	*/
 
 
@@ -0,0 +1,341 @@
+// Binary delta (patch) codec
+//
+// A patch is a byte-aligned LZ77 stream that encodes a new version of a file
+// using the old version as a dictionary. Matches reference a virtual buffer
+// made up of the old file immediately followed by the data decoded so far, so
+// unchanged regions of the old file turn into long matches regardless of how
+// far they moved.
+//
+// Stream layout:
+//   1 byte   LZP_PATCH_ID
+//   4 bytes  size of the old file (little endian)
+//   4 bytes  CRC32 of the old file (little endian)
+//   4 bytes  size of the new file (little endian)
+//   then a sequence of:
+//     1 byte   token (upper nibble: literal count, lower nibble: match length-4)
+//     n bytes  literal count extension (only if upper nibble is 15)
+//     n bytes  literals
+//     n bytes  match offset
+//     n bytes  match length extension (only if lower nibble is 15)
+//
+// Unlike in the fast codec, offsets and length extensions are variable-length
+// integers (7 bits per byte, little endian, bit 7 set on all bytes but the
+// last), as matches spanning most of a file are common in patches.
+
+#include <stdint.h>
+#include <string.h>
+
+#include "lzconfig.h"
+#if LZP_NO_COMPRESS == FALSE
+#include <stdlib.h>
+#endif
+
+#include "fast.h"
+#include "lzp.h"
+
+
+#define PATCH_HEAD_SIZE	13
+
+// Reads a variable-length integer.
+#define READ_VARINT(in, value) { \
+	int _shift = 0; \
+	(value) = 0; \
+	do { \
+		(value) |= (*(in)&0x7f)<<_shift; \
+		_shift  += 7; \
+	} while(*((in)++)&0x80); \
+}
+
+static uint32_t get_word(const uint8_t *ptr) {
+
+	return(ptr[0]|(ptr[1]<<8)|(ptr[2]<<16)|((uint32_t)ptr[3]<<24));
+
+}
+
+
+// Patch creation
+//
+
+#if LZP_NO_COMPRESS == FALSE
+
+#define PATCH_HASH_BITS		20
+#define PATCH_HASH_SIZE		(1<<PATCH_HASH_BITS)
+#define PATCH_MAX_CHAIN		256
+
+static uint32_t patch_hash(const uint8_t *ptr) {
+
+	return((get_word(ptr)*2654435761u)>>(32-PATCH_HASH_BITS));
+
+}
+
+static uint8_t *put_word(uint8_t *out, uint32_t value) {
+
+	*(out++) = value;
+	*(out++) = value>>8;
+	*(out++) = value>>16;
+	*(out++) = value>>24;
+
+	return(out);
+
+}
+
+static int varint_size(uint32_t value) {
+
+	int size = 1;
+
+	while(value >= 0x80) {
+		value >>= 7;
+		size++;
+	}
+
+	return(size);
+
+}
+
+static uint8_t *put_varint(uint8_t *out, uint32_t value) {
+
+	while(value >= 0x80) {
+		*(out++) = value|0x80;
+		value >>= 7;
+	}
+	*(out++) = value;
+
+	return(out);
+
+}
+
+static uint8_t *patch_put_sequence(
+	uint8_t *out, const uint8_t *lit, int litLen, uint32_t offset, int matchLen
+) {
+
+	uint8_t *token = out++;
+	int		mlen   = matchLen-FAST_MIN_MATCH;
+
+	*token = ((litLen < 15) ? litLen : 15)<<4;
+	if (litLen >= 15)
+		out = put_varint(out, litLen-15);
+
+	memcpy(out, lit, litLen);
+	out += litLen;
+
+	if (!matchLen)
+		return(out);
+
+	out = put_varint(out, offset);
+
+	*token |= (mlen < 15) ? mlen : 15;
+	if (mlen >= 15)
+		out = put_varint(out, mlen-15);
+
+	return(out);
+
+}
+
+int lzCreatePatch(
+	void* outBuff, const void* oldBuff, int oldSize, const void* newBuff, int newSize
+) {
+
+	int		total = oldSize+newSize;
+	uint8_t	*buff = malloc(total+FAST_MIN_MATCH);
+	int		*head = malloc(4*PATCH_HASH_SIZE);
+	int		*prev = malloc(4*total);
+	uint8_t	*out  = (uint8_t *)outBuff;
+
+	int		i, p, s, len, matchLen, chain, anchor;
+	int		last = total-FAST_MIN_MATCH;
+	uint32_t offset = 0;
+
+	// Concatenate the old and new files so the matcher can treat the old file
+	// as a dictionary preceding the new one.
+	memcpy(buff, oldBuff, oldSize);
+	memcpy(buff+oldSize, newBuff, newSize);
+
+	for(i=0; i<PATCH_HASH_SIZE; i++)
+		head[i] = -1;
+
+	for(p=0; (p<oldSize) && (p<=last); p++) {
+		uint32_t h = patch_hash(&buff[p]);
+
+		prev[p] = head[h];
+		head[h] = p;
+	}
+
+	*(out++) = LZP_PATCH_ID;
+	out = put_word(out, oldSize);
+	out = put_word(out, lzCRC32(oldBuff, oldSize, LZP_CRC32_REMAINDER));
+	out = put_word(out, newSize);
+
+	p		= oldSize;
+	anchor	= oldSize;
+
+	while(p <= last) {
+
+		// Find the longest match, ignoring matches too short to be worth
+		// encoding with their offset.
+		matchLen	= 0;
+		chain		= PATCH_MAX_CHAIN;
+		s			= head[patch_hash(&buff[p])];
+
+		while((chain-- != 0) && (s >= 0)) {
+
+			if (buff[s+matchLen] == buff[p+matchLen]) {
+
+				for(len=0; (len<(total-p)) && (buff[s+len] == buff[p+len]); len++);
+
+				if (
+					(len > matchLen) &&
+					(len >= FAST_MIN_MATCH) &&
+					(len >= varint_size(p-s)+2)
+				) {
+					matchLen	= len;
+					offset		= p-s;
+
+					if (len == (total-p))
+						break;
+				}
+
+			}
+
+			s = prev[s];
+
+		}
+
+		if (matchLen) {
+			out		= patch_put_sequence(out, &buff[anchor], p-anchor, offset, matchLen);
+			anchor	= p+matchLen;
+		} else {
+			matchLen = 1;
+		}
+
+		for(; matchLen; matchLen--, p++) {
+
+			if (p <= last) {
+				uint32_t h = patch_hash(&buff[p]);
+
+				prev[p] = head[h];
+				head[h] = p;
+			}
+
+		}
+
+	}
+
+	if (anchor < total)
+		out = patch_put_sequence(out, &buff[anchor], total-anchor, 0, 0);
+
+	free(buff);
+	free(head);
+	free(prev);
+
+	return(out-(uint8_t *)outBuff);
+
+}
+
+#endif // LZP_NO_COMPRESS
+
+
+// Patch application
+//
+
+int lzPatchSize(const void* patchBuff) {
+
+	const uint8_t *in = (const uint8_t *)patchBuff;
+
+	if (*in != LZP_PATCH_ID)
+		return(LZP_ERR_DECOMPRESS);
+
+	return(get_word(&in[9]));
+
+}
+
+int lzApplyPatch(
+	void* outBuff, const void* oldBuff, int oldSize, const void* patchBuff, int patchSize
+) {
+
+	const uint8_t	*in    = (const uint8_t *)patchBuff;
+	const uint8_t	*inEnd = in+patchSize;
+	const uint8_t	*old   = (const uint8_t *)oldBuff;
+	uint8_t			*out   = (uint8_t *)outBuff;
+	const uint8_t	*match;
+	uint32_t		offset, ext;
+	int				token, len, pos, count;
+
+	if (*in != LZP_PATCH_ID)
+		return(LZP_ERR_DECOMPRESS);
+	if (get_word(&in[1]) != (uint32_t)oldSize)
+		return(LZP_ERR_PATCH_MISMATCH);
+
+	// Unlike the CRC of LZP archive entries, the CRC of the old data is
+	// always checked as a patch applied to the wrong data of the same size
+	// would otherwise silently produce garbage.
+	if (get_word(&in[5]) != lzCRC32(oldBuff, oldSize, LZP_CRC32_REMAINDER))
+		return(LZP_ERR_PATCH_MISMATCH);
+
+	in += PATCH_HEAD_SIZE;
+
+	while(in < inEnd) {
+
+		token = *(in++);
+
+		// Copy literals
+		len = token>>4;
+		if (len == 15) {
+			READ_VARINT(in, ext);
+			len += ext;
+		}
+
+		for(; len>=4; len-=4, in+=4, out+=4)
+			COPY_WORD(out, in);
+		for(; len; len--)
+			*(out++) = *(in++);
+
+		if (in >= inEnd)
+			break;
+
+		// Decode match offset and length
+		READ_VARINT(in, offset);
+
+		len = token&15;
+		if (len == 15) {
+			READ_VARINT(in, ext);
+			len += ext;
+		}
+		len += FAST_MIN_MATCH;
+
+		// Position of the match in the virtual (old file + output) buffer
+		pos = (out-(uint8_t *)outBuff)+oldSize-(int)offset;
+		if (pos < 0)
+			return(LZP_ERR_DECOMPRESS);
+
+		// Copy the part of the match that lies within the old file, which
+		// never overlaps the output.
+		if (pos < oldSize) {
+			match = &old[pos];
+			count = oldSize-pos;
+			if (count > len)
+				count = len;
+
+			len -= count;
+			for(; count>=4; count-=4, match+=4, out+=4)
+				COPY_WORD(out, match);
+			for(; count; count--)
+				*(out++) = *(match++);
+
+			pos = oldSize;
+		}
+
+		// Copy the rest of the match from the output
+		match = ((uint8_t *)outBuff)+(pos-oldSize);
+
+		if ((out-match) >= 4) {
+			for(; len>=4; len-=4, match+=4, out+=4)
+				COPY_WORD(out, match);
+		}
+		for(; len; len--)
+			*(out++) = *(match++);
+
+	}
+
+	return(out-(uint8_t *)outBuff);
+
+}
@@ -0,0 +1,57 @@
+/*
+ * PSn00bSDK static overlay loader
+ * (C) 2022 PSn00bSDK contributors - MPL licensed
+ *
+ * Overlays are linked by exe.ld to run from a fixed region after the
+ * executable's BSS and extracted by elf2x into separate files, padded to a
+ * whole number of sectors. Loading one is just a matter of reading its file
+ * into the region and flushing the instruction cache; no relocation or symbol
+ * resolution is needed, unlike DLLs.
+ */
+
+#undef  SDK_LIBRARY_NAME
+#define SDK_LIBRARY_NAME "psxcd/ovl"
+
+#include <stdint.h>
+#include <assert.h>
+#include <psxapi.h>
+#include <psxcd.h>
+
+// Defined by the linker script
+extern uint32_t __overlay_start[];
+extern uint32_t __overlay_end[];
+
+int CdLoadOverlay(const char *filename) {
+	CdlFILE  file;
+	uint32_t max_size = (uint32_t) __overlay_end - (uint32_t) __overlay_start;
+
+	if (!CdSearchFile(&file, filename)) {
+		_sdk_log("can't find %s\n", filename);
+		return -1;
+	}
+
+	int sectors = (file.size + 2047) / 2048;
+
+	if ((sectors * 2048) > max_size) {
+		_sdk_log(
+			"%s (%d bytes) doesn't fit in overlay region (%d bytes)\n",
+			filename,
+			file.size,
+			max_size
+		);
+		return -1;
+	}
+
+	CdControl(CdlSetloc, &file.pos, 0);
+	CdRead(sectors, __overlay_start, CdlModeSpeed);
+
+	if (CdReadSync(0, 0) < 0) {
+		_sdk_log("read error while loading %s\n", filename);
+		return -1;
+	}
+
+	// The region may still be in the instruction cache if another overlay was
+	// previously loaded into it.
+	FlushCache();
+	return file.size;
+}
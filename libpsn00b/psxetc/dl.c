@@ -191,51 +191,64 @@ int DL_ParseSymbolMap(const char *ptr, size_t size) {
 		return err;
 
 	// Go again through the symbol map and fill in the hash table by calling
-	// DL_AddMapSymbol() for each valid entry.
+	// DL_AddMapSymbol() for each valid entry. Each line is split into tokens
+	// in-place using strntok() rather than sscanf(), as the map can contain
+	// thousands of entries.
 	entries = 0;
 
-	for (int pos = 0; (pos < size) && ptr[pos]; pos++) {
-		uint64_t full_addr;
-		char     name[64], type_string[4];
-		size_t   _size;
+	const char *end = ptr + size;
+
+	while (ptr < end) {
+		const char *line_end = memchr((void *) ptr, '\n', end - ptr);
+		if (!line_end)
+			line_end = end;
 
 		// e.g. "main T ffffffff80000000 100 ...\n"
-		int parsed = sscanf(
-			&(ptr[pos]),
-			"%63s %1s %Lx %x",
-			name,
-			type_string,
-			&full_addr,
-			&_size // Optional, unused (yet)
-		);
-
-		if (parsed >= 3) {
-			// Drop the upper 32 bits of the address (for some reason MIPS nm
-			// insists on printing 64-bit addresses... wtf) and check if the
-			// entry is valid and non-null.
-			void *addr = (void *) ((uint32_t) full_addr);
-			char _type = toupper(type_string[0]);
-
-			if (addr && (
-				(_type == 'T') || // .text
-				(_type == 'R') || // .rodata
-				(_type == 'D') || // .data
-				(_type == 'B')    // .bss
-			)) {
-				//_sdk_log(
-					//"map sym: %08x,%08x [%c %s]\n",
-					//addr, _size, _type, name
-				//);
+		const char *name, *type, *addr_string;
+		int        name_length = strntok(&ptr, line_end, " \t\r", &name);
+		int        type_length = strntok(&ptr, line_end, " \t\r", &type);
+		int        addr_length = strntok(&ptr, line_end, " \t\r", &addr_string);
+
+		ptr = line_end + 1;
+
+		if (
+			!name_length || (name_length > 63) ||
+			(type_length != 1) ||
+			!addr_length
+		)
+			continue;
 
-				DL_AddMapSymbol(name, addr);
-				entries++;
-			}
+		// Only parse the lower 32 bits of the address (for some reason MIPS nm
+		// insists on printing 64-bit addresses... wtf) and check if the entry
+		// is valid and non-null.
+		if (addr_length > 8) {
+			addr_string += addr_length - 8;
+			addr_length  = 8;
 		}
 
-		// Skip the line by advancing the pointer until a newline is found. The
-		// for loop will then skip the newline itself.
-		while ((pos < size) && (ptr[pos] != '\n'))
-			pos++;
+		char *addr_end;
+		void *addr  = (void *) strtoul(addr_string, &addr_end, 16);
+		char _type  = toupper(*type);
+
+		if ((addr_end != (addr_string + addr_length)) || !addr)
+			continue;
+
+		if (
+			(_type == 'T') || // .text
+			(_type == 'R') || // .rodata
+			(_type == 'D') || // .data
+			(_type == 'B')    // .bss
+		) {
+			char name_string[64];
+
+			memcpy(name_string, name, name_length);
+			name_string[name_length] = 0;
+
+			//_sdk_log("map sym: %08x [%c %s]\n", addr, _type, name_string);
+
+			DL_AddMapSymbol(name_string, addr);
+			entries++;
+		}
 	}
 
 	_sdk_log("parsed %d symbols\n", entries);
@@ -457,13 +470,15 @@ DLL *DL_CreateDLL(DLL *dll, void *ptr, size_t size, DL_ResolveMode mode) {
 	// Call the DLL's global constructors. This is the same thing we'd do in
 	// _start() for regular executables, but we have to do it outside of the
 	// DLL as there's no _start() or even a defined entry point within the
-	// DLL itself.
-	const uint32_t *ctor_list = DL_GetDLLSymbol(dll, "__CTOR_LIST__");
-	if (ctor_list) {
-		for (int i = ((int) ctor_list[0]); i >= 1; i--) {
-			void (*ctor)(void) = (void (*)(void)) ctor_list[i];
-			DL_PRE_CALL(ctor);
-			ctor();
+	// DLL itself. Dynamic relocations are not processed, so the DLL's base
+	// address has to be added to each entry of the array.
+	const uint32_t *ctor = DL_GetDLLSymbol(dll, "__init_array_start");
+	const uint32_t *end  = DL_GetDLLSymbol(dll, "__init_array_end");
+	if (ctor && end) {
+		for (; ctor < end; ctor++) {
+			void (*func)(void) = (void (*)(void)) (*ctor + (uint32_t) ptr);
+			DL_PRE_CALL(func);
+			func();
 		}
 	}
 
@@ -475,13 +490,14 @@ void DL_DestroyDLL(DLL *dll) {
 		return;
 
 	if (dll->ptr) {
-		// Call the DLL's global destructors.
-		const uint32_t *dtor_list = DL_GetDLLSymbol(dll, "__DTOR_LIST__");
-		if (dtor_list) {
-			for (int i = 0; i < ((int) dtor_list[0]); i++) {
-				void (*dtor)(void) = (void (*)(void)) dtor_list[i + 1];
-				DL_PRE_CALL(dtor);
-				dtor();
+		// Call the DLL's global destructors in reverse order.
+		const uint32_t *start = DL_GetDLLSymbol(dll, "__fini_array_start");
+		const uint32_t *dtor  = DL_GetDLLSymbol(dll, "__fini_array_end");
+		if (start && dtor) {
+			while (dtor > start) {
+				void (*func)(void) = (void (*)(void)) (*(--dtor) + (uint32_t) dll->ptr);
+				DL_PRE_CALL(func);
+				func();
 			}
 		}
 
@@ -0,0 +1,386 @@
+/*
+ * PSn00bSDK sampling profiler
+ * (C) 2022 PSn00bSDK contributors - MPL licensed
+ *
+ * The profiler uses a root counter to periodically interrupt the program and
+ * reads the interrupted PC from the kernel's current thread control block,
+ * where it is saved by the BIOS exception handler. Samples are accumulated
+ * into a histogram covering the executable's text section and, optionally,
+ * into a ring buffer of call stacks. Both can be dumped to the TTY (which can
+ * be redirected to the serial port using AddSIO()) or to a file and processed
+ * on the host using psxprof.
+ *
+ * The o32 ABI does not chain stack frames together, not even when building
+ * with -fno-omit-frame-pointer, so call stacks are recovered by looking for
+ * the prologue of each function instead: scanning backwards from the PC for
+ * the "addiu $sp, $sp, -N" instruction gives the frame size, while the
+ * "sw $ra, N($sp)" following it gives the location of the return address.
+ * This works with any code generated by GCC as long as functions have a
+ * single prologue, which is the case unless -fshrink-wrap-separate or similar
+ * options are used. Leaf functions without a stack frame are detected by
+ * hitting the "jr $ra" at the end of the previous function.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <psxapi.h>
+#include <psxetc.h>
+#include <hwregs_c.h>
+
+#define KERNEL_PCB			((PCB **) 0x80000108)
+#define NUM_TIMERS			3
+#define MAX_STACK_DEPTH		16
+#define MAX_PROLOGUE_SCAN	1024
+#define FILE_BLOCK_SIZE		128
+
+#define INSN_JR_RA			0x03e00008
+#define INSN_ADDIU_SP_MASK	0xffff8000
+#define INSN_ADDIU_SP_NEG	0x27bd8000
+#define INSN_SW_RA_MASK		0xffff0000
+#define INSN_SW_RA			0xafbf0000
+
+// Control register values for each timer (reset and fire an IRQ when reaching
+// the reload value, repeatedly). Timers 0 and 1 are clocked from the CPU
+// clock, timer 2 from the CPU clock divided by 8.
+static const uint16_t _timer_ctrl[NUM_TIMERS]  = { 0x0058, 0x0058, 0x0258 };
+static const uint32_t _timer_clock[NUM_TIMERS] = { F_CPU, F_CPU, F_CPU / 8 };
+
+extern uint32_t __text_start[];
+extern uint32_t __text_end[];
+
+/* Internal globals */
+
+static uint16_t *_prof_counters = 0;
+static uint32_t _prof_length, _prof_shift, _prof_rate;
+static uint32_t _prof_total, _prof_outside;
+static int      _prof_timer = -1;
+static void     (*_prof_saved_callback)(void);
+
+static uint32_t *_prof_ring = 0;
+static uint32_t _prof_ring_length, _prof_depth;
+static volatile uint32_t _prof_ring_head, _prof_ring_tail, _prof_dropped;
+
+static int      _prof_fd;
+static uint32_t _prof_file_length;
+static char     _prof_file_buffer[FILE_BLOCK_SIZE];
+
+/* Stack unwinding */
+
+static int _is_text_address(uint32_t addr) {
+	return
+		!(addr % 4) &&
+		(addr >= (uint32_t) __text_start) &&
+		(addr < (uint32_t) __text_end);
+}
+
+// Return addresses must point right after a jal, jalr or bal instruction (and
+// its delay slot). This catches most garbage picked up from the stack.
+static int _is_return_address(uint32_t addr) {
+	if (!_is_text_address(addr - 8))
+		return 0;
+
+	uint32_t insn = *((const uint32_t *) (addr - 8));
+
+	return
+		((insn >> 26) == 3) ||
+		((insn & 0xfc00003f) == 0x00000009) ||
+		((insn & 0xfc1f0000) == 0x04110000);
+}
+
+// Finds the prologue of the function containing the given address and
+// returns its frame size (0 for functions without a stack frame) and the
+// offset of the saved return address within the frame (-1 if the return
+// address has not been saved yet), or -1 if no prologue could be found.
+static int _find_frame(uint32_t pc, int *ra_offset) {
+	const uint32_t *ptr = (const uint32_t *) pc;
+	const uint32_t *end = ptr;
+
+	*ra_offset = -1;
+
+	for (int i = 0; i < MAX_PROLOGUE_SCAN; i++) {
+		// Reaching the beginning of the text section means the first function
+		// was sampled, which is assumed not to have a stack frame.
+		if (--ptr < __text_start)
+			return 0;
+
+		uint32_t insn = *ptr;
+
+		if (insn == INSN_JR_RA)
+			return 0;
+		if ((insn & INSN_ADDIU_SP_MASK) != INSN_ADDIU_SP_NEG)
+			continue;
+
+		for (const uint32_t *sw = ptr + 1; sw < end; sw++) {
+			if ((*sw & INSN_SW_RA_MASK) == INSN_SW_RA) {
+				*ra_offset = (int16_t) *sw;
+				break;
+			}
+		}
+
+		return -((int16_t) insn);
+	}
+
+	return -1;
+}
+
+static void _capture_stack(uint32_t *frames, const TCB *thread) {
+	uint32_t pc = thread->cop0r14;
+	uint32_t sp = thread->sp;
+	uint32_t ra = thread->ra;
+	int      ra_offset, i;
+
+	frames[0] = pc;
+
+	for (i = 1; (i < _prof_depth) && _is_text_address(pc); i++) {
+		int size = _find_frame(pc, &ra_offset);
+
+		if (size < 0)
+			break;
+
+		// Only the innermost function may have not saved its return address
+		// yet (or not need to save it at all).
+		if (ra_offset >= 0) {
+			uint32_t addr = sp + ra_offset;
+
+			if ((addr % 4) || (addr < 0x80000000) || (addr >= 0x80800000))
+				break;
+
+			ra = *((const uint32_t *) addr);
+		} else if (i > 1) {
+			break;
+		}
+
+		if (!_is_return_address(ra))
+			break;
+
+		pc        = ra;
+		sp       += size;
+		frames[i] = pc;
+	}
+
+	for (; i < _prof_depth; i++)
+		frames[i] = 0;
+}
+
+/* Timer IRQ handler */
+
+static void _prof_timer_handler(void) {
+	const TCB *thread = (*KERNEL_PCB)->thread;
+	uint32_t  pc      = thread->cop0r14;
+	uint32_t  index   = (pc - (uint32_t) __text_start) >> _prof_shift;
+
+	_prof_total++;
+
+	// Counters saturate rather than wrapping around, so that an overflow can
+	// be detected on the host side.
+	if (index < _prof_length) {
+		if (_prof_counters[index] != 0xffff)
+			_prof_counters[index]++;
+	} else {
+		_prof_outside++;
+	}
+
+	if (!_prof_ring)
+		return;
+
+	// Samples are dropped rather than overwriting older ones if the ring is
+	// full, so that the stacks dumped always form a contiguous sequence.
+	uint32_t next = (_prof_ring_head + 1) % _prof_ring_length;
+
+	if (next == _prof_ring_tail) {
+		_prof_dropped++;
+		return;
+	}
+
+	_capture_stack(&_prof_ring[_prof_ring_head * _prof_depth], thread);
+	_prof_ring_head = next;
+}
+
+/* Output */
+
+static void _tty_output(const char *str) {
+	printf("%s", str);
+}
+
+// Memory card files can only be written in 128-byte blocks, so the output is
+// buffered and the last block is padded with spaces.
+static void _file_output(const char *str) {
+	while (*str) {
+		_prof_file_buffer[_prof_file_length++] = *(str++);
+
+		if (_prof_file_length == FILE_BLOCK_SIZE) {
+			write(_prof_fd, (const uint8_t *) _prof_file_buffer, FILE_BLOCK_SIZE);
+			_prof_file_length = 0;
+		}
+	}
+}
+
+static void _file_flush(void) {
+	if (!_prof_file_length)
+		return;
+
+	memset(
+		&_prof_file_buffer[_prof_file_length],
+		' ',
+		FILE_BLOCK_SIZE - _prof_file_length
+	);
+	_prof_file_buffer[FILE_BLOCK_SIZE - 1] = '\n';
+
+	write(_prof_fd, (const uint8_t *) _prof_file_buffer, FILE_BLOCK_SIZE);
+	_prof_file_length = 0;
+}
+
+// The dump is made up of lines prefixed with "@prof" so psxprof can pick it
+// out of a TTY log. Counters and stacks are cleared as they are dumped,
+// allowing a running profile to be streamed by dumping it periodically.
+static void _prof_dump(void (*output)(const char *)) {
+	char line[16 + MAX_STACK_DEPTH * 9];
+
+	if (_prof_counters) {
+		sprintf(
+			line,
+			"@prof hist %08x %d %d %d %d %d\n",
+			(uint32_t) __text_start,
+			_prof_shift,
+			_prof_length,
+			_prof_rate,
+			_prof_total,
+			_prof_outside
+		);
+		output(line);
+
+		_prof_total   = 0;
+		_prof_outside = 0;
+
+		for (int i = 0; i < _prof_length; i++) {
+			uint16_t count = _prof_counters[i];
+
+			if (!count)
+				continue;
+
+			_prof_counters[i] = 0;
+
+			sprintf(line, "@prof %x %d\n", i, count);
+			output(line);
+		}
+
+		output("@prof end\n");
+	}
+
+	if (_prof_ring) {
+		uint32_t head = _prof_ring_head;
+
+		sprintf(
+			line,
+			"@prof stacks %d %d %d\n",
+			_prof_rate,
+			_prof_depth,
+			_prof_dropped
+		);
+		output(line);
+
+		_prof_dropped = 0;
+
+		for (uint32_t i = _prof_ring_tail; i != head;) {
+			const uint32_t *frames = &_prof_ring[i * _prof_depth];
+			char           *ptr    = line + sprintf(line, "@prof s");
+
+			for (int j = 0; (j < _prof_depth) && frames[j]; j++)
+				ptr += sprintf(ptr, " %08x", frames[j]);
+
+			*(ptr++) = '\n';
+			*ptr     = 0;
+			output(line);
+
+			i = (i + 1) % _prof_ring_length;
+			_prof_ring_tail = i;
+		}
+
+		output("@prof end\n");
+	}
+}
+
+/* Public API */
+
+int ProfGetLength(int shift) {
+	uint32_t size = (uint32_t) __text_end - (uint32_t) __text_start;
+
+	return (size + (1 << shift) - 1) >> shift;
+}
+
+int ProfSetStacks(uint32_t *ring, int length, int depth) {
+	if ((_prof_timer >= 0) || (depth > MAX_STACK_DEPTH))
+		return -1;
+
+	if (!ring || (length < 2) || (depth < 1)) {
+		_prof_ring = 0;
+		return 0;
+	}
+
+	_prof_ring        = ring;
+	_prof_ring_length = length;
+	_prof_depth       = depth;
+	_prof_ring_head   = 0;
+	_prof_ring_tail   = 0;
+	_prof_dropped     = 0;
+
+	return 0;
+}
+
+int ProfStart(uint16_t *counters, int length, int shift, int timer, int rate) {
+	if ((timer < 0) || (timer >= NUM_TIMERS) || (rate <= 0) || (_prof_timer >= 0))
+		return -1;
+
+	uint32_t reload = _timer_clock[timer] / rate;
+	if ((reload < 1) || (reload > 0xffff))
+		return -1;
+
+	// A null counter array can be passed if only call stacks are needed.
+	_prof_counters = counters;
+	_prof_length   = counters ? length : 0;
+	_prof_shift    = shift;
+	_prof_rate     = _timer_clock[timer] / reload;
+	_prof_total    = 0;
+	_prof_outside  = 0;
+	_prof_timer    = timer;
+
+	for (int i = 0; i < _prof_length; i++)
+		counters[i] = 0;
+
+	EnterCriticalSection();
+	TIMER_CTRL(timer)   = _timer_ctrl[timer];
+	TIMER_RELOAD(timer) = reload;
+	TIMER_VALUE(timer)  = 0;
+
+	_prof_saved_callback = InterruptCallback(
+		IRQ_TIMER0 + timer,
+		&_prof_timer_handler
+	);
+	ExitCriticalSection();
+
+	return 0;
+}
+
+void ProfStop(void) {
+	if (_prof_timer < 0)
+		return;
+
+	EnterCriticalSection();
+	InterruptCallback(IRQ_TIMER0 + _prof_timer, _prof_saved_callback);
+	ExitCriticalSection();
+
+	_prof_timer = -1;
+}
+
+void ProfDump(void) {
+	_prof_dump(&_tty_output);
+}
+
+void ProfSave(int fd) {
+	_prof_fd          = fd;
+	_prof_file_length = 0;
+
+	_prof_dump(&_file_output);
+	_file_flush();
+}
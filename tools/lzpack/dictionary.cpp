@@ -0,0 +1,170 @@
+// Preset dictionary trainer
+//
+// Every sample is split into fixed-size candidate segments, each of which is
+// scored by summing, over all the distinct 8-byte strings it contains, the
+// number of samples other than its own that contain the same string. Segments
+// are then picked greedily from the highest score down; once a segment has
+// been picked the strings in it stop counting towards the score of the other
+// segments, so the dictionary doesn't fill up with copies of the same data.
+
+#include <string.h>
+#include <stdint.h>
+#include <queue>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "dictionary.h"
+
+
+#define DMER_LEN		8
+#define SEGMENT_LEN		64
+#define SEGMENT_STEP	16
+
+
+typedef struct {
+	int		score;
+	int		sample;
+	int		offset;
+	int		length;
+} SEGMENT;
+
+struct SegmentOrder {
+
+	bool operator()(const SEGMENT& a, const SEGMENT& b) const {
+		return(a.score < b.score);
+	}
+
+};
+
+
+static uint64_t GetDmer(const char* ptr) {
+
+	uint64_t value;
+
+	memcpy(&value, ptr, DMER_LEN);
+
+	return(value);
+
+}
+
+static int ScoreSegment(const SEGMENT& seg, const char* const* samples, std::unordered_map<uint64_t, int>& freq) {
+
+	std::unordered_set<uint64_t>	seen;
+	const char*						ptr = samples[seg.sample]+seg.offset;
+	int								score = 0;
+
+	for(int i=0; i<=(seg.length-DMER_LEN); i++) {
+
+		uint64_t dmer = GetDmer(ptr+i);
+
+		if (!seen.insert(dmer).second)
+			continue;
+
+		auto it = freq.find(dmer);
+
+		// The sample the segment comes from doesn't count, as the string is
+		// already within its reach without a dictionary.
+		if ((it != freq.end()) && (it->second > 1))
+			score += it->second-1;
+
+	}
+
+	return(score);
+
+}
+
+int TrainDictionary(char* dictBuff, int dictSize, const char* const* samples, const int* sampleSizes, int numSamples) {
+
+	std::unordered_map<uint64_t, int>	freq;
+	std::unordered_map<uint64_t, int>	lastSample;
+
+	// Count the number of samples each string appears in
+	for(int s=0; s<numSamples; s++) {
+
+		for(int i=0; i<=(sampleSizes[s]-DMER_LEN); i++) {
+
+			uint64_t	dmer = GetDmer(samples[s]+i);
+			auto		it = lastSample.find(dmer);
+
+			if (it == lastSample.end()) {
+				lastSample[dmer] = s;
+				freq[dmer] = 1;
+			} else if (it->second != s) {
+				it->second = s;
+				freq[dmer]++;
+			}
+
+		}
+
+	}
+
+	lastSample.clear();
+
+
+	// Score all candidate segments
+	std::priority_queue<SEGMENT, std::vector<SEGMENT>, SegmentOrder> queue;
+
+	for(int s=0; s<numSamples; s++) {
+
+		for(int i=0; i<sampleSizes[s]; i+=SEGMENT_STEP) {
+
+			SEGMENT seg;
+
+			seg.sample	= s;
+			seg.offset	= i;
+			seg.length	= sampleSizes[s]-i;
+
+			if (seg.length > SEGMENT_LEN)
+				seg.length = SEGMENT_LEN;
+			if (seg.length < DMER_LEN)
+				break;
+
+			seg.score	= ScoreSegment(seg, samples, freq);
+
+			if (seg.score > 0)
+				queue.push(seg);
+
+		}
+
+	}
+
+
+	// Pick segments greedily, filling the dictionary from the end. As scores
+	// only ever decrease, a segment whose rescored value is still at least
+	// the next best candidate's can be picked without rescoring the others.
+	int pos = dictSize;
+
+	while((pos > 0) && !queue.empty()) {
+
+		SEGMENT seg = queue.top();
+		queue.pop();
+
+		int score = ScoreSegment(seg, samples, freq);
+
+		if (score <= 0)
+			continue;
+
+		if (score < seg.score) {
+			seg.score = score;
+			queue.push(seg);
+			continue;
+		}
+
+		int len = (seg.length < pos) ? seg.length : pos;
+
+		pos -= len;
+		memcpy(dictBuff+pos, samples[seg.sample]+seg.offset+(seg.length-len), len);
+
+		for(int i=0; i<=(seg.length-DMER_LEN); i++)
+			freq.erase(GetDmer(samples[seg.sample]+seg.offset+i));
+
+	}
+
+	// Move the dictionary to the start of the buffer if it wasn't filled
+	if (pos > 0)
+		memmove(dictBuff, dictBuff+pos, dictSize-pos);
+
+	return(dictSize-pos);
+
+}
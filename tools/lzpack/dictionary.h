@@ -0,0 +1,10 @@
+#ifndef _DICTIONARY_H
+#define _DICTIONARY_H
+
+// Builds a preset dictionary of up to dictSize bytes out of segments that occur
+// in as many of the given samples as possible. The most useful segments are
+// placed at the end of the dictionary, where they can be referenced with the
+// shortest offsets. Returns the actual size of the dictionary.
+int TrainDictionary(char* dictBuff, int dictSize, const char* const* samples, const int* sampleSizes, int numSamples);
+
+#endif
@@ -26,7 +26,7 @@ FileListClass::~FileListClass() {
 
 }
 
-void FileListClass::AddFileEntry(const char* fileName, const char* aliasName, short windowSize, short hash1Size, short hash2Size) {
+void FileListClass::AddFileEntry(const char* fileName, const char* aliasName, short windowSize, short hash1Size, short hash2Size, int codec) {
 
 	if (NumFiles >= AllocFiles) {
 
@@ -46,6 +46,7 @@ void FileListClass::AddFileEntry(const char* fileName, const char* aliasName, sh
 	FileList[NumFiles].windowSize	= windowSize;
 	FileList[NumFiles].hash1Size	= hash1Size;
 	FileList[NumFiles].hash2Size	= hash2Size;
+	FileList[NumFiles].codec		= codec;
 	NumFiles++;
 
 }
@@ -22,8 +22,16 @@ typedef struct {
     int		windowSize;
     int		hash1Size;
     int		hash2Size;
+    int		codec;
 } FileListEntry;
 
+// Codec selection policies for LZP archive entries
+enum {
+	CODEC_LZP	= 0,	// Always use lzCompress()
+	CODEC_FAST	= 1,	// Always use lzCompressFast()
+	CODEC_AUTO	= 2		// Pick lzCompressFast() if its ratio is close enough
+};
+
 class FileListClass {
 
 	int				NumFiles;
@@ -35,7 +43,7 @@ public:
     FileListClass();
     virtual ~FileListClass();
 
-    void AddFileEntry(const char* fileName, const char* aliasName, short windowSize, short hash1Size, short hash2Size);
+    void AddFileEntry(const char* fileName, const char* aliasName, short windowSize, short hash1Size, short hash2Size, int codec);
 
     const FileListEntry* Entry(int index);
     int EntryCount();
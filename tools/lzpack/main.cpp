@@ -1,13 +1,26 @@
 #include <stdio.h>
+#include <chrono>
 #include <tinyxml2.h>
 
 #include "lzconfig.h"
 #include "lzp.h"
 #include "filelist.h"
+#include "dictionary.h"
 
 
 #define BUFF_SIZE	4096
 
+// Default maximum size increase (in percent) accepted by the "auto" codec
+// policy in exchange for using the fast codec
+#define DEFAULT_MAX_LOSS	10
+
+// Number of times each entry is decompressed when benchmarking
+#define BENCH_PASSES		32
+
+// Largest preset dictionary size accepted (the fast codec can't reference
+// data further back than 64 KB anyway)
+#define MAX_DICT_SIZE		65536
+
 
 typedef struct {
 	char			id[3];
@@ -38,12 +51,15 @@ typedef struct {
 namespace param {
 
 	bool	AlwaysOverwrite		= false;
+	bool	Benchmark			= false;
 	char	ScriptFile[MAX_PATH]= { 0 };
 
 }
 
 
 int ParseCreateElement(tinyxml2::XMLElement* element);
+int ParseCodecName(const char* name);
+int CreatePatchFile(const char* oldFile, const char* newFile, const char* patchFile);
 
 char* lcase(char* str);
 const char* TrimPathName(const char* path);
@@ -51,14 +67,18 @@ const char* TrimPathName(const char* path);
 
 int main(int argc, const char* argv[]) {
 
-    printf("LZPack v0.61b - File Compression and Packing Utility\n");
+    printf("LZPack v0.62b - File Compression and Packing Utility\n");
     printf("2016-2019 Meido-Tek Productions (Lameguy64)\n\n");
 
 	if (argc <= 1) {
 
 		printf("Parameters:\n");
-		printf("   lzpack [-y] <scriptFile>\n\n");
+		printf("   lzpack [-y] [-b] <scriptFile>\n");
+		printf("   lzpack -p <oldFile> <newFile> <patchFile>\n\n");
 		printf("   -y           - Always overwrite existing files.\n");
+		printf("   -b           - Benchmark both codecs on each LZP entry.\n");
+		printf("   -p           - Create a patch to turn oldFile into newFile (e.g. two\n");
+		printf("                  versions of a pack), to be applied with lzApplyPatch().\n");
 		printf("   <scriptFile> - Script file to parse (in XML format, see readme.txt).\n");
 
 		exit(0);
@@ -73,6 +93,19 @@ int main(int argc, const char* argv[]) {
 
 			param::AlwaysOverwrite = true;
 
+        } else if (strcmp("-b", argv[i]) == 0) {
+
+			param::Benchmark = true;
+
+        } else if (strcmp("-p", argv[i]) == 0) {
+
+			if ((i+3) >= argc) {
+				printf("ERROR: -p requires old, new and patch file names.\n");
+				exit(EXIT_FAILURE);
+			}
+
+			return(CreatePatchFile(argv[i+1], argv[i+2], argv[i+3]) ? 0 : EXIT_FAILURE);
+
         } else if ((argv[i][0] == '-') || (argv[i][0] == '/')) {
 
 			printf("Unknown parameter: %s\n", argv[i]);
@@ -148,18 +181,311 @@ int main(int argc, const char* argv[]) {
 }
 
 
-int CreateLZPfile(const char* packFile, FileListClass* fileList) {
+double BenchmarkDecompress(char* outBuff, const char* compBuff, int compSize, bool fast) {
+
+	auto start = std::chrono::steady_clock::now();
+
+	for(int i=0; i<BENCH_PASSES; i++) {
+
+		if (fast)
+			lzDecompressFast(outBuff, compBuff, compSize);
+		else
+			lzDecompress(outBuff, compBuff, compSize);
+
+	}
+
+	std::chrono::duration<double> time = std::chrono::steady_clock::now()-start;
+
+	return(time.count()/BENCH_PASSES);
+
+}
+
+void BenchmarkEntry(const char* fileBuff, int fileSize) {
+
+	char*	lzpBuff		= new char[fileSize+16384];
+	char*	fastBuff	= new char[LZP_FAST_BOUND(fileSize)];
+	char*	outBuff		= new char[fileSize+4];
+
+	int		lzpSize		= lzCompress(lzpBuff, fileBuff, fileSize, 2);
+	int		fastSize	= lzCompressFast(fastBuff, fileBuff, fileSize, 2);
+
+	if ((lzpSize < 0) || (fastSize < 0)) {
+		printf("      Benchmark skipped, out of memory.\n");
+
+		delete[] outBuff;
+		delete[] fastBuff;
+		delete[] lzpBuff;
+		return;
+	}
+
+	double	lzpTime		= BenchmarkDecompress(outBuff, lzpBuff, lzpSize, false);
+	double	fastTime	= BenchmarkDecompress(outBuff, fastBuff, fastSize, true);
+
+	printf("      lzp: %d (%.02f%%), fast: %d (%.02f%%), decode speedup: %.02fx\n",
+		lzpSize,
+		100.f*((float)lzpSize/fileSize),
+		fastSize,
+		100.f*((float)fastSize/fileSize),
+		(fastTime > 0) ? (lzpTime/fastTime) : 0.0
+	);
+
+	delete[] outBuff;
+	delete[] fastBuff;
+	delete[] lzpBuff;
+
+}
+
+// In-place margin computation
+//
+// Decompressing in-place (with the compressed data loaded at the end of the
+// output buffer) is safe as long as the decoder never writes over input it has
+// yet to read. The functions below walk a compressed stream the same way the
+// decoders do, without writing anything, and return the largest amount of
+// bytes the output ever gets ahead of the input. The stream is never actually
+// decoded in-place until the margin is known to be safe, as doing so with a
+// margin too small would corrupt the stream and make the decoder write past
+// the end of the buffer.
+
+// Simple LSB-first bit reader mirroring get_bits() in the LZP library
+typedef struct {
+	const unsigned char*	ptr;
+	int						pos;
+	int						buff;
+	int						count;
+} BIT_READER;
+
+static int ReadBits(BIT_READER* reader, int n) {
+
+	while(reader->count < n) {
+
+		reader->buff |= reader->ptr[reader->pos++]<<reader->count;
+		reader->count += 8;
+
+	}
+
+	int x = reader->buff&((1<<n)-1);
+	reader->buff >>= n;
+	reader->count -= n;
+
+	return(x);
+
+}
+
+int LZPStreamLead(const unsigned char* in, int inSize, int start) {
+
+	BIT_READER	reader = { in, start, 0, 0 };
+	int			out = 0, lead = 0, len, log;
+
+	int windowSize = ReadBits(&reader, 5);
+
+	while(reader.pos < inSize) {
+
+		if (ReadBits(&reader, 1)) {
+
+			// Match length codes (see lzDecompress())
+			if (ReadBits(&reader, 1))
+				len = ReadBits(&reader, 2);
+			else if (ReadBits(&reader, 1))
+				len = ReadBits(&reader, 2)+4;
+			else if (ReadBits(&reader, 1))
+				len = ReadBits(&reader, 2)+8;
+			else if (ReadBits(&reader, 1))
+				len = ReadBits(&reader, 3)+12;
+			else if (ReadBits(&reader, 1))
+				len = ReadBits(&reader, 5)+20;
+			else
+				len = ReadBits(&reader, 9)+52;
+
+			log = ReadBits(&reader, 4)+(windowSize-16);
+			ReadBits(&reader, (log > (windowSize-16)) ? log : (windowSize-15));
+
+			out += len+3;
+
+		} else {
+
+			ReadBits(&reader, 8);
+			out++;
+
+		}
+
+		if ((out-reader.pos) > lead)
+			lead = out-reader.pos;
+
+	}
+
+	return(lead);
+
+}
+
+int FastStreamLead(const unsigned char* in, int inSize, int start) {
+
+	int pos = start+1, out = 0, lead = 0, token, len, c;
+
+	while(pos < inSize) {
+
+		token = in[pos++];
+
+		// Literals are read and written at the same pace
+		len = token>>4;
+		if (len == 15) {
+			do {
+				c = in[pos++];
+				len += c;
+			} while(c == 255);
+		}
+
+		pos += len;
+		out += len;
+
+		if ((out-pos) > lead)
+			lead = out-pos;
+
+		if (pos >= inSize)
+			break;
+
+		// Matches are written after the offset and length have been read
+		pos += 2;
+
+		len = token&15;
+		if (len == 15) {
+			do {
+				c = in[pos++];
+				len += c;
+			} while(c == 255);
+		}
+
+		out += len+4;
+
+		if ((out-pos) > lead)
+			lead = out-pos;
+
+	}
+
+	return(lead);
+
+}
+
+// Decompresses an entry in-place with the given margin and checks the result.
+bool TestInPlaceMargin(const char* fileBuff, int fileSize, const char* compBuff, int compSize, const char* dict, int dictSize, int margin) {
+
+	int		buffSize = (fileSize+margin+3)&~3;
+	char*	buff = new char[buffSize];
+
+	memcpy(buff+buffSize-compSize, compBuff, compSize);
+
+	const char* packedData = buff+buffSize-compSize;
+	int			packedSize = compSize;
+	int			unpackedSize;
+
+	if (*((const unsigned char*)packedData) == LZP_DICT_STREAM_ID) {
+		packedData++;
+		packedSize--;
+	} else {
+		dictSize = 0;
+	}
+
+	if (*((const unsigned char*)packedData) == LZP_FAST_ID)
+		unpackedSize = lzDecompressFastDict(buff, packedData, packedSize, dict, dictSize);
+	else
+		unpackedSize = lzDecompressDict(buff, packedData, packedSize, dict, dictSize);
+
+	bool valid = (unpackedSize == fileSize) && (memcmp(buff, fileBuff, fileSize) == 0);
+
+	delete[] buff;
+
+	return(valid);
+
+}
+
+// Computes the smallest margin that allows an entry to be decompressed in-place
+// and checks it by running the decompressor on a buffer laid out the same way
+// as on the target.
+int ComputeInPlaceMargin(const char* fileBuff, int fileSize, const char* compBuff, int compSize, const char* dict, int dictSize) {
+
+	const unsigned char*	in = (const unsigned char*)compBuff;
+	int						start = (in[0] == LZP_DICT_STREAM_ID) ? 1 : 0;
+	int						lead;
+
+	if (in[start] == LZP_FAST_ID)
+		lead = FastStreamLead(in, compSize, start);
+	else
+		lead = LZPStreamLead(in, compSize, start);
+
+	// The output must stay behind the input, which starts compSize-fileSize
+	// bytes past the beginning of the buffer when no margin is added
+	int margin = lead+compSize-fileSize;
+
+	if (margin < 0)
+		margin = 0;
+
+	if (!TestInPlaceMargin(fileBuff, fileSize, compBuff, compSize, dict, dictSize, margin)) {
+		printf("WARNING: Entry can't be decompressed in-place. ");
+		return(LZP_INPLACE_MARGIN(fileSize));
+	}
+
+	return(margin);
+
+}
+
+// Compresses a file using the given codec policy, optionally with a preset
+// dictionary, and returns the size of the compressed data or a negative LZP
+// error code.
+int CompressEntry(char* compBuff, const char* fileBuff, int fileSize, int codec, int maxLoss, const char* dict, int dictSize, bool* useFast) {
+
+	int	compSize = 0;
+
+	*useFast = (codec == CODEC_FAST);
+
+	if (codec != CODEC_FAST) {
+		compSize = lzCompressDict(compBuff, fileBuff, fileSize, dict, dictSize, 2);
+
+		if (compSize < 0)
+			return(compSize);
+	}
+
+	// Compress the file again using the fast codec and keep the result if
+	// the size increase is within the limit set for the pack.
+	if (codec != CODEC_LZP) {
+
+		char*	fastBuff = new char[LZP_FAST_BOUND(fileSize)];
+		int		fastSize = lzCompressFastDict(fastBuff, fileBuff, fileSize, dict, dictSize, 2);
+
+		if (fastSize < 0) {
+			delete[] fastBuff;
+			return(fastSize);
+		}
+
+		if ((codec == CODEC_FAST) || (fastSize*100 <= compSize*(100+maxLoss)))
+			*useFast = true;
+
+		if (*useFast) {
+			memcpy(compBuff, fastBuff, fastSize);
+			compSize = fastSize;
+		}
+
+		delete[] fastBuff;
+
+	}
+
+	return(compSize);
+
+}
+
+int CreateLZPfile(const char* packFile, FileListClass* fileList, int maxLoss, int dictSize) {
 
 	FILE*		packp;
-	LZP_FILE*	entry=new LZP_FILE[fileList->EntryCount()];
+	int			numFiles=fileList->EntryCount();
+	LZP_FILE*	entry=new LZP_FILE[numFiles];
+	uint32_t*	margin=new uint32_t[numFiles];
+	char**		fileBuffs=new char*[numFiles];
+	int*		fileSizes=new int[numFiles];
+	char*		dict=NULL;
 	int			overallSize=0;
 	int			overallPackedSize=0;
+	int			fastCount=0;
+	int			dictCount=0;
 
-    packp = fopen(packFile, "wb");
-
-    fseek(packp, sizeof(LZP_HEAD)+(sizeof(LZP_FILE)*fileList->EntryCount()), SEEK_SET);
-
-	for(int i=0; i<fileList->EntryCount(); i++) {
+	for(int i=0; i<numFiles; i++) {
 
         const char* name;
 
@@ -176,9 +502,14 @@ int CreateLZPfile(const char* packFile, FileListClass* fileList) {
         if (strlen(name) > 15) {
 
             printf("ERROR: Entry '%s' has more than 15 characters.\n", name);
-            fclose(packp);
-            unlink(packFile);
+
+            for(int j=0; j<i; j++)
+				delete[] fileBuffs[j];
+
             delete[] entry;
+            delete[] margin;
+            delete[] fileBuffs;
+            delete[] fileSizes;
 
             return(0);
 
@@ -186,6 +517,41 @@ int CreateLZPfile(const char* packFile, FileListClass* fileList) {
 
 		strcpy(entry[i].fileName, name);
 
+		// All files are loaded beforehand, as they are needed to train the
+		// dictionary
+		FILE*	fp = fopen(fileList->Entry(i)->fileName, "rb");
+
+		fseek(fp, 0, SEEK_END);
+        fileSizes[i] = ftell(fp);
+		fseek(fp, 0, SEEK_SET);
+
+        fileBuffs[i] = new char[fileSizes[i]];
+		fread(fileBuffs[i], fileSizes[i], 1, fp);
+
+		fclose(fp);
+
+	}
+
+	if (dictSize > 0) {
+
+		dict = new char[dictSize];
+		dictSize = TrainDictionary(dict, dictSize, fileBuffs, fileSizes, numFiles);
+
+		printf("   Trained %d byte dictionary.\n", dictSize);
+
+	}
+
+    packp = fopen(packFile, "wb");
+
+	// Leave room for the header, file entry table, in-place margin table and
+	// dictionary block
+	fseek(packp, sizeof(LZP_HEAD)+((sizeof(LZP_FILE)+4)*numFiles)+4, SEEK_SET);
+
+	if (dictSize > 0)
+		fseek(packp, 8+((dictSize+3)&~3), SEEK_CUR);
+
+	for(int i=0; i<numFiles; i++) {
+
 		if (fileList->Entry(i)->aliasName == NULL) {
 			printf("   Packing %s... ", fileList->Entry(i)->fileName);
 		} else {
@@ -193,33 +559,82 @@ int CreateLZPfile(const char* packFile, FileListClass* fileList) {
 		}
 
 
-		FILE*	fp = fopen(fileList->Entry(i)->fileName, "rb");
+        const char*	fileBuff = fileBuffs[i];
+        int			fileSize = fileSizes[i];
+        int			codec    = fileList->Entry(i)->codec;
+        char*		compBuff = new char[LZP_FAST_BOUND(fileSize)+16384];
+        bool		useFast;
+        bool		useDict  = false;
 
-		fseek(fp, 0, SEEK_END);
-        int fileSize = ftell(fp);
-		fseek(fp, 0, SEEK_SET);
+        int compSize = CompressEntry(compBuff, fileBuff, fileSize, codec, maxLoss, NULL, 0, &useFast);
 
-        char* fileBuff = new char[fileSize];
-		fread(fileBuff, fileSize, 1, fp);
+		// Compress the file again using the dictionary and keep the result if
+		// it's smaller, even after adding the prefix byte.
+		if (dictSize > 0) {
 
-		fclose(fp);
+			char*	dictBuff = new char[LZP_FAST_BOUND(fileSize)+16384+1];
+			bool	dictFast;
+			int		dictCompSize = CompressEntry(dictBuff+1, fileBuff, fileSize, codec, maxLoss, dict, dictSize, &dictFast);
 
+			if (dictCompSize < 0)
+				compSize = dictCompSize;
+			else if (++dictCompSize < compSize) {
+				dictBuff[0] = LZP_DICT_STREAM_ID;
+
+				memcpy(compBuff, dictBuff, dictCompSize);
+				compSize	= dictCompSize;
+				useFast		= dictFast;
+				useDict		= true;
+				dictCount++;
+			}
+
+			delete[] dictBuff;
+
+		}
 
-        char*	compBuff = new char[fileSize+16384];
-        int		compSize = lzCompress(compBuff, fileBuff, fileSize, 2);
+		if (compSize < 0) {
+
+			printf("ERROR: Out of memory while compressing '%s'.\n", entry[i].fileName);
+
+			fclose(packp);
+
+			for(int j=0; j<numFiles; j++)
+				delete[] fileBuffs[j];
+
+			delete[] compBuff;
+			delete[] entry;
+			delete[] margin;
+			delete[] fileBuffs;
+			delete[] fileSizes;
+			delete[] dict;
+
+			return(0);
+
+		}
+
+		if (useFast)
+			fastCount++;
 
 
         entry[i].crc		= lzCRC32(compBuff, compSize, LZP_CRC32_REMAINDER);
 		entry[i].fileSize	= fileSize;
+		margin[i]			= ComputeInPlaceMargin(fileBuff, fileSize, compBuff, compSize, dict, dictSize);
 		entry[i].packedSize	= compSize;
         entry[i].offset		= ftell(packp);
 
         fwrite(compBuff, compSize, 1, packp);
 
         delete[] compBuff;
-        delete[] fileBuff;
 
-		printf("Ok. (%.02f%%)\n", 100.f*((float)compSize/fileSize));
+		printf("Ok. (%.02f%%%s%s, margin %d)\n",
+			100.f*((float)compSize/fileSize),
+			useFast ? ", fast" : "",
+			useDict ? ", dict" : "",
+			margin[i]
+		);
+
+		if (param::Benchmark)
+			BenchmarkEntry(fileBuff, fileSize);
 
 		overallSize			+= fileSize;
 		overallPackedSize	+= compSize;
@@ -237,8 +652,33 @@ int CreateLZPfile(const char* packFile, FileListClass* fileList) {
 
     fwrite(entry, sizeof(LZP_FILE), fileList->EntryCount(), packp);
 
+	fwrite(LZP_MARGIN_ID, 4, 1, packp);
+	fwrite(margin, sizeof(uint32_t), fileList->EntryCount(), packp);
+
+	if (dictSize > 0) {
+
+		uint32_t	size = dictSize;
+		char		pad[4] = { 0 };
+
+		fwrite(LZP_DICT_ID, 4, 1, packp);
+		fwrite(&size, 4, 1, packp);
+		fwrite(dict, dictSize, 1, packp);
+		fwrite(pad, ((dictSize+3)&~3)-dictSize, 1, packp);
+
+		overallPackedSize += 8+((dictSize+3)&~3);
+
+	}
+
 	fclose(packp);
+
+	for(int i=0; i<numFiles; i++)
+		delete[] fileBuffs[i];
+
 	delete[] entry;
+	delete[] margin;
+	delete[] fileBuffs;
+	delete[] fileSizes;
+	delete[] dict;
 
     printf("Packed %d file(s) totaling %d bytes (%.02f%% compression ratio).\n",
 		fileList->EntryCount(),
@@ -246,11 +686,92 @@ int CreateLZPfile(const char* packFile, FileListClass* fileList) {
 		100.f*((float)overallPackedSize/overallSize)
 	);
 
+	if (fastCount)
+		printf("%d file(s) use the fast codec.\n", fastCount);
+	if (dictCount)
+		printf("%d file(s) use the dictionary.\n", dictCount);
+
 
 	return(true);
 
 }
 
+char* LoadFile(const char* fileName, int* fileSize) {
+
+	FILE* fp = fopen(fileName, "rb");
+
+	if (!fp) {
+		printf("ERROR: File '%s' either does not exist or it cannot be opened.\n", fileName);
+		return(NULL);
+	}
+
+	fseek(fp, 0, SEEK_END);
+	*fileSize = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+
+	char* fileBuff = new char[*fileSize+1];
+	fread(fileBuff, *fileSize, 1, fp);
+
+	fclose(fp);
+
+	return(fileBuff);
+
+}
+
+int CreatePatchFile(const char* oldFile, const char* newFile, const char* patchFile) {
+
+	int		oldSize, newSize;
+	char*	oldBuff = LoadFile(oldFile, &oldSize);
+	char*	newBuff = LoadFile(newFile, &newSize);
+
+	if (!oldBuff || !newBuff) {
+		delete[] oldBuff;
+		delete[] newBuff;
+		return(false);
+	}
+
+	printf("Creating patch %s... ", patchFile);
+
+	char*	patchBuff = new char[LZP_PATCH_BOUND(newSize)];
+	int		patchSize = lzCreatePatch(patchBuff, oldBuff, oldSize, newBuff, newSize);
+
+	// Make sure the patch actually rebuilds the new file before writing it
+	char*	testBuff = new char[newSize+1];
+	bool	valid = (
+		(lzApplyPatch(testBuff, oldBuff, oldSize, patchBuff, patchSize) == newSize) &&
+		(memcmp(testBuff, newBuff, newSize) == 0)
+	);
+
+	delete[] testBuff;
+
+	if (valid) {
+
+		FILE* fp = fopen(patchFile, "wb");
+
+		if (fp) {
+			fwrite(patchBuff, patchSize, 1, fp);
+			fclose(fp);
+
+			printf("Ok. (%d bytes, %.02f%% of new file)\n", patchSize, 100.f*((float)patchSize/newSize));
+		} else {
+			printf("\nERROR: Could not create %s.\n", patchFile);
+			valid = false;
+		}
+
+	} else {
+
+		printf("\nERROR: Patch verification failed.\n");
+
+	}
+
+	delete[] patchBuff;
+	delete[] newBuff;
+	delete[] oldBuff;
+
+	return(valid);
+
+}
+
 int CreateQLPfile(const char* packFile, FileListClass* fileList) {
 
     FILE*		packp;
@@ -495,6 +1016,27 @@ int ParseCreateElement(tinyxml2::XMLElement* element) {
 	}
 
 
+	int packCodec = CODEC_LZP;
+	int maxLoss   = element->IntAttribute("maxloss", DEFAULT_MAX_LOSS);
+	int dictSize  = element->IntAttribute("dictionary", 0);
+
+	if ((dictSize < 0) || (dictSize > MAX_DICT_SIZE)) {
+		printf("ERROR: Dictionary size must be between 0 and %d bytes.\n", MAX_DICT_SIZE);
+		return(false);
+	}
+
+	if (element->Attribute("codec") != NULL) {
+
+		packCodec = ParseCodecName(element->Attribute("codec"));
+
+		if (packCodec < 0) {
+			printf("ERROR: Unknown codec: %s\n", element->Attribute("codec"));
+			return(false);
+		}
+
+	}
+
+
 	printf("Creating %s in ", packName);
 	switch(packFormat) {
 	case 0:
@@ -548,13 +1090,27 @@ int ParseCreateElement(tinyxml2::XMLElement* element) {
 		fclose(fp);
 
 
+		int		entryCodec		= packCodec;
+
+		if (fileElement->Attribute("codec") != NULL) {
+
+			entryCodec = ParseCodecName(fileElement->Attribute("codec"));
+
+			if (entryCodec < 0) {
+				printf("WARNING: Unknown codec '%s', using pack default.\n", fileElement->Attribute("codec"));
+				entryCodec = packCodec;
+			}
+
+		}
+
 		if (valid) {
 			fileList.AddFileEntry(
 				fileElement->GetText(),
 				fileElement->Attribute("alias"),
 				entryWindowSize,
 				entryHash1Size,
-				entryHash2Size
+				entryHash2Size,
+				entryCodec
 			);
 		}
 
@@ -574,7 +1130,7 @@ int ParseCreateElement(tinyxml2::XMLElement* element) {
 
 	switch(packFormat) {
 	case 0:	// Create LZP
-		CreateLZPfile(packName, &fileList);
+		CreateLZPfile(packName, &fileList, maxLoss, dictSize);
 		break;
 	case 1:	// Create QLP
 		CreateQLPfile(packName, &fileList);
@@ -590,6 +1146,24 @@ int ParseCreateElement(tinyxml2::XMLElement* element) {
 }
 
 
+int ParseCodecName(const char* name) {
+
+	char*	codecName = lcase(strdup(name));
+	int		codec = -1;
+
+	if (strcmp("lzp", codecName) == 0)
+		codec = CODEC_LZP;
+	else if (strcmp("fast", codecName) == 0)
+		codec = CODEC_FAST;
+	else if (strcmp("auto", codecName) == 0)
+		codec = CODEC_AUTO;
+
+	free(codecName);
+
+	return(codec);
+
+}
+
 const char* TrimPathName(const char* path) {
 
     if ((strrchr(path, '\\') == NULL) && (strrchr(path, '/') == NULL)) {
@@ -10,6 +10,7 @@ Only one object can be exported at a time.
 """
 
 import os
+import struct
 import bpy
 
 from bpy.props import (CollectionProperty,
@@ -55,6 +56,12 @@ class ExportSMX(bpy.types.Operator, ExportHelper):
         default=True,
         )
     
+    exp_binary = BoolProperty(
+        name="Binary",
+        description="Write a binary SMX file, which smxlink loads much faster than XML",
+        default=False,
+        )
+    
     #exp_vertexWeights = BoolProperty(
     #    name="Vertex Weights",
     #    description="Export vertex weights",
@@ -111,197 +118,288 @@ class ExportSMX(bpy.types.Operator, ExportHelper):
         filepath = self.filepath
         filepath = bpy.path.ensure_ext(filepath, self.filename_ext)
         
-        with open(filepath, "w") as f:
-            
-            # Write a banner
-            f.write("<!-- Created using Project Scarlet SMX Export Plug-in for Blender -->\n")
-            f.write("<!-- NOTE: If you plan to use this model as a static mesh, it is recommended that you run this file through smxopt -->\n")
-            f.write("<!-- or smxtool to clean up duplicate/unused normals which are kept for animation purposes. -->\n")
-            
-            f.write("<model version=\"1\">\n")
-            
-            # Write vertices
-            f.write("<vertices count=\"%d\">\n" % len(mesh.vertices))
-            for v in mesh.vertices:
-                f.write("<v x=\"%f\" y=\"%f\" z=\"%f\"/>\n" % (v.co.x, -v.co.z, v.co.y))
-            f.write("</vertices>\n")
-            
-            
-            # Scan if there are any flat primitives
-            has_flats = False
-            for i,p in enumerate(mesh.tessfaces):
-                if p.use_smooth is False:
-                    has_flats = True
-                    break
+        # Vertices
+        verts = [(v.co.x, -v.co.z, v.co.y) for v in mesh.vertices]
+        
+        # Scan if there are any flat primitives
+        has_flats = False
+        for i,p in enumerate(mesh.tessfaces):
+            if p.use_smooth is False:
+                has_flats = True
+                break
 
-            # Export normals
-            if self.exp_writeNormals:
-                if has_flats:
-                    f.write("<normals count=\"%d\">\n" % (len(mesh.vertices)+len(mesh.polygons)))
-                else:
-                    f.write("<normals count=\"%d\">\n" % (len(mesh.vertices)))
-                f.write("<!-- Smooth normals begin here -->\n")
-                for v in mesh.vertices:
-                    f.write("<v x=\"%f\" y=\"%f\" z=\"%f\"/>\n" % (v.normal.x, -v.normal.z, v.normal.y))
-                if has_flats:
-                    f.write("<!-- Flat normals begin here -->\n")
-                    flatnorms_start = len(mesh.vertices)
-                    for p in mesh.polygons:
-                        f.write("<v x=\"%f\" y=\"%f\" z=\"%f\"/>\n" % (p.normal.x, -p.normal.z, p.normal.y))
-                f.write("</normals>\n")
+        # Normals
+        if self.exp_writeNormals:
+            norms = [(v.normal.x, -v.normal.z, v.normal.y) for v in mesh.vertices]
+            flatnorms_start = len(norms)
+            if has_flats:
+                for p in mesh.polygons:
+                    norms.append((p.normal.x, -p.normal.z, p.normal.y))
+        else:
+            norms = None
 
 
-            # Write texture files
-            mesh_uvs = mesh.tessface_uv_textures.active
-                
-            if mesh_uvs is not None:
-                mesh_uvs = mesh_uvs.data
-            
-            # Scan through all faces for assigned textures
-            if mesh_uvs is not None:
-                tex_table = []
-                tex_files = []
-                for uv in mesh_uvs:
-                    if uv.image is not None:
-                        addTex = True
-                        texFileName = bpy.path.display_name_from_filepath(uv.image.filepath)
-                        if len(tex_files)>0:
-                            for c,t in enumerate(tex_files):
-                                if t == texFileName:
-                                    tex_table.append(c+1)
-                                    addTex = False
-                                    break
-                        if addTex:
-                            print("TF:%s" % (texFileName))
-                            tex_files.append(texFileName)
-                            tex_table.append(len(tex_files))   
-                    else:
-                        tex_table.append(0)
-                        
-                # Write texture files
-                f.write("<textures count=\"%d\">\n" % len(tex_files))
-                for n in tex_files:
-                    f.write("<texture file=\"%s\"/>\n" % n)
-                f.write("</textures>\n")
-            else:
-                tex_table = None
-                tex_files = None        
+        # Texture files
+        mesh_uvs = mesh.tessface_uv_textures.active
             
+        if mesh_uvs is not None:
+            mesh_uvs = mesh_uvs.data
+        
+        # Scan through all faces for assigned textures
+        if mesh_uvs is not None:
+            tex_table = []
+            tex_files = []
+            for uv in mesh_uvs:
+                if uv.image is not None:
+                    addTex = True
+                    texFileName = bpy.path.display_name_from_filepath(uv.image.filepath)
+                    if len(tex_files)>0:
+                        for c,t in enumerate(tex_files):
+                            if t == texFileName:
+                                tex_table.append(c+1)
+                                addTex = False
+                                break
+                    if addTex:
+                        print("TF:%s" % (texFileName))
+                        tex_files.append(texFileName)
+                        tex_table.append(len(tex_files))   
+                else:
+                    tex_table.append(0)
+        else:
+            tex_table = None
+            tex_files = None        
+        
+        
+        mesh_cols = mesh.tessface_vertex_colors.active
             
-            mesh_cols = mesh.tessface_vertex_colors.active
+        if mesh_cols is not None:
+            mesh_cols = mesh_cols.data
                 
-            if mesh_cols is not None:
-                mesh_cols = mesh_cols.data
-                    
-            tri_indices = ( 0, 2, 1 );
-            quad_indices = ( 3, 2, 0, 1 );
+        tri_indices = ( 0, 2, 1 );
+        quad_indices = ( 3, 2, 0, 1 );
+        
+        # Primitives
+        prims = []
+        for i,p in enumerate(mesh.tessfaces):
             
-            f.write("<primitives count=\"%d\">\n" % len(mesh.tessfaces))
-            for i,p in enumerate(mesh.tessfaces):
-                
-                # Write vertex indices
-                f.write("<poly ")
-                if (len(p.vertices) == 3):
-                    f.write("v0=\"%d\" " % (p.vertices[0]))
-                    f.write("v1=\"%d\" " % (p.vertices[2]))
-                    f.write("v2=\"%d\" " % (p.vertices[1]))
-                elif (len(p.vertices) == 4):
-                    f.write("v0=\"%d\" " % (p.vertices[3]))
-                    f.write("v1=\"%d\" " % (p.vertices[2]))
-                    f.write("v2=\"%d\" " % (p.vertices[0]))
-                    f.write("v3=\"%d\" " % (p.vertices[1]))
+            prim = {
+                "shading":  None,
+                "n":        [],
+                "gouraud":  False,
+                "texture":  None,
+                "uv":       [],
+                }
+            
+            # Vertex indices
+            if (len(p.vertices) == 3):
+                prim["v"] = [p.vertices[0], p.vertices[2], p.vertices[1]]
+            elif (len(p.vertices) == 4):
+                prim["v"] = [p.vertices[3], p.vertices[2], p.vertices[0], p.vertices[1]]
+            
+            # Normal indices and shading mode
+            if self.exp_writeNormals:
+                if p.use_smooth:
+                    prim["n"] = list(prim["v"])
+                    prim["shading"] = "S"
+                else:
+                    prim["n"] = [flatnorms_start+i]
+                    prim["shading"] = "F"
                 
-                # Write normal indices and shading mode
-                if self.exp_writeNormals:
-                    if p.use_smooth:
-                        if (len(p.vertices) == 3):
-                            f.write("n0=\"%d\" " % (p.vertices[0]))
-                            f.write("n1=\"%d\" " % (p.vertices[2]))
-                            f.write("n2=\"%d\" " % (p.vertices[1]))
-                        elif (len(p.vertices) == 4):
-                            f.write("n0=\"%d\" " % (p.vertices[3]))
-                            f.write("n1=\"%d\" " % (p.vertices[2]))
-                            f.write("n2=\"%d\" " % (p.vertices[0]))
-                            f.write("n3=\"%d\" " % (p.vertices[1]))
-                        f.write("shading=\"S\" ")
-                    else:
-                        f.write("n0=\"%d\" " % (flatnorms_start+i))
-                        f.write("shading=\"F\" ")
-                    
-                if tex_table is not None:
-                    if (tex_table[i] > 0):
-                        color_mul = 128.0
-                    else:
-                        color_mul = 255.0
+            if tex_table is not None:
+                if (tex_table[i] > 0):
+                    color_mul = 128.0
                 else:
                     color_mul = 255.0
-					
-                # Write out vertex colors if available
-                if mesh_cols is None:
-                    f.write("r0=\"128\" g0=\"128\" b0=\"128\" ")
-                    typecode = "F"
+            else:
+                color_mul = 255.0
+                
+            # Vertex colors if available
+            if mesh_cols is None:
+                prim["rgb"] = [(128, 128, 128)]
+            else:
+                col = mesh_cols[i]
+                col = col.color1[:], col.color2[:], col.color3[:], col.color4[:]
+                # Check if polygon is flat shaded
+                if (col[0] == col[1]) and (col[1] == col[2]) and (col[2] == col[0]):
+                    # is flat...
+                    color = col[0]
+                    prim["rgb"] = [(int(color[0]*color_mul),
+                                    int(color[1]*color_mul),
+                                    int(color[2]*color_mul),
+                                    )]
                 else:
-                    col = mesh_cols[i]
-                    col = col.color1[:], col.color2[:], col.color3[:], col.color4[:]
-                    # Check if polygon is flat shaded
-                    if (col[0] == col[1]) and (col[1] == col[2]) and (col[2] == col[0]):
-                        # is flat...
-                        color = col[0]
-                        color = (int(color[0]*color_mul),
-                                 int(color[1]*color_mul),
-                                 int(color[2]*color_mul),
-                                 )
-                        f.write("r0=\"%d\" g0=\"%d\" b0=\"%d\" " % color[:])
-                        typecode = "F"
-                    else:
-                        # is gouraud...
-                        for j,c in enumerate(p.vertices):
-                            if (len(p.vertices) == 4):
-                                color = col[quad_indices[j]]
-                            else:
-                                color = col[tri_indices[j]]
-                            color = (int(color[0]*color_mul),
-                                     int(color[1]*color_mul),
-                                     int(color[2]*color_mul),
-                                     )
-                            f.write("r%d=\"%d\" g%d=\"%d\" b%d=\"%d\" " % 
-                                (j, color[0], j, color[1], j, color[2]))
-                        typecode = "G"
-                        
-                # Add texcoords
-                if tex_table is not None:
-                    if (tex_table[i] > 0):
-                        f.write("texture=\"%d\" " % (tex_table[i]-1));
-                        if (len(p.vertices) == 3):
-                            uv = (mesh_uvs[i].uv1, 
-                                  mesh_uvs[i].uv3, 
-                                  mesh_uvs[i].uv2
-                                  )
-                        elif (len(p.vertices) == 4):
-                            uv = (mesh_uvs[i].uv4, 
-                                  mesh_uvs[i].uv3, 
-                                  mesh_uvs[i].uv1, 
-                                  mesh_uvs[i].uv2
-                                  )
-                        tex_w = mesh_uvs[i].image.size[0]-0.85#(1.0/mesh_uvs[i].image.size[0])
-                        tex_h = mesh_uvs[i].image.size[1]-0.85#(1.0-(1.0/mesh_uvs[i].image.size[1]))
-                        for j,c in enumerate(uv):
-                            f.write("tu%d=\"%d\" tv%d=\"%d\" " % 
-                                (j, round(tex_w*uv[j].x), j, round(tex_h-(tex_h*uv[j].y))))
-                        typecode += "T"
+                    # is gouraud...
+                    prim["rgb"] = []
+                    for j,c in enumerate(p.vertices):
+                        if (len(p.vertices) == 4):
+                            color = col[quad_indices[j]]
+                        else:
+                            color = col[tri_indices[j]]
+                        prim["rgb"].append((int(color[0]*color_mul),
+                                            int(color[1]*color_mul),
+                                            int(color[2]*color_mul),
+                                            ))
+                    prim["gouraud"] = True
                     
-                typecode += "%d" % len(p.vertices)
-                f.write("type=\"%s\" " % typecode)
-                f.write("/>\n")
-
-            f.write("</primitives>\n")
-            
-            f.write("</model>")
+            # Texcoords
+            if tex_table is not None:
+                if (tex_table[i] > 0):
+                    prim["texture"] = tex_table[i]-1
+                    if (len(p.vertices) == 3):
+                        uv = (mesh_uvs[i].uv1, 
+                              mesh_uvs[i].uv3, 
+                              mesh_uvs[i].uv2
+                              )
+                    elif (len(p.vertices) == 4):
+                        uv = (mesh_uvs[i].uv4, 
+                              mesh_uvs[i].uv3, 
+                              mesh_uvs[i].uv1, 
+                              mesh_uvs[i].uv2
+                              )
+                    tex_w = mesh_uvs[i].image.size[0]-0.85#(1.0/mesh_uvs[i].image.size[0])
+                    tex_h = mesh_uvs[i].image.size[1]-0.85#(1.0-(1.0/mesh_uvs[i].image.size[1]))
+                    for j,c in enumerate(uv):
+                        prim["uv"].append((round(tex_w*uv[j].x), round(tex_h-(tex_h*uv[j].y))))
             
-            f.close()
+            prims.append(prim)
+        
+        if self.exp_binary:
+            with open(filepath, "wb") as f:
+                write_smx_binary(f, verts, norms, tex_files, prims)
+        else:
+            with open(filepath, "w") as f:
+                write_smx_xml(f, verts, norms, has_flats, tex_files, prims)
             
         return {'FINISHED'};
     
+def write_smx_xml(f, verts, norms, has_flats, tex_files, prims):
+    
+    # Write a banner
+    f.write("<!-- Created using Project Scarlet SMX Export Plug-in for Blender -->\n")
+    f.write("<!-- NOTE: If you plan to use this model as a static mesh, it is recommended that you run this file through smxopt -->\n")
+    f.write("<!-- or smxtool to clean up duplicate/unused normals which are kept for animation purposes. -->\n")
+    
+    f.write("<model version=\"1\">\n")
+    
+    # Write vertices
+    f.write("<vertices count=\"%d\">\n" % len(verts))
+    for v in verts:
+        f.write("<v x=\"%f\" y=\"%f\" z=\"%f\"/>\n" % v)
+    f.write("</vertices>\n")
+    
+    # Export normals
+    if norms is not None:
+        f.write("<normals count=\"%d\">\n" % len(norms))
+        f.write("<!-- Smooth normals begin here -->\n")
+        for j,v in enumerate(norms):
+            if has_flats and (j == len(verts)):
+                f.write("<!-- Flat normals begin here -->\n")
+            f.write("<v x=\"%f\" y=\"%f\" z=\"%f\"/>\n" % v)
+        f.write("</normals>\n")
+
+    # Write texture files
+    if tex_files is not None:
+        f.write("<textures count=\"%d\">\n" % len(tex_files))
+        for n in tex_files:
+            f.write("<texture file=\"%s\"/>\n" % n)
+        f.write("</textures>\n")
+    
+    f.write("<primitives count=\"%d\">\n" % len(prims))
+    for p in prims:
+        
+        # Write vertex indices
+        f.write("<poly ")
+        for j,v in enumerate(p["v"]):
+            f.write("v%d=\"%d\" " % (j, v))
+        
+        # Write normal indices and shading mode
+        if p["shading"] is not None:
+            for j,n in enumerate(p["n"]):
+                f.write("n%d=\"%d\" " % (j, n))
+            f.write("shading=\"%s\" " % p["shading"])
+        
+        # Write out vertex colors
+        for j,c in enumerate(p["rgb"]):
+            f.write("r%d=\"%d\" g%d=\"%d\" b%d=\"%d\" " % 
+                (j, c[0], j, c[1], j, c[2]))
+        
+        if p["gouraud"]:
+            typecode = "G"
+        else:
+            typecode = "F"
+        
+        # Add texcoords
+        if p["texture"] is not None:
+            f.write("texture=\"%d\" " % p["texture"]);
+            for j,c in enumerate(p["uv"]):
+                f.write("tu%d=\"%d\" tv%d=\"%d\" " % (j, c[0], j, c[1]))
+            typecode += "T"
+            
+        typecode += "%d" % len(p["v"])
+        f.write("type=\"%s\" " % typecode)
+        f.write("/>\n")
+
+    f.write("</primitives>\n")
+    
+    f.write("</model>")
+
+# Binary SMX layout (see tools/smxlink/model.h), all values little endian
+SMB_HAS_VERTS       = 1
+SMB_HAS_NORMS       = 2
+SMB_HAS_PRIMS       = 4
+
+SMB_PRIM_GOURAUD    = 1
+SMB_PRIM_TEXTURED   = 2
+
+def write_smx_binary(f, verts, norms, tex_files, prims):
+    
+    if norms is None:
+        norms = []
+        flags = SMB_HAS_VERTS|SMB_HAS_PRIMS
+    else:
+        flags = SMB_HAS_VERTS|SMB_HAS_NORMS|SMB_HAS_PRIMS
+    
+    if tex_files is None:
+        tex_files = []
+    
+    f.write(struct.pack("<3sBHHIII", b"SMB", 1, flags, len(tex_files), 
+        len(verts), len(norms), len(prims)))
+    
+    # Texture names, padded to a multiple of 4 bytes as a whole
+    names = b"".join(n.encode("utf-8")+b"\0" for n in tex_files)
+    f.write(names)
+    f.write(b"\0" * (-len(names) & 3))
+    
+    for v in verts:
+        f.write(struct.pack("<3f", *v))
+    for v in norms:
+        f.write(struct.pack("<3f", *v))
+    
+    shading_modes = { None: 0, "F": 1, "S": 2 }
+    
+    for p in prims:
+        
+        count = len(p["v"])
+        flags = 0
+        
+        if p["gouraud"]:
+            flags |= SMB_PRIM_GOURAUD
+        if p["texture"] is not None:
+            flags |= SMB_PRIM_TEXTURED
+            texture = p["texture"]
+        else:
+            texture = 0
+        
+        rgb = []
+        for c in (p["rgb"]+[(0, 0, 0)]*4)[:4]:
+            rgb.extend(c)
+        uv = (p["uv"]+[(0, 0)]*4)[:4]
+        
+        f.write(struct.pack("<4Bhh4i4i12B4h4h",
+            count, shading_modes[p["shading"]], flags, 0, texture, 0,
+            *((p["v"]+[0]*4)[:4]+(p["n"]+[0]*4)[:4]+rgb+
+                [c[0] for c in uv]+[c[1] for c in uv])))
+    
 # For registering to Blender menus
 def menu_func(self, context):
     self.layout.operator(ExportSMX.bl_idname, text="Scarlet 3D SMX v3 (.smx)");
@@ -0,0 +1,156 @@
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include "elfsym.h"
+
+#define SHT_SYMTAB	2
+#define STT_FUNC	2
+
+static uint32_t GetWord(const std::vector<uint8_t>& data, size_t offset) {
+
+	if ((offset+4) > data.size())
+		return 0;
+
+	return data[offset]|(data[offset+1]<<8)|(data[offset+2]<<16)|
+		((uint32_t)data[offset+3]<<24);
+
+}
+
+static uint16_t GetHalf(const std::vector<uint8_t>& data, size_t offset) {
+
+	if ((offset+2) > data.size())
+		return 0;
+
+	return data[offset]|(data[offset+1]<<8);
+
+}
+
+bool SymbolTable::Load(const char* fileName) {
+
+	FILE* fp = fopen(fileName, "rb");
+
+	if (fp == NULL) {
+		printf("ERROR: Unable to open ELF file: %s\n", fileName);
+		return false;
+	}
+
+	std::vector<uint8_t> data;
+
+	fseek(fp, 0, SEEK_END);
+	data.resize(ftell(fp));
+	fseek(fp, 0, SEEK_SET);
+
+	if (fread(data.data(), 1, data.size(), fp) != data.size()) {
+		printf("ERROR: Unable to read ELF file: %s\n", fileName);
+		fclose(fp);
+		return false;
+	}
+
+	fclose(fp);
+
+	if ((data.size() < 52) || (memcmp(data.data(), "\x7f" "ELF", 4) != 0) ||
+		(data[4] != 1) || (data[5] != 1) || (GetHalf(data, 18) != 8)) {
+		printf("ERROR: %s is not a 32-bit little endian MIPS ELF file.\n", fileName);
+		return false;
+	}
+
+	uint32_t	shOffset	= GetWord(data, 32);
+	int			shSize		= GetHalf(data, 46);
+	int			shCount		= GetHalf(data, 48);
+
+	symbols.clear();
+
+	for(int i=0; i<shCount; i++) {
+
+		size_t sh = shOffset+i*shSize;
+
+		if (GetWord(data, sh+4) != SHT_SYMTAB)
+			continue;
+
+		uint32_t	symOffset	= GetWord(data, sh+16);
+		uint32_t	symSize		= GetWord(data, sh+20);
+		uint32_t	entSize		= GetWord(data, sh+36);
+		size_t		strSh		= shOffset+GetWord(data, sh+24)*shSize;
+		uint32_t	strOffset	= GetWord(data, strSh+16);
+		uint32_t	strSize		= GetWord(data, strSh+20);
+
+		if (!entSize || ((symOffset+symSize) > data.size()) ||
+			((strOffset+strSize) > data.size())) {
+			printf("ERROR: Invalid symbol table in %s.\n", fileName);
+			return false;
+		}
+
+		for(uint32_t s=0; s<symSize; s+=entSize) {
+
+			size_t		sym		= symOffset+s;
+			uint32_t	name	= GetWord(data, sym);
+			uint8_t		info	= data[sym+12];
+
+			if (((info&0xf) != STT_FUNC) || (name >= strSize))
+				continue;
+
+			SYMBOL symbol;
+
+			symbol.name	= (const char*)&data[strOffset+name];
+			symbol.addr	= GetWord(data, sym+4);
+			symbol.size	= GetWord(data, sym+8);
+
+			symbols.push_back(symbol);
+
+		}
+
+	}
+
+	if (symbols.empty()) {
+		printf("ERROR: No function symbols found in %s.\n", fileName);
+		return false;
+	}
+
+	std::stable_sort(symbols.begin(), symbols.end(), [](const SYMBOL& a, const SYMBOL& b) {
+		return a.addr < b.addr;
+	});
+
+	// Drop aliases (keeping the first symbol at each address) and give
+	// functions without a size the space up to the next one
+	std::vector<SYMBOL> unique;
+
+	for(const SYMBOL& symbol : symbols) {
+
+		if (!unique.empty() && (unique.back().addr == symbol.addr))
+			continue;
+
+		unique.push_back(symbol);
+
+	}
+
+	for(size_t i=0; i<unique.size(); i++) {
+
+		if (!unique[i].size && ((i+1) < unique.size()))
+			unique[i].size = unique[i+1].addr-unique[i].addr;
+
+	}
+
+	symbols = unique;
+
+	return true;
+
+}
+
+int SymbolTable::Find(uint32_t addr) const {
+
+	auto it = std::upper_bound(symbols.begin(), symbols.end(), addr,
+		[](uint32_t a, const SYMBOL& s) {
+		return a < s.addr;
+	});
+
+	if (it == symbols.begin())
+		return -1;
+
+	--it;
+
+	if ((addr-it->addr) >= it->size)
+		return -1;
+
+	return it-symbols.begin();
+
+}
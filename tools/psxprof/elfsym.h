@@ -0,0 +1,28 @@
+#ifndef _ELFSYM_H
+#define _ELFSYM_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+typedef struct {
+	std::string	name;
+	uint32_t	addr;
+	uint32_t	size;
+} SYMBOL;
+
+// Function symbols of an executable, sorted by address
+class SymbolTable {
+public:
+	std::vector<SYMBOL> symbols;
+
+	// Loads all function symbols from a 32-bit little endian MIPS ELF file.
+	// Functions without a size (e.g. assembly functions lacking a .size
+	// directive) are assumed to extend up to the next symbol.
+	bool Load(const char* fileName);
+
+	// Returns the index of the function containing the given address, or -1
+	int Find(uint32_t addr) const;
+};
+
+#endif // _ELFSYM_H
@@ -0,0 +1,354 @@
+/* Host side of the PSn00bSDK sampling profiler
+ *
+ * Reads the sample histograms and call stacks printed by ProfDump() on the
+ * target, attributes them to functions using the executable's symbol table
+ * and prints a flat profile. It can also write the call stacks in the "folded"
+ * format used by flame graph tools (one line per unique stack, with function
+ * names separated by semicolons and followed by a sample count) and generate
+ * a function ordering file for the linker (see psn00bsdk_target_text_order()),
+ * which groups the most frequently executed functions together so they don't
+ * evict each other from the instruction cache.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <map>
+#include "elfsym.h"
+#include "profile.h"
+
+#define VERSION "0.20"
+
+namespace param {
+
+	std::string	orderFileName;
+	std::string	foldedFileName;
+	float		coverage	= 99.f;
+	int			topCount	= 20;
+
+}
+
+typedef struct {
+	int			symbol;
+	uint32_t	samples;	// Samples taken within the function
+	uint32_t	inclusive;	// Call stacks the function appears in
+} FUNC_SAMPLES;
+
+// Attributes each counter (or the innermost address of each call stack, if
+// no histogram was dumped) to the function its range starts in, and each call
+// stack to all functions in it
+static std::vector<FUNC_SAMPLES> GetFunctionSamples(const PROFILE& profile, const SymbolTable& symbols, uint32_t* unknown) {
+
+	std::vector<uint32_t> samples(symbols.symbols.size(), 0);
+	std::vector<uint32_t> inclusive(symbols.symbols.size(), 0);
+	std::vector<size_t> lastStack(symbols.symbols.size(), SIZE_MAX);
+
+	*unknown = 0;
+
+	for(size_t i=0; i<profile.counters.size(); i++) {
+
+		if (!profile.counters[i])
+			continue;
+
+		int symbol = symbols.Find(profile.base+(i<<profile.shift));
+
+		if (symbol < 0)
+			*unknown += profile.counters[i];
+		else
+			samples[symbol] += profile.counters[i];
+
+	}
+
+	for(size_t i=0; i<profile.stacks.size(); i++) {
+
+		const std::vector<uint32_t>& stack = profile.stacks[i];
+
+		for(size_t j=0; j<stack.size(); j++) {
+
+			int symbol = symbols.Find(stack[j]);
+
+			if (symbol < 0)
+				continue;
+
+			if (!j && profile.counters.empty())
+				samples[symbol]++;
+
+			// Recursive functions are only counted once per stack
+			if (lastStack[symbol] != i) {
+				inclusive[symbol]++;
+				lastStack[symbol] = i;
+			}
+
+		}
+
+	}
+
+	std::vector<FUNC_SAMPLES> funcs;
+
+	for(size_t i=0; i<samples.size(); i++) {
+
+		if (samples[i] || inclusive[i])
+			funcs.push_back({ (int)i, samples[i], inclusive[i] });
+
+	}
+
+	// Most sampled first, ties broken by address to keep the output stable
+	std::sort(funcs.begin(), funcs.end(), [](const FUNC_SAMPLES& a, const FUNC_SAMPLES& b) {
+		if (a.samples != b.samples)
+			return a.samples > b.samples;
+		if (a.inclusive != b.inclusive)
+			return a.inclusive > b.inclusive;
+
+		return a.symbol < b.symbol;
+	});
+
+	return funcs;
+
+}
+
+// Writes the hottest functions (the ones accounting for the given percentage
+// of samples) as a list of input sections. This relies on functions being
+// compiled into their own .text.<name> sections (-ffunction-sections), which
+// is the case for the SDK libraries and projects built using its CMake scripts.
+static bool WriteOrderFile(const char* fileName, const std::vector<FUNC_SAMPLES>& funcs, const SymbolTable& symbols, const char* logFileName) {
+
+	FILE* fp = fopen(fileName, "w");
+
+	if (fp == NULL) {
+		printf("ERROR: Unable to create ordering file: %s\n", fileName);
+		return false;
+	}
+
+	uint32_t total = 0, covered = 0, size = 0;
+	int count = 0;
+
+	for(const FUNC_SAMPLES& func : funcs)
+		total += func.samples;
+
+	fprintf(fp, "/* Generated by psxprof " VERSION " from %s, do not edit */\n\n", logFileName);
+
+	for(const FUNC_SAMPLES& func : funcs) {
+
+		if (!func.samples || ((covered*100.f) >= (total*param::coverage)))
+			break;
+
+		const SYMBOL& symbol = symbols.symbols[func.symbol];
+
+		fprintf(fp, "*(.text.%s)\t/* %u samples, %u bytes */\n",
+			symbol.name.c_str(), func.samples, symbol.size);
+
+		covered	+= func.samples;
+		size	+= symbol.size;
+		count++;
+
+	}
+
+	fclose(fp);
+
+	printf("Wrote %d functions (%u bytes, %.1f%% of samples) to %s.\n",
+		count, size, total ? (covered*100.f/total) : 0.f, fileName);
+
+	if (size > 4096)
+		printf("Note: hot code is larger than the 4 KB instruction cache.\n");
+
+	return true;
+
+}
+
+static std::string GetFrameName(uint32_t addr, const SymbolTable& symbols) {
+
+	int symbol = symbols.Find(addr);
+
+	if (symbol >= 0)
+		return symbols.symbols[symbol].name;
+
+	char name[16];
+	snprintf(name, sizeof(name), "[%08x]", addr);
+
+	return name;
+
+}
+
+// Writes the call stacks in folded format, outermost function first. The
+// output can be fed to flamegraph.pl, speedscope, inferno and similar tools.
+static bool WriteFoldedStacks(const char* fileName, const PROFILE& profile, const SymbolTable& symbols) {
+
+	std::map<std::string, uint32_t> folded;
+
+	for(const std::vector<uint32_t>& stack : profile.stacks) {
+
+		std::string line;
+
+		for(size_t i=stack.size(); i>0; i--) {
+
+			if (!line.empty())
+				line += ';';
+
+			line += GetFrameName(stack[i-1], symbols);
+
+		}
+
+		folded[line]++;
+
+	}
+
+	FILE* fp = fopen(fileName, "w");
+
+	if (fp == NULL) {
+		printf("ERROR: Unable to create folded stacks file: %s\n", fileName);
+		return false;
+	}
+
+	for(const auto& entry : folded)
+		fprintf(fp, "%s %u\n", entry.first.c_str(), entry.second);
+
+	fclose(fp);
+
+	printf("Wrote %d unique stacks (%d samples) to %s.\n",
+		(int)folded.size(), (int)profile.stacks.size(), fileName);
+
+	return true;
+
+}
+
+int main(int argc, const char* argv[]) {
+
+	printf("PSXPROF " VERSION " - PSn00bSDK Profile Analyzer\n\n");
+
+	if (argc <= 2) {
+
+		printf("Parameters:\n");
+		printf("   psxprof [-o <file>] [-c <percent>] [-f <file>] [-n <count>] <elf> <log>\n\n");
+		printf("   -o <file>      - Generate a function ordering file for the linker\n");
+		printf("   -c <percent>   - Percentage of samples the functions in the ordering\n");
+		printf("                    file shall account for (default: 99)\n");
+		printf("   -f <file>      - Write call stacks in folded format (for flame graphs)\n");
+		printf("   -n <count>     - Number of functions to list (default: 20)\n");
+		printf("   <elf>          - Executable the profile was collected from\n");
+		printf("   <log>          - TTY log or file containing the output of ProfDump()\n");
+		printf("                    or ProfSave() (- to read from stdin)\n");
+
+		return EXIT_SUCCESS;
+
+	}
+
+	const char* elfFileName = NULL;
+	const char* logFileName = NULL;
+
+	for(int i=1; i<argc; i++) {
+
+		if ((strcmp(argv[i], "-o") == 0) && (i < argc-1)) {
+
+			param::orderFileName = argv[++i];
+
+		} else if ((strcmp(argv[i], "-c") == 0) && (i < argc-1)) {
+
+			param::coverage = atof(argv[++i]);
+
+		} else if ((strcmp(argv[i], "-f") == 0) && (i < argc-1)) {
+
+			param::foldedFileName = argv[++i];
+
+		} else if ((strcmp(argv[i], "-n") == 0) && (i < argc-1)) {
+
+			param::topCount = atoi(argv[++i]);
+
+		} else if (elfFileName == NULL) {
+
+			elfFileName = argv[i];
+
+		} else {
+
+			logFileName = argv[i];
+
+		}
+
+	}
+
+	if ((elfFileName == NULL) || (logFileName == NULL)) {
+		printf("ERROR: No executable or log file specified.\n");
+		return EXIT_FAILURE;
+	}
+
+	SymbolTable	symbols;
+	PROFILE		profile;
+
+	if (!symbols.Load(elfFileName))
+		return EXIT_FAILURE;
+
+	int dumps = ReadProfileLog(logFileName, &profile);
+
+	if (dumps < 0)
+		return EXIT_FAILURE;
+
+	if (!dumps) {
+		printf("ERROR: No profiler dumps found in %s.\n", logFileName);
+		return EXIT_FAILURE;
+	}
+
+	uint32_t unknown;
+	std::vector<FUNC_SAMPLES> funcs = GetFunctionSamples(profile, symbols, &unknown);
+
+	// Percentages are relative to the histogram's sample count, or to the
+	// number of call stacks if only stacks were collected
+	uint32_t total	= profile.counters.empty() ? profile.stacks.size() : profile.total;
+	int rate		= profile.counters.empty() ? profile.stackRate : profile.rate;
+
+	printf("Samples : %u from %d dump(s), %.2f seconds at %d Hz\n",
+		total, dumps, rate ? ((float)total/rate) : 0.f, rate);
+
+	if (!profile.counters.empty())
+		printf("Outside : %u (BIOS, DLLs or interrupt handlers)\n", profile.outside);
+	if (unknown)
+		printf("Unknown : %u (no matching symbol)\n", unknown);
+	if (!profile.stacks.empty() || profile.dropped)
+		printf("Stacks  : %u (%u dropped)\n", (uint32_t)profile.stacks.size(), profile.dropped);
+
+	bool hasStacks = !profile.stacks.empty();
+
+	if (hasStacks)
+		printf("\n   Self %%  Total %%  Samples  Size    Function\n");
+	else
+		printf("\n   Self %%  Samples  Size    Function\n");
+
+	for(int i=0; (i<param::topCount) && (i<(int)funcs.size()); i++) {
+
+		const SYMBOL& symbol = symbols.symbols[funcs[i].symbol];
+
+		printf("   %6.1f  ", total ? (funcs[i].samples*100.f/total) : 0.f);
+
+		if (hasStacks)
+			printf("%7.1f  ", funcs[i].inclusive*100.f/profile.stacks.size());
+
+		printf("%-7u  %-6u  %s\n",
+			funcs[i].samples, symbol.size, symbol.name.c_str());
+
+	}
+
+	printf("\n");
+
+	if (!param::foldedFileName.empty()) {
+
+		if (!hasStacks) {
+			printf("ERROR: No call stacks found in %s.\n", logFileName);
+			return EXIT_FAILURE;
+		}
+
+		if (!WriteFoldedStacks(param::foldedFileName.c_str(), profile, symbols))
+			return EXIT_FAILURE;
+
+	}
+
+	if (!param::orderFileName.empty()) {
+
+		if (!WriteOrderFile(param::orderFileName.c_str(), funcs, symbols, logFileName))
+			return EXIT_FAILURE;
+
+	}
+
+	return EXIT_SUCCESS;
+
+}
@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "profile.h"
+
+// Dumps are made up of lines prefixed with "@prof" (which may be preceded by
+// anything the emulator or terminal adds to each line):
+//   @prof hist <base> <shift> <counters> <rate> <total> <outside>
+//   @prof <index> <count>     (one for each non-zero counter, index in hex)
+//   @prof end
+// followed, if call stack sampling was enabled, by:
+//   @prof stacks <rate> <depth> <dropped>
+//   @prof s <address> [<address> ...]  (one for each sample)
+//   @prof end
+int ReadProfileLog(const char* fileName, PROFILE* profile) {
+
+	bool  isStdin = (strcmp(fileName, "-") == 0);
+	FILE* fp = isStdin ? stdin : fopen(fileName, "r");
+
+	if (fp == NULL) {
+		printf("ERROR: Unable to open profile log: %s\n", fileName);
+		return -1;
+	}
+
+	char	line[256];
+	int		dumps = 0, lineNum = 0;
+	bool	inDump = false, inStacks = false;
+
+	profile->base		= 0;
+	profile->shift		= 0;
+	profile->rate		= 0;
+	profile->total		= 0;
+	profile->outside	= 0;
+	profile->stackRate	= 0;
+	profile->dropped	= 0;
+	profile->counters.clear();
+	profile->stacks.clear();
+
+	while(fgets(line, sizeof(line), fp)) {
+
+		const char* ptr = strstr(line, "@prof ");
+
+		lineNum++;
+
+		if (ptr == NULL)
+			continue;
+
+		ptr += 6;
+
+		unsigned int	base, total, outside, index, count;
+		int				shift, length, rate;
+
+		if (sscanf(ptr, "hist %x %d %d %d %u %u",
+			&base, &shift, &length, &rate, &total, &outside) == 6) {
+
+			if (profile->counters.empty()) {
+
+				profile->base	= base;
+				profile->shift	= shift;
+				profile->rate	= rate;
+				profile->counters.resize(length);
+
+			} else if ((base != profile->base) || (shift != profile->shift) ||
+				(length != (int)profile->counters.size())) {
+
+				printf("ERROR: Dump at line %d doesn't match previous ones.\n", lineNum);
+				if (!isStdin)
+					fclose(fp);
+				return -1;
+
+			}
+
+			profile->total		+= total;
+			profile->outside	+= outside;
+			inDump = true;
+			dumps++;
+
+		} else if (sscanf(ptr, "stacks %d %d %u", &rate, &length, &count) == 3) {
+
+			profile->stackRate	= rate;
+			profile->dropped	+= count;
+			inStacks = true;
+			dumps++;
+
+		} else if (strncmp(ptr, "end", 3) == 0) {
+
+			inDump		= false;
+			inStacks	= false;
+
+		} else if (inStacks && (strncmp(ptr, "s ", 2) == 0)) {
+
+			std::vector<uint32_t> stack;
+			char* next;
+
+			ptr += 2;
+
+			while(true) {
+
+				uint32_t addr = strtoul(ptr, &next, 16);
+
+				if (next == ptr)
+					break;
+
+				stack.push_back(addr);
+				ptr = next;
+
+			}
+
+			if (!stack.empty())
+				profile->stacks.push_back(stack);
+
+		} else if (inDump && (sscanf(ptr, "%x %u", &index, &count) == 2)) {
+
+			if (index >= profile->counters.size()) {
+				printf("ERROR: Counter index out of range at line %d.\n", lineNum);
+				if (!isStdin)
+					fclose(fp);
+				return -1;
+			}
+
+			profile->counters[index] += count;
+
+		}
+
+	}
+
+	if (!isStdin)
+		fclose(fp);
+
+	return dumps;
+
+}
@@ -0,0 +1,27 @@
+#ifndef _PROFILE_H
+#define _PROFILE_H
+
+#include <stdint.h>
+#include <vector>
+
+// Histogram dumped by ProfDump() on the target
+typedef struct {
+	uint32_t				base;		// Address covered by the first counter
+	int						shift;		// Log2 of bytes covered by each counter
+	int						rate;		// Sampling rate in Hz
+	uint32_t				total;		// Total number of samples
+	uint32_t				outside;	// Samples outside of the text section
+	std::vector<uint32_t>	counters;
+
+	int						stackRate;	// Sampling rate of call stacks
+	uint32_t				dropped;	// Stacks dropped due to the ring being full
+	std::vector<std::vector<uint32_t>> stacks;	// Innermost address first
+} PROFILE;
+
+// Reads all profiler dumps from a TTY log (or from stdin if the file name is
+// "-"), merging them into a single histogram (dumps must have been collected
+// with the same base and shift) and a list of call stacks. Returns the number
+// of dumps found.
+int ReadProfileLog(const char* fileName, PROFILE* profile);
+
+#endif // _PROFILE_H
@@ -0,0 +1,263 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include "timreader.h"
+#include "batch.h"
+
+
+// 64-bit FNV-1a
+uint64_t HashData(const void* data, size_t size, uint64_t hash) {
+
+	const unsigned char* ptr = (const unsigned char*)data;
+
+	for(size_t i=0; i<size; i++) {
+		hash ^= ptr[i];
+		hash *= 0x100000001b3ull;
+	}
+
+	return hash;
+
+}
+
+int HashFile(const char* fileName, uint64_t* hash) {
+
+	FILE*	fp = fopen(fileName, "rb");
+	char	buff[65536];
+	size_t	len;
+
+	if (fp == NULL)
+		return false;
+
+	while((len = fread(buff, 1, sizeof(buff), fp)) > 0)
+		*hash = HashData(buff, len, *hash);
+
+	fclose(fp);
+
+	return true;
+
+}
+
+// Only the coordinates of the textures end up in the SMD, so editing the image
+// data of a TIM without moving it doesn't force the model to be rebuilt.
+uint64_t HashTextures(const std::vector<std::string>& texFiles) {
+
+	uint64_t hash = HASH_INIT;
+
+	for(const std::string& file : texFiles) {
+
+		TIM_COORDS coords;
+
+		memset(&coords, 0x00, sizeof(TIM_COORDS));
+
+		hash = HashData(file.c_str(), file.size()+1, hash);
+
+		if (GetTimCoordsCached(file.c_str(), &coords))
+			hash = HashData(&coords, sizeof(TIM_COORDS), hash);
+
+	}
+
+	return hash;
+
+}
+
+
+// Batch lists have one model per line, optionally followed by the output file
+// name. Empty lines and lines starting with # are ignored.
+int ReadBatchList(const char* fileName, std::vector<BATCH_JOB>& jobs) {
+
+	FILE*	fp = fopen(fileName, "r");
+	char	line[1024];
+
+	if (fp == NULL) {
+		printf("ERROR: Unable to open batch list: %s\n", fileName);
+		return false;
+	}
+
+	while(fgets(line, sizeof(line), fp)) {
+
+		BATCH_JOB	job;
+		char*		input = strtok(line, " \t\r\n");
+		char*		output = strtok(NULL, " \t\r\n");
+
+		if ((input == NULL) || (input[0] == '#'))
+			continue;
+
+		job.input = input;
+
+		if (output != NULL) {
+
+			job.output = output;
+
+		} else {
+
+			job.output = job.input;
+
+			if (job.output.rfind(".") != std::string::npos)
+				job.output.erase(job.output.rfind("."));
+
+			job.output += ".smd";
+
+		}
+
+		jobs.push_back(job);
+
+	}
+
+	fclose(fp);
+
+	return true;
+
+}
+
+
+// Build cache files are text files with one line per output, made up of the
+// input and texture hashes, the output file name and the texture file names,
+// all separated by tabs.
+int LoadBuildCache(const char* fileName, BUILD_CACHE* cache) {
+
+	FILE*	fp = fopen(fileName, "r");
+	char	line[4096];
+
+	// A missing cache simply means everything has to be built
+	if (fp == NULL)
+		return false;
+
+	while(fgets(line, sizeof(line), fp)) {
+
+		CACHE_ENTRY	entry;
+		char*		tok;
+
+		if (!(tok = strtok(line, "\t\r\n")))
+			continue;
+		entry.inputHash = strtoull(tok, NULL, 16);
+
+		if (!(tok = strtok(NULL, "\t\r\n")))
+			continue;
+		entry.texHash = strtoull(tok, NULL, 16);
+
+		if (!(tok = strtok(NULL, "\t\r\n")))
+			continue;
+
+		std::string output = tok;
+
+		while((tok = strtok(NULL, "\t\r\n")))
+			entry.texFiles.push_back(tok);
+
+		cache->entries[output] = entry;
+
+	}
+
+	fclose(fp);
+
+	return true;
+
+}
+
+int SaveBuildCache(const char* fileName, BUILD_CACHE* cache) {
+
+	FILE* fp = fopen(fileName, "w");
+
+	if (fp == NULL) {
+		printf("ERROR: Unable to write build cache: %s\n", fileName);
+		return false;
+	}
+
+	for(const auto& entry : cache->entries) {
+
+		fprintf(fp, "%016llx\t%016llx\t%s",
+			(unsigned long long)entry.second.inputHash,
+			(unsigned long long)entry.second.texHash, entry.first.c_str());
+
+		for(const std::string& file : entry.second.texFiles)
+			fprintf(fp, "\t%s", file.c_str());
+
+		fprintf(fp, "\n");
+
+	}
+
+	fclose(fp);
+
+	return true;
+
+}
+
+bool IsUpToDate(BUILD_CACHE* cache, const std::string& output, uint64_t inputHash) {
+
+	CACHE_ENTRY entry;
+
+	{
+		std::lock_guard<std::mutex> guard(cache->lock);
+
+		auto found = cache->entries.find(output);
+
+		if ((found == cache->entries.end()) || (found->second.inputHash != inputHash))
+			return false;
+
+		entry = found->second;
+	}
+
+	// The output must also still exist
+	FILE* fp = fopen(output.c_str(), "rb");
+
+	if (fp == NULL)
+		return false;
+
+	fclose(fp);
+
+	return HashTextures(entry.texFiles) == entry.texHash;
+
+}
+
+void UpdateBuildCache(BUILD_CACHE* cache, const std::string& output, uint64_t inputHash, const std::vector<std::string>& texFiles) {
+
+	CACHE_ENTRY entry;
+
+	entry.inputHash	= inputHash;
+	entry.texHash	= HashTextures(texFiles);
+	entry.texFiles	= texFiles;
+
+	std::lock_guard<std::mutex> guard(cache->lock);
+
+	cache->entries[output] = entry;
+
+}
+
+
+int RunBatch(const std::vector<BATCH_JOB>& jobs, int numThreads, const std::function<int(const BATCH_JOB&)>& convert) {
+
+	std::vector<std::thread>	threads;
+	std::atomic<size_t>			next(0);
+	std::atomic<int>			failed(0);
+
+	if (numThreads < 1)
+		numThreads = 1;
+	if ((size_t)numThreads > jobs.size())
+		numThreads = jobs.size();
+
+	// Each thread keeps taking the next unprocessed job until none are left
+	auto worker = [&]() {
+
+		size_t i;
+
+		while((i = next++) < jobs.size()) {
+
+			if (!convert(jobs[i]))
+				failed++;
+
+		}
+
+	};
+
+	for(int i=1; i<numThreads; i++)
+		threads.emplace_back(worker);
+
+	worker();
+
+	for(std::thread& thread : threads)
+		thread.join();
+
+	return failed;
+
+}
@@ -0,0 +1,51 @@
+#ifndef _BATCH_H
+#define _BATCH_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <functional>
+
+#define HASH_INIT	0xcbf29ce484222325ull
+
+typedef struct {
+	std::string					input;
+	std::string					output;
+} BATCH_JOB;
+
+typedef struct {
+	uint64_t					inputHash;	// Hash of the SMX file and options
+	uint64_t					texHash;	// Hash of the texture coordinates
+	std::vector<std::string>	texFiles;	// Textures the model depends on
+} CACHE_ENTRY;
+
+// Hashes of the inputs each output file was last built from, used to skip
+// models that haven't changed since the previous run
+typedef struct {
+	std::map<std::string, CACHE_ENTRY>	entries;
+	std::mutex							lock;
+} BUILD_CACHE;
+
+uint64_t HashData(const void* data, size_t size, uint64_t hash = HASH_INIT);
+
+int HashFile(const char* fileName, uint64_t* hash);
+
+uint64_t HashTextures(const std::vector<std::string>& texFiles);
+
+int ReadBatchList(const char* fileName, std::vector<BATCH_JOB>& jobs);
+
+int LoadBuildCache(const char* fileName, BUILD_CACHE* cache);
+
+int SaveBuildCache(const char* fileName, BUILD_CACHE* cache);
+
+bool IsUpToDate(BUILD_CACHE* cache, const std::string& output, uint64_t inputHash);
+
+void UpdateBuildCache(BUILD_CACHE* cache, const std::string& output, uint64_t inputHash, const std::vector<std::string>& texFiles);
+
+// Runs the given function for each job on a pool of threads and returns the
+// number of jobs that failed
+int RunBatch(const std::vector<BATCH_JOB>& jobs, int numThreads, const std::function<int(const BATCH_JOB&)>& convert);
+
+#endif // _BATCH_H
@@ -0,0 +1,558 @@
+// Level of detail generation
+//
+// Models are simplified with half-edge collapses (a vertex u is merged into one
+// of its neighbors v, which doesn't move), ordered by the quadric error metric
+// described in Garland & Heckbert's "Surface Simplification Using Quadric
+// Error Metrics". Half-edge collapses never create new vertex positions or
+// attributes, which keeps texture coordinates and colors exact and lets the
+// result share the quantized vertex list format of the original model.
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <queue>
+#include <vector>
+#include <algorithm>
+#include "lod.h"
+
+// Minimum cosine between a triangle's normal before and after a collapse
+#define LOD_MIN_FLIP_COS	0.2
+
+
+typedef struct {
+	int				v[3];
+	int				material;
+	int				n[3];
+	unsigned char	rgb[3][3];
+	int				tu[3],tv[3];
+	bool			removed;
+} LOD_TRI;
+
+typedef struct {
+	double q[10];	// Symmetric 4x4 matrix (upper triangle)
+} QUADRIC;
+
+typedef struct {
+	double	cost;
+	int		u, v;
+	int		uVersion, vVersion;
+} COLLAPSE;
+
+struct CollapseOrder {
+
+	bool operator()(const COLLAPSE& a, const COLLAPSE& b) const {
+		return a.cost > b.cost;
+	}
+
+};
+
+class Simplifier {
+
+	SMX_MODEL*						model;
+	std::vector<SMX_PRIM>			materials;
+	std::vector<LOD_TRI>			tris;
+	std::vector<std::vector<int> >	fans;
+	std::vector<QUADRIC>			quadrics;
+	std::vector<int>				version;
+	std::vector<char>				dead;
+	int								liveTris;
+
+	std::priority_queue<COLLAPSE, std::vector<COLLAPSE>, CollapseOrder> queue;
+
+	int		FindMaterial(const SMX_PRIM* prim);
+	void	AddTri(const SMX_PRIM* prim, int material, int a, int b, int c);
+	bool	SameCorner(const LOD_TRI* a, int i, const LOD_TRI* b, int j);
+	bool	GetNormal(int a, int b, int c, double* normal);
+	int		Corner(const LOD_TRI* tri, int vertex);
+	bool	IsLocked(int u);
+	bool	CanCollapse(int u, int v, int* refTri);
+	double	Cost(int u, int v);
+	void	PushEdges(int v);
+	void	Collapse(int u, int v, int refTri);
+
+public:
+
+	Simplifier(SMX_MODEL* model);
+
+	int  GetTriCount() const { return liveTris; }
+	void Run(int targetTris);
+	void Output();
+
+};
+
+
+Simplifier::Simplifier(SMX_MODEL* smxModel) {
+
+	model = smxModel;
+
+	fans.resize(model->verts.size());
+	quadrics.resize(model->verts.size());
+	version.resize(model->verts.size(), 0);
+	dead.resize(model->verts.size(), 0);
+
+	memset(quadrics.data(), 0x00, sizeof(QUADRIC)*quadrics.size());
+
+	// Split quads into triangles, following the GPU's (v0,v1,v2) (v1,v2,v3)
+	// split with the second triangle's winding flipped to match the first
+	for(size_t i=0; i<model->prims.size(); i++) {
+
+		const SMX_PRIM* prim = &model->prims[i];
+		int material = FindMaterial(prim);
+
+		AddTri(prim, material, 0, 1, 2);
+
+		if (prim->type == PRIM_TYPE_QUAD)
+			AddTri(prim, material, 2, 1, 3);
+
+	}
+
+	liveTris = tris.size();
+
+	// Accumulate the quadrics of the planes of all triangles around each
+	// vertex, weighted by area
+	for(size_t i=0; i<tris.size(); i++) {
+
+		const LOD_TRI* tri = &tris[i];
+		double n[4];
+
+		if (!GetNormal(tri->v[0], tri->v[1], tri->v[2], n))
+			continue;
+
+		const SMX_VERTEX* p = &model->verts[tri->v[0]];
+		double d = -(n[0]*p->x+n[1]*p->y+n[2]*p->z);
+		double plane[4] = { n[0], n[1], n[2], d };
+		double area = n[3];
+
+		for(int j=0; j<3; j++) {
+
+			QUADRIC* q = &quadrics[tri->v[j]];
+			int k = 0;
+
+			for(int r=0; r<4; r++) {
+				for(int c=r; c<4; c++)
+					q->q[k++] += area*plane[r]*plane[c];
+			}
+
+		}
+
+	}
+
+}
+
+int Simplifier::FindMaterial(const SMX_PRIM* prim) {
+
+	SMX_PRIM mat;
+
+	// Only keep the attributes shared by the whole primitive
+	memset(&mat, 0x00, sizeof(SMX_PRIM));
+
+	mat.type		= PRIM_TYPE_TRI;
+	mat.lighting	= prim->lighting;
+	mat.gouraud		= prim->gouraud;
+	mat.textured	= prim->textured;
+	mat.doubleSided	= prim->doubleSided;
+	mat.blend		= prim->blend;
+
+	if (prim->textured)
+		mat.texture = prim->texture;
+	if (prim->lighting == PRIM_LIGHTING_FLAT)
+		mat.n[0] = prim->n[0];
+	if (!prim->gouraud)
+		memcpy(mat.rgb[0], prim->rgb[0], 3);
+
+	for(size_t i=0; i<materials.size(); i++) {
+
+		if (memcmp(&materials[i], &mat, sizeof(SMX_PRIM)) == 0)
+			return i;
+
+	}
+
+	materials.push_back(mat);
+
+	return materials.size()-1;
+
+}
+
+void Simplifier::AddTri(const SMX_PRIM* prim, int material, int a, int b, int c) {
+
+	LOD_TRI tri;
+	int corners[3] = { a, b, c };
+
+	memset(&tri, 0x00, sizeof(LOD_TRI));
+
+	tri.material = material;
+
+	for(int i=0; i<3; i++) {
+
+		int k = corners[i];
+
+		tri.v[i] = prim->v[k];
+		tri.tu[i] = prim->tu[k];
+		tri.tv[i] = prim->tv[k];
+
+		if (prim->lighting == PRIM_LIGHTING_SMOOTH)
+			tri.n[i] = prim->n[k];
+		if (prim->gouraud)
+			memcpy(tri.rgb[i], prim->rgb[k], 3);
+
+	}
+
+	// Skip triangles that are already degenerate
+	if ((tri.v[0] == tri.v[1]) || (tri.v[1] == tri.v[2]) || (tri.v[2] == tri.v[0]))
+		return;
+
+	for(int i=0; i<3; i++)
+		fans[tri.v[i]].push_back(tris.size());
+
+	tris.push_back(tri);
+
+}
+
+bool Simplifier::SameCorner(const LOD_TRI* a, int i, const LOD_TRI* b, int j) {
+
+	if (a->material != b->material)
+		return false;
+	if ((a->n[i] != b->n[j]) || memcmp(a->rgb[i], b->rgb[j], 3))
+		return false;
+	if ((a->tu[i] != b->tu[j]) || (a->tv[i] != b->tv[j]))
+		return false;
+
+	return true;
+
+}
+
+// Computes the unit normal of a triangle, storing its area in normal[3].
+bool Simplifier::GetNormal(int a, int b, int c, double* normal) {
+
+	const SMX_VERTEX* v0 = &model->verts[a];
+	const SMX_VERTEX* v1 = &model->verts[b];
+	const SMX_VERTEX* v2 = &model->verts[c];
+
+	double ax = v1->x-v0->x, ay = v1->y-v0->y, az = v1->z-v0->z;
+	double bx = v2->x-v0->x, by = v2->y-v0->y, bz = v2->z-v0->z;
+
+	normal[0] = ay*bz-az*by;
+	normal[1] = az*bx-ax*bz;
+	normal[2] = ax*by-ay*bx;
+
+	double len = sqrt(normal[0]*normal[0]+normal[1]*normal[1]+normal[2]*normal[2]);
+
+	if (len == 0)
+		return false;
+
+	normal[0] /= len;
+	normal[1] /= len;
+	normal[2] /= len;
+	normal[3] = len/2;
+
+	return true;
+
+}
+
+int Simplifier::Corner(const LOD_TRI* tri, int vertex) {
+
+	for(int i=0; i<3; i++) {
+		if (tri->v[i] == vertex)
+			return i;
+	}
+
+	return -1;
+
+}
+
+// A vertex can't be moved if it lies on an open edge of the mesh or if the
+// triangles around it don't agree on its attributes (i.e. it's on a seam).
+bool Simplifier::IsLocked(int u) {
+
+	const LOD_TRI* first = NULL;
+	std::vector<int> edges;
+
+	for(size_t i=0; i<fans[u].size(); i++) {
+
+		const LOD_TRI* tri = &tris[fans[u][i]];
+
+		if (tri->removed)
+			continue;
+
+		int c = Corner(tri, u);
+
+		if (first == NULL)
+			first = tri;
+		else if (!SameCorner(first, Corner(first, u), tri, c))
+			return true;
+
+		edges.push_back(tri->v[(c+1)%3]);
+		edges.push_back(tri->v[(c+2)%3]);
+
+	}
+
+	// In a closed fan every neighbor is shared by exactly two triangles
+	std::sort(edges.begin(), edges.end());
+
+	for(size_t i=0; i<edges.size(); i+=2) {
+		if (((i+1) >= edges.size()) || (edges[i] != edges[i+1]))
+			return true;
+		if (((i+2) < edges.size()) && (edges[i+2] == edges[i]))
+			return true;
+	}
+
+	return (first == NULL);
+
+}
+
+bool Simplifier::CanCollapse(int u, int v, int* refTri) {
+
+	std::vector<int> uNeighbors, vNeighbors, shared, opposite;
+
+	if (dead[u] || dead[v] || IsLocked(u))
+		return false;
+
+	*refTri = -1;
+
+	for(size_t i=0; i<fans[u].size(); i++) {
+
+		const LOD_TRI* tri = &tris[fans[u][i]];
+
+		if (tri->removed)
+			continue;
+
+		int c = Corner(tri, u);
+		int cv = Corner(tri, v);
+
+		uNeighbors.push_back(tri->v[(c+1)%3]);
+		uNeighbors.push_back(tri->v[(c+2)%3]);
+
+		if (cv >= 0) {
+
+			// The triangles being removed must agree on v's attributes, as
+			// they're going to be applied to all of u's corners
+			if (*refTri < 0)
+				*refTri = fans[u][i];
+			else if (!SameCorner(&tris[*refTri], Corner(&tris[*refTri], v), tri, cv))
+				return false;
+
+			opposite.push_back(tri->v[3-c-cv]);
+			continue;
+
+		}
+
+		// Make sure the triangle doesn't flip or collapse
+		double before[4], after[4];
+		int nv[3] = { tri->v[0], tri->v[1], tri->v[2] };
+
+		nv[c] = v;
+
+		if (!GetNormal(tri->v[0], tri->v[1], tri->v[2], before) ||
+			!GetNormal(nv[0], nv[1], nv[2], after))
+			return false;
+		if ((before[0]*after[0]+before[1]*after[1]+before[2]*after[2]) < LOD_MIN_FLIP_COS)
+			return false;
+
+	}
+
+	if (*refTri < 0)
+		return false;
+
+	// Link condition: u and v may only share the neighbors opposite to the
+	// edge, otherwise the collapse would create non-manifold geometry
+	for(size_t i=0; i<fans[v].size(); i++) {
+
+		const LOD_TRI* tri = &tris[fans[v][i]];
+
+		if (tri->removed)
+			continue;
+
+		for(int j=0; j<3; j++)
+			vNeighbors.push_back(tri->v[j]);
+
+	}
+
+	std::sort(uNeighbors.begin(), uNeighbors.end());
+	uNeighbors.erase(std::unique(uNeighbors.begin(), uNeighbors.end()), uNeighbors.end());
+	std::sort(vNeighbors.begin(), vNeighbors.end());
+	vNeighbors.erase(std::unique(vNeighbors.begin(), vNeighbors.end()), vNeighbors.end());
+	std::sort(opposite.begin(), opposite.end());
+	opposite.erase(std::unique(opposite.begin(), opposite.end()), opposite.end());
+
+	std::set_intersection(
+		uNeighbors.begin(), uNeighbors.end(),
+		vNeighbors.begin(), vNeighbors.end(),
+		std::back_inserter(shared)
+	);
+
+	for(size_t i=0; i<shared.size(); i++) {
+
+		if ((shared[i] == u) || (shared[i] == v))
+			continue;
+		if (!std::binary_search(opposite.begin(), opposite.end(), shared[i]))
+			return false;
+
+	}
+
+	return true;
+
+}
+
+double Simplifier::Cost(int u, int v) {
+
+	const QUADRIC* a = &quadrics[u];
+	const QUADRIC* b = &quadrics[v];
+	const SMX_VERTEX* p = &model->verts[v];
+	double x[4] = { (double)p->x, (double)p->y, (double)p->z, 1.0 };
+	double cost = 0;
+	int k = 0;
+
+	for(int r=0; r<4; r++) {
+		for(int c=r; c<4; c++) {
+			double q = a->q[k]+b->q[k];
+
+			cost += ((r == c) ? 1 : 2)*q*x[r]*x[c];
+			k++;
+		}
+	}
+
+	return fabs(cost);
+
+}
+
+void Simplifier::PushEdges(int v) {
+
+	for(size_t i=0; i<fans[v].size(); i++) {
+
+		const LOD_TRI* tri = &tris[fans[v][i]];
+
+		if (tri->removed)
+			continue;
+
+		for(int j=0; j<3; j++) {
+
+			int w = tri->v[j];
+
+			if (w == v)
+				continue;
+
+			COLLAPSE a = { Cost(v, w), v, w, version[v], version[w] };
+			COLLAPSE b = { Cost(w, v), w, v, version[w], version[v] };
+
+			queue.push(a);
+			queue.push(b);
+
+		}
+
+	}
+
+}
+
+void Simplifier::Collapse(int u, int v, int refTri) {
+
+	LOD_TRI ref = tris[refTri];
+	int rc = Corner(&ref, v);
+
+	for(size_t i=0; i<fans[u].size(); i++) {
+
+		LOD_TRI* tri = &tris[fans[u][i]];
+
+		if (tri->removed)
+			continue;
+
+		if (Corner(tri, v) >= 0) {
+			tri->removed = true;
+			liveTris--;
+			continue;
+		}
+
+		int c = Corner(tri, u);
+
+		tri->v[c] = v;
+		tri->n[c] = ref.n[rc];
+		tri->tu[c] = ref.tu[rc];
+		tri->tv[c] = ref.tv[rc];
+		memcpy(tri->rgb[c], ref.rgb[rc], 3);
+
+		fans[v].push_back(fans[u][i]);
+
+	}
+
+	for(int k=0; k<10; k++)
+		quadrics[v].q[k] += quadrics[u].q[k];
+
+	fans[u].clear();
+	dead[u] = 1;
+	version[v]++;
+
+	PushEdges(v);
+
+}
+
+void Simplifier::Run(int targetTris) {
+
+	for(size_t v=0; v<fans.size(); v++)
+		PushEdges(v);
+
+	while((liveTris > targetTris) && !queue.empty()) {
+
+		COLLAPSE col = queue.top();
+		int refTri;
+
+		queue.pop();
+
+		if ((version[col.u] != col.uVersion) || (version[col.v] != col.vVersion))
+			continue;
+		if (!CanCollapse(col.u, col.v, &refTri))
+			continue;
+
+		Collapse(col.u, col.v, refTri);
+
+	}
+
+}
+
+void Simplifier::Output() {
+
+	std::vector<SMX_PRIM> prims;
+
+	for(size_t i=0; i<tris.size(); i++) {
+
+		const LOD_TRI* tri = &tris[i];
+
+		if (tri->removed)
+			continue;
+
+		SMX_PRIM prim = materials[tri->material];
+
+		for(int j=0; j<3; j++) {
+
+			prim.v[j] = tri->v[j];
+			prim.tu[j] = tri->tu[j];
+			prim.tv[j] = tri->tv[j];
+
+			if (prim.lighting == PRIM_LIGHTING_SMOOTH)
+				prim.n[j] = tri->n[j];
+			if (prim.gouraud)
+				memcpy(prim.rgb[j], tri->rgb[j], 3);
+
+		}
+
+		prims.push_back(prim);
+
+	}
+
+	model->prims = prims;
+
+}
+
+
+int SimplifyModel(SMX_MODEL* model, float ratio, int* targetTris) {
+
+	Simplifier simplifier(model);
+
+	// The target is relative to the triangle count after degenerate triangles
+	// have been dropped, so that they don't count towards the reduction
+	*targetTris = simplifier.GetTriCount()*ratio;
+
+	simplifier.Run(*targetTris);
+	simplifier.Output();
+
+	return simplifier.GetTriCount();
+
+}
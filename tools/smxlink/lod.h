@@ -0,0 +1,18 @@
+#ifndef _LOD_H
+#define _LOD_H
+
+#include "model.h"
+
+// Simplifies a model down to the given fraction of its triangle count (quads
+// count as two, degenerate triangles are dropped and not counted) using
+// quadric error metric edge collapses. Vertices lying on mesh boundaries or on
+// attribute seams (texture coordinates, normals, colors or material changes)
+// are never moved, so seams are preserved. The result is made of triangles
+// only and should be run through MergeQuads().
+//
+// Returns the number of triangles left and stores the target count in
+// targetTris. The result is higher than the target if no more edges could be
+// collapsed without moving locked vertices or flipping triangles.
+int SimplifyModel(SMX_MODEL* model, float ratio, int* targetTris);
+
+#endif // _LOD_H
@@ -9,996 +9,492 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include <tinyxml2.h>
 #include <string>
+#include <thread>
 //#include <windef.h>
 #include "timreader.h"
+#include "model.h"
+#include "optimize.h"
+#include "lod.h"
+#include "batch.h"
 
 #ifdef WIN32
 #define strcasecmp _stricmp
 #endif
 
-#define VERSION "0.25b"
+#define VERSION "0.30b"
 
 namespace param
 {
 	std::string smxFileName;
 	std::string smdFileName;
 	std::string texDir;
+	std::string layoutFileName;
 
 	float	scaleFactor = 1.f;
+
+	bool	weld		= false;
+	int		weldVerts	= 0;
+	int		weldNorms	= 0;
+	bool	mergeQuads	= false;
+	bool	reorder		= false;
+	bool	packets		= false;
+
+	int		numLods		= 1;
+	float	lodRatio	= 0.5f;
+	std::string lodDists;
+
+	std::string batchFileName;
+	std::string cacheFileName;
+	int		numThreads	= 0;
+	bool	verbose		= true;
 }
 
-typedef struct {
-	char			id[3];		// File ID (SMD)
-	unsigned char	version;	// Version number (0x01)
-	unsigned short	flags;
-	unsigned short	numverts;
-	unsigned short	numnorms;
-	unsigned short	numprims;
-	unsigned long	vtxAddr;
-	unsigned long	nrmAddr;
-	unsigned long	priAddr;
-} SMD_HEADER;
-
-typedef struct {
-	short vx,vy,vz,vp;
-} SVECTOR;
-
-
-#define PRIM_TYPE_LINE	0
-#define PRIM_TYPE_TRI	1
-#define PRIM_TYPE_QUAD	2
-
-#define PRIM_LIGHTING_NONE		0	// No shading (no normals)
-#define PRIM_LIGHTING_FLAT		1	// Flat shading (1 normal)
-#define PRIM_LIGHTING_SMOOTH	2	// Smooth shading (3 normals per vertex)
-
-typedef struct {
-	
-    unsigned char type:2;		// Primitive type
-	unsigned char l_type:2;		// Lighting type (0 - none, 1 - flat shading, 2 - smooth shading)
-	unsigned char c_type:1;		// Coloring type (0 - solid color, 1 - gouraud)
-    unsigned char texture:1;	// Texture mapped
-	unsigned char blend:2;		// Blend mode setting (actual blend enable is determined by primitive code)
-	// byte boundary
-	unsigned char zoff:4;
-	unsigned char nocull:1;		// Double sided (no cull)
-	unsigned char mask:1;		// Force mask bit setting    
-	unsigned char texwin:2;
-	// byte boundary
-	unsigned char texoff:2;
-	unsigned char reserved:6;
-	// byte boundary
-	unsigned char len;
-} PRIM_ID;
-
-typedef struct {
-	unsigned short	v0,v1,v2,v3;
-} PRIM_V;
-
-typedef struct {
-	unsigned char	r,g,b,c;
-} PRIM_RGBC;
-
-typedef struct {
-	unsigned short tpage,clut;
-} PRIM_TC;
-
-typedef struct {
-	unsigned char	u,v;
-} PRIM_UV;
+// Default farthest Z of the first LOD, doubled for each following LOD
+#define DEFAULT_LOD_Z	1024
 
 
-int main(int argc, const char* argv[]) {
+static void PrintStats(const char* label, const SMX_STATS* stats) {
 
-	printf("SMXLINK " VERSION " - Scarlet SMX to SMD Model Converter "
-		"(part of Scarlet Engine)\n");
-	printf("Note: Outputs in *NEW* revision 1 format!\n");
-	printf("2017-2019 Meido-Tek Productions\n\n");
+	printf("   %-7s %6d verts, %6d norms, %6d tris, %6d quads, %6d transforms\n",
+		label, stats->verts, stats->norms, stats->tris, stats->quads,
+		stats->transforms);
 
-	if (argc <= 1) {
+}
 
-		printf("Parameters:\n");
-		printf("   smxlink [-o <filename>] [-s <scale>] <smxfile>\n\n");
-		printf("   -o  <filename> - Specify output filename (default: first file specified)\n");
-		printf("   -s  <scale>    - Scale factor to apply to model on conversion (default: 1.0)\n");
-		printf("   -tp <path>     - Specify directory path to TIM texture files\n");
-		printf("   <smxfile>	  - SMX file to convert to SMD\n");
 
-		return EXIT_SUCCESS;
+// Generates the LODs by simplifying each level from the previous one, then
+// writes them to an SML file.
+static int GenerateLODs(const SMX_MODEL* model, const char* fileName) {
+
+	std::vector<SMX_MODEL>	lods;
+	std::vector<uint32_t>	maxZ;
+	const char*				dist = param::lodDists.c_str();
 
+	if (model->badIndices) {
+		printf("ERROR: Can't generate LODs for a model with invalid indices.\n");
+		return false;
+	}
+	if ((param::lodRatio <= 0) || (param::lodRatio >= 1)) {
+		printf("ERROR: LOD ratio must be between 0 and 1.\n");
+		return false;
 	}
 
-	for(int i=1; i<argc; i++) {
+	lods.push_back(*model);
 
-		if (strcasecmp(argv[i], "-o") == 0) {
+	if (param::verbose)
+		printf("LOD generation:\n");
 
-			i++;
-			param::smdFileName = argv[i];
+	for(int i=0; i<param::numLods; i++) {
 
-		} else if (strcasecmp(argv[i], "-s") == 0) {
+		SMX_STATS stats;
 
-			i++;
-			param::scaleFactor = atof(argv[i]);
+		if (i > 0) {
 
-		} else if (strcasecmp(argv[i], "-tp") == 0) {
+			SMX_MODEL lod = lods[i-1];
+			int target, result;
 
-			i++;
-			param::texDir = argv[i];
+			result = SimplifyModel(&lod, param::lodRatio, &target);
 
-			if( ( param::texDir[param::texDir.size()-1] != '\\' ) &&
-				( param::texDir[param::texDir.size()-1] != '/') ) {
-				
-				param::texDir += "/";
-				
+			if (result > target) {
+				printf("WARNING: %s: LOD %d has %d triangles, could not reach "
+					"target of %d without breaking seams or boundaries.\n",
+					fileName, i, result, target);
 			}
-			
-		} else {
 
-			param::smxFileName = argv[i];
+			MergeQuads(&lod);
 
-		}
+			if (param::reorder)
+				ReorderModel(&lod);
+			else
+				CompactModel(&lod, false);
 
-	}
+			lods.push_back(lod);
 
-	if (param::smdFileName.empty()) {
+		}
 
-        param::smdFileName = param::smxFileName;
-        param::smdFileName.erase(param::smdFileName.rfind("."));
-        param::smdFileName += ".smd";
+		// Parse the next distance from the list, or make one up
+		if (i == (param::numLods-1)) {
 
-	}
+			maxZ.push_back(0xffffffff);
 
-	printf("Input  : %s\n", param::smxFileName.c_str());
-	printf("Output : %s\n", param::smdFileName.c_str());
+		} else if (*dist) {
 
-	if (!param::texDir.empty())
-		printf("TexDir : %s\n", param::texDir.c_str());
+			maxZ.push_back(strtoul(dist, (char**)&dist, 0));
 
-	printf("\n");
+			if (*dist == ',')
+				dist++;
 
-    tinyxml2::XMLDocument smxFile;
+		} else {
 
-    if (smxFile.LoadFile(param::smxFileName.c_str()) != tinyxml2::XML_SUCCESS) {
-		printf("ERROR: Unable to load SMX file:\n");
-		smxFile.PrintError();
-		return EXIT_FAILURE;
-    }
+			maxZ.push_back(DEFAULT_LOD_Z<<i);
 
-    tinyxml2::XMLElement* smxModel = smxFile.FirstChildElement("model");
+		}
 
-	// Parse textures
-	TIM_COORDS *texCoords = NULL;
-	int numTextures = 0;
+		if (!param::verbose)
+			continue;
 
-	if (smxModel->FirstChildElement("textures") != NULL) {
+		GetModelStats(&lods[i], &stats);
 
-        tinyxml2::XMLElement *texFileElement = smxModel->FirstChildElement("textures");
+		printf("   LOD %d: %6d verts, %6d tris, %6d quads, max Z ",
+			i, stats.verts, stats.tris, stats.quads);
 
-        if (texFileElement != NULL) {
+		if (maxZ[i] == 0xffffffff)
+			printf("(any)\n");
+		else
+			printf("%u\n", maxZ[i]);
 
-			numTextures = atoi(texFileElement->Attribute("count"));
-			texFileElement = texFileElement->FirstChildElement("texture");
+	}
 
-			texCoords = (TIM_COORDS*)malloc(sizeof(TIM_COORDS)*numTextures);
+	if (param::verbose)
+		printf("\n");
 
-			int index = 0;
+	return WriteSML(fileName, lods, maxZ, param::packets);
 
-			while(texFileElement != NULL) {
+}
 
-				std::string timFileName = texFileElement->Attribute("file");
+// Returns a string made up of all parameters that affect the output, which is
+// hashed along with each input file for the build cache.
+static std::string GetOptionsKey(void) {
 
-				if (timFileName.rfind(".") == std::string::npos)
-				{
-					timFileName.append(".tim");
-				}
+	char key[256];
 
-				timFileName = param::texDir + timFileName;
+	snprintf(key, sizeof(key), VERSION "|%g|%d|%d|%d|%d|%d|%d|%d|%g|",
+		param::scaleFactor, param::weld, param::weldVerts, param::weldNorms,
+		param::mergeQuads, param::reorder, param::packets, param::numLods,
+		param::lodRatio);
 
-                if (!GetTimCoords(timFileName.c_str(), &texCoords[index])) {
-                    printf("ERROR: Unable to open texture file: %s\n", timFileName.c_str());
-                    free(texCoords);
-                    return EXIT_FAILURE;
-                }
+	return key + param::lodDists + "|" + param::texDir + "|" + param::layoutFileName;
 
-				switch(texCoords[index].flag.pmode) {
-				case 0:	// 4-bit
-					texCoords[index].pixdata.pw *= 4;
-					break;
-				case 1: // 8-bit
-					texCoords[index].pixdata.pw *= 2;
-					break;
-				}
-				
-				texFileElement = texFileElement->NextSiblingElement("texture");
-				index++;
+}
 
-			}
+static int ConvertModel(const BATCH_JOB& job, BUILD_CACHE* cache) {
 
-        }
+	SMX_MODEL	model;
+	uint64_t	inputHash = HASH_INIT;
 
-	}
+	if (cache) {
 
+		std::string key = GetOptionsKey();
 
-    FILE* smdFile = fopen(param::smdFileName.c_str(), "wb");
+		inputHash = HashData(key.c_str(), key.size(), inputHash);
 
-	// Create temporary header
-	SMD_HEADER smdHeader;
+		if (HashFile(job.input.c_str(), &inputHash) &&
+			IsUpToDate(cache, job.output, inputHash)) {
 
-	memset(&smdHeader, 0x00, sizeof(SMD_HEADER));
-	fwrite(&smdHeader, sizeof(SMD_HEADER), 1, smdFile);
+			if (param::verbose)
+				printf("Output is up to date.\n");
+			else
+				printf("Up to date: %s\n", job.output.c_str());
 
+			return true;
 
-    // Convert vertices
-	if (smxModel->FirstChildElement("vertices") != NULL) {
+		}
 
-		smdHeader.vtxAddr = ftell(smdFile);
-		
-		tinyxml2::XMLElement* smxVertices = smxModel->FirstChildElement("vertices");
-		smxVertices = smxVertices->FirstChildElement("v");
+	}
 
-        while(smxVertices != NULL) {
+	if (!param::verbose)
+		printf("Converting: %s -> %s\n", job.input.c_str(), job.output.c_str());
 
-            SVECTOR vertex;
+	if (!LoadSMX(job.input.c_str(), &model, param::texDir, param::scaleFactor))
+		return false;
 
-			vertex.vx = round(param::scaleFactor * atof(smxVertices->Attribute("x")));
-			vertex.vy = round(param::scaleFactor * atof(smxVertices->Attribute("y")));
-			vertex.vz = round(param::scaleFactor * atof(smxVertices->Attribute("z")));
-			vertex.vp = 0;
 
-			fwrite(&vertex, sizeof(SVECTOR), 1, smdFile);
-			smdHeader.numverts++;
-			
-			smxVertices = smxVertices->NextSiblingElement("v");
+	if (model.badIndices) {
 
-        }
-		
-		smdHeader.flags |= 0x1;
+		printf("WARNING: %s: %d primitive(s) reference missing vertices or normals.\n",
+			job.input.c_str(), model.badIndices);
 
 	}
 
+	// Run optimization passes
+	if ((param::weld || param::mergeQuads || param::reorder) && model.badIndices) {
 
-	// Convert normals
-	if (smxModel->FirstChildElement("normals") != NULL) {
+		printf("WARNING: %s: Skipping optimizations due to invalid indices.\n",
+			job.input.c_str());
 
-		smdHeader.nrmAddr = ftell(smdFile);
+	} else if (param::weld || param::mergeQuads || param::reorder) {
 
-		tinyxml2::XMLElement* smxVertices = smxModel->FirstChildElement("normals");
+		SMX_STATS before, after;
 
-		smxVertices = smxVertices->FirstChildElement("v");
+		GetModelStats(&model, &before);
 
-        while(smxVertices != NULL) {
+		if (param::weld) {
 
-            SVECTOR vertex;
+			int removed = WeldModel(&model, param::weldVerts, param::weldNorms);
 
-			vertex.vx = round(4096 * atof(smxVertices->Attribute("x")));
-			vertex.vy = round(4096 * atof(smxVertices->Attribute("y")));
-			vertex.vz = round(4096 * atof(smxVertices->Attribute("z")));
-			vertex.vp = 0;
+			if (removed && param::verbose)
+				printf("Welding removed %d degenerate primitive(s).\n", removed);
 
-			fwrite(&vertex, sizeof(SVECTOR), 1, smdFile);
-			smdHeader.numnorms++;
-			
-			smxVertices = smxVertices->NextSiblingElement("v");
-
-        }
-		
-		smdHeader.flags |= 0x2;
+		}
 
-	} else {
-		
-		smdHeader.numnorms = 0;
-		
-	}
+		if (param::mergeQuads)
+			MergeQuads(&model);
 
+		if (param::reorder)
+			ReorderModel(&model);
 
-	if (smxModel->FirstChildElement("primitives") != NULL) {
+		GetModelStats(&model, &after);
 
-		smdHeader.priAddr = ftell(smdFile);
+		if (param::verbose) {
 
-		tinyxml2::XMLElement* smxPrimitive = smxModel->FirstChildElement("primitives");
-		smxPrimitive = smxPrimitive->FirstChildElement("poly");
+			printf("\nOptimization report (%d vertex cache):\n", VERTEX_CACHE_SIZE);
+			PrintStats("Before:", &before);
+			PrintStats("After:", &after);
 
-		PRIM_ID *prim;
-		char pribuff[40];
-		char* priptr;
-		while(smxPrimitive != NULL) {
-			
-			const char* primType = smxPrimitive->Attribute("type");
-			
-			if( primType == NULL ) {
-				smxPrimitive = smxPrimitive->NextSiblingElement("poly");
-				continue;
-			}
-			
-			memset( pribuff, 0x0, 32 );
-			priptr = pribuff;
-			
-			prim = (PRIM_ID*)priptr;
-			
-			if( smxPrimitive->IntAttribute( "double" )  )
-				prim->nocull = true;
-			
-			if( ( strcasecmp( "F3", primType ) == 0 ) || 
-				( strcasecmp( "FT3", primType ) == 0 ) ) {
-				
-				prim->type		= PRIM_TYPE_TRI;
-				prim->len		= 4;
-				
-				priptr += sizeof(PRIM_ID);
-				
-				// Write vertex indices
-				((PRIM_V*)priptr)->v0 = atoi( smxPrimitive->Attribute( "v0" ) );
-				((PRIM_V*)priptr)->v1 = atoi( smxPrimitive->Attribute( "v1" ) );
-				((PRIM_V*)priptr)->v2 = atoi( smxPrimitive->Attribute( "v2" ) );
-				((PRIM_V*)priptr)->v3 = 0;
-				
-				priptr += 8;
-				prim->len += 8;
-				
-				if( strcasecmp( "F", smxPrimitive->Attribute( "shading" ) ) == 0 ) {
-
-					prim->l_type = PRIM_LIGHTING_FLAT;
-					
-					((PRIM_V*)priptr)->v0 = atoi( smxPrimitive->Attribute( "n0" ) );
-					((PRIM_V*)priptr)->v1 = 0;
-					priptr += 4;
-					prim->len += 4;
-							
-				} else if( strcasecmp( "S", smxPrimitive->Attribute( "shading" ) ) == 0 ) {
-
-					prim->l_type = PRIM_LIGHTING_SMOOTH;
-					
-					((PRIM_V*)priptr)->v0 = atoi( smxPrimitive->Attribute( "n0" ) );
-					((PRIM_V*)priptr)->v1 = atoi( smxPrimitive->Attribute( "n1" ) );
-					((PRIM_V*)priptr)->v2 = atoi( smxPrimitive->Attribute( "n2" ) );
-					((PRIM_V*)priptr)->v3 = 0;
-					
-					priptr += 8;
-					prim->len += 8;
-					
-				}
-				
-				((PRIM_RGBC*)priptr)->r = atoi( smxPrimitive->Attribute( "r0" ) );
-				((PRIM_RGBC*)priptr)->g = atoi( smxPrimitive->Attribute( "g0" ) );
-				((PRIM_RGBC*)priptr)->b = atoi( smxPrimitive->Attribute( "b0" ) );
-				
-				if( smxPrimitive->IntAttribute( "blend" ) > 0 ) {
-					((PRIM_RGBC*)priptr)->c = 0x2;
-					prim->blend = smxPrimitive->IntAttribute( "blend" )-1;
-				}
-				
-				priptr += 4;
-				prim->len += 4;
-				
-				if( strcasecmp( "FT3", primType ) == 0 ) {	// Textured
-					
-					TIM_COORDS *tex;
-					int uoffs,voffs;
-					int texNum = atoi( smxPrimitive->Attribute( "texture" ) );
-
-					if( texNum < 0 ) {
-
-						printf( "ERROR: Primitive with negative texture index encountered.\n" );
-
-						fclose( smdFile );
-
-						if( texCoords != NULL ) {
-							free( texCoords );
-						}
-
-						return EXIT_FAILURE;
-
-					} else if( texNum > numTextures-1 ) {
-
-						printf( "ERROR: Primitive with texture index greater than specified encountered.\n" );
-
-						fclose( smdFile );
-
-						if( texCoords != NULL ) {
-							free( texCoords );
-						}
-
-						return EXIT_FAILURE;
-
-					}
-					
-					tex = &texCoords[texNum];
-					
-					uoffs = tex->pixdata.px;
-					voffs = tex->pixdata.py&0xff;
-					
-					switch(tex->flag.pmode) {
-					case 0:	// 4-bit
-						uoffs = (uoffs*4)%256;
-						break;
-					case 1: // 8-bit
-						uoffs = (uoffs*2)%128;
-						break;
-					case 2: // 16-bit
-						uoffs = uoffs%64;
-						break;
-					}
-					
-					((PRIM_UV*)priptr)[0].u = smxPrimitive->IntAttribute( "tu0" )+uoffs;
-					((PRIM_UV*)priptr)[0].v = smxPrimitive->IntAttribute( "tv0" )+voffs;
-					((PRIM_UV*)priptr)[1].u = smxPrimitive->IntAttribute( "tu1" )+uoffs;
-					((PRIM_UV*)priptr)[1].v = smxPrimitive->IntAttribute( "tv1" )+voffs;
-					((PRIM_UV*)priptr)[2].u = smxPrimitive->IntAttribute( "tu2" )+uoffs;
-					((PRIM_UV*)priptr)[2].v = smxPrimitive->IntAttribute( "tv2" )+voffs;
-					((PRIM_UV*)priptr)[3].u = 0;
-					((PRIM_UV*)priptr)[3].v = 0;
-					
-					priptr += 8;
-					prim->len += 8;
-					
-					((PRIM_TC*)priptr)->tpage = GetTPage( tex->flag.pmode, 
-						prim->blend, tex->pixdata.px, tex->pixdata.py );
-                    ((PRIM_TC*)priptr)->clut = GetClut( tex->clutdata.px, tex->clutdata.py );
-					
-					priptr += 4;
-					prim->len += 4;
-					
-					prim->texture = true;
-					
-				}
-				
-				fwrite( pribuff, 1, prim->len, smdFile );
-				smdHeader.numprims++;
-			
-			} else if( strcasecmp( "G3", primType ) == 0 ) {
-				
-				prim->type		= PRIM_TYPE_TRI;
-				prim->len		= 4;
-				prim->c_type	= 1;	// Gouraud
-				
-				priptr += sizeof(PRIM_ID);
-				
-				// Write vertex indices
-				((PRIM_V*)priptr)->v0 = atoi( smxPrimitive->Attribute( "v0" ) );
-				((PRIM_V*)priptr)->v1 = atoi( smxPrimitive->Attribute( "v1" ) );
-				((PRIM_V*)priptr)->v2 = atoi( smxPrimitive->Attribute( "v2" ) );
-				((PRIM_V*)priptr)->v3 = 0;
-				
-				priptr += 8;
-				prim->len += 8;
-				
-				if( strcasecmp( "F", smxPrimitive->Attribute( "shading" ) ) == 0 ) {
-
-					prim->l_type = PRIM_LIGHTING_FLAT;
-					
-					((PRIM_V*)priptr)->v0 = atoi( smxPrimitive->Attribute( "n0" ) );
-					((PRIM_V*)priptr)->v1 = 0;
-					priptr += 4;
-					prim->len += 4;
-							
-				} else if( strcasecmp( "S", smxPrimitive->Attribute( "shading" ) ) == 0 ) {
-
-					prim->l_type = PRIM_LIGHTING_SMOOTH;
-					
-					((PRIM_V*)priptr)->v0 = atoi( smxPrimitive->Attribute( "n0" ) );
-					((PRIM_V*)priptr)->v1 = atoi( smxPrimitive->Attribute( "n1" ) );
-					((PRIM_V*)priptr)->v2 = atoi( smxPrimitive->Attribute( "n2" ) );
-					((PRIM_V*)priptr)->v3 = 0;
-					
-					priptr += 8;
-					prim->len += 8;
-					
-				}
-				
-				((PRIM_RGBC*)priptr)->r = atoi( smxPrimitive->Attribute( "r0" ) );
-				((PRIM_RGBC*)priptr)->g = atoi( smxPrimitive->Attribute( "g0" ) );
-				((PRIM_RGBC*)priptr)->b = atoi( smxPrimitive->Attribute( "b0" ) );
-				if( smxPrimitive->IntAttribute( "blend" ) > 0 ) {
-					((PRIM_RGBC*)priptr)->c = 0x2;
-					prim->blend = smxPrimitive->IntAttribute( "blend" )-1;
-				}
-				priptr += 4;
-				prim->len += 4;
-				
-				// Color 1
-				((PRIM_RGBC*)priptr)->r = atoi( smxPrimitive->Attribute( "r1" ) );
-				((PRIM_RGBC*)priptr)->g = atoi( smxPrimitive->Attribute( "g1" ) );
-				((PRIM_RGBC*)priptr)->b = atoi( smxPrimitive->Attribute( "b1" ) );
-				priptr += 4;
-				prim->len += 4;
-				
-				// Color 2
-				((PRIM_RGBC*)priptr)->r = atoi( smxPrimitive->Attribute( "r2" ) );
-				((PRIM_RGBC*)priptr)->g = atoi( smxPrimitive->Attribute( "g2" ) );
-				((PRIM_RGBC*)priptr)->b = atoi( smxPrimitive->Attribute( "b2" ) );
-				priptr += 4;
-				prim->len += 4;
-				
-				fwrite( pribuff, 1, prim->len, smdFile );
-				smdHeader.numprims++;
-				
-			} else if( ( strcasecmp( "F4", primType ) == 0 ) || 
-				( strcasecmp( "FT4", primType ) == 0 ) ) {
-				
-				prim->type		= PRIM_TYPE_QUAD;
-				prim->len		= 4;
-				
-				priptr += sizeof(PRIM_ID);
-				
-				// Write vertex indices
-				((PRIM_V*)priptr)->v0 = atoi( smxPrimitive->Attribute( "v0" ) );
-				((PRIM_V*)priptr)->v1 = atoi( smxPrimitive->Attribute( "v1" ) );
-				((PRIM_V*)priptr)->v2 = atoi( smxPrimitive->Attribute( "v2" ) );
-				((PRIM_V*)priptr)->v3 = atoi( smxPrimitive->Attribute( "v3" ) );
-				
-				priptr += 8;
-				prim->len += 8;
-				
-				if( strcasecmp( "F", smxPrimitive->Attribute( "shading" ) ) == 0 ) {
-
-					prim->l_type = PRIM_LIGHTING_FLAT;
-					
-					((PRIM_V*)priptr)->v0 = atoi( smxPrimitive->Attribute( "n0" ) );
-					((PRIM_V*)priptr)->v1 = 0;
-					priptr += 4;
-					prim->len += 4;
-							
-				} else if( strcasecmp( "S", smxPrimitive->Attribute( "shading" ) ) == 0 ) {
-
-					prim->l_type = PRIM_LIGHTING_SMOOTH;
-					
-					((PRIM_V*)priptr)->v0 = atoi( smxPrimitive->Attribute( "n0" ) );
-					((PRIM_V*)priptr)->v1 = atoi( smxPrimitive->Attribute( "n1" ) );
-					((PRIM_V*)priptr)->v2 = atoi( smxPrimitive->Attribute( "n2" ) );
-					((PRIM_V*)priptr)->v3 = atoi( smxPrimitive->Attribute( "n3" ) );
-					
-					priptr += 8;
-					prim->len += 8;
-					
-				}
-				
-				((PRIM_RGBC*)priptr)->r = atoi( smxPrimitive->Attribute( "r0" ) );
-				((PRIM_RGBC*)priptr)->g = atoi( smxPrimitive->Attribute( "g0" ) );
-				((PRIM_RGBC*)priptr)->b = atoi( smxPrimitive->Attribute( "b0" ) );
-				
-				if( smxPrimitive->IntAttribute( "blend" ) > 0 ) {
-					((PRIM_RGBC*)priptr)->c = 0x2;
-					prim->blend = smxPrimitive->IntAttribute( "blend" )-1;
-				}
-				
-				priptr += 4;
-				prim->len += 4;
-				
-				if( strcasecmp( "FT4", primType ) == 0 ) {	// Textured
-					
-					TIM_COORDS *tex;
-					int uoffs,voffs;
-					int texNum = atoi( smxPrimitive->Attribute( "texture" ) );
-
-					if( texNum < 0 ) {
-
-						printf( "ERROR: Primitive with negative texture index encountered.\n" );
-
-						fclose( smdFile );
-
-						if( texCoords != NULL ) {
-							free( texCoords );
-						}
-
-						return EXIT_FAILURE;
-
-					} else if( texNum > numTextures-1 ) {
-
-						printf( "ERROR: Primitive with texture index greater than specified encountered.\n" );
-
-						fclose( smdFile );
-
-						if( texCoords != NULL ) {
-							free( texCoords );
-						}
-
-						return EXIT_FAILURE;
-
-					}
-					
-					tex = &texCoords[texNum];
-					
-					uoffs = tex->pixdata.px;
-					voffs = tex->pixdata.py&0xff;
-					
-					switch(tex->flag.pmode) {
-					case 0:	// 4-bit
-						uoffs = (uoffs*4)%256;
-						break;
-					case 1: // 8-bit
-						uoffs = (uoffs*2)%128;
-						break;
-					case 2: // 16-bit
-						uoffs = uoffs%64;
-						break;
-					}
-					
-					((PRIM_UV*)priptr)[0].u = smxPrimitive->IntAttribute( "tu0" )+uoffs;
-					((PRIM_UV*)priptr)[0].v = smxPrimitive->IntAttribute( "tv0" )+voffs;
-					((PRIM_UV*)priptr)[1].u = smxPrimitive->IntAttribute( "tu1" )+uoffs;
-					((PRIM_UV*)priptr)[1].v = smxPrimitive->IntAttribute( "tv1" )+voffs;
-					((PRIM_UV*)priptr)[2].u = smxPrimitive->IntAttribute( "tu2" )+uoffs;
-					((PRIM_UV*)priptr)[2].v = smxPrimitive->IntAttribute( "tv2" )+voffs;
-					((PRIM_UV*)priptr)[3].u = smxPrimitive->IntAttribute( "tu3" )+uoffs;
-					((PRIM_UV*)priptr)[3].v = smxPrimitive->IntAttribute( "tv3" )+voffs;
-					
-					priptr += 8;
-					prim->len += 8;
-					
-					((PRIM_TC*)priptr)->tpage = GetTPage( tex->flag.pmode, 
-						prim->blend, tex->pixdata.px, tex->pixdata.py );
-                    ((PRIM_TC*)priptr)->clut = GetClut( tex->clutdata.px, tex->clutdata.py );
-					
-					priptr += 4;
-					prim->len += 4;
-					
-					prim->texture = true;
-					
-				}
-				
-				fwrite( pribuff, 1, prim->len, smdFile );
-				smdHeader.numprims++;
-			
-			} else if( strcasecmp( "G4", primType ) == 0 ) {
-				
-				prim->type		= PRIM_TYPE_QUAD;
-				prim->len		= 4;
-				prim->c_type	= 1;	// Gouraud
-				
-				priptr += sizeof(PRIM_ID);
-				
-				// Write vertex indices
-				((PRIM_V*)priptr)->v0 = atoi( smxPrimitive->Attribute( "v0" ) );
-				((PRIM_V*)priptr)->v1 = atoi( smxPrimitive->Attribute( "v1" ) );
-				((PRIM_V*)priptr)->v2 = atoi( smxPrimitive->Attribute( "v2" ) );
-				((PRIM_V*)priptr)->v3 = atoi( smxPrimitive->Attribute( "v3" ) );
-				
-				priptr += 8;
-				prim->len += 8;
-				
-				if( strcasecmp( "F", smxPrimitive->Attribute( "shading" ) ) == 0 ) {
-
-					prim->l_type = PRIM_LIGHTING_FLAT;
-					
-					((PRIM_V*)priptr)->v0 = atoi( smxPrimitive->Attribute( "n0" ) );
-					((PRIM_V*)priptr)->v1 = 0;
-					priptr += 4;
-					prim->len += 4;
-							
-				} else if( strcasecmp( "S", smxPrimitive->Attribute( "shading" ) ) == 0 ) {
-
-					prim->l_type = PRIM_LIGHTING_SMOOTH;
-					
-					((PRIM_V*)priptr)->v0 = atoi( smxPrimitive->Attribute( "n0" ) );
-					((PRIM_V*)priptr)->v1 = atoi( smxPrimitive->Attribute( "n1" ) );
-					((PRIM_V*)priptr)->v2 = atoi( smxPrimitive->Attribute( "n2" ) );
-					((PRIM_V*)priptr)->v3 = atoi( smxPrimitive->Attribute( "n3" ) );
-					
-					priptr += 8;
-					prim->len += 8;
-					
-				}
-				
-				// Color 0
-				((PRIM_RGBC*)priptr)->r = atoi( smxPrimitive->Attribute( "r0" ) );
-				((PRIM_RGBC*)priptr)->g = atoi( smxPrimitive->Attribute( "g0" ) );
-				((PRIM_RGBC*)priptr)->b = atoi( smxPrimitive->Attribute( "b0" ) );
-				
-				if( smxPrimitive->IntAttribute( "blend" ) > 0 ) {
-					((PRIM_RGBC*)priptr)->c = 0x2;
-					prim->blend = smxPrimitive->IntAttribute( "blend" )-1;
-				}
-				
-				priptr += 4;
-				prim->len += 4;
-				
-				// Color 1
-				((PRIM_RGBC*)priptr)->r = atoi( smxPrimitive->Attribute( "r1" ) );
-				((PRIM_RGBC*)priptr)->g = atoi( smxPrimitive->Attribute( "g1" ) );
-				((PRIM_RGBC*)priptr)->b = atoi( smxPrimitive->Attribute( "b1" ) );
-				((PRIM_RGBC*)priptr)->c = 0;
-				priptr += 4;
-				prim->len += 4;
-				
-				// Color 2
-				((PRIM_RGBC*)priptr)->r = atoi( smxPrimitive->Attribute( "r2" ) );
-				((PRIM_RGBC*)priptr)->g = atoi( smxPrimitive->Attribute( "g2" ) );
-				((PRIM_RGBC*)priptr)->b = atoi( smxPrimitive->Attribute( "b2" ) );
-				((PRIM_RGBC*)priptr)->c = 0;
-				priptr += 4;
-				prim->len += 4;
-				
-				// Color 3
-				((PRIM_RGBC*)priptr)->r = atoi( smxPrimitive->Attribute( "r3" ) );
-				((PRIM_RGBC*)priptr)->g = atoi( smxPrimitive->Attribute( "g3" ) );
-				((PRIM_RGBC*)priptr)->b = atoi( smxPrimitive->Attribute( "b3" ) );
-				((PRIM_RGBC*)priptr)->c = 0;
-				priptr += 4;
-				prim->len += 4;
-				
-				fwrite( pribuff, 1, prim->len, smdFile );
-				smdHeader.numprims++;
-				
-			} else {
-				
-				printf( "ERROR: Unknown or unsupported primitive type: %s\n", 
-					primType );
-				
-				fclose( smdFile );
-				
-				if( texCoords != NULL ) {
-					free( texCoords );
-				}
-				
-				return EXIT_FAILURE;
-				
-			}
-			
-			smxPrimitive = smxPrimitive->NextSiblingElement("poly");
-			
-		}
-		
-		{
-			int term = 0;
-			fwrite( &term, 1, 4, smdFile );
 		}
-		
-		/*
-		while(smxPrimitive != NULL) {
 
-			bool polyBlended = false;
-			const char* primType = smxPrimitive->Attribute("type");
+	}
 
-			memset(&prim, 0x00, sizeof(PRIM_ID));
+	if (param::verbose)
+		printf("\n");
 
-			if (strcasecmp("F", smxPrimitive->Attribute("shading")) == 0) {
+	if (param::numLods > 1) {
 
-				prim.lighting = PRIM_LIGHTING_FLAT;
+		if (!GenerateLODs(&model, job.output.c_str()))
+			return false;
 
-			} else if (strcasecmp("S", smxPrimitive->Attribute("shading")) == 0) {
+	} else if (!WriteSMD(job.output.c_str(), &model, param::packets)) {
 
-				prim.lighting = PRIM_LIGHTING_SMOOTH;
+		return false;
 
-			}
+	}
 
-			// 3-point polygons
-			if ((strcasecmp("F3", primType) == 0) ||
-			(strcasecmp("G3", primType) == 0) ||
-			(strcasecmp("FT3", primType) == 0) ||
-			(strcasecmp("GT3", primType) == 0)) {
+	if (cache)
+		UpdateBuildCache(cache, job.output, inputHash, model.texFiles);
 
-				if (strcasecmp("F3", primType) == 0) {
+	return true;
 
-					prim.type		= PRIM_TYPE_TRI;
-					prim.len		= 20;
+}
 
-				} else if (strcasecmp("G3", primType) == 0) {
+int main(int argc, const char* argv[]) {
 
-					prim.type		= PRIM_TYPE_TRI;
-					prim.gouraud	= true;
-					prim.len		= 28;
+	printf("SMXLINK " VERSION " - Scarlet SMX to SMD Model Converter "
+		"(part of Scarlet Engine)\n");
+	printf("Note: Outputs in *NEW* revision 1 format!\n");
+	printf("2017-2019 Meido-Tek Productions\n\n");
 
-				} else if (strcasecmp("FT3", primType) == 0) {
+	if (argc <= 1) {
+
+		printf("Parameters:\n");
+		printf("   smxlink [-o <filename>] [-s <scale>] [-opt] <smxfile>\n");
+		printf("   smxlink -b <listfile> [-j <threads>] [-c <cachefile>] [-s <scale>] [-opt]\n\n");
+		printf("   -o  <filename> - Specify output filename (default: first file specified)\n");
+		printf("   -s  <scale>    - Scale factor to apply to model on conversion (default: 1.0)\n");
+		printf("   -tp <path>     - Specify directory path to TIM texture files\n");
+		printf("   -tl <layout>   - Take texture positions from a timpack layout file\n");
+		printf("   -w  <tol>      - Weld vertices within <tol> units of each other\n");
+		printf("   -wn <tol>      - Weld normals within <tol> (4.12 fixed point) units (implies -w)\n");
+		printf("   -q             - Merge coplanar triangle pairs into quads\n");
+		printf("   -r             - Reorder primitives and vertices for locality\n");
+		printf("   -opt           - Enable all optimizations (-w 0 -q -r)\n");
+		printf("   -pk            - Include pre-built GPU packets for smdSortModelBaked()\n");
+		printf("   -lod <count>   - Generate <count> levels of detail and output an SML file\n");
+		printf("   -lr  <ratio>   - Triangle count ratio between LODs (default: 0.5)\n");
+		printf("   -lz  <z,...>   - Farthest Z at which each LOD but the last one is drawn\n");
+		printf("                    (default: %d, doubling for each LOD)\n", DEFAULT_LOD_Z);
+		printf("   -b  <listfile> - Convert all models listed in <listfile>, one per line,\n");
+		printf("                    each optionally followed by its output filename\n");
+		printf("   -j  <threads>  - Number of threads to use in batch mode (default: all cores)\n");
+		printf("   -c  <file>     - Skip models whose inputs haven't changed since they were\n");
+		printf("                    last converted, tracking them in <file>\n");
+		printf("   <smxfile>	  - SMX file (XML or binary) to convert to SMD\n");
 
-					prim.type		= PRIM_TYPE_TRI;
-					prim.textured	= true;
-					prim.len		= 32;
+		return EXIT_SUCCESS;
+
+	}
+
+	for(int i=1; i<argc; i++) {
 
-				} else if (strcasecmp("GT3", primType) == 0) {
+		if (strcasecmp(argv[i], "-o") == 0) {
 
-					prim.type		= PRIM_TYPE_TRI;
-					prim.gouraud	= true;
-					prim.textured	= true;
-					prim.len		= 42;
+			i++;
+			param::smdFileName = argv[i];
 
-				}
+		} else if (strcasecmp(argv[i], "-s") == 0) {
 
-				if ( smxPrimitive->IntAttribute("blendmode") > 0 ) {
-					
-					polyBlended = true;
-					prim.blendmode = smxPrimitive->IntAttribute("blendmode")-1;
+			i++;
+			param::scaleFactor = atof(argv[i]);
 
-				}
+		} else if (strcmp(argv[i], "-w") == 0) {
 
-				if ( smxPrimitive->IntAttribute("doublesided")  ) {
+			i++;
+			param::weld = true;
+			param::weldVerts = atoi(argv[i]);
 
-					prim.noculling = true;
+		} else if (strcmp(argv[i], "-wn") == 0) {
 
-				}
+			i++;
+			param::weld = true;
+			param::weldNorms = atoi(argv[i]);
 
-				PRIM_V3 vert;
+		} else if (strcmp(argv[i], "-q") == 0) {
 
-				vert.v0 = atoi(smxPrimitive->Attribute("v0"));
-				vert.v1 = atoi(smxPrimitive->Attribute("v1"));
-				vert.v2 = atoi(smxPrimitive->Attribute("v2"));
+			param::mergeQuads = true;
 
-				if ((vert.v0 < 0) || (vert.v1 < 0) || (vert.v2 < 0)) {
+		} else if (strcmp(argv[i], "-r") == 0) {
 
-					printf("ERROR: Primitive with negative vertex index encountered.\n");
+			param::reorder = true;
 
-					fclose(smdFile);
+		} else if (strcasecmp(argv[i], "-opt") == 0) {
 
-					if (texCoords != NULL)
-						free(texCoords);
+			param::weld = true;
+			param::mergeQuads = true;
+			param::reorder = true;
 
-					return EXIT_FAILURE;
+		} else if (strcasecmp(argv[i], "-pk") == 0) {
 
-				}
+			param::packets = true;
 
-				PRIM_V3 norm = { 0 };
+		} else if (strcasecmp(argv[i], "-lod") == 0) {
 
-				if (prim.lighting == PRIM_LIGHTING_FLAT) {
+			i++;
+			param::numLods = atoi(argv[i]);
 
-					norm.v0 = atoi(smxPrimitive->Attribute("n0"));
-					prim.len += 4;
+		} else if (strcasecmp(argv[i], "-lr") == 0) {
 
-				} else if (prim.lighting == PRIM_LIGHTING_SMOOTH) {
+			i++;
+			param::lodRatio = atof(argv[i]);
 
-					norm.v0 = atoi(smxPrimitive->Attribute("n0"));
-					norm.v1 = atoi(smxPrimitive->Attribute("n1"));
-					norm.v2 = atoi(smxPrimitive->Attribute("n2"));
-					prim.len += 12;
+		} else if (strcasecmp(argv[i], "-lz") == 0) {
 
-				}
+			i++;
+			param::lodDists = argv[i];
 
-				if ((norm.v0 < 0) || (norm.v1 < 0) || (norm.v2 < 0)) {
+		} else if (strcmp(argv[i], "-b") == 0) {
 
-					printf("ERROR: Primitive with negative normal index encountered.\n");
+			i++;
+			param::batchFileName = argv[i];
 
-					fclose(smdFile);
+		} else if (strcmp(argv[i], "-j") == 0) {
 
-					if (texCoords != NULL)
-						free(texCoords);
+			i++;
+			param::numThreads = atoi(argv[i]);
 
-					return EXIT_FAILURE;
+		} else if (strcmp(argv[i], "-c") == 0) {
 
-				}
+			i++;
+			param::cacheFileName = argv[i];
 
-				fwrite(&prim, sizeof(PRIM_ID), 1, smdFile);
-				fwrite(&vert, sizeof(PRIM_V3), 1, smdFile);
+		} else if (strcasecmp(argv[i], "-tp") == 0) {
 
-				if (prim.lighting == PRIM_LIGHTING_FLAT) {
-					fwrite(&norm, 4, 1, smdFile);
-				} else if (prim.lighting == PRIM_LIGHTING_SMOOTH) {
-					fwrite(&norm, sizeof(PRIM_V3), 1, smdFile);
-				}
+			i++;
+			param::texDir = argv[i];
 
-				PRIM_RGBC col;
+			if( ( param::texDir[param::texDir.size()-1] != '\\' ) &&
+				( param::texDir[param::texDir.size()-1] != '/') ) {
+				
+				param::texDir += "/";
+				
+			}
+			
+		} else if (strcasecmp(argv[i], "-tl") == 0) {
 
-                col.r = atoi(smxPrimitive->Attribute("r0"));
-                col.g = atoi(smxPrimitive->Attribute("g0"));
-                col.b = atoi(smxPrimitive->Attribute("b0"));
-                col.c = 0x00;
+			i++;
+			param::layoutFileName = argv[i];
 
-                if (polyBlended) {
-					col.c |= 0x2;
-				}
+		} else {
 
-				fwrite(&col, sizeof(PRIM_RGBC), 1, smdFile);
+			param::smxFileName = argv[i];
 
-				if ((strcasecmp("G3", primType) == 0) ||
-				(strcasecmp("GT3", primType) == 0)) {
+		}
 
-					col.r = atoi(smxPrimitive->Attribute("r1"));
-					col.g = atoi(smxPrimitive->Attribute("g1"));
-					col.b = atoi(smxPrimitive->Attribute("b1"));
-					col.c = 0x00;
+	}
 
-					fwrite(&col, sizeof(PRIM_RGBC), 1, smdFile);
+	BUILD_CACHE					cache;
+	BUILD_CACHE*				cachePtr = NULL;
+	std::vector<BATCH_JOB>		jobs;
 
-					col.r = atoi(smxPrimitive->Attribute("r2"));
-					col.g = atoi(smxPrimitive->Attribute("g2"));
-					col.b = atoi(smxPrimitive->Attribute("b2"));
-					col.c = 0x00;
+	if (!param::layoutFileName.empty()) {
 
-					fwrite(&col, sizeof(PRIM_RGBC), 1, smdFile);
+		if (!LoadTexLayout(param::layoutFileName.c_str(), param::texDir))
+			return EXIT_FAILURE;
 
-				}
+		printf("Layout : %s\n", param::layoutFileName.c_str());
 
-				if ((strcasecmp("FT3", primType) == 0) || (strcasecmp("GT3", primType) == 0)) {
+	}
 
-					PRIM_TC tc;
-					PRIM_UV uvcd;
+	if (!param::cacheFileName.empty()) {
 
-					int texNum = atoi(smxPrimitive->Attribute("texture"));
+		LoadBuildCache(param::cacheFileName.c_str(), &cache);
+		cachePtr = &cache;
 
-					if (texNum < 0) {
+	}
 
-						printf("ERROR: Primitive with negative texture index encountered.\n");
+	if (!param::batchFileName.empty()) {
 
-						fclose(smdFile);
+		if (!ReadBatchList(param::batchFileName.c_str(), jobs))
+			return EXIT_FAILURE;
 
-						if (texCoords != NULL)
-							free(texCoords);
+		if (param::numThreads <= 0)
+			param::numThreads = std::thread::hardware_concurrency();
 
-						return EXIT_FAILURE;
+		printf("Batch  : %s (%d models, %d threads)\n", param::batchFileName.c_str(),
+			(int)jobs.size(), param::numThreads);
 
-					} else if (texNum > numTextures-1) {
+		if (!param::texDir.empty())
+			printf("TexDir : %s\n", param::texDir.c_str());
 
-						printf("ERROR: Primitive with texture index greater than specified encountered.\n");
+		printf("\n");
 
-						fclose(smdFile);
+		param::verbose = false;
 
-						if (texCoords != NULL)
-							free(texCoords);
+		int failed = RunBatch(jobs, param::numThreads, [&](const BATCH_JOB& job) {
 
-						return EXIT_FAILURE;
+			if (ConvertModel(job, cachePtr))
+				return true;
 
-					}
+			printf("ERROR: Failed to convert %s\n", job.input.c_str());
+			return false;
 
-					TIM_COORDS *tex = &texCoords[texNum];
+		});
 
-					int uoffs = tex->pixdata.px;
-					int voffs = tex->pixdata.py&0xff;
-					
-					switch(tex->flag.pmode) {
-					case 0:	// 4-bit
-						uoffs = (uoffs*4)%256;
-						break;
-					case 1: // 8-bit
-						uoffs = (uoffs*2)%128;
-						break;
-					case 2: // 16-bit
-						uoffs = uoffs%64;
-						break;
-					}
-					
-                    // TPAGE and CLUT
-                    tc.tpage = GetTPage( tex->flag.pmode, prim.blendmode, 
-						tex->pixdata.px, tex->pixdata.py );					
-                    tc.clut = GetClut( tex->clutdata.px, tex->clutdata.py );
-					fwrite(&tc, sizeof(PRIM_TC), 1, smdFile);
-					
-					// Texcoords
-                    uvcd.u = smxPrimitive->IntAttribute("tu0")+uoffs;
-                    uvcd.v = smxPrimitive->IntAttribute("tv0")+voffs;
-					fwrite(&uvcd, sizeof(PRIM_UV), 1, smdFile);
+		if (cachePtr)
+			SaveBuildCache(param::cacheFileName.c_str(), cachePtr);
 
-					uvcd.u = smxPrimitive->IntAttribute("tu1")+uoffs;
-                    uvcd.v = smxPrimitive->IntAttribute("tv1")+voffs;
-					fwrite(&uvcd, sizeof(PRIM_UV), 1, smdFile);
+		if (failed) {
+			printf("\n%d of %d model(s) failed to convert.\n", failed, (int)jobs.size());
+			return EXIT_FAILURE;
+		}
 
-					uvcd.u = smxPrimitive->IntAttribute("tu2")+uoffs;
-                    uvcd.v = smxPrimitive->IntAttribute("tv2")+voffs;
-					fwrite(&uvcd, sizeof(PRIM_UV), 1, smdFile);
+		printf("\nConverted %d model(s) successfully.\n", (int)jobs.size());
 
-					// Padding
-					uvcd.u = uvcd.v = 0;
-					fwrite(&uvcd, sizeof(PRIM_UV), 1, smdFile);
-					
-				}
+		return EXIT_SUCCESS;
 
-			} else {
+	}
 
-				printf("Unsupported primitive %s, ignoring...\n", primType);
+	if (param::smxFileName.empty()) {
 
-			}
+		printf("ERROR: No input file specified.\n");
+		return EXIT_FAILURE;
 
-			smxPrimitive = smxPrimitive->NextSiblingElement("poly");
+	}
 
-		}
+	if (param::smdFileName.empty()) {
 
-		// Write terminator
-		memset(&prim, 0x00, sizeof(PRIM_ID));
-		fwrite(&prim, sizeof(PRIM_ID), 1, smdFile);
-		*/
+        param::smdFileName = param::smxFileName;
+        param::smdFileName.erase(param::smdFileName.rfind("."));
+        param::smdFileName += ".smd";
 
 	}
 
+	printf("Input  : %s\n", param::smxFileName.c_str());
+	printf("Output : %s\n", param::smdFileName.c_str());
 
-	strcpy(smdHeader.id, "SMD");
-	smdHeader.version = 1;
+	if (!param::texDir.empty())
+		printf("TexDir : %s\n", param::texDir.c_str());
 
-	fseek(smdFile, 0, SEEK_SET);
-	fwrite(&smdHeader, sizeof(SMD_HEADER), 1, smdFile);
+	jobs.push_back({ param::smxFileName, param::smdFileName });
 
-	fclose(smdFile);
+	if (!ConvertModel(jobs[0], cachePtr))
+		return EXIT_FAILURE;
 
-	if (texCoords != NULL)
-		free(texCoords);
+	if (cachePtr)
+		SaveBuildCache(param::cacheFileName.c_str(), cachePtr);
 
 	printf("Converted successfully.\n");
 
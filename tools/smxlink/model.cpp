@@ -0,0 +1,904 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "model.h"
+
+#ifdef WIN32
+#define strcasecmp _stricmp
+#endif
+
+
+static int ParseVertices(tinyxml2::XMLElement* element, std::vector<SMX_VERTEX>& list, double scale) {
+
+	element = element->FirstChildElement("v");
+
+	while(element != NULL) {
+
+		SMX_VERTEX vertex;
+
+		vertex.x = round(scale * atof(element->Attribute("x")));
+		vertex.y = round(scale * atof(element->Attribute("y")));
+		vertex.z = round(scale * atof(element->Attribute("z")));
+
+		list.push_back(vertex);
+
+		element = element->NextSiblingElement("v");
+
+	}
+
+	return true;
+
+}
+
+static int AddTexture(SMX_MODEL* model, const std::string& texDir, const char* fileName) {
+
+	TIM_COORDS coords;
+	std::string timFileName = fileName;
+
+	if (timFileName.rfind(".") == std::string::npos)
+	{
+		timFileName.append(".tim");
+	}
+
+	timFileName = texDir + timFileName;
+
+	if (!GetTimCoordsCached(timFileName.c_str(), &coords)) {
+		printf("ERROR: Unable to open texture file: %s\n", timFileName.c_str());
+		return false;
+	}
+
+	switch(coords.flag.pmode) {
+	case 0:	// 4-bit
+		coords.pixdata.pw *= 4;
+		break;
+	case 1: // 8-bit
+		coords.pixdata.pw *= 2;
+		break;
+	}
+
+	model->textures.push_back(coords);
+	model->texFiles.push_back(timFileName);
+
+	return true;
+
+}
+
+static int ParseTextures(tinyxml2::XMLElement* texFileElement, SMX_MODEL* model, const std::string& texDir) {
+
+	texFileElement = texFileElement->FirstChildElement("texture");
+
+	while(texFileElement != NULL) {
+
+		if (!AddTexture(model, texDir, texFileElement->Attribute("file")))
+			return false;
+
+		texFileElement = texFileElement->NextSiblingElement("texture");
+
+	}
+
+	return true;
+
+}
+
+// Checks that all indices in a primitive are within the vertex and normal
+// lists. Out of range indices are written to the SMD as they are, as older
+// versions of this tool did, but the model can't be optimized.
+static bool CheckPrimIndices(const SMX_PRIM* prim, const SMX_MODEL* model) {
+
+	int count = (prim->type == PRIM_TYPE_QUAD) ? 4 : 3;
+
+	for(int i=0; i<count; i++) {
+		if ((prim->v[i] < 0) || (prim->v[i] >= (int)model->verts.size()))
+			return false;
+	}
+
+	if (prim->lighting == PRIM_LIGHTING_FLAT)
+		count = 1;
+	else if (prim->lighting == PRIM_LIGHTING_NONE)
+		count = 0;
+
+	for(int i=0; i<count; i++) {
+		if ((prim->n[i] < 0) || (prim->n[i] >= (int)model->norms.size()))
+			return false;
+	}
+
+	return true;
+
+}
+
+static int ParsePrim(tinyxml2::XMLElement* smxPrimitive, const char* primType, SMX_PRIM* prim, const SMX_MODEL* model) {
+
+	const char* shading = smxPrimitive->Attribute("shading");
+	int			count;
+
+	memset(prim, 0x00, sizeof(SMX_PRIM));
+
+	if ((strcasecmp("F3", primType) == 0) || (strcasecmp("FT3", primType) == 0)) {
+
+		prim->type = PRIM_TYPE_TRI;
+
+	} else if (strcasecmp("G3", primType) == 0) {
+
+		prim->type = PRIM_TYPE_TRI;
+		prim->gouraud = true;
+
+	} else if ((strcasecmp("F4", primType) == 0) || (strcasecmp("FT4", primType) == 0)) {
+
+		prim->type = PRIM_TYPE_QUAD;
+
+	} else if (strcasecmp("G4", primType) == 0) {
+
+		prim->type = PRIM_TYPE_QUAD;
+		prim->gouraud = true;
+
+	} else {
+
+		printf("ERROR: Unknown or unsupported primitive type: %s\n", primType);
+		return false;
+
+	}
+
+	prim->textured		= (strcasecmp("FT3", primType) == 0) || (strcasecmp("FT4", primType) == 0);
+	prim->doubleSided	= smxPrimitive->IntAttribute("double") != 0;
+	prim->blend			= smxPrimitive->IntAttribute("blend");
+
+	if (prim->blend < 0)
+		prim->blend = 0;
+
+	count = (prim->type == PRIM_TYPE_QUAD) ? 4 : 3;
+
+	for(int i=0; i<count; i++) {
+
+		char name[4];
+
+		sprintf(name, "v%d", i);
+		prim->v[i] = smxPrimitive->IntAttribute(name);
+
+		if (prim->gouraud || (i == 0)) {
+
+			sprintf(name, "r%d", i);
+			prim->rgb[i][0] = smxPrimitive->IntAttribute(name);
+			sprintf(name, "g%d", i);
+			prim->rgb[i][1] = smxPrimitive->IntAttribute(name);
+			sprintf(name, "b%d", i);
+			prim->rgb[i][2] = smxPrimitive->IntAttribute(name);
+
+		}
+
+		if (prim->textured) {
+
+			sprintf(name, "tu%d", i);
+			prim->tu[i] = smxPrimitive->IntAttribute(name);
+			sprintf(name, "tv%d", i);
+			prim->tv[i] = smxPrimitive->IntAttribute(name);
+
+		}
+
+	}
+
+	// Primitives without a shading attribute are treated as unlit
+	if ((shading != NULL) && (strcasecmp("F", shading) == 0)) {
+
+		prim->lighting = PRIM_LIGHTING_FLAT;
+		prim->n[0] = smxPrimitive->IntAttribute("n0");
+
+	} else if ((shading != NULL) && (strcasecmp("S", shading) == 0)) {
+
+		prim->lighting = PRIM_LIGHTING_SMOOTH;
+
+		for(int i=0; i<count; i++) {
+
+			char name[4];
+
+			sprintf(name, "n%d", i);
+			prim->n[i] = smxPrimitive->IntAttribute(name);
+
+		}
+
+	}
+
+	if (prim->textured) {
+
+		prim->texture = smxPrimitive->IntAttribute("texture");
+
+		if (prim->texture < 0) {
+
+			printf("ERROR: Primitive with negative texture index encountered.\n");
+			return false;
+
+		} else if (prim->texture > (int)model->textures.size()-1) {
+
+			printf("ERROR: Primitive with texture index greater than specified encountered.\n");
+			return false;
+
+		}
+
+	}
+
+	return true;
+
+}
+
+int ParseSMX(tinyxml2::XMLElement* smxModel, SMX_MODEL* model, const std::string& texDir, float scale) {
+
+	tinyxml2::XMLElement* element;
+
+	model->hasVerts = false;
+	model->hasNorms = false;
+	model->hasPrims = false;
+	model->badIndices = 0;
+
+	// Parse textures
+	if ((element = smxModel->FirstChildElement("textures")) != NULL) {
+
+		if (!ParseTextures(element, model, texDir))
+			return false;
+
+	}
+
+	// Parse vertices
+	if ((element = smxModel->FirstChildElement("vertices")) != NULL) {
+
+		ParseVertices(element, model->verts, scale);
+		model->hasVerts = true;
+
+	}
+
+	// Parse normals
+	if ((element = smxModel->FirstChildElement("normals")) != NULL) {
+
+		ParseVertices(element, model->norms, 4096);
+		model->hasNorms = true;
+
+	}
+
+	// Parse primitives
+	if ((element = smxModel->FirstChildElement("primitives")) != NULL) {
+
+		model->hasPrims = true;
+		element = element->FirstChildElement("poly");
+
+		while(element != NULL) {
+
+			const char* primType = element->Attribute("type");
+
+			if (primType != NULL) {
+
+				SMX_PRIM prim;
+
+				if (!ParsePrim(element, primType, &prim, model))
+					return false;
+
+				if (!CheckPrimIndices(&prim, model))
+					model->badIndices++;
+
+				model->prims.push_back(prim);
+
+			}
+
+			element = element->NextSiblingElement("poly");
+
+		}
+
+	}
+
+	return true;
+
+}
+
+int ParseSMB(const void* data, size_t size, SMX_MODEL* model, const std::string& texDir, float scale) {
+
+	const SMB_HEADER*	head = (const SMB_HEADER*)data;
+	const char*			ptr = (const char*)data + sizeof(SMB_HEADER);
+	const char*			end = (const char*)data + size;
+
+	model->hasVerts = (head->flags & SMB_HAS_VERTS) != 0;
+	model->hasNorms = (head->flags & SMB_HAS_NORMS) != 0;
+	model->hasPrims = (head->flags & SMB_HAS_PRIMS) != 0;
+	model->badIndices = 0;
+
+	// Texture names
+	for(int i=0; i<head->numtex; i++) {
+
+		size_t len = strnlen(ptr, end-ptr);
+
+		if ((ptr+len) >= end) {
+			printf("ERROR: Binary SMX file is truncated.\n");
+			return false;
+		}
+		if (!AddTexture(model, texDir, ptr))
+			return false;
+
+		ptr += len+1;
+
+	}
+
+	ptr = (const char*)data + ((ptr-(const char*)data+3)&~3);
+
+	if ((size_t)(end-ptr) <
+		(12*((size_t)head->numverts+head->numnorms) + sizeof(SMB_PRIM)*(size_t)head->numprims)) {
+		printf("ERROR: Binary SMX file is truncated.\n");
+		return false;
+	}
+
+	// Vertices and normals
+	const float* vec = (const float*)ptr;
+
+	for(uint32_t i=0; i<head->numverts; i++, vec+=3) {
+
+		SMX_VERTEX vertex;
+
+		vertex.x = round(scale * vec[0]);
+		vertex.y = round(scale * vec[1]);
+		vertex.z = round(scale * vec[2]);
+
+		model->verts.push_back(vertex);
+
+	}
+
+	for(uint32_t i=0; i<head->numnorms; i++, vec+=3) {
+
+		SMX_VERTEX vertex;
+
+		vertex.x = round(4096 * vec[0]);
+		vertex.y = round(4096 * vec[1]);
+		vertex.z = round(4096 * vec[2]);
+
+		model->norms.push_back(vertex);
+
+	}
+
+	// Primitives, which only keep the attributes their type uses (as the XML
+	// parser does)
+	const SMB_PRIM* smbPrim = (const SMB_PRIM*)vec;
+
+	for(uint32_t i=0; i<head->numprims; i++, smbPrim++) {
+
+		SMX_PRIM	prim;
+		int			count = smbPrim->count;
+
+		memset(&prim, 0x00, sizeof(SMX_PRIM));
+
+		if ((count != 3) && (count != 4)) {
+			printf("ERROR: Unknown or unsupported primitive with %d vertices.\n", count);
+			return false;
+		}
+		if (smbPrim->shading > PRIM_LIGHTING_SMOOTH) {
+			printf("ERROR: Unknown shading mode %d.\n", smbPrim->shading);
+			return false;
+		}
+
+		prim.type			= (count == 4) ? PRIM_TYPE_QUAD : PRIM_TYPE_TRI;
+		prim.lighting		= smbPrim->shading;
+		prim.gouraud		= (smbPrim->flags & SMB_PRIM_GOURAUD) != 0;
+		prim.textured		= (smbPrim->flags & SMB_PRIM_TEXTURED) != 0;
+		prim.doubleSided	= (smbPrim->flags & SMB_PRIM_DOUBLE) != 0;
+		prim.blend			= smbPrim->blend;
+
+		for(int j=0; j<count; j++) {
+
+			prim.v[j] = smbPrim->v[j];
+
+			if (prim.gouraud || (j == 0))
+				memcpy(prim.rgb[j], smbPrim->rgb[j], 3);
+
+			if (prim.textured) {
+				prim.tu[j] = smbPrim->tu[j];
+				prim.tv[j] = smbPrim->tv[j];
+			}
+
+		}
+
+		if (prim.lighting == PRIM_LIGHTING_FLAT) {
+
+			prim.n[0] = smbPrim->n[0];
+
+		} else if (prim.lighting == PRIM_LIGHTING_SMOOTH) {
+
+			for(int j=0; j<count; j++)
+				prim.n[j] = smbPrim->n[j];
+
+		}
+
+		if (prim.textured) {
+
+			prim.texture = smbPrim->texture;
+
+			if ((prim.texture < 0) || (prim.texture >= (int)model->textures.size())) {
+				printf("ERROR: Primitive with invalid texture index %d encountered.\n", prim.texture);
+				return false;
+			}
+
+		}
+
+		if (!CheckPrimIndices(&prim, model))
+			model->badIndices++;
+
+		model->prims.push_back(prim);
+
+	}
+
+	return true;
+
+}
+
+int LoadSMX(const char* fileName, SMX_MODEL* model, const std::string& texDir, float scale) {
+
+	FILE*				fp;
+	std::vector<char>	data;
+	long				size;
+
+	if (!(fp = fopen(fileName, "rb"))) {
+		printf("ERROR: Unable to open SMX file: %s\n", fileName);
+		return false;
+	}
+
+	fseek(fp, 0, SEEK_END);
+	size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+
+	data.resize(size+1);
+
+	if (fread(data.data(), 1, size, fp) != (size_t)size) {
+		printf("ERROR: Unable to read SMX file: %s\n", fileName);
+		fclose(fp);
+		return false;
+	}
+
+	fclose(fp);
+
+	// Binary SMX files are identified by their header, anything else is
+	// assumed to be XML
+	if ((size >= (long)sizeof(SMB_HEADER)) && (memcmp(data.data(), "SMB", 3) == 0)) {
+
+		if (data[3] != 1) {
+			printf("ERROR: Unsupported binary SMX version %d.\n", data[3]);
+			return false;
+		}
+
+		return ParseSMB(data.data(), size, model, texDir, scale);
+
+	}
+
+	tinyxml2::XMLDocument smxFile;
+
+	data[size] = 0;
+
+	if (smxFile.Parse(data.data(), size) != tinyxml2::XML_SUCCESS) {
+		printf("ERROR: Unable to parse SMX file: %s\n", fileName);
+		smxFile.PrintError();
+		return false;
+	}
+
+	tinyxml2::XMLElement* smxModel = smxFile.FirstChildElement("model");
+
+	if (smxModel == NULL) {
+		printf("ERROR: No model element found in SMX file: %s\n", fileName);
+		return false;
+	}
+
+	return ParseSMX(smxModel, model, texDir, scale);
+
+}
+
+// Reads a layout file generated by timpack and registers the VRAM position of
+// each texture in it with the TIM coordinate cache, under the path AddTexture()
+// would look it up with. Models then no longer need the TIM files themselves.
+int LoadTexLayout(const char* fileName, const std::string& texDir) {
+
+	tinyxml2::XMLDocument layout;
+
+	if (layout.LoadFile(fileName) != tinyxml2::XML_SUCCESS) {
+		printf("ERROR: Unable to load texture layout: %s\n", fileName);
+		return false;
+	}
+
+	tinyxml2::XMLElement* element = layout.FirstChildElement("layout");
+
+	if (element == NULL) {
+		printf("ERROR: No layout element found in texture layout: %s\n", fileName);
+		return false;
+	}
+
+	for(element = element->FirstChildElement("texture"); element != NULL;
+		element = element->NextSiblingElement("texture")) {
+
+		const char*	name = element->Attribute("name");
+		TIM_COORDS	coords;
+
+		if (name == NULL) {
+			printf("ERROR: Texture without a name in texture layout: %s\n", fileName);
+			return false;
+		}
+
+		memset(&coords, 0x00, sizeof(TIM_COORDS));
+
+		switch(element->IntAttribute("bpp")) {
+		case 4:
+			coords.flag.pmode = 0;
+			break;
+		case 8:
+			coords.flag.pmode = 1;
+			break;
+		case 16:
+			coords.flag.pmode = 2;
+			break;
+		default:
+			printf("ERROR: Unsupported color depth for texture %s in texture layout.\n", name);
+			return false;
+		}
+
+		coords.pixdata.px = element->IntAttribute("x");
+		coords.pixdata.py = element->IntAttribute("y");
+		coords.pixdata.pw = element->IntAttribute("w");
+		coords.pixdata.ph = element->IntAttribute("h");
+
+		if (element->Attribute("colors")) {
+			coords.flag.cf = 1;
+			coords.clutdata.px = element->IntAttribute("cx");
+			coords.clutdata.py = element->IntAttribute("cy");
+			coords.clutdata.pw = element->IntAttribute("colors");
+			coords.clutdata.ph = 1;
+		}
+
+		SetTimCoordsCached((texDir + name + ".tim").c_str(), &coords);
+
+	}
+
+	return true;
+
+}
+
+// Computes the VRAM texture coordinates, texture page and CLUT of a textured
+// primitive.
+static void GetPrimTexCoords(const SMX_PRIM* prim, const SMX_MODEL* model, PRIM_UV* uv, PRIM_TC* tc) {
+
+	const TIM_COORDS* tex = &model->textures[prim->texture];
+	int count = (prim->type == PRIM_TYPE_QUAD) ? 4 : 3;
+	int uoffs,voffs;
+
+	uoffs = tex->pixdata.px;
+	voffs = tex->pixdata.py&0xff;
+
+	switch(tex->flag.pmode) {
+	case 0:	// 4-bit
+		uoffs = (uoffs*4)%256;
+		break;
+	case 1: // 8-bit
+		uoffs = (uoffs*2)%128;
+		break;
+	case 2: // 16-bit
+		uoffs = uoffs%64;
+		break;
+	}
+
+	for(int i=0; i<4; i++) {
+
+		if (i < count) {
+			uv[i].u = prim->tu[i]+uoffs;
+			uv[i].v = prim->tv[i]+voffs;
+		} else {
+			uv[i].u = 0;
+			uv[i].v = 0;
+		}
+
+	}
+
+	tc->tpage = GetTPage(tex->flag.pmode,
+		(prim->blend > 0) ? prim->blend-1 : 0, tex->pixdata.px, tex->pixdata.py);
+	tc->clut = GetClut(tex->clutdata.px, tex->clutdata.py);
+
+}
+
+int EncodePrim(const SMX_PRIM* prim, const SMX_MODEL* model, char* buff) {
+
+	PRIM_ID*	id = (PRIM_ID*)buff;
+	char*		priptr = buff;
+	int			count = (prim->type == PRIM_TYPE_QUAD) ? 4 : 3;
+
+	memset(buff, 0x00, sizeof(PRIM_ID));
+
+	id->type	= prim->type;
+	id->l_type	= prim->lighting;
+	id->c_type	= prim->gouraud;
+	id->nocull	= prim->doubleSided;
+	id->len		= 4;
+
+	priptr += sizeof(PRIM_ID);
+
+	// Write vertex indices
+	((PRIM_V*)priptr)->v0 = prim->v[0];
+	((PRIM_V*)priptr)->v1 = prim->v[1];
+	((PRIM_V*)priptr)->v2 = prim->v[2];
+	((PRIM_V*)priptr)->v3 = (count == 4) ? prim->v[3] : 0;
+
+	priptr += 8;
+	id->len += 8;
+
+	// Write normal indices
+	if (prim->lighting == PRIM_LIGHTING_FLAT) {
+
+		((PRIM_V*)priptr)->v0 = prim->n[0];
+		((PRIM_V*)priptr)->v1 = 0;
+		priptr += 4;
+		id->len += 4;
+
+	} else if (prim->lighting == PRIM_LIGHTING_SMOOTH) {
+
+		((PRIM_V*)priptr)->v0 = prim->n[0];
+		((PRIM_V*)priptr)->v1 = prim->n[1];
+		((PRIM_V*)priptr)->v2 = prim->n[2];
+		((PRIM_V*)priptr)->v3 = (count == 4) ? prim->n[3] : 0;
+		priptr += 8;
+		id->len += 8;
+
+	}
+
+	// Write colors, the first of which also carries the blend enable bit
+	for(int i=0; i<(prim->gouraud ? count : 1); i++) {
+
+		((PRIM_RGBC*)priptr)->r = prim->rgb[i][0];
+		((PRIM_RGBC*)priptr)->g = prim->rgb[i][1];
+		((PRIM_RGBC*)priptr)->b = prim->rgb[i][2];
+		((PRIM_RGBC*)priptr)->c = 0;
+
+		if ((i == 0) && (prim->blend > 0)) {
+			((PRIM_RGBC*)priptr)->c = 0x2;
+			id->blend = prim->blend-1;
+		}
+
+		priptr += 4;
+		id->len += 4;
+
+	}
+
+	if (prim->textured) {
+
+		GetPrimTexCoords(prim, model, (PRIM_UV*)priptr, (PRIM_TC*)(priptr+8));
+
+		priptr += 12;
+		id->len += 12;
+
+		id->texture = true;
+
+	}
+
+	return id->len;
+
+}
+
+// Encodes the GPU packet the renderer would build for a primitive, minus the
+// screen coordinates and OT link. The packet is preceded by a word holding the
+// offsets of the XY fields (in bytes from the start of the packet) for each
+// vertex, so the renderer can patch them without decoding the packet type.
+// The packet type matches the one picked by smdSortModel(): smooth shaded
+// primitives use gouraud packets and unlit gouraud ones are never textured.
+int EncodePacket(const SMX_PRIM* prim, const SMX_MODEL* model, char* buff) {
+
+	unsigned char*	info = (unsigned char*)buff;
+	uint32_t*		packet = (uint32_t*)(buff+4);
+	int				count = (prim->type == PRIM_TYPE_QUAD) ? 4 : 3;
+	int				len = 1;
+
+	bool unlitGouraud	= (prim->lighting == PRIM_LIGHTING_NONE) && prim->gouraud;
+	bool gouraud		= (prim->lighting == PRIM_LIGHTING_SMOOTH) || unlitGouraud;
+	bool textured		= prim->textured && !unlitGouraud;
+	int blend			= (prim->blend > 0) ? prim->blend-1 : 0;
+
+	PRIM_UV			uv[4];
+	PRIM_TC			tc;
+	uint32_t		code = 0x20;
+
+	if (count == 4)
+		code |= 0x08;
+	if (gouraud)
+		code |= 0x10;
+	if (textured)
+		code |= 0x04;
+	if (prim->blend > 0)
+		code |= 0x02;
+
+	memset(buff, 0x00, 4);
+
+	if (textured)
+		GetPrimTexCoords(prim, model, uv, &tc);
+	else
+		packet[len++] = 0xe1000000|SMD_PACKET_TPAGE|(blend<<5);
+
+	for(int i=0; i<count; i++) {
+
+		// Lit primitives only carry the material color, which is replaced
+		// with the result of the lighting calculation
+		if ((i == 0) || gouraud) {
+
+			const unsigned char* rgb = prim->rgb[unlitGouraud ? i : 0];
+
+			packet[len++] = rgb[0]|(rgb[1]<<8)|(rgb[2]<<16)|((i == 0) ? (code<<24) : 0);
+
+		}
+
+		info[i] = len*4;
+		packet[len++] = 0;
+
+		if (textured) {
+
+			packet[len] = uv[i].u|(uv[i].v<<8);
+
+			if (i == 0)
+				packet[len] |= tc.clut<<16;
+			else if (i == 1)
+				packet[len] |= tc.tpage<<16;
+
+			len++;
+
+		}
+
+	}
+
+	packet[0] = (len-1)<<24;
+
+	return 4+len*4;
+
+}
+
+static void WriteVertices(FILE* smdFile, const std::vector<SMX_VERTEX>& list) {
+
+	for(size_t i=0; i<list.size(); i++) {
+
+		SVECTOR vertex;
+
+		vertex.vx = list[i].x;
+		vertex.vy = list[i].y;
+		vertex.vz = list[i].z;
+		vertex.vp = 0;
+
+		fwrite(&vertex, sizeof(SVECTOR), 1, smdFile);
+
+	}
+
+}
+
+// Writes an SMD at the current position of the file, with all offsets in its
+// header relative to the beginning of the SMD.
+static void WriteSMDData(FILE* smdFile, const SMX_MODEL* model, bool packets) {
+
+	long base = ftell(smdFile);
+
+	// Create temporary header
+	SMD_HEADER	smdHeader;
+	uint32_t	pktAddr = 0;
+
+	memset(&smdHeader, 0x00, sizeof(SMD_HEADER));
+	fwrite(&smdHeader, sizeof(SMD_HEADER), 1, smdFile);
+
+	if (packets)
+		fwrite(&pktAddr, 4, 1, smdFile);
+
+	if (model->hasVerts) {
+
+		smdHeader.vtxAddr	= ftell(smdFile)-base;
+		smdHeader.numverts	= model->verts.size();
+		smdHeader.flags		|= SMD_FLAG_VERTS;
+
+		WriteVertices(smdFile, model->verts);
+
+	}
+
+	if (model->hasNorms) {
+
+		smdHeader.nrmAddr	= ftell(smdFile)-base;
+		smdHeader.numnorms	= model->norms.size();
+		smdHeader.flags		|= SMD_FLAG_NORMS;
+
+		WriteVertices(smdFile, model->norms);
+
+	}
+
+	if (model->hasPrims) {
+
+		char	pribuff[64];
+		int		term = 0;
+
+		smdHeader.priAddr = ftell(smdFile)-base;
+
+		for(size_t i=0; i<model->prims.size(); i++) {
+
+			int len = EncodePrim(&model->prims[i], model, pribuff);
+
+			fwrite(pribuff, 1, len, smdFile);
+			smdHeader.numprims++;
+
+		}
+
+		fwrite(&term, 1, 4, smdFile);
+
+		// Packet templates, in the same order as the primitives
+		if (packets) {
+
+			pktAddr = ftell(smdFile)-base;
+			smdHeader.flags |= SMD_FLAG_PACKETS;
+
+			for(size_t i=0; i<model->prims.size(); i++) {
+
+				int len = EncodePacket(&model->prims[i], model, pribuff);
+
+				fwrite(pribuff, 1, len, smdFile);
+
+			}
+
+		}
+
+	}
+
+	long end = ftell(smdFile);
+
+	strcpy(smdHeader.id, "SMD");
+	smdHeader.version = 1;
+
+	fseek(smdFile, base, SEEK_SET);
+	fwrite(&smdHeader, sizeof(SMD_HEADER), 1, smdFile);
+
+	if (packets)
+		fwrite(&pktAddr, 4, 1, smdFile);
+
+	fseek(smdFile, end, SEEK_SET);
+
+}
+
+int WriteSMD(const char* fileName, const SMX_MODEL* model, bool packets) {
+
+	FILE* smdFile = fopen(fileName, "wb");
+
+	if (smdFile == NULL) {
+		printf("ERROR: Unable to create output file: %s\n", fileName);
+		return false;
+	}
+
+	WriteSMDData(smdFile, model, packets);
+
+	fclose(smdFile);
+
+	return true;
+
+}
+
+int WriteSML(const char* fileName, const std::vector<SMX_MODEL>& lods, const std::vector<uint32_t>& maxZ, bool packets) {
+
+	FILE* smdFile = fopen(fileName, "wb");
+
+	if (smdFile == NULL) {
+		printf("ERROR: Unable to create output file: %s\n", fileName);
+		return false;
+	}
+
+	SML_HEADER	smlHeader;
+	SML_LOD*	smlLods = new SML_LOD[lods.size()];
+
+	memset(&smlHeader, 0x00, sizeof(SML_HEADER));
+	memcpy(smlHeader.id, "SML", 3);
+	smlHeader.version = 1;
+	smlHeader.numlods = lods.size();
+
+	// Leave room for the header and LOD table
+	fseek(smdFile, sizeof(SML_HEADER)+sizeof(SML_LOD)*lods.size(), SEEK_SET);
+
+	for(size_t i=0; i<lods.size(); i++) {
+
+		smlLods[i].offset	= ftell(smdFile);
+		smlLods[i].maxz		= maxZ[i];
+
+		WriteSMDData(smdFile, &lods[i], packets);
+
+	}
+
+	fseek(smdFile, 0, SEEK_SET);
+	fwrite(&smlHeader, sizeof(SML_HEADER), 1, smdFile);
+	fwrite(smlLods, sizeof(SML_LOD), lods.size(), smdFile);
+
+	fclose(smdFile);
+	delete[] smlLods;
+
+	return true;
+
+}
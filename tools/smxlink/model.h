@@ -0,0 +1,178 @@
+#ifndef _MODEL_H
+#define _MODEL_H
+
+#include <stdint.h>
+#include <vector>
+#include <string>
+#include <tinyxml2.h>
+#include "timreader.h"
+
+// SMD header flags
+#define SMD_FLAG_VERTS		0x1
+#define SMD_FLAG_NORMS		0x2
+#define SMD_FLAG_PACKETS	0x4		// Header is followed by pktAddr
+
+// Draw mode (E1) bits baked into the packets of untextured primitives, in
+// place of the base set by smdSetBaseTPage() at runtime (dithering enabled)
+#define SMD_PACKET_TPAGE	0x200
+
+typedef struct {
+	char			id[3];		// File ID (SMD)
+	unsigned char	version;	// Version number (0x01)
+	unsigned short	flags;
+	unsigned short	numverts;
+	unsigned short	numnorms;
+	unsigned short	numprims;
+	uint32_t		vtxAddr;
+	uint32_t		nrmAddr;
+	uint32_t		priAddr;
+} SMD_HEADER;
+
+typedef struct {
+	short vx,vy,vz,vp;
+} SVECTOR;
+
+// Binary SMX, a direct dump of the SMX data that can be loaded without any
+// parsing. The header is followed by the texture file names (null terminated,
+// padded to a multiple of 4 bytes as a whole), the vertices and normals (as
+// unscaled floats) and the primitives. All values are little endian.
+#define SMB_HAS_VERTS	1
+#define SMB_HAS_NORMS	2
+#define SMB_HAS_PRIMS	4
+
+#define SMB_PRIM_GOURAUD	1
+#define SMB_PRIM_TEXTURED	2
+#define SMB_PRIM_DOUBLE		4
+
+typedef struct {
+	char			id[3];		// File ID (SMB)
+	unsigned char	version;	// Version number (0x01)
+	unsigned short	flags;		// SMB_HAS_*
+	unsigned short	numtex;
+	uint32_t		numverts;
+	uint32_t		numnorms;
+	uint32_t		numprims;
+} SMB_HEADER;
+
+typedef struct {
+	unsigned char	count;		// Number of vertices (3 or 4)
+	unsigned char	shading;	// PRIM_LIGHTING_*
+	unsigned char	flags;		// SMB_PRIM_*
+	unsigned char	blend;		// 0 - opaque, 1-4 - blend mode+1
+	short			texture;
+	short			reserved;
+	int32_t			v[4];
+	int32_t			n[4];
+	unsigned char	rgb[4][3];
+	short			tu[4],tv[4];
+} SMB_PRIM;
+
+// Multi-LOD container, made up of this header followed by a table of LODs
+// (sorted from most to least detailed) and a complete SMD for each LOD
+typedef struct {
+	char			id[3];		// File ID (SML)
+	unsigned char	version;	// Version number (0x01)
+	unsigned short	numlods;
+	unsigned short	reserved;
+} SML_HEADER;
+
+typedef struct {
+	uint32_t		offset;		// Offset of the LOD's SMD from the start of the file
+	uint32_t		maxz;		// Farthest screen Z (SZ) the LOD is drawn at
+} SML_LOD;
+
+
+#define PRIM_TYPE_LINE	0
+#define PRIM_TYPE_TRI	1
+#define PRIM_TYPE_QUAD	2
+
+#define PRIM_LIGHTING_NONE		0	// No shading (no normals)
+#define PRIM_LIGHTING_FLAT		1	// Flat shading (1 normal)
+#define PRIM_LIGHTING_SMOOTH	2	// Smooth shading (3 normals per vertex)
+
+typedef struct {
+	
+    unsigned char type:2;		// Primitive type
+	unsigned char l_type:2;		// Lighting type (0 - none, 1 - flat shading, 2 - smooth shading)
+	unsigned char c_type:1;		// Coloring type (0 - solid color, 1 - gouraud)
+    unsigned char texture:1;	// Texture mapped
+	unsigned char blend:2;		// Blend mode setting (actual blend enable is determined by primitive code)
+	// byte boundary
+	unsigned char zoff:4;
+	unsigned char nocull:1;		// Double sided (no cull)
+	unsigned char mask:1;		// Force mask bit setting    
+	unsigned char texwin:2;
+	// byte boundary
+	unsigned char texoff:2;
+	unsigned char reserved:6;
+	// byte boundary
+	unsigned char len;
+} PRIM_ID;
+
+typedef struct {
+	unsigned short	v0,v1,v2,v3;
+} PRIM_V;
+
+typedef struct {
+	unsigned char	r,g,b,c;
+} PRIM_RGBC;
+
+typedef struct {
+	unsigned short tpage,clut;
+} PRIM_TC;
+
+typedef struct {
+	unsigned char	u,v;
+} PRIM_UV;
+
+
+// In-memory representation of an SMX model, kept between parsing and writing
+// so that optimization passes can be run on it
+
+typedef struct {
+	short			x,y,z;		// Quantized position (or 4.12 normal)
+} SMX_VERTEX;
+
+typedef struct {
+	unsigned char	type;		// PRIM_TYPE_TRI or PRIM_TYPE_QUAD
+	unsigned char	lighting;	// PRIM_LIGHTING_*
+	bool			gouraud;
+	bool			textured;
+	bool			doubleSided;
+	int				blend;		// 0 - opaque, 1-4 - blend mode+1
+	int				texture;	// Texture index (textured primitives only)
+	int				v[4];		// Vertex indices
+	int				n[4];		// Normal indices (n[0] only for flat shading)
+	unsigned char	rgb[4][3];	// Colors (rgb[0] only for solid color)
+	int				tu[4],tv[4];// Texture coordinates relative to the texture
+} SMX_PRIM;
+
+typedef struct {
+	bool						hasVerts;
+	bool						hasNorms;
+	bool						hasPrims;
+	int							badIndices;	// Primitives with out of range indices
+	std::vector<SMX_VERTEX>		verts;
+	std::vector<SMX_VERTEX>		norms;
+	std::vector<SMX_PRIM>		prims;
+	std::vector<TIM_COORDS>		textures;
+	std::vector<std::string>	texFiles;	// Paths to the texture files
+} SMX_MODEL;
+
+int ParseSMX(tinyxml2::XMLElement* smxModel, SMX_MODEL* model, const std::string& texDir, float scale);
+
+int ParseSMB(const void* data, size_t size, SMX_MODEL* model, const std::string& texDir, float scale);
+
+int LoadSMX(const char* fileName, SMX_MODEL* model, const std::string& texDir, float scale);
+
+int LoadTexLayout(const char* fileName, const std::string& texDir);
+
+int EncodePrim(const SMX_PRIM* prim, const SMX_MODEL* model, char* buff);
+
+int EncodePacket(const SMX_PRIM* prim, const SMX_MODEL* model, char* buff);
+
+int WriteSMD(const char* fileName, const SMX_MODEL* model, bool packets);
+
+int WriteSML(const char* fileName, const std::vector<SMX_MODEL>& lods, const std::vector<uint32_t>& maxZ, bool packets);
+
+#endif // _MODEL_H
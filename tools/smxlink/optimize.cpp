@@ -0,0 +1,549 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include "optimize.h"
+
+// Minimum cosine of the angle between two triangles for them to be merged
+#define MERGE_MIN_COS	0.999
+
+
+static int PrimPoints(const SMX_PRIM* prim) {
+
+	return (prim->type == PRIM_TYPE_QUAD) ? 4 : 3;
+
+}
+
+static int PrimNormals(const SMX_PRIM* prim) {
+
+	switch(prim->lighting) {
+	case PRIM_LIGHTING_FLAT:
+		return 1;
+	case PRIM_LIGHTING_SMOOTH:
+		return PrimPoints(prim);
+	}
+
+	return 0;
+
+}
+
+
+// Statistics
+//
+
+void GetModelStats(const SMX_MODEL* model, SMX_STATS* stats) {
+
+	std::deque<int>		cache;
+	std::vector<char>	cached(model->verts.size(), 0);
+
+	memset(stats, 0x00, sizeof(SMX_STATS));
+
+	stats->verts = model->verts.size();
+	stats->norms = model->norms.size();
+
+	for(size_t i=0; i<model->prims.size(); i++) {
+
+		const SMX_PRIM* prim = &model->prims[i];
+
+		if (prim->type == PRIM_TYPE_QUAD)
+			stats->quads++;
+		else
+			stats->tris++;
+
+		for(int j=0; j<PrimPoints(prim); j++) {
+
+			int v = prim->v[j];
+
+			if (cached[v])
+				continue;
+
+			stats->transforms++;
+
+			cache.push_back(v);
+			cached[v] = 1;
+
+			if (cache.size() > VERTEX_CACHE_SIZE) {
+				cached[cache.front()] = 0;
+				cache.pop_front();
+			}
+
+		}
+
+	}
+
+}
+
+
+// Welding
+//
+
+// Builds a table mapping each vertex to the first one within the tolerance,
+// using a grid of cells slightly larger than the tolerance so that only the
+// neighboring cells have to be searched.
+static void WeldList(const std::vector<SMX_VERTEX>& list, int tolerance, std::vector<int>& remap) {
+
+	std::unordered_map<uint64_t, std::vector<int> > grid;
+	int cellSize = tolerance+1;
+
+	remap.resize(list.size());
+
+	for(size_t i=0; i<list.size(); i++) {
+
+		const SMX_VERTEX* vtx = &list[i];
+		int cx = (int)floor((double)vtx->x/cellSize);
+		int cy = (int)floor((double)vtx->y/cellSize);
+		int cz = (int)floor((double)vtx->z/cellSize);
+
+		remap[i] = -1;
+
+		for(int z=cz-1; (z<=cz+1) && (remap[i] < 0); z++) {
+			for(int y=cy-1; (y<=cy+1) && (remap[i] < 0); y++) {
+				for(int x=cx-1; (x<=cx+1) && (remap[i] < 0); x++) {
+
+					uint64_t key = ((uint64_t)(x&0x1fffff)<<42)|((uint64_t)(y&0x1fffff)<<21)|(z&0x1fffff);
+					auto cell = grid.find(key);
+
+					if (cell == grid.end())
+						continue;
+
+					for(size_t j=0; j<cell->second.size(); j++) {
+
+						const SMX_VERTEX* other = &list[cell->second[j]];
+
+						if ((abs(other->x-vtx->x) <= tolerance) &&
+							(abs(other->y-vtx->y) <= tolerance) &&
+							(abs(other->z-vtx->z) <= tolerance)) {
+							remap[i] = cell->second[j];
+							break;
+						}
+
+					}
+
+				}
+			}
+		}
+
+		if (remap[i] < 0) {
+
+			uint64_t key = ((uint64_t)(cx&0x1fffff)<<42)|((uint64_t)(cy&0x1fffff)<<21)|(cz&0x1fffff);
+
+			remap[i] = i;
+			grid[key].push_back(i);
+
+		}
+
+	}
+
+}
+
+int WeldModel(SMX_MODEL* model, int vtxTolerance, int nrmTolerance) {
+
+	std::vector<int>		vtxRemap, nrmRemap;
+	std::vector<SMX_PRIM>	prims;
+
+	WeldList(model->verts, vtxTolerance, vtxRemap);
+	WeldList(model->norms, nrmTolerance, nrmRemap);
+
+	for(size_t i=0; i<model->prims.size(); i++) {
+
+		SMX_PRIM prim = model->prims[i];
+
+		for(int j=0; j<PrimPoints(&prim); j++)
+			prim.v[j] = vtxRemap[prim.v[j]];
+		for(int j=0; j<PrimNormals(&prim); j++)
+			prim.n[j] = nrmRemap[prim.n[j]];
+
+		// Drop triangles that collapsed into a line or a point
+		if ((prim.type == PRIM_TYPE_TRI) && (
+			(prim.v[0] == prim.v[1]) ||
+			(prim.v[1] == prim.v[2]) ||
+			(prim.v[2] == prim.v[0])))
+			continue;
+
+		prims.push_back(prim);
+
+	}
+
+	int removed = model->prims.size()-prims.size();
+
+	model->prims = prims;
+	CompactModel(model, false);
+
+	return removed;
+
+}
+
+
+// Quad merging
+//
+
+static bool GetTriNormal(const SMX_MODEL* model, const SMX_PRIM* prim, double* normal) {
+
+	const SMX_VERTEX* v0 = &model->verts[prim->v[0]];
+	const SMX_VERTEX* v1 = &model->verts[prim->v[1]];
+	const SMX_VERTEX* v2 = &model->verts[prim->v[2]];
+
+	double ax = v1->x-v0->x, ay = v1->y-v0->y, az = v1->z-v0->z;
+	double bx = v2->x-v0->x, by = v2->y-v0->y, bz = v2->z-v0->z;
+
+	normal[0] = ay*bz-az*by;
+	normal[1] = az*bx-ax*bz;
+	normal[2] = ax*by-ay*bx;
+
+	double len = sqrt(normal[0]*normal[0]+normal[1]*normal[1]+normal[2]*normal[2]);
+
+	if (len == 0)
+		return false;
+
+	normal[0] /= len;
+	normal[1] /= len;
+	normal[2] /= len;
+
+	return true;
+
+}
+
+static bool SamePointAttribs(const SMX_PRIM* a, int i, const SMX_PRIM* b, int j) {
+
+	if ((a->lighting == PRIM_LIGHTING_SMOOTH) && (a->n[i] != b->n[j]))
+		return false;
+	if (a->gouraud && memcmp(a->rgb[i], b->rgb[j], 3))
+		return false;
+	if (a->textured && ((a->tu[i] != b->tu[j]) || (a->tv[i] != b->tv[j])))
+		return false;
+
+	return true;
+
+}
+
+static bool SamePrimAttribs(const SMX_PRIM* a, const SMX_PRIM* b) {
+
+	if ((a->lighting != b->lighting) || (a->gouraud != b->gouraud) ||
+		(a->textured != b->textured) || (a->doubleSided != b->doubleSided) ||
+		(a->blend != b->blend))
+		return false;
+
+	if (a->textured && (a->texture != b->texture))
+		return false;
+	if ((a->lighting == PRIM_LIGHTING_FLAT) && (a->n[0] != b->n[0]))
+		return false;
+	if (!a->gouraud && memcmp(a->rgb[0], b->rgb[0], 3))
+		return false;
+
+	return true;
+
+}
+
+// Attempts to merge triangle b into triangle a, sharing edge a->v[e]-a->v[e+1].
+// The GPU draws a quad as the triangles (v0,v1,v2) and (v1,v2,v3), so the
+// shared edge becomes v1-v2 and the result is rasterized exactly like the two
+// original triangles.
+static bool TryMerge(const SMX_MODEL* model, SMX_PRIM* a, const SMX_PRIM* b, int e) {
+
+	int s0 = a->v[e];
+	int s1 = a->v[(e+1)%3];
+	int ia = (e+2)%3;
+	int j0 = -1, j1 = -1, jb = -1;
+
+	if (!SamePrimAttribs(a, b))
+		return false;
+
+	// The other triangle must use the edge in the opposite direction, i.e.
+	// have the same winding
+	for(int j=0; j<3; j++) {
+		if ((b->v[j] == s1) && (b->v[(j+1)%3] == s0)) {
+			j1 = j;
+			j0 = (j+1)%3;
+			jb = (j+2)%3;
+		}
+	}
+
+	if (jb < 0)
+		return false;
+	if (!SamePointAttribs(a, e, b, j0) || !SamePointAttribs(a, (e+1)%3, b, j1))
+		return false;
+
+	double na[3], nb[3];
+
+	if (!GetTriNormal(model, a, na) || !GetTriNormal(model, b, nb))
+		return false;
+	if ((na[0]*nb[0]+na[1]*nb[1]+na[2]*nb[2]) < MERGE_MIN_COS)
+		return false;
+
+	SMX_PRIM quad = *a;
+	int order[3] = { ia, e, (e+1)%3 };
+
+	for(int k=0; k<3; k++) {
+
+		int i = order[k];
+
+		quad.v[k] = a->v[i];
+		quad.tu[k] = a->tu[i];
+		quad.tv[k] = a->tv[i];
+		if (a->lighting == PRIM_LIGHTING_SMOOTH)
+			quad.n[k] = a->n[i];
+		if (a->gouraud)
+			memcpy(quad.rgb[k], a->rgb[i], 3);
+
+	}
+
+	quad.type = PRIM_TYPE_QUAD;
+	quad.v[3] = b->v[jb];
+	quad.tu[3] = b->tu[jb];
+	quad.tv[3] = b->tv[jb];
+	if (a->lighting == PRIM_LIGHTING_SMOOTH)
+		quad.n[3] = b->n[jb];
+	if (a->gouraud)
+		memcpy(quad.rgb[3], b->rgb[jb], 3);
+
+	*a = quad;
+
+	return true;
+
+}
+
+int MergeQuads(SMX_MODEL* model) {
+
+	std::map<std::pair<int, int>, std::vector<int> > edges;
+	std::vector<char>		removed(model->prims.size(), 0);
+	std::vector<SMX_PRIM>	prims;
+	int						merged = 0;
+
+	for(size_t i=0; i<model->prims.size(); i++) {
+
+		const SMX_PRIM* prim = &model->prims[i];
+
+		if (prim->type != PRIM_TYPE_TRI)
+			continue;
+
+		for(int e=0; e<3; e++) {
+			int v0 = prim->v[e], v1 = prim->v[(e+1)%3];
+			edges[std::make_pair(std::min(v0, v1), std::max(v0, v1))].push_back(i);
+		}
+
+	}
+
+	for(size_t i=0; i<model->prims.size(); i++) {
+
+		SMX_PRIM* prim = &model->prims[i];
+
+		if (removed[i] || (prim->type != PRIM_TYPE_TRI))
+			continue;
+
+		for(int e=0; (e<3) && (prim->type == PRIM_TYPE_TRI); e++) {
+
+			int v0 = prim->v[e], v1 = prim->v[(e+1)%3];
+			std::vector<int>& list = edges[std::make_pair(std::min(v0, v1), std::max(v0, v1))];
+
+			for(size_t k=0; k<list.size(); k++) {
+
+				int j = list[k];
+
+				if ((j == (int)i) || removed[j] || (model->prims[j].type != PRIM_TYPE_TRI))
+					continue;
+
+				if (TryMerge(model, prim, &model->prims[j], e)) {
+					removed[j] = 1;
+					merged++;
+					break;
+				}
+
+			}
+
+		}
+
+	}
+
+	for(size_t i=0; i<model->prims.size(); i++) {
+		if (!removed[i])
+			prims.push_back(model->prims[i]);
+	}
+
+	model->prims = prims;
+
+	return merged;
+
+}
+
+
+// Reordering
+//
+
+void ReorderModel(SMX_MODEL* model) {
+
+	int numPrims = model->prims.size();
+
+	std::vector<std::vector<int> >	users(model->verts.size());
+	std::vector<char>				emitted(numPrims, 0);
+	std::vector<char>				cached(model->verts.size(), 0);
+	std::deque<int>					cache;
+	std::vector<SMX_PRIM>			prims;
+	int								next = 0;
+
+	for(int i=0; i<numPrims; i++) {
+
+		const SMX_PRIM* prim = &model->prims[i];
+
+		for(int j=0; j<PrimPoints(prim); j++)
+			users[prim->v[j]].push_back(i);
+
+	}
+
+	// Greedily pick the primitive with the most vertices already in the
+	// cache, falling back to the first one left in the original order
+	while((int)prims.size() < numPrims) {
+
+		int best = -1, bestScore = 0;
+
+		for(size_t c=0; c<cache.size(); c++) {
+
+			const std::vector<int>& list = users[cache[c]];
+
+			for(size_t k=0; k<list.size(); k++) {
+
+				int p = list[k];
+				int score = 0;
+
+				if (emitted[p])
+					continue;
+
+				for(int j=0; j<PrimPoints(&model->prims[p]); j++) {
+					if (cached[model->prims[p].v[j]])
+						score++;
+				}
+
+				if ((score > bestScore) || ((score == bestScore) && (p < best))) {
+					best = p;
+					bestScore = score;
+				}
+
+			}
+
+		}
+
+		if (best < 0) {
+
+			while(emitted[next])
+				next++;
+
+			best = next;
+
+		}
+
+		const SMX_PRIM* prim = &model->prims[best];
+
+		emitted[best] = 1;
+		prims.push_back(*prim);
+
+		for(int j=0; j<PrimPoints(prim); j++) {
+
+			int v = prim->v[j];
+
+			if (cached[v])
+				continue;
+
+			cache.push_back(v);
+			cached[v] = 1;
+
+			if (cache.size() > VERTEX_CACHE_SIZE) {
+				cached[cache.front()] = 0;
+				cache.pop_front();
+			}
+
+		}
+
+	}
+
+	model->prims = prims;
+	CompactModel(model, true);
+
+}
+
+
+// Compaction
+//
+
+static void CompactList(std::vector<SMX_VERTEX>& list, std::vector<int>& order) {
+
+	std::vector<SMX_VERTEX>	newList;
+	std::vector<int>		remap(list.size(), -1);
+
+	for(size_t i=0; i<order.size(); i++) {
+		remap[order[i]] = i;
+		newList.push_back(list[order[i]]);
+	}
+
+	list = newList;
+	order = remap;
+
+}
+
+void CompactModel(SMX_MODEL* model, bool firstUse) {
+
+	std::vector<char>	vtxUsed(model->verts.size(), 0);
+	std::vector<char>	nrmUsed(model->norms.size(), 0);
+	std::vector<int>	vtxOrder, nrmOrder;
+
+	// Collect the referenced vertices and normals, either in order of first
+	// use or in their original order
+	for(size_t i=0; i<model->prims.size(); i++) {
+
+		const SMX_PRIM* prim = &model->prims[i];
+
+		for(int j=0; j<PrimPoints(prim); j++) {
+
+			int v = prim->v[j];
+
+			if (!vtxUsed[v]) {
+				vtxUsed[v] = 1;
+				vtxOrder.push_back(v);
+			}
+
+		}
+		for(int j=0; j<PrimNormals(prim); j++) {
+
+			int n = prim->n[j];
+
+			if (!nrmUsed[n]) {
+				nrmUsed[n] = 1;
+				nrmOrder.push_back(n);
+			}
+
+		}
+
+	}
+
+	if (!firstUse) {
+
+		vtxOrder.clear();
+		nrmOrder.clear();
+
+		for(size_t i=0; i<vtxUsed.size(); i++) {
+			if (vtxUsed[i])
+				vtxOrder.push_back(i);
+		}
+		for(size_t i=0; i<nrmUsed.size(); i++) {
+			if (nrmUsed[i])
+				nrmOrder.push_back(i);
+		}
+
+	}
+
+	CompactList(model->verts, vtxOrder);
+	CompactList(model->norms, nrmOrder);
+
+	// The order tables now map old indices to new ones
+	for(size_t i=0; i<model->prims.size(); i++) {
+
+		SMX_PRIM* prim = &model->prims[i];
+
+		for(int j=0; j<PrimPoints(prim); j++)
+			prim->v[j] = vtxOrder[prim->v[j]];
+		for(int j=0; j<PrimNormals(prim); j++)
+			prim->n[j] = nrmOrder[prim->n[j]];
+
+	}
+
+}
@@ -0,0 +1,37 @@
+#ifndef _OPTIMIZE_H
+#define _OPTIMIZE_H
+
+#include "model.h"
+
+// Number of most recently transformed vertices assumed to be kept around
+// (e.g. in the scratchpad) by a renderer transforming vertices in batches
+#define VERTEX_CACHE_SIZE	32
+
+typedef struct {
+	int		verts;
+	int		norms;
+	int		tris;
+	int		quads;
+	int		transforms;	// Vertex transforms with a VERTEX_CACHE_SIZE FIFO cache
+} SMX_STATS;
+
+void GetModelStats(const SMX_MODEL* model, SMX_STATS* stats);
+
+// Merges vertices (and normals) whose quantized coordinates are within the
+// given tolerance on all axes, then removes triangles that became degenerate.
+// Returns the number of primitives removed.
+int WeldModel(SMX_MODEL* model, int vtxTolerance, int nrmTolerance);
+
+// Merges pairs of triangles sharing an edge, facing the same way and having
+// matching attributes into quads. Returns the number of quads created.
+int MergeQuads(SMX_MODEL* model);
+
+// Reorders primitives so that consecutive ones share as many vertices as
+// possible, then renumbers vertices and normals in order of first use.
+void ReorderModel(SMX_MODEL* model);
+
+// Removes unreferenced vertices and normals. If firstUse is set, the remaining
+// ones are also sorted in the order they are referenced by primitives.
+void CompactModel(SMX_MODEL* model, bool firstUse);
+
+#endif // _OPTIMIZE_H
@@ -1,5 +1,8 @@
 #include <stdio.h>
 #include <string.h>
+#include <string>
+#include <map>
+#include <mutex>
 #include "timreader.h"
 
 #ifdef WIN32
@@ -46,6 +49,39 @@ int GetTimCoords(const char* fileName, TIM_COORDS *coords) {
 
 }
 
+static std::map<std::string, TIM_COORDS>	cache;
+static std::mutex							lock;
+
+int GetTimCoordsCached(const char* fileName, TIM_COORDS *coords) {
+
+	std::lock_guard<std::mutex> guard(lock);
+
+	auto entry = cache.find(fileName);
+
+	if (entry != cache.end()) {
+
+		*coords = entry->second;
+		return true;
+
+	}
+
+	if (!GetTimCoords(fileName, coords))
+		return false;
+
+	cache[fileName] = *coords;
+
+	return true;
+
+}
+
+void SetTimCoordsCached(const char* fileName, const TIM_COORDS *coords) {
+
+	std::lock_guard<std::mutex> guard(lock);
+
+	cache[fileName] = *coords;
+
+}
+
 unsigned short GetClut(int cx, int cy) {
 
 	unsigned short clut = (cx/16)&0x3f;
@@ -21,6 +21,16 @@ typedef struct {
 
 int GetTimCoords(const char *fileName, TIM_COORDS *coords);
 
+// Same as GetTimCoords(), but keeps the coordinates of every file read so far
+// so that textures shared by several models are only opened once. Safe to
+// call from multiple threads.
+int GetTimCoordsCached(const char *fileName, TIM_COORDS *coords);
+
+// Stores coordinates for a file in the cache used by GetTimCoordsCached(),
+// which then returns them instead of reading the file (used for textures
+// whose positions come from a timpack layout).
+void SetTimCoordsCached(const char *fileName, const TIM_COORDS *coords);
+
 unsigned short GetClut(int cx, int cy);
 
 unsigned short GetTPage(int tp, int abr, int x, int y);
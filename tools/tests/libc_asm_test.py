@@ -0,0 +1,322 @@
+#!/usr/bin/env python3
+# PSn00bSDK libc test harness
+# (C) 2022 PSn00bSDK contributors - MPL licensed
+#
+# Assembles libc's hand-written assembly string functions with the MIPS
+# toolchain, runs them on the host using the interpreter in mipsemu.py and
+# compares their results against a Python reference over all combinations of
+# buffer alignments, lengths and mismatch/match positions. Load delay slot
+# hazards are reported as failures too, as they would go unnoticed on newer
+# MIPS CPUs (and most emulators) but break on a real PS1.
+#
+# Usage: libc_asm_test.py [-p mipsel-none-elf-] [-s seed] [test ...]
+
+import os, random, subprocess, sys, tempfile
+from argparse import ArgumentParser
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from mipsemu import CPU
+
+LIBC_DIR  = os.path.join(os.path.dirname(os.path.abspath(__file__)), "../../libpsn00b/libc")
+LOAD_ADDR = 0x80010000
+BUFFER_A  = 0x80100000
+BUFFER_B  = 0x80180000
+
+LINKER_SCRIPT = f"SECTIONS {{ . = {LOAD_ADDR:#x}; .text : {{ *(.text*) }} }}\n"
+
+## Building
+
+def build(prefix, name, workdir):
+    """
+    Assembles and links libc/<name>.s, then loads it into a new CPU instance.
+    Returns the CPU and the address of the function with the same name.
+    """
+
+    source = os.path.join(LIBC_DIR, f"{name}.s")
+    obj    = os.path.join(workdir, f"{name}.o")
+    elf    = os.path.join(workdir, f"{name}.elf")
+    binary = os.path.join(workdir, f"{name}.bin")
+    script = os.path.join(workdir, "test.ld")
+
+    with open(script, "w") as _file:
+        _file.write(LINKER_SCRIPT)
+
+    subprocess.run([ f"{prefix}as", "-EL", "-march=r3000", "-o", obj, source ], check = True)
+    subprocess.run([ f"{prefix}ld", "-T", script, "-e", name, "-o", elf, obj ], check = True)
+    subprocess.run([ f"{prefix}objcopy", "-O", "binary", elf, binary ], check = True)
+
+    symbols = subprocess.run(
+        [ f"{prefix}nm", elf ], check = True, capture_output = True, text = True
+    ).stdout
+    address = None
+
+    for line in symbols.splitlines():
+        fields = line.split()
+
+        if (len(fields) == 3) and (fields[2] == name):
+            address = int(fields[0], 16)
+
+    if address is None:
+        raise RuntimeError(f"symbol {name} not found in {elf}")
+
+    cpu = CPU()
+    with open(binary, "rb") as _file:
+        cpu.write(LOAD_ADDR, _file.read())
+
+    return cpu, address
+
+## Test helpers
+
+# Lengths around the word loop thresholds, plus a few longer ones.
+LENGTHS      = list(range(0, 41)) + [ 63, 64, 65, 200 ]
+LONG_LENGTH  = 40
+
+def _s32(value):
+    return value - 0x100000000 if value & 0x80000000 else value
+
+def _positions(length):
+    # Test every position in short buffers but only the edges and the middle
+    # in long ones, to keep the run time reasonable.
+    if length <= LONG_LENGTH:
+        return list(range(length))
+
+    return sorted({ 0, 1, length // 2, length - 2, length - 1 })
+
+class TestContext:
+    def __init__(self, name, rng):
+        self.name     = name
+        self.rng      = rng
+        self.failures = 0
+        self.cases    = 0
+
+    def random_bytes(self, length):
+        return bytes(self.rng.getrandbits(8) for _ in range(length))
+
+    def random_string(self, length):
+        # Favor the values most likely to confuse the zero byte test.
+        return bytes(
+            self.rng.choice(( 0x01, 0x7f, 0x80, 0x81, 0xff, self.rng.randint(1, 255) ))
+            for _ in range(length)
+        )
+
+    def check(self, condition, message):
+        self.cases += 1
+
+        if not condition:
+            self.failures += 1
+            if self.failures <= 10:
+                print(f"  {self.name}: {message}")
+
+## Tests
+
+def test_memcmp(ctx, cpu, func):
+    for align_a in range(4):
+        for align_b in range(4):
+            for length in LENGTHS:
+                for pos in _positions(length) + [ None ]:
+                    data_a = ctx.random_bytes(length)
+                    data_b = bytearray(data_a)
+
+                    if pos is not None:
+                        data_b[pos] = (data_b[pos] + ctx.rng.randint(1, 255)) & 0xff
+
+                    # Fill the surroundings with garbage to catch overreads
+                    # affecting the result.
+                    cpu.write(BUFFER_A, ctx.random_bytes(length + 8))
+                    cpu.write(BUFFER_B, ctx.random_bytes(length + 8))
+                    cpu.write(BUFFER_A + align_a, data_a)
+                    cpu.write(BUFFER_B + align_b, data_b)
+
+                    result   = _s32(cpu.call(func, BUFFER_A + align_a, BUFFER_B + align_b, length))
+                    expected = 0 if (pos is None) else (data_a[pos] - data_b[pos])
+
+                    ctx.check(
+                        result == expected,
+                        f"align={align_a},{align_b} len={length} pos={pos}: got {result}, expected {expected}"
+                    )
+
+    # A negative length must be treated as zero.
+    result = cpu.call(func, BUFFER_A, BUFFER_B, -1)
+    ctx.check(result == 0, f"len=-1: got {_s32(result)}, expected 0")
+
+def test_memchr(ctx, cpu, func):
+    for align in range(4):
+        for length in LENGTHS:
+            for char in ( 0x00, 0x01, 0x41, 0x80, 0xff ):
+                # Fill the buffer with values one bit or one unit away from the
+                # character, which are the most likely to produce false
+                # positives in the word loop's zero byte test.
+                pool = [
+                    value for value in (
+                        char ^ 1, (char + 1) & 0xff, (char - 1) & 0xff,
+                        0x00, 0x01, 0x80, 0xfe
+                    ) if value != char
+                ]
+
+                for pos in _positions(length) + [ None ]:
+                    data = bytearray(ctx.rng.choice(pool) for _ in range(length))
+
+                    if pos is not None:
+                        data[pos] = char
+
+                        for index in range(pos + 1, length):
+                            if ctx.rng.random() < 0.3:
+                                data[index] = char
+
+                    # Surround the buffer with the character to catch reads
+                    # past the end.
+                    cpu.write(BUFFER_A, bytes([ char ]) * (length + 8))
+                    cpu.write(BUFFER_A + align, data)
+
+                    # The upper bits of the character argument must be ignored.
+                    arg      = char | (0x1200 if (char & 1) else 0)
+                    result   = cpu.call(func, BUFFER_A + align, arg, length)
+                    expected = 0 if (pos is None) else (BUFFER_A + align + pos)
+
+                    ctx.check(
+                        result == expected,
+                        f"align={align} len={length} char={char:#04x} pos={pos}: got {result:#x}, expected {expected:#x}"
+                    )
+
+    result = cpu.call(func, BUFFER_A, 0, -1)
+    ctx.check(result == 0, f"len=-1: got {result:#x}, expected 0")
+
+def test_strlen(ctx, cpu, func):
+    for align in range(4):
+        for length in LENGTHS:
+            for _ in range(4):
+                cpu.write(BUFFER_A, ctx.random_string(length + 8))
+                cpu.write(BUFFER_A + align + length, b"\0")
+
+                result = cpu.call(func, BUFFER_A + align)
+
+                ctx.check(
+                    result == length,
+                    f"align={align} len={length}: got {_s32(result)}"
+                )
+
+def test_strcmp(ctx, cpu, func):
+    for align_a in range(4):
+        for align_b in range(4):
+            for length in LENGTHS:
+                # Besides differing characters, also test strings that are
+                # prefixes of each other (i.e. one terminator is compared
+                # against a character).
+                for pos in _positions(length) + [ None ]:
+                    for prefix in ( False, True ):
+                        if prefix and (pos is None):
+                            continue
+
+                        data_a = ctx.random_string(length) + b"\0"
+                        data_b = bytearray(data_a)
+
+                        if prefix:
+                            data_b[pos] = 0
+                        elif pos is not None:
+                            data_b[pos] = ctx.rng.choice([ v for v in range(1, 256) if v != data_a[pos] ])
+
+                        cpu.write(BUFFER_A, ctx.random_bytes(length + 8))
+                        cpu.write(BUFFER_B, ctx.random_bytes(length + 8))
+                        cpu.write(BUFFER_A + align_a, data_a)
+                        cpu.write(BUFFER_B + align_b, data_b)
+
+                        result = _s32(cpu.call(func, BUFFER_A + align_a, BUFFER_B + align_b))
+
+                        if pos is None:
+                            expected = 0
+                        else:
+                            expected = data_a[pos] - data_b[pos]
+
+                        # Try the other way around as well.
+                        swapped = _s32(cpu.call(func, BUFFER_B + align_b, BUFFER_A + align_a))
+
+                        ctx.check(
+                            (result == expected) and (swapped == -expected),
+                            f"align={align_a},{align_b} len={length} pos={pos} prefix={prefix}: "
+                            f"got {result}/{swapped}, expected {expected}/{-expected}"
+                        )
+
+def test_strcpy(ctx, cpu, func):
+    for align_dst in range(4):
+        for align_src in range(4):
+            for length in LENGTHS:
+                data   = ctx.random_string(length) + b"\0"
+                canary = bytes([ 0xa5 ]) * (length + 12)
+
+                cpu.write(BUFFER_A, canary)
+                cpu.write(BUFFER_B, ctx.random_bytes(length + 8))
+                cpu.write(BUFFER_B + align_src, data)
+
+                result = cpu.call(func, BUFFER_A + align_dst, BUFFER_B + align_src)
+
+                # The bytes before and after the copied string must be left
+                # untouched.
+                expected = canary[0:align_dst] + data + canary[align_dst + len(data):]
+
+                ctx.check(
+                    (result == BUFFER_A + align_dst) and (cpu.read(BUFFER_A, len(canary)) == expected),
+                    f"align={align_dst},{align_src} len={length}: wrong output or return value {result:#x}"
+                )
+
+TESTS = {
+    "memcmp": test_memcmp,
+    "memchr": test_memchr,
+    "strlen": test_strlen,
+    "strcmp": test_strcmp,
+    "strcpy": test_strcpy
+}
+
+## Main
+
+def main():
+    parser = ArgumentParser(
+        description = "Runs libc's assembly string functions in a MIPS interpreter and checks their results."
+    )
+    parser.add_argument(
+        "-p", "--prefix",
+        type    = str,
+        default = os.environ.get("PSN00BSDK_TC_PREFIX", "mipsel-none-elf-"),
+        help    = "Toolchain prefix (default: mipsel-none-elf-)"
+    )
+    parser.add_argument(
+        "-s", "--seed",
+        type    = int,
+        default = 1,
+        help    = "Random seed (default: 1)"
+    )
+    parser.add_argument(
+        "tests",
+        nargs   = "*",
+        default = list(TESTS.keys()),
+        help    = "Tests to run (default: all)"
+    )
+    args = parser.parse_args()
+
+    failed = 0
+
+    with tempfile.TemporaryDirectory() as workdir:
+        for name in args.tests:
+            if name not in TESTS:
+                parser.error(f"unknown test: {name}")
+
+            cpu, func = build(args.prefix, name, workdir)
+            ctx       = TestContext(name, random.Random(args.seed))
+
+            TESTS[name](ctx, cpu, func)
+
+            for hazard in cpu.hazards[:10]:
+                print(f"  {name}: hazard at {hazard}")
+
+            status = "OK" if not (ctx.failures or cpu.hazards) else "FAILED"
+            print(
+                f"{name}: {status} ({ctx.cases} cases, {ctx.failures} failures, "
+                f"{len(cpu.hazards)} hazards, {cpu.cycles} instructions)"
+            )
+
+            if ctx.failures or cpu.hazards:
+                failed += 1
+
+    return 1 if failed else 0
+
+if __name__ == "__main__":
+    sys.exit(main())
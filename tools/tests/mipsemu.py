@@ -0,0 +1,235 @@
+# PSn00bSDK libc test harness - minimal MIPS R3000 interpreter
+# (C) 2022 PSn00bSDK contributors - MPL licensed
+#
+# This is not a PS1 emulator: it only implements the user-mode integer subset
+# of the R3000 instruction set used by libc's hand-written assembly routines,
+# on top of a flat little-endian RAM. It is meant to run leaf functions on the
+# host and compare their results against a Python reference.
+#
+# Unlike most emulators, load delay slots are checked rather than emulated:
+# reading a register in the instruction right after the load that writes it
+# (which returns the old value on an R3000 but the new one on later MIPS CPUs)
+# is reported as a hazard, as is issuing a mult/div too close to a mfhi/mflo.
+
+import struct
+
+RAM_SIZE   = 0x200000
+RAM_MASK   = RAM_SIZE - 1
+RETURN_PC  = 0x80001000
+STACK_TOP  = 0x801ffff0
+
+def _s16(value):
+    return value - 0x10000 if value & 0x8000 else value
+
+def _s32(value):
+    return value - 0x100000000 if value & 0x80000000 else value
+
+def _u32(value):
+    return value & 0xffffffff
+
+class EmulatorError(Exception):
+    pass
+
+class CPU:
+    def __init__(self):
+        self.mem     = bytearray(RAM_SIZE)
+        self.r       = [ 0 ] * 32
+        self.hi      = 0
+        self.lo      = 0
+        self.cycles  = 0
+        self.hazards = []
+
+        self._last_mf = -10
+
+    ## Memory access
+
+    def read(self, addr, length):
+        addr &= RAM_MASK
+        return bytes(self.mem[addr:addr + length])
+
+    def write(self, addr, data):
+        addr &= RAM_MASK
+        self.mem[addr:addr + len(data)] = data
+
+    def _lw(self, addr):
+        return struct.unpack_from("<I", self.mem, addr & RAM_MASK)[0]
+
+    def _sw(self, addr, value):
+        struct.pack_into("<I", self.mem, addr & RAM_MASK, _u32(value))
+
+    ## Execution
+
+    def call(self, pc, *args, max_cycles = 10000000):
+        """
+        Calls the function at the given address with up to four integer
+        arguments and returns the contents of $v0 once it returns. The number
+        of instructions executed is accumulated into the cycles attribute.
+        """
+
+        self.r     = [ 0 ] * 32
+        self.r[29] = STACK_TOP
+        self.r[31] = RETURN_PC
+
+        for index, value in enumerate(args):
+            self.r[4 + index] = _u32(value)
+
+        self._run(pc, self.cycles + max_cycles)
+        return self.r[2]
+
+    def _hazard(self, pc, message):
+        self.hazards.append(f"{pc:08x}: {message}")
+
+    def _run(self, pc, max_cycles):
+        npc       = pc + 4
+        last_load = 0
+        R         = self.r
+
+        while pc != RETURN_PC:
+            if self.cycles >= max_cycles:
+                raise EmulatorError(f"timed out at {pc:08x}")
+
+            ins = self._lw(pc)
+            self.cycles += 1
+
+            op  = ins >> 26
+            rs  = (ins >> 21) & 31
+            rt  = (ins >> 16) & 31
+            rd  = (ins >> 11) & 31
+            sa  = (ins >>  6) & 31
+            fn  = ins & 63
+            imm = ins & 0xffff
+            si  = _s16(imm)
+
+            # Figure out which registers this instruction reads, in order to
+            # detect load delay slot violations.
+            if op == 0:
+                reads = { rt } if fn in ( 0x00, 0x02, 0x03 ) else { rs, rt }
+            elif op in ( 0x04, 0x05, 0x28, 0x29, 0x2a, 0x2b, 0x2e ):
+                reads = { rs, rt }
+            elif op in ( 0x22, 0x26 ):
+                # lwl/lwr merge into the destination, so reading it right after
+                # another lwl/lwr to the same register is allowed.
+                reads = { rs }
+            elif op in ( 0x02, 0x03, 0x0f ):
+                reads = set()
+            else:
+                reads = { rs }
+
+            if last_load and (last_load in reads):
+                self._hazard(pc, f"${last_load} used in load delay slot")
+
+            last_load = 0
+            nnpc      = npc + 4
+            dest      = 0
+            value     = 0
+
+            if op == 0x00:
+                if fn == 0x00:   dest, value = rd, R[rt] << sa
+                elif fn == 0x02: dest, value = rd, R[rt] >> sa
+                elif fn == 0x03: dest, value = rd, _s32(R[rt]) >> sa
+                elif fn == 0x04: dest, value = rd, R[rt] << (R[rs] & 31)
+                elif fn == 0x06: dest, value = rd, R[rt] >> (R[rs] & 31)
+                elif fn == 0x07: dest, value = rd, _s32(R[rt]) >> (R[rs] & 31)
+                elif fn == 0x08: nnpc = R[rs]
+                elif fn == 0x09: dest, value, nnpc = rd, pc + 8, R[rs]
+                elif fn == 0x10: dest, value, self._last_mf = rd, self.hi, self.cycles
+                elif fn == 0x12: dest, value, self._last_mf = rd, self.lo, self.cycles
+                elif fn in ( 0x18, 0x19, 0x1a, 0x1b ):
+                    if (self.cycles - self._last_mf) <= 2:
+                        self._hazard(pc, "mult/div too close to mfhi/mflo")
+
+                    a, b = R[rs], R[rt]
+                    if fn in ( 0x18, 0x1a ):
+                        a, b = _s32(a), _s32(b)
+
+                    if fn in ( 0x18, 0x19 ):
+                        product = a * b
+                        self.lo = _u32(product)
+                        self.hi = _u32(product >> 32)
+                    elif b:
+                        quotient = abs(a) // abs(b)
+                        if (a < 0) != (b < 0):
+                            quotient = -quotient
+
+                        self.lo = _u32(quotient)
+                        self.hi = _u32(a - quotient * b)
+                elif fn == 0x21: dest, value = rd, R[rs] + R[rt]
+                elif fn == 0x23: dest, value = rd, R[rs] - R[rt]
+                elif fn == 0x24: dest, value = rd, R[rs] & R[rt]
+                elif fn == 0x25: dest, value = rd, R[rs] | R[rt]
+                elif fn == 0x26: dest, value = rd, R[rs] ^ R[rt]
+                elif fn == 0x27: dest, value = rd, ~(R[rs] | R[rt])
+                elif fn == 0x2a: dest, value = rd, int(_s32(R[rs]) < _s32(R[rt]))
+                elif fn == 0x2b: dest, value = rd, int(R[rs] < R[rt])
+                else:
+                    raise EmulatorError(f"unsupported SPECIAL function {fn:#x} at {pc:08x}")
+            elif op == 0x01:
+                if rt & 0x10:
+                    dest, value = 31, pc + 8
+                if (R[rs] >= 0x80000000) == (not (rt & 1)):
+                    nnpc = npc + (si << 2)
+            elif op == 0x02: nnpc = (npc & 0xf0000000) | ((ins & 0x3ffffff) << 2)
+            elif op == 0x03:
+                dest, value = 31, pc + 8
+                nnpc = (npc & 0xf0000000) | ((ins & 0x3ffffff) << 2)
+            elif op == 0x04:
+                if R[rs] == R[rt]: nnpc = npc + (si << 2)
+            elif op == 0x05:
+                if R[rs] != R[rt]: nnpc = npc + (si << 2)
+            elif op == 0x06:
+                if _s32(R[rs]) <= 0: nnpc = npc + (si << 2)
+            elif op == 0x07:
+                if _s32(R[rs]) > 0: nnpc = npc + (si << 2)
+            elif op == 0x09: dest, value = rt, R[rs] + si
+            elif op == 0x0a: dest, value = rt, int(_s32(R[rs]) < si)
+            elif op == 0x0b: dest, value = rt, int(R[rs] < _u32(si))
+            elif op == 0x0c: dest, value = rt, R[rs] & imm
+            elif op == 0x0d: dest, value = rt, R[rs] | imm
+            elif op == 0x0e: dest, value = rt, R[rs] ^ imm
+            elif op == 0x0f: dest, value = rt, imm << 16
+            elif 0x20 <= op <= 0x26:
+                addr      = _u32(R[rs] + si)
+                dest      = rt
+                last_load = rt
+
+                if op == 0x20:   value = _u32(_s32(self.mem[addr & RAM_MASK] << 24) >> 24)
+                elif op == 0x21: value = _u32(_s16(struct.unpack_from("<H", self.mem, addr & RAM_MASK)[0]))
+                elif op == 0x23: value = self._lw(addr)
+                elif op == 0x24: value = self.mem[addr & RAM_MASK]
+                elif op == 0x25: value = struct.unpack_from("<H", self.mem, addr & RAM_MASK)[0]
+                else:
+                    word  = self._lw(addr & ~3)
+                    shift = (addr & 3) * 8
+
+                    if op == 0x22: # lwl
+                        shift = 24 - shift
+                        mask  = _u32(0xffffffff << shift)
+                        value = (R[rt] & ~mask) | _u32(word << shift)
+                    else:          # lwr
+                        mask  = 0xffffffff >> shift
+                        value = (R[rt] & ~mask) | (word >> shift)
+            elif op in ( 0x28, 0x29, 0x2a, 0x2b, 0x2e ):
+                addr = _u32(R[rs] + si)
+
+                if op == 0x28:   self.mem[addr & RAM_MASK] = R[rt] & 0xff
+                elif op == 0x29: struct.pack_into("<H", self.mem, addr & RAM_MASK, R[rt] & 0xffff)
+                elif op == 0x2b: self._sw(addr, R[rt])
+                else:
+                    word  = self._lw(addr & ~3)
+                    shift = (addr & 3) * 8
+
+                    if op == 0x2a: # swl
+                        mask = 0xffffffff >> (24 - shift)
+                        word = (word & ~mask) | (R[rt] >> (24 - shift))
+                    else:          # swr
+                        mask = _u32(0xffffffff << shift)
+                        word = (word & ~mask) | _u32(R[rt] << shift)
+
+                    self._sw(addr & ~3, word)
+            else:
+                raise EmulatorError(f"unsupported opcode {op:#x} at {pc:08x}")
+
+            if dest:
+                R[dest] = _u32(value)
+
+            pc, npc = npc, nnpc
@@ -0,0 +1,466 @@
+/*
+ * PSn00bSDK C++ utility library unit tests
+ * (C) 2022 PSn00bSDK contributors - MPL licensed
+ *
+ * The util/ headers do not depend on any PS1-specific code (other than
+ * util/gpu.hpp), so they are tested by compiling them for the host. See
+ * CMakeLists.txt in this directory for how the headers are made available
+ * without also pulling in libpsn00b's own libc headers.
+ *
+ * Each test counts the number of live instances of a tracked type, in order
+ * to catch containers that leak or destroy elements twice.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <util/containers.hpp>
+#include <util/fixed.hpp>
+#include <util/function.hpp>
+
+// Placement new is normally provided by libpsn00b's libc.
+void *operator new(size_t size, void *ptr) noexcept {
+	return ptr;
+}
+
+static int _failures = 0, _checks = 0;
+
+#define CHECK(expr) \
+	do { \
+		_checks++; \
+		if (!(expr)) { \
+			printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr); \
+			_failures++; \
+		} \
+	} while (0)
+
+/* Tracked object type */
+
+static int _live = 0;
+
+struct Tracked {
+	int value;
+
+	Tracked(int _value)
+	: value(_value) {
+		_live++;
+	}
+	Tracked(const Tracked &other)
+	: value(other.value) {
+		_live++;
+	}
+	Tracked &operator=(const Tracked &other) = default;
+	~Tracked(void) {
+		_live--;
+	}
+};
+
+/* Vector */
+
+static int _sum(util::Span<const int> span) {
+	int total = 0;
+
+	for (int value : span)
+		total += value;
+
+	return total;
+}
+
+static void test_vector(void) {
+	{
+		util::Vector<Tracked, 4> vec;
+
+		CHECK(vec.empty() && (vec.capacity() == 4));
+		CHECK(vec.push(Tracked(1)) && vec.push(Tracked(2)));
+		CHECK(vec.emplace(3) && vec.emplace(4));
+		CHECK(vec.full() && !vec.emplace(5));
+		CHECK(_live == 4);
+
+		vec.remove(1);
+		CHECK((vec.size() == 3) && (_live == 3));
+		CHECK((vec[0].value == 1) && (vec[1].value == 3) && (vec[2].value == 4));
+
+		CHECK(vec.insert(1, Tracked(9)));
+		CHECK((vec[1].value == 9) && (vec[2].value == 3) && (vec[3].value == 4));
+		CHECK(_live == 4);
+		CHECK(!vec.insert(0, Tracked(10)));
+		CHECK(_live == 4);
+
+		vec.removeSwap(0);
+		CHECK((vec.size() == 3) && (vec[0].value == 4) && (_live == 3));
+
+		Tracked output(0);
+		CHECK(vec.pop(&output) && (output.value == 3));
+		CHECK((vec.size() == 2) && (vec.back().value == 9));
+	}
+	CHECK(_live == 0);
+
+	{
+		util::HeapAllocator  heap;
+		util::Vector<int> vec;
+
+		CHECK((vec.capacity() == 0) && !vec.push(1));
+		CHECK(vec.allocate(heap, 8));
+
+		for (int i = 0; i < 8; i++)
+			vec.push(i);
+
+		CHECK(vec.full() && !vec.push(8));
+		CHECK(_sum(vec) == 28);
+		CHECK(_sum(util::Span<const int>(vec).subspan(4)) == 22);
+		CHECK(_sum(util::Span<const int>(vec).first(2)) == 1);
+
+		int array[3] = { 1, 2, 3 };
+		CHECK(_sum(array) == 6);
+
+		vec.release(heap);
+		CHECK((vec.capacity() == 0) && vec.empty());
+	}
+}
+
+/* Ring buffer */
+
+static void test_ring_buffer(void) {
+	static uint8_t arena_buffer[256];
+
+	util::ArenaAllocator arena(arena_buffer, sizeof(arena_buffer));
+
+	{
+		util::RingBuffer<Tracked> ring;
+
+		// Capacities that are not a power of two must be rejected.
+		CHECK(!ring.allocate(arena, 6));
+		CHECK(ring.allocate(arena, 4));
+
+		// Push more items than the capacity while popping, so that the head
+		// and tail counters wrap around the buffer several times.
+		for (int i = 0; i < 10; i++) {
+			CHECK(ring.emplace(i));
+
+			if (ring.size() == 3) {
+				Tracked output(0);
+
+				CHECK(ring.pop(&output) && (output.value == (i - 2)));
+			}
+		}
+
+		CHECK(ring.size() == 2);
+		CHECK((ring.front().value == 8) && (ring.back().value == 9));
+		CHECK(ring[1].value == 9);
+
+		CHECK(ring.emplace(10) && ring.emplace(11));
+		CHECK(ring.full() && !ring.emplace(12));
+		CHECK(_live == 4);
+
+		ring.release(arena);
+		CHECK(_live == 0);
+	}
+
+	{
+		util::RingBuffer<int, 8> ring;
+		int                      output;
+
+		CHECK(!ring.pop(&output));
+
+		for (int i = 0; i < 100; i++) {
+			CHECK(ring.push(i));
+			CHECK(ring.pop(&output) && (output == i));
+		}
+
+		CHECK(ring.empty());
+	}
+}
+
+/* Hash map */
+
+// Hashes all keys to the same slot, so that every entry ends up in the same
+// probe sequence.
+struct CollidingHash {
+	static uint32_t hash(const int &key) {
+		return 0;
+	}
+	static bool equal(const int &a, const int &b) {
+		return (a == b);
+	}
+};
+
+static void test_hash_map(void) {
+	{
+		util::HashMap<uint32_t, int, 64> map;
+
+		for (uint32_t i = 0; i < 48; i++)
+			CHECK(map.set(i * 64, i));
+		for (uint32_t i = 0; i < 48; i++)
+			CHECK(map.get(i * 64) && (*map.get(i * 64) == int(i)));
+
+		for (uint32_t i = 0; i < 48; i += 2)
+			CHECK(map.remove(i * 64));
+
+		CHECK(!map.remove(0) && !map.get(0));
+		CHECK(map.size() == 24);
+
+		for (uint32_t i = 1; i < 48; i += 2)
+			CHECK(*map.get(i * 64) == int(i));
+
+		int count = 0;
+		map.forEach([&](const uint32_t &key, int &value) {
+			count++;
+		});
+		CHECK(count == 24);
+
+		map.clear();
+		CHECK(map.empty() && !map.get(64) && map.set(1, 1));
+	}
+
+	// Tombstone reuse: removing an entry in the middle of a probe sequence
+	// must not hide the entries after it, and reinserting a key that is
+	// still present further along the sequence must update it rather than
+	// filling the tombstone with a duplicate.
+	{
+		util::HashMap<int, Tracked, 8, CollidingHash> map;
+
+		CHECK(map.emplace(1, 10) && map.emplace(2, 20) && map.emplace(3, 30));
+		CHECK(map.remove(1));
+		CHECK(map.get(2) && (map.get(2)->value == 20));
+		CHECK(map.get(3) && (map.get(3)->value == 30));
+
+		CHECK(map.set(3, Tracked(31)));
+		CHECK(map.size() == 2);
+		CHECK(map.remove(3));
+		CHECK(!map.get(3));
+
+		CHECK(map.emplace(2, 99) && (map.get(2)->value == 20));
+		CHECK(map.set(4, Tracked(40)) && (map.size() == 2));
+		CHECK(_live == 2);
+
+		// Repeatedly inserting and removing keys must keep reusing the same
+		// tombstones rather than running out of slots.
+		for (int i = 100; i < 200; i++) {
+			CHECK(map.emplace(i, i));
+			CHECK(map.remove(i));
+		}
+
+		CHECK(map.size() == 2);
+		CHECK(_live == 2);
+	}
+	CHECK(_live == 0);
+
+	// Full map: once all slots are used, inserting a new key must fail while
+	// updating an existing one must still work. Lookups of missing keys must
+	// terminate even though there are no empty slots left.
+	{
+		util::HashMap<int, int, 8> map;
+
+		for (int i = 0; i < 8; i++)
+			CHECK(map.set(i * 3, i));
+
+		CHECK(map.size() == 8);
+		CHECK(!map.set(100, 0) && !map.emplace(100, 0));
+		CHECK(!map.get(100) && !map.remove(100));
+		CHECK(map.set(9, 42) && (*map.get(9) == 42));
+		CHECK(map.size() == 8);
+
+		// Replace every entry with a tombstone, then fill the map again.
+		for (int i = 0; i < 8; i++)
+			CHECK(map.remove(i * 3));
+
+		CHECK(map.empty() && !map.get(0));
+
+		for (int i = 0; i < 8; i++)
+			CHECK(map.set(i + 1000, i));
+
+		CHECK(map.size() == 8 && !map.set(2000, 0));
+
+		for (int i = 0; i < 8; i++)
+			CHECK(map.get(i + 1000) && (*map.get(i + 1000) == i));
+	}
+
+	// DYNAMIC maps are unusable until given a buffer.
+	{
+		util::HeapAllocator       heap;
+		util::HashMap<int, int> map;
+
+		CHECK(!map.set(1, 1) && !map.get(1));
+		CHECK(!map.allocate(heap, 12));
+		CHECK(map.allocate(heap, 16) && (map.capacity() == 16));
+		CHECK(map.set(1, 1) && (*map.get(1) == 1));
+
+		map.release(heap);
+		CHECK(!map.get(1));
+	}
+
+	// Other key types
+	{
+		util::HashMap<const char *, int, 8> map;
+		char                                key[] = "abc";
+
+		map.set("abc", 1);
+		map.set("def", 2);
+		CHECK(map.get(key) && (*map.get(key) == 1));
+		CHECK(!map.get("abd"));
+
+		enum class Enum { A, B };
+		util::HashMap<Enum, int, 4> enum_map;
+
+		enum_map.set(Enum::B, 3);
+		CHECK(enum_map.get(Enum::B) && !enum_map.get(Enum::A));
+
+		int                         value;
+		util::HashMap<int *, int, 4> ptr_map;
+
+		ptr_map.set(&value, 3);
+		CHECK(ptr_map.get(&value) && (*ptr_map.get(&value) == 3));
+	}
+}
+
+/* Intrusive list */
+
+struct DrawTag {};
+
+struct Actor
+: public util::ListNode<Actor>, public util::ListNode<Actor, DrawTag> {
+	int id;
+
+	Actor(int _id)
+	: id(_id) {}
+};
+
+template<typename L> static int _listIDs(L &list) {
+	int ids = 0;
+
+	for (auto &actor : list)
+		ids = ids * 10 + actor.id;
+
+	return ids;
+}
+
+static void test_intrusive_list(void) {
+	Actor a(1), b(2), c(3);
+
+	util::IntrusiveList<Actor>          all;
+	util::IntrusiveList<Actor, DrawTag> draw;
+
+	CHECK(all.empty() && !all.front() && !all.popFront());
+
+	all.pushBack(&a);
+	all.pushBack(&c);
+	all.insertAfter(&a, &b);
+	draw.pushFront(&c);
+	draw.pushFront(&a);
+
+	// The same objects can be in both lists independently.
+	CHECK(_listIDs(all) == 123);
+	CHECK(_listIDs(draw) == 13);
+	CHECK(all.size() == 3);
+
+	all.remove(&b);
+	CHECK((_listIDs(all) == 13) && (all.size() == 2));
+	CHECK(_listIDs(draw) == 13);
+
+	using DrawList = util::IntrusiveList<Actor, DrawTag>;
+	CHECK((draw.front() == &a) && (DrawList::next(&a) == &c));
+	CHECK((DrawList::prev(&c) == &a) && !DrawList::prev(&a));
+
+	all.insertAfter(&c, &b);
+	CHECK((_listIDs(all) == 132) && (all.back() == &b));
+
+	CHECK(all.popBack() == &b);
+	CHECK(all.popFront() == &a);
+	CHECK(all.popFront() == &c);
+	CHECK(all.empty() && !all.popBack());
+
+	draw.clear();
+	CHECK(draw.empty());
+}
+
+/* Function */
+
+static int _negate(int value) {
+	return -value;
+}
+
+static void test_function(void) {
+	int base = 10;
+
+	util::Function<int(int)> func = [&base](int value) {
+		return value + base;
+	};
+	util::Function<int(int)> copy = func;
+
+	base = 20;
+	CHECK((func(1) == 21) && (copy(2) == 22));
+
+	util::Function<int(int), 16> large;
+	CHECK(!large);
+
+	{
+		Tracked captured(5);
+
+		large = [captured](int value) {
+			return value * captured.value;
+		};
+	}
+	CHECK(large && (_live == 1) && (large(3) == 15));
+
+	{
+		auto large_copy = large;
+
+		CHECK((_live == 2) && (large_copy(4) == 20));
+		large = nullptr;
+		CHECK(!large && (_live == 1));
+	}
+	CHECK(_live == 0);
+
+	util::Function<int(int)> pointer = &_negate;
+	CHECK(pointer(3) == -3);
+
+	pointer = func;
+	CHECK(pointer(3) == 23);
+}
+
+/* Fixed-point */
+
+constexpr util::Fix16 _half = util::Fix16::fromFloat(0.5);
+
+static_assert((_half * util::Fix16(3)).raw() == 0x18000, "");
+static_assert(util::Fix12(util::Fix16::fromRaw(0x18000)).raw() == 0x1800, "");
+static_assert(util::Fix16(util::Fix12::fromRaw(0x1800)).raw() == 0x18000, "");
+static_assert((util::Fix16(3) / util::Fix16(2)) == util::Fix16::fromRatio(3, 2), "");
+
+// Negative values must work in constant expressions as well, which rules out
+// left-shifting them.
+static_assert(util::Fix16::fromRatio(-1, 2).raw() == -0x8000, "");
+static_assert(util::Fix16::fromRatio(3, -4).raw() == -0xc000, "");
+static_assert((util::Fix16(-3) / util::Fix16(2)) == util::Fix16::fromRatio(-3, 2), "");
+static_assert((util::Fix16(3) / util::Fix16(-2)).raw() == -0x18000, "");
+static_assert((util::Fix16(-3) << 2) == util::Fix16(-12), "");
+static_assert((util::Fix12::fromRatio(-5, 4) << 1).raw() == -0x2800, "");
+
+static void test_fixed(void) {
+	util::Fix16 value = util::Fix16::fromRatio(-7, 2);
+
+	CHECK(value.toInt() == -4);
+	CHECK(value.round() == -3);
+	CHECK(value.abs() == util::Fix16::fromRatio(7, 2));
+	CHECK((value * 2).toInt() == -7);
+	CHECK(((value >> 1) << 1) == value);
+
+	value += util::Fix16(1);
+	value *= util::Fix16(2);
+	CHECK(value == util::Fix16(-5));
+}
+
+/* Main */
+
+int main(int argc, const char **argv) {
+	test_vector();
+	test_ring_buffer();
+	test_hash_map();
+	test_intrusive_list();
+	test_function();
+	test_fixed();
+
+	CHECK(_live == 0);
+
+	printf("%d checks, %d failures\n", _checks, _failures);
+	return _failures ? 1 : 0;
+}
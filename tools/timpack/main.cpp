@@ -0,0 +1,567 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+#include <tinyxml2.h>
+
+#include "png.h"
+#include "quantize.h"
+#include "packer.h"
+
+#ifdef WIN32
+#define strcasecmp _stricmp
+#endif
+
+#define VERSION "0.10"
+
+#define VRAM_W		1024
+#define VRAM_H		512
+#define TPAGE_X		64		// Texture pages start at multiples of 64 pixels
+#define MAX_TEX_W	256		// Largest texture addressable by UVs (in texels)
+#define MAX_TEX_H	256
+
+namespace param {
+
+	std::string	outDir;
+	std::string	layoutFileName	= "layout.xml";
+	std::string	headerFileName;
+
+}
+
+typedef struct {
+	std::string				name;
+	std::string				fileName;
+	int						bpp;
+	bool					stp;
+	int						group;		// Index of the CLUT used
+	IMAGE					image;
+	std::vector<uint8_t>	indices;	// 4/8-bit images only
+	RECT					rect;		// Position in VRAM (in VRAM pixels)
+} TEXTURE;
+
+typedef struct {
+	int						bpp;
+	bool					stp;
+	std::vector<int>		members;
+	std::vector<uint16_t>	colors;
+	RECT					rect;
+} CLUT_GROUP;
+
+
+static int VRAMWidth(int width, int bpp) {
+
+	switch(bpp) {
+	case 4:
+		return (width+3)/4;
+	case 8:
+		return (width+1)/2;
+	default:
+		return width;
+	}
+
+}
+
+static int PixelMode(int bpp) {
+
+	return (bpp == 4) ? 0 : (bpp == 8) ? 1 : 2;
+
+}
+
+static RECT ParseRect(tinyxml2::XMLElement* element, const RECT& def) {
+
+	RECT rect = def;
+
+	if (element) {
+		rect.x = element->IntAttribute("x", def.x);
+		rect.y = element->IntAttribute("y", def.y);
+		rect.w = element->IntAttribute("w", def.w);
+		rect.h = element->IntAttribute("h", def.h);
+	}
+
+	return rect;
+
+}
+
+// Parses a texture element, inheriting the color depth and semi-transparency
+// settings from its group (if any)
+static int ParseTexture(tinyxml2::XMLElement* element, int bpp, bool stp, int group, std::vector<TEXTURE>& textures) {
+
+	TEXTURE		tex;
+	const char*	file = element->Attribute("file");
+
+	if (file == NULL) {
+		printf("ERROR: Texture element without a file attribute.\n");
+		return false;
+	}
+
+	tex.fileName	= file;
+	tex.bpp			= element->IntAttribute("bpp", bpp);
+	tex.stp			= element->BoolAttribute("semitrans", stp);
+	tex.group		= group;
+
+	if (element->Attribute("name")) {
+
+		tex.name = element->Attribute("name");
+
+	} else {
+
+		// Default to the file name without its path and extension
+		tex.name = tex.fileName;
+
+		if (tex.name.find_last_of("/\\") != std::string::npos)
+			tex.name.erase(0, tex.name.find_last_of("/\\")+1);
+		if (tex.name.rfind(".") != std::string::npos)
+			tex.name.erase(tex.name.rfind("."));
+
+	}
+
+	if ((tex.bpp != 4) && (tex.bpp != 8) && (tex.bpp != 16)) {
+		printf("ERROR: Invalid color depth %d for texture %s.\n", tex.bpp, tex.name.c_str());
+		return false;
+	}
+
+	if (!LoadPNG(tex.fileName.c_str(), &tex.image))
+		return false;
+
+	if ((tex.image.width > MAX_TEX_W) || (tex.image.height > MAX_TEX_H)) {
+		printf("ERROR: Texture %s is larger than %dx%d.\n", tex.name.c_str(),
+			MAX_TEX_W, MAX_TEX_H);
+		return false;
+	}
+
+	textures.push_back(tex);
+
+	return true;
+
+}
+
+static int ParseProject(tinyxml2::XMLElement* root, std::vector<TEXTURE>& textures,
+	std::vector<CLUT_GROUP>& groups) {
+
+	for(tinyxml2::XMLElement* element = root->FirstChildElement();
+		element != NULL; element = element->NextSiblingElement()) {
+
+		if (strcasecmp(element->Name(), "texture") == 0) {
+
+			if (!ParseTexture(element, 8, false, -1, textures))
+				return false;
+
+		} else if (strcasecmp(element->Name(), "group") == 0) {
+
+			// All textures in a group share the same CLUT
+			CLUT_GROUP	group;
+			int			bpp = element->IntAttribute("bpp", 8);
+			bool		stp = element->BoolAttribute("semitrans", false);
+
+			if ((bpp != 4) && (bpp != 8)) {
+				printf("ERROR: Texture groups must be 4 or 8-bit.\n");
+				return false;
+			}
+
+			group.bpp	= bpp;
+			group.stp	= stp;
+
+			for(tinyxml2::XMLElement* tex = element->FirstChildElement("texture");
+				tex != NULL; tex = tex->NextSiblingElement("texture")) {
+
+				if (!ParseTexture(tex, bpp, stp, groups.size(), textures))
+					return false;
+
+				// Textures in groups can't override the group's settings
+				textures.back().bpp = bpp;
+				textures.back().stp = stp;
+				group.members.push_back(textures.size()-1);
+
+			}
+
+			groups.push_back(group);
+
+		}
+
+	}
+
+	// Give every paletted texture outside a group its own CLUT
+	for(size_t i=0; i<textures.size(); i++) {
+
+		if ((textures[i].group >= 0) || (textures[i].bpp == 16))
+			continue;
+
+		CLUT_GROUP group;
+
+		group.bpp	= textures[i].bpp;
+		group.stp	= textures[i].stp;
+		group.members.push_back(i);
+
+		textures[i].group = groups.size();
+		groups.push_back(group);
+
+	}
+
+	return true;
+
+}
+
+
+// TIM output
+//
+
+static void WriteTIM(FILE* fp, const TEXTURE* tex, const CLUT_GROUP* group) {
+
+	uint32_t	word;
+	uint16_t	rect[4];
+	int			vramWidth = VRAMWidth(tex->image.width, tex->bpp);
+
+	word = 0x10;
+	fwrite(&word, 4, 1, fp);
+
+	word = PixelMode(tex->bpp)|(group ? 0x8 : 0);
+	fwrite(&word, 4, 1, fp);
+
+	if (group) {
+
+		word = 12+group->colors.size()*2;
+		fwrite(&word, 4, 1, fp);
+
+		rect[0] = group->rect.x;
+		rect[1] = group->rect.y;
+		rect[2] = group->colors.size();
+		rect[3] = 1;
+		fwrite(rect, 2, 4, fp);
+		fwrite(group->colors.data(), 2, group->colors.size(), fp);
+
+	}
+
+	word = 12+vramWidth*2*tex->image.height;
+	fwrite(&word, 4, 1, fp);
+
+	rect[0] = tex->rect.x;
+	rect[1] = tex->rect.y;
+	rect[2] = vramWidth;
+	rect[3] = tex->image.height;
+	fwrite(rect, 2, 4, fp);
+
+	// Pixel data, with rows padded to a whole number of VRAM pixels
+	std::vector<uint16_t> row(vramWidth);
+
+	for(int y=0; y<tex->image.height; y++) {
+
+		const int w = tex->image.width;
+
+		std::fill(row.begin(), row.end(), 0);
+
+		for(int x=0; x<w; x++) {
+
+			switch(tex->bpp) {
+			case 4:
+				row[x/4] |= tex->indices[y*w+x]<<((x%4)*4);
+				break;
+			case 8:
+				row[x/2] |= tex->indices[y*w+x]<<((x%2)*8);
+				break;
+			default:
+				row[x] = ToVRAMColor(tex->image.pixels[y*w+x], tex->stp);
+				break;
+			}
+
+		}
+
+		fwrite(row.data(), 2, vramWidth, fp);
+
+	}
+
+}
+
+
+// Layout manifest output
+//
+
+static int GetTPageValue(const TEXTURE* tex) {
+
+	return ((tex->rect.x/TPAGE_X)&0xf)|(((tex->rect.y/256)&1)<<4)|
+		(PixelMode(tex->bpp)<<7);
+
+}
+
+static int GetClutValue(const CLUT_GROUP* group) {
+
+	return ((group->rect.x/16)&0x3f)|((group->rect.y&0x1ff)<<6);
+
+}
+
+static int WriteLayout(const char* fileName, const std::vector<TEXTURE>& textures,
+	const std::vector<CLUT_GROUP>& groups) {
+
+	FILE* fp = fopen(fileName, "w");
+
+	if (fp == NULL) {
+		printf("ERROR: Unable to create layout file: %s\n", fileName);
+		return false;
+	}
+
+	fprintf(fp, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+	fprintf(fp, "<!-- Generated by timpack " VERSION ". x/y/w/h are VRAM coordinates, -->\n");
+	fprintf(fp, "<!-- u/v/tw/th are texture coordinates within the texture page. -->\n");
+	fprintf(fp, "<layout>\n");
+
+	for(const TEXTURE& tex : textures) {
+
+		fprintf(fp, "\t<texture name=\"%s\" file=\"%s%s.tim\" bpp=\"%d\" "
+			"x=\"%d\" y=\"%d\" w=\"%d\" h=\"%d\" u=\"%d\" v=\"%d\" tw=\"%d\" th=\"%d\" "
+			"tpage=\"0x%04x\"",
+			tex.name.c_str(), param::outDir.c_str(), tex.name.c_str(), tex.bpp,
+			tex.rect.x, tex.rect.y, tex.rect.w, tex.rect.h,
+			(tex.rect.x%TPAGE_X)*(16/tex.bpp), tex.rect.y%256,
+			tex.image.width, tex.image.height, GetTPageValue(&tex));
+
+		if (tex.group >= 0) {
+
+			const CLUT_GROUP* group = &groups[tex.group];
+
+			fprintf(fp, " cx=\"%d\" cy=\"%d\" colors=\"%d\" clut=\"0x%04x\"",
+				group->rect.x, group->rect.y, (int)group->colors.size(),
+				GetClutValue(group));
+
+		}
+
+		fprintf(fp, "/>\n");
+
+	}
+
+	fprintf(fp, "</layout>\n");
+	fclose(fp);
+
+	return true;
+
+}
+
+static int WriteHeader(const char* fileName, const std::vector<TEXTURE>& textures,
+	const std::vector<CLUT_GROUP>& groups) {
+
+	FILE* fp = fopen(fileName, "w");
+
+	if (fp == NULL) {
+		printf("ERROR: Unable to create header file: %s\n", fileName);
+		return false;
+	}
+
+	fprintf(fp, "/* Generated by timpack " VERSION ", do not edit */\n\n");
+	fprintf(fp, "#ifndef _TIMPACK_LAYOUT_H\n#define _TIMPACK_LAYOUT_H\n\n");
+
+	for(const TEXTURE& tex : textures) {
+
+		std::string name = tex.name;
+
+		for(char& c : name)
+			c = isalnum((unsigned char)c) ? toupper((unsigned char)c) : '_';
+
+		fprintf(fp, "#define TEX_%s_TPAGE\t0x%04x\n", name.c_str(), GetTPageValue(&tex));
+
+		if (tex.group >= 0)
+			fprintf(fp, "#define TEX_%s_CLUT\t0x%04x\n", name.c_str(), GetClutValue(&groups[tex.group]));
+
+		fprintf(fp, "#define TEX_%s_U\t\t%d\n", name.c_str(), (tex.rect.x%TPAGE_X)*(16/tex.bpp));
+		fprintf(fp, "#define TEX_%s_V\t\t%d\n", name.c_str(), tex.rect.y%256);
+		fprintf(fp, "#define TEX_%s_W\t\t%d\n", name.c_str(), tex.image.width);
+		fprintf(fp, "#define TEX_%s_H\t\t%d\n\n", name.c_str(), tex.image.height);
+
+	}
+
+	fprintf(fp, "#endif\n");
+	fclose(fp);
+
+	return true;
+
+}
+
+
+int main(int argc, const char* argv[]) {
+
+	printf("TIMPACK " VERSION " - Texture Atlas Packer and TIM Generator\n\n");
+
+	if (argc <= 1) {
+
+		printf("Parameters:\n");
+		printf("   timpack [-o <dir>] [-l <layout>] [-h <header>] <project>\n\n");
+		printf("   -o <dir>       - Directory to write TIM files to (created if missing)\n");
+		printf("   -l <layout>    - Layout manifest to generate (default: layout.xml)\n");
+		printf("   -h <header>    - Also generate a C header with texture coordinates\n");
+		printf("   <project>      - XML file listing the textures and VRAM areas to use\n\n");
+		printf("Project file format:\n");
+		printf("   <timpack>\n");
+		printf("      <vram x=\"320\" y=\"0\" w=\"704\" h=\"512\"/>    (area to pack textures into)\n");
+		printf("      <clut x=\"0\" y=\"480\" w=\"320\" h=\"32\"/>     (area for CLUTs, optional)\n");
+		printf("      <texture file=\"a.png\" [name=\"a\"] [bpp=\"4|8|16\"] [semitrans=\"1\"]/>\n");
+		printf("      <group bpp=\"4|8\" [semitrans=\"1\"]>          (textures sharing a CLUT)\n");
+		printf("         <texture file=\"b.png\"/>\n");
+		printf("      </group>\n");
+		printf("   </timpack>\n");
+
+		return EXIT_SUCCESS;
+
+	}
+
+	const char* projectFileName = NULL;
+
+	for(int i=1; i<argc; i++) {
+
+		if ((strcmp(argv[i], "-o") == 0) && (i < argc-1)) {
+
+			param::outDir = argv[++i];
+
+			if ((param::outDir.back() != '/') && (param::outDir.back() != '\\'))
+				param::outDir += "/";
+
+		} else if ((strcmp(argv[i], "-l") == 0) && (i < argc-1)) {
+
+			param::layoutFileName = argv[++i];
+
+		} else if ((strcmp(argv[i], "-h") == 0) && (i < argc-1)) {
+
+			param::headerFileName = argv[++i];
+
+		} else {
+
+			projectFileName = argv[i];
+
+		}
+
+	}
+
+	tinyxml2::XMLDocument project;
+
+	if (project.LoadFile(projectFileName) != tinyxml2::XML_SUCCESS) {
+		printf("ERROR: Unable to load project file:\n");
+		project.PrintError();
+		return EXIT_FAILURE;
+	}
+
+	tinyxml2::XMLElement* root = project.FirstChildElement("timpack");
+
+	if (root == NULL) {
+		printf("ERROR: No timpack element found in project file.\n");
+		return EXIT_FAILURE;
+	}
+
+	std::vector<TEXTURE>	textures;
+	std::vector<CLUT_GROUP>	groups;
+
+	const RECT vramDefault	= { 320, 0, VRAM_W-320, VRAM_H };
+	const RECT noArea		= { 0, 0, 0, 0 };
+	RECT vramArea = ParseRect(root->FirstChildElement("vram"), vramDefault);
+	RECT clutArea = ParseRect(root->FirstChildElement("clut"), noArea);
+
+	if (!ParseProject(root, textures, groups))
+		return EXIT_FAILURE;
+
+	// Quantize each group to a shared CLUT
+	for(CLUT_GROUP& group : groups) {
+
+		std::vector<const IMAGE*>			images;
+		std::vector<std::vector<uint8_t>>	indices;
+
+		for(int i : group.members)
+			images.push_back(&textures[i].image);
+
+		QuantizeImages(images, 1<<group.bpp, group.stp, group.colors, indices);
+
+		for(size_t i=0; i<group.members.size(); i++)
+			textures[group.members[i]].indices = indices[i];
+
+	}
+
+	// Pack textures from tallest to shortest, which gives the skyline packer
+	// the best chance of keeping its skyline flat
+	std::vector<int> order;
+
+	for(size_t i=0; i<textures.size(); i++)
+		order.push_back(i);
+
+	std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+		return textures[a].image.height > textures[b].image.height;
+	});
+
+	SkylinePacker packer(vramArea);
+
+	for(int i : order) {
+
+		TEXTURE*	tex = &textures[i];
+		int			pageWidth = (tex->bpp == 4) ? 64 : (tex->bpp == 8) ? 128 : 256;
+
+		if (!packer.Pack(VRAMWidth(tex->image.width, tex->bpp), tex->image.height,
+			pageWidth, 1, &tex->rect)) {
+			printf("ERROR: Out of VRAM space while packing %s.\n", tex->name.c_str());
+			return EXIT_FAILURE;
+		}
+
+	}
+
+	// CLUTs go in their own area if one was given, aligned to 16 pixels
+	SkylinePacker clutPacker(clutArea.w ? clutArea : vramArea);
+
+	for(CLUT_GROUP& group : groups) {
+
+		SkylinePacker* p = clutArea.w ? &clutPacker : &packer;
+
+		if (!p->Pack(group.colors.size(), 1, 0, 16, &group.rect)) {
+			printf("ERROR: Out of VRAM space while packing CLUTs.\n");
+			return EXIT_FAILURE;
+		}
+
+	}
+
+	// Create the output directory if it doesn't exist yet
+	if (!param::outDir.empty()) {
+
+		std::error_code err;
+		std::filesystem::create_directories(param::outDir, err);
+
+		if (err) {
+			printf("ERROR: Unable to create output directory %s: %s\n",
+				param::outDir.c_str(), err.message().c_str());
+			return EXIT_FAILURE;
+		}
+
+	}
+
+	// Write TIMs
+	int used = 0;
+
+	for(const TEXTURE& tex : textures) {
+
+		std::string fileName = param::outDir+tex.name+".tim";
+		FILE* fp = fopen(fileName.c_str(), "wb");
+
+		if (fp == NULL) {
+			printf("ERROR: Unable to create TIM file: %s\n", fileName.c_str());
+			return EXIT_FAILURE;
+		}
+
+		WriteTIM(fp, &tex, (tex.group >= 0) ? &groups[tex.group] : NULL);
+		fclose(fp);
+
+		printf("   %-16s %2d-bit %3dx%-3d at (%4d,%3d)\n", tex.name.c_str(), tex.bpp,
+			tex.image.width, tex.image.height, tex.rect.x, tex.rect.y);
+
+		used += tex.rect.w*tex.rect.h;
+
+	}
+
+	printf("\n%d texture(s) and %d CLUT(s) packed, %d%% of the texture area used.\n",
+		(int)textures.size(), (int)groups.size(),
+		(int)(100ll*used/(vramArea.w*vramArea.h)));
+
+	if (!WriteLayout(param::layoutFileName.c_str(), textures, groups))
+		return EXIT_FAILURE;
+
+	if (!param::headerFileName.empty() &&
+		!WriteHeader(param::headerFileName.c_str(), textures, groups))
+		return EXIT_FAILURE;
+
+	return EXIT_SUCCESS;
+
+}
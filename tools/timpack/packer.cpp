@@ -0,0 +1,137 @@
+#include <stddef.h>
+#include <limits.h>
+#include "packer.h"
+
+#define TPAGE_X		64
+#define TPAGE_H		256
+
+
+SkylinePacker::SkylinePacker(const RECT& area) {
+
+	NODE node = { area.x, area.y, area.w };
+
+	this->area = area;
+	skyline.push_back(node);
+
+}
+
+// Returns the Y coordinate a rectangle would be placed at if its left edge was
+// at x (which lies within the given node), or -1 if it doesn't fit there.
+int SkylinePacker::FitAt(int index, int x, int w, int h, int pageWidth, int align) const {
+
+	if ((x%align) || ((x+w) > (area.x+area.w)))
+		return -1;
+
+	if (pageWidth && (((x/TPAGE_X)*TPAGE_X+pageWidth) < (x+w)))
+		return -1;
+
+	// Find the highest point of the skyline below the rectangle
+	int y = 0;
+
+	for(size_t i=index; (i<skyline.size()) && (skyline[i].x<(x+w)); i++) {
+		if (skyline[i].y > y)
+			y = skyline[i].y;
+	}
+
+	// Move the rectangle to the next page if it would cross a page boundary
+	if (pageWidth && ((y/TPAGE_H) != ((y+h-1)/TPAGE_H)))
+		y = ((y/TPAGE_H)+1)*TPAGE_H;
+
+	if ((y+h) > (area.y+area.h))
+		return -1;
+
+	return y;
+
+}
+
+void SkylinePacker::Insert(int x, int y, int w, int h) {
+
+	std::vector<NODE>	result;
+	NODE				node = { x, y+h, w };
+
+	// Keep the parts of the skyline to the left and right of the new node
+	for(const NODE& n : skyline) {
+
+		if ((n.x+n.w) <= x) {
+			result.push_back(n);
+		} else if (n.x < x) {
+			NODE left = { n.x, n.y, x-n.x };
+			result.push_back(left);
+		}
+
+	}
+
+	result.push_back(node);
+
+	for(const NODE& n : skyline) {
+
+		if (n.x >= (x+w)) {
+			result.push_back(n);
+		} else if ((n.x+n.w) > (x+w)) {
+			NODE right = { x+w, n.y, n.x+n.w-(x+w) };
+			result.push_back(right);
+		}
+
+	}
+
+	// Merge neighboring nodes at the same height
+	skyline.clear();
+
+	for(const NODE& n : result) {
+
+		if (skyline.size() && (skyline.back().y == n.y))
+			skyline.back().w += n.w;
+		else
+			skyline.push_back(n);
+
+	}
+
+}
+
+bool SkylinePacker::Pack(int w, int h, int pageWidth, int align, RECT* rect) {
+
+	int bestY = INT_MAX, bestX = 0, bestIndex = -1;
+
+	if (align < 1)
+		align = 1;
+
+	// Try the left edge of each node as well as the aligned and page
+	// boundary positions within it
+	for(size_t i=0; i<skyline.size(); i++) {
+
+		int start	= skyline[i].x;
+		int end		= skyline[i].x+skyline[i].w;
+
+		for(int x=((start+align-1)/align)*align; x<end;) {
+
+			int y = FitAt(i, x, w, h, pageWidth, align);
+
+			if ((y >= 0) && (y < bestY)) {
+				bestY		= y;
+				bestX		= x;
+				bestIndex	= i;
+			}
+
+			// Only the first aligned position and page boundaries matter,
+			// as the skyline is flat within a node
+			int next = ((x/TPAGE_X)+1)*TPAGE_X;
+
+			x = ((next+align-1)/align)*align;
+
+		}
+
+	}
+
+	if (bestIndex < 0)
+		return false;
+
+	rect->x = bestX;
+	rect->y = bestY;
+	rect->w = w;
+	rect->h = h;
+
+	Insert(bestX, bestY, w, h);
+
+	return true;
+
+}
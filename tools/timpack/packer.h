@@ -0,0 +1,38 @@
+#ifndef _PACKER_H
+#define _PACKER_H
+
+#include <vector>
+
+typedef struct {
+	int x,y,w,h;
+} RECT;
+
+// Skyline bottom-left packer for a rectangular area of VRAM. Rectangles can
+// optionally be kept from crossing texture page boundaries, so that they can
+// be addressed through a single tpage.
+class SkylinePacker {
+
+	typedef struct {
+		int x,y,w;
+	} NODE;
+
+	RECT				area;
+	std::vector<NODE>	skyline;
+
+	int		FitAt(int index, int x, int w, int h, int pageWidth, int align) const;
+	void	Insert(int x, int y, int w, int h);
+
+public:
+
+	SkylinePacker(const RECT& area);
+
+	// Finds a spot for a w*h rectangle (in VRAM pixels) whose X coordinate is
+	// a multiple of align. If pageWidth is non-zero, the rectangle is kept
+	// within a single pageWidth pixels wide texture page starting at a 64
+	// pixel boundary and within a 256 line page. Returns false if it doesn't
+	// fit anywhere.
+	bool	Pack(int w, int h, int pageWidth, int align, RECT* rect);
+
+};
+
+#endif // _PACKER_H
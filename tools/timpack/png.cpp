@@ -0,0 +1,493 @@
+#include <stdio.h>
+#include <string.h>
+#include "png.h"
+
+// Minimal PNG decoder, implemented here (inflate included) to keep the tools
+// free of external dependencies other than tinyxml2
+
+
+// Inflate (RFC 1951)
+//
+
+typedef struct {
+	const uint8_t*	data;
+	size_t			size;
+	size_t			pos;
+	uint32_t		bits;
+	int				count;
+} BITREADER;
+
+typedef struct {
+	uint16_t		counts[16];		// Number of codes of each length
+	uint16_t		symbols[320];	// Symbols sorted by code
+} HUFFMAN;
+
+static int GetBits(BITREADER* in, int n) {
+
+	while(in->count < n) {
+
+		if (in->pos >= in->size)
+			return -1;
+
+		in->bits |= (uint32_t)in->data[in->pos++]<<in->count;
+		in->count += 8;
+
+	}
+
+	int value = in->bits&((1<<n)-1);
+
+	in->bits >>= n;
+	in->count -= n;
+
+	return value;
+
+}
+
+static void BuildHuffman(HUFFMAN* h, const uint8_t* lengths, int num) {
+
+	uint16_t offsets[16];
+
+	memset(h->counts, 0, sizeof(h->counts));
+
+	for(int i=0; i<num; i++)
+		h->counts[lengths[i]]++;
+
+	h->counts[0] = 0;
+	offsets[1] = 0;
+
+	for(int i=1; i<15; i++)
+		offsets[i+1] = offsets[i]+h->counts[i];
+
+	for(int i=0; i<num; i++) {
+		if (lengths[i])
+			h->symbols[offsets[lengths[i]]++] = i;
+	}
+
+}
+
+// Decodes a symbol by walking the canonical code one bit at a time
+static int DecodeSymbol(BITREADER* in, const HUFFMAN* h) {
+
+	int code = 0, first = 0, index = 0;
+
+	for(int len=1; len<16; len++) {
+
+		int bit = GetBits(in, 1);
+
+		if (bit < 0)
+			return -1;
+
+		code |= bit;
+
+		int count = h->counts[len];
+
+		if ((code-first) < count)
+			return h->symbols[index+(code-first)];
+
+		index += count;
+		first = (first+count)<<1;
+		code <<= 1;
+
+	}
+
+	return -1;
+
+}
+
+static const uint16_t lengthBase[29] = {
+	3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+	35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t lengthExtra[29] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+	3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t distBase[30] = {
+	1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+	257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+static const uint8_t distExtra[30] = {
+	0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+	7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+static int InflateBlock(BITREADER* in, std::vector<uint8_t>& out, const HUFFMAN* lit, const HUFFMAN* dist) {
+
+	for(;;) {
+
+		int sym = DecodeSymbol(in, lit);
+
+		if (sym < 0)
+			return false;
+
+		if (sym < 256) {
+
+			out.push_back(sym);
+
+		} else if (sym == 256) {
+
+			return true;
+
+		} else {
+
+			sym -= 257;
+
+			if (sym >= 29)
+				return false;
+
+			int len = lengthBase[sym]+GetBits(in, lengthExtra[sym]);
+			int d = DecodeSymbol(in, dist);
+
+			if ((d < 0) || (d >= 30))
+				return false;
+
+			size_t offset = distBase[d]+GetBits(in, distExtra[d]);
+
+			if (offset > out.size())
+				return false;
+
+			for(int i=0; i<len; i++)
+				out.push_back(out[out.size()-offset]);
+
+		}
+
+	}
+
+}
+
+static int Inflate(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+
+	BITREADER	in = { data, size, 0, 0, 0 };
+	HUFFMAN		lit, dist;
+	uint8_t		lengths[320];
+	int			last;
+
+	do {
+
+		last = GetBits(&in, 1);
+
+		switch(GetBits(&in, 2)) {
+		case 0:		// Stored
+			{
+				in.bits = 0;
+				in.count = 0;
+
+				if ((in.pos+4) > in.size)
+					return false;
+
+				int len = in.data[in.pos]|(in.data[in.pos+1]<<8);
+
+				in.pos += 4;
+
+				if ((in.pos+len) > in.size)
+					return false;
+
+				out.insert(out.end(), &in.data[in.pos], &in.data[in.pos+len]);
+				in.pos += len;
+			}
+			break;
+
+		case 1:		// Fixed Huffman codes
+			for(int i=0; i<288; i++)
+				lengths[i] = (i < 144) ? 8 : (i < 256) ? 9 : (i < 280) ? 7 : 8;
+			BuildHuffman(&lit, lengths, 288);
+
+			for(int i=0; i<30; i++)
+				lengths[i] = 5;
+			BuildHuffman(&dist, lengths, 30);
+
+			if (!InflateBlock(&in, out, &lit, &dist))
+				return false;
+			break;
+
+		case 2:		// Dynamic Huffman codes
+			{
+				static const uint8_t order[19] = {
+					16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+				};
+
+				int		numLit	= GetBits(&in, 5)+257;
+				int		numDist	= GetBits(&in, 5)+1;
+				int		numCode	= GetBits(&in, 4)+4;
+				HUFFMAN	code;
+
+				memset(lengths, 0, sizeof(lengths));
+
+				for(int i=0; i<numCode; i++)
+					lengths[order[i]] = GetBits(&in, 3);
+
+				BuildHuffman(&code, lengths, 19);
+				memset(lengths, 0, sizeof(lengths));
+
+				for(int i=0; i<(numLit+numDist);) {
+
+					int sym = DecodeSymbol(&in, &code);
+					int rep = 0, value = 0;
+
+					if (sym < 0)
+						return false;
+
+					if (sym < 16) {
+						lengths[i++] = sym;
+						continue;
+					} else if (sym == 16) {
+						if (i == 0)
+							return false;
+						value = lengths[i-1];
+						rep = 3+GetBits(&in, 2);
+					} else if (sym == 17) {
+						rep = 3+GetBits(&in, 3);
+					} else {
+						rep = 11+GetBits(&in, 7);
+					}
+
+					if ((i+rep) > (numLit+numDist))
+						return false;
+
+					while(rep--)
+						lengths[i++] = value;
+
+				}
+
+				BuildHuffman(&lit, lengths, numLit);
+				BuildHuffman(&dist, lengths+numLit, numDist);
+
+				if (!InflateBlock(&in, out, &lit, &dist))
+					return false;
+			}
+			break;
+
+		default:
+			return false;
+		}
+
+	} while(!last);
+
+	return true;
+
+}
+
+
+// PNG decoding
+//
+
+static uint32_t GetBE32(const uint8_t* ptr) {
+
+	return (ptr[0]<<24)|(ptr[1]<<16)|(ptr[2]<<8)|ptr[3];
+
+}
+
+static int Paeth(int a, int b, int c) {
+
+	int p = a+b-c;
+	int pa = (p > a) ? p-a : a-p;
+	int pb = (p > b) ? p-b : b-p;
+	int pc = (p > c) ? p-c : c-p;
+
+	if ((pa <= pb) && (pa <= pc))
+		return a;
+
+	return (pb <= pc) ? b : c;
+
+}
+
+int LoadPNG(const char* fileName, IMAGE* image) {
+
+	static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+
+	FILE*					fp = fopen(fileName, "rb");
+	std::vector<uint8_t>	file, idat, raw;
+	uint32_t				palette[256];
+	int						depth = 0, colorType = 0, interlace = 0;
+	int						trnsKey[3] = { -1, -1, -1 };
+
+	if (fp == NULL) {
+		printf("ERROR: Unable to open image file: %s\n", fileName);
+		return false;
+	}
+
+	fseek(fp, 0, SEEK_END);
+	file.resize(ftell(fp));
+	fseek(fp, 0, SEEK_SET);
+
+	if (fread(file.data(), 1, file.size(), fp) != file.size())
+		file.clear();
+
+	fclose(fp);
+
+	if ((file.size() < 8) || memcmp(file.data(), signature, 8)) {
+		printf("ERROR: Not a PNG file: %s\n", fileName);
+		return false;
+	}
+
+	for(int i=0; i<256; i++)
+		palette[i] = 0xff000000;
+
+	// Go through the chunks, collecting the compressed image data
+	for(size_t pos=8; (pos+12)<=file.size();) {
+
+		uint32_t		len = GetBE32(&file[pos]);
+		const uint8_t*	type = &file[pos+4];
+		const uint8_t*	data = &file[pos+8];
+
+		if ((pos+12+len) > file.size())
+			break;
+
+		if (!memcmp(type, "IHDR", 4)) {
+
+			image->width	= GetBE32(data);
+			image->height	= GetBE32(data+4);
+			depth			= data[8];
+			colorType		= data[9];
+			interlace		= data[12];
+
+		} else if (!memcmp(type, "PLTE", 4)) {
+
+			for(uint32_t i=0; (i<len/3) && (i<256); i++)
+				palette[i] = data[i*3]|(data[i*3+1]<<8)|(data[i*3+2]<<16)|0xff000000;
+
+		} else if (!memcmp(type, "tRNS", 4)) {
+
+			if (colorType == 3) {
+				for(uint32_t i=0; (i<len) && (i<256); i++)
+					palette[i] = (palette[i]&0xffffff)|(data[i]<<24);
+			} else if (colorType == 0) {
+				trnsKey[0] = trnsKey[1] = trnsKey[2] = (data[0]<<8)|data[1];
+			} else if (colorType == 2) {
+				for(int i=0; i<3; i++)
+					trnsKey[i] = (data[i*2]<<8)|data[i*2+1];
+			}
+
+		} else if (!memcmp(type, "IDAT", 4)) {
+
+			idat.insert(idat.end(), data, data+len);
+
+		} else if (!memcmp(type, "IEND", 4)) {
+
+			break;
+
+		}
+
+		pos += 12+len;
+
+	}
+
+	if (interlace) {
+		printf("ERROR: Interlaced PNG files are not supported: %s\n", fileName);
+		return false;
+	}
+
+	int channels;
+
+	switch(colorType) {
+	case 0: channels = 1; break;	// Grayscale
+	case 2: channels = 3; break;	// RGB
+	case 3: channels = 1; break;	// Indexed
+	case 4: channels = 2; break;	// Grayscale + alpha
+	case 6: channels = 4; break;	// RGBA
+	default:
+		printf("ERROR: Unsupported PNG color type %d: %s\n", colorType, fileName);
+		return false;
+	}
+
+	// Skip the 2-byte zlib header and inflate the data
+	if ((idat.size() < 2) || !Inflate(idat.data()+2, idat.size()-2, raw)) {
+		printf("ERROR: Corrupted PNG file: %s\n", fileName);
+		return false;
+	}
+
+	int bpp		= (channels*depth+7)/8;				// Bytes per pixel (at least 1)
+	int stride	= (image->width*channels*depth+7)/8;
+
+	if (raw.size() < (size_t)(stride+1)*image->height) {
+		printf("ERROR: Truncated PNG file: %s\n", fileName);
+		return false;
+	}
+
+	// Undo the row filters in place
+	for(int y=0; y<image->height; y++) {
+
+		uint8_t*		row = &raw[y*(stride+1)+1];
+		const uint8_t*	prev = y ? &raw[(y-1)*(stride+1)+1] : NULL;
+		int				filter = row[-1];
+
+		for(int x=0; x<stride; x++) {
+
+			int a = (x >= bpp) ? row[x-bpp] : 0;
+			int b = prev ? prev[x] : 0;
+			int c = (prev && (x >= bpp)) ? prev[x-bpp] : 0;
+
+			switch(filter) {
+			case 1: row[x] += a; break;
+			case 2: row[x] += b; break;
+			case 3: row[x] += (a+b)/2; break;
+			case 4: row[x] += Paeth(a, b, c); break;
+			}
+
+		}
+
+	}
+
+	// Convert to RGBA
+	image->pixels.resize(image->width*image->height);
+
+	for(int y=0; y<image->height; y++) {
+
+		const uint8_t* row = &raw[y*(stride+1)+1];
+
+		for(int x=0; x<image->width; x++) {
+
+			int sample[4];
+
+			for(int c=0; c<channels; c++) {
+
+				if (depth == 16) {
+
+					int i = (x*channels+c)*2;
+					sample[c] = (row[i]<<8)|row[i+1];
+
+				} else {
+
+					int bit = (x*channels+c)*depth;
+					sample[c] = (row[bit/8]>>(8-depth-(bit%8)))&((1<<depth)-1);
+
+				}
+
+			}
+
+			uint32_t	pixel;
+			int			max = (1<<depth)-1;
+			bool		keyed = (trnsKey[0] == sample[0]);
+
+			switch(colorType) {
+			case 0:
+				sample[0] = sample[0]*255/max;
+				pixel = sample[0]|(sample[0]<<8)|(sample[0]<<16)|(keyed ? 0 : 0xff000000);
+				break;
+			case 2:
+				keyed = keyed && (trnsKey[1] == sample[1]) && (trnsKey[2] == sample[2]);
+				pixel = (sample[0]*255/max)|((sample[1]*255/max)<<8)|
+					((sample[2]*255/max)<<16)|(keyed ? 0 : 0xff000000);
+				break;
+			case 3:
+				pixel = palette[sample[0]];
+				break;
+			case 4:
+				sample[0] = sample[0]*255/max;
+				pixel = sample[0]|(sample[0]<<8)|(sample[0]<<16)|((sample[1]*255/max)<<24);
+				break;
+			default:
+				pixel = (sample[0]*255/max)|((sample[1]*255/max)<<8)|
+					((sample[2]*255/max)<<16)|((uint32_t)(sample[3]*255/max)<<24);
+				break;
+			}
+
+			image->pixels[y*image->width+x] = pixel;
+
+		}
+
+	}
+
+	return true;
+
+}
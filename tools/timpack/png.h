@@ -0,0 +1,17 @@
+#ifndef _PNG_H
+#define _PNG_H
+
+#include <stdint.h>
+#include <vector>
+
+typedef struct {
+	int						width;
+	int						height;
+	std::vector<uint32_t>	pixels;		// RGBA, red in the lowest byte
+} IMAGE;
+
+// Loads a non-interlaced PNG file of any color type and converts it to RGBA
+// (16-bit channels are reduced to 8 bits)
+int LoadPNG(const char* fileName, IMAGE* image);
+
+#endif // _PNG_H
@@ -0,0 +1,244 @@
+#include <string.h>
+#include <algorithm>
+#include "quantize.h"
+
+typedef struct {
+	uint16_t	color;
+	uint32_t	count;
+} HIST_ENTRY;
+
+typedef struct {
+	int			first,last;		// Range of histogram entries
+	int			axis;			// Channel with the largest range
+	int			range;
+} COLOR_BOX;
+
+static int Channel(uint16_t color, int axis) {
+
+	return (color>>(axis*5))&31;
+
+}
+
+uint16_t ToVRAMColor(uint32_t rgba, bool stp) {
+
+	if ((rgba>>24) < 128)
+		return 0x0000;
+
+	uint16_t color = ((rgba>>3)&31)|(((rgba>>11)&31)<<5)|(((rgba>>19)&31)<<10);
+
+	if (stp || (color == 0))
+		color |= 0x8000;
+
+	return color;
+
+}
+
+static void ShrinkBox(COLOR_BOX* box, const std::vector<HIST_ENTRY>& hist) {
+
+	int min[3] = { 31, 31, 31 }, max[3] = { 0, 0, 0 };
+
+	for(int i=box->first; i<=box->last; i++) {
+
+		for(int c=0; c<3; c++) {
+			min[c] = std::min(min[c], Channel(hist[i].color, c));
+			max[c] = std::max(max[c], Channel(hist[i].color, c));
+		}
+
+	}
+
+	box->axis	= 0;
+	box->range	= -1;
+
+	for(int c=0; c<3; c++) {
+
+		if ((max[c]-min[c]) > box->range) {
+			box->axis	= c;
+			box->range	= max[c]-min[c];
+		}
+
+	}
+
+}
+
+void QuantizeImages(const std::vector<const IMAGE*>& images, int numColors, bool stp,
+	std::vector<uint16_t>& clut, std::vector<std::vector<uint8_t>>& indices) {
+
+	std::vector<uint32_t>	counts(0x10000, 0);
+	std::vector<HIST_ENTRY>	hist;
+	std::vector<COLOR_BOX>	boxes;
+	bool					transparent = false;
+
+	// Build a histogram of all colors (ignoring the STP bit)
+	for(const IMAGE* image : images) {
+
+		for(uint32_t pixel : image->pixels) {
+
+			uint16_t color = ToVRAMColor(pixel, stp);
+
+			if (color == 0)
+				transparent = true;
+			else
+				counts[color&0x7fff]++;
+
+		}
+
+	}
+
+	for(int i=0; i<0x8000; i++) {
+
+		if (counts[i]) {
+			HIST_ENTRY entry = { (uint16_t)i, counts[i] };
+			hist.push_back(entry);
+		}
+
+	}
+
+	int available = numColors-(transparent ? 1 : 0);
+
+	clut.clear();
+
+	if (transparent)
+		clut.push_back(0x0000);
+
+	if ((int)hist.size() <= available) {
+
+		// Few enough colors to use them as they are
+		for(const HIST_ENTRY& entry : hist)
+			clut.push_back(entry.color);
+
+	} else {
+
+		// Median cut: keep splitting the box with the widest channel range
+		// at the weighted median along that channel
+		COLOR_BOX box = { 0, (int)hist.size()-1, 0, 0 };
+
+		ShrinkBox(&box, hist);
+		boxes.push_back(box);
+
+		while((int)boxes.size() < available) {
+
+			int best = -1;
+
+			for(size_t i=0; i<boxes.size(); i++) {
+
+				if ((boxes[i].first < boxes[i].last) &&
+					((best < 0) || (boxes[i].range > boxes[best].range)))
+					best = i;
+
+			}
+
+			if (best < 0)
+				break;
+
+			COLOR_BOX*	split = &boxes[best];
+			int			axis = split->axis;
+			uint64_t	total = 0, sum = 0;
+			int			mid;
+
+			std::sort(hist.begin()+split->first, hist.begin()+split->last+1,
+				[axis](const HIST_ENTRY& a, const HIST_ENTRY& b) {
+					return Channel(a.color, axis) < Channel(b.color, axis);
+				});
+
+			for(int i=split->first; i<=split->last; i++)
+				total += hist[i].count;
+
+			for(mid=split->first; mid<(split->last-1); mid++) {
+
+				sum += hist[mid].count;
+
+				if ((sum*2) >= total)
+					break;
+
+			}
+
+			COLOR_BOX upper = { mid+1, split->last, 0, 0 };
+
+			split->last = mid;
+
+			ShrinkBox(split, hist);
+			ShrinkBox(&upper, hist);
+			boxes.push_back(upper);
+
+		}
+
+		// Use the weighted average of each box
+		for(const COLOR_BOX& b : boxes) {
+
+			uint64_t sum[3] = { 0, 0, 0 }, total = 0;
+
+			for(int i=b.first; i<=b.last; i++) {
+
+				for(int c=0; c<3; c++)
+					sum[c] += (uint64_t)Channel(hist[i].color, c)*hist[i].count;
+
+				total += hist[i].count;
+
+			}
+
+			uint16_t color = 0;
+
+			for(int c=0; c<3; c++)
+				color |= ((sum[c]+total/2)/total)<<(c*5);
+
+			clut.push_back(color);
+
+		}
+
+	}
+
+	// Opaque colors can't be 0x0000, and have the STP bit set if requested
+	for(size_t i=(transparent ? 1 : 0); i<clut.size(); i++) {
+
+		if (stp || (clut[i] == 0))
+			clut[i] |= 0x8000;
+
+	}
+
+	// Map every color to its closest CLUT entry
+	std::vector<uint8_t> map(0x8000, 0);
+
+	for(const HIST_ENTRY& entry : hist) {
+
+		int bestDist = 0x7fffffff;
+
+		for(size_t i=(transparent ? 1 : 0); i<clut.size(); i++) {
+
+			int dist = 0;
+
+			for(int c=0; c<3; c++) {
+				int d = Channel(entry.color, c)-Channel(clut[i], c);
+				dist += d*d;
+			}
+
+			if (dist < bestDist) {
+				bestDist = dist;
+				map[entry.color] = i;
+			}
+
+		}
+
+	}
+
+	while((int)clut.size() < numColors)
+		clut.push_back(0x0000);
+
+	indices.clear();
+
+	for(const IMAGE* image : images) {
+
+		std::vector<uint8_t> out(image->pixels.size());
+
+		for(size_t i=0; i<image->pixels.size(); i++) {
+
+			uint16_t color = ToVRAMColor(image->pixels[i], stp);
+
+			out[i] = color ? map[color&0x7fff] : 0;
+
+		}
+
+		indices.push_back(out);
+
+	}
+
+}
@@ -0,0 +1,20 @@
+#ifndef _QUANTIZE_H
+#define _QUANTIZE_H
+
+#include <stdint.h>
+#include <vector>
+#include "png.h"
+
+// Converts an RGBA pixel to a 15-bit VRAM color. Pixels with an alpha below
+// 128 become 0x0000 (transparent), while opaque colors that would otherwise
+// end up as 0x0000 get the STP bit set so they're drawn as black. If stp is
+// true, the STP bit is set on all opaque colors (semi-transparent textures).
+uint16_t ToVRAMColor(uint32_t rgba, bool stp);
+
+// Builds a single CLUT of at most numColors entries for all given images
+// using median cut, and converts each image to indices into it. Index 0 is
+// reserved for transparent pixels if any image has them.
+void QuantizeImages(const std::vector<const IMAGE*>& images, int numColors, bool stp,
+	std::vector<uint16_t>& clut, std::vector<std::vector<uint8_t>>& indices);
+
+#endif // _QUANTIZE_H
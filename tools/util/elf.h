@@ -40,6 +40,19 @@ typedef struct {
 	unsigned int alignment;
 } PRG_HEADER;
 
+typedef struct {
+	unsigned int sh_name;
+	unsigned int sh_type;
+	unsigned int sh_flags;
+	unsigned int sh_addr;
+	unsigned int sh_offset;
+	unsigned int sh_size;
+	unsigned int sh_link;
+	unsigned int sh_info;
+	unsigned int sh_addralign;
+	unsigned int sh_entsize;
+} SEC_HEADER;
+
 #pragma pack(pop)
 
 #endif /* _ELF_H */
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <lzp.h>
 #include "elf.h"
 
 #ifdef WIN32
@@ -11,6 +12,8 @@
 #endif
 
 #define	MAX_prg_entry_count	128
+#define MAX_overlay_count	64
+#define OVERLAY_PREFIX		".overlay."
 #define	true	(1)
 #define	false	(0)
 
@@ -32,6 +35,14 @@ typedef struct {
 	unsigned int base;
 } EXEC;
 
+// Static overlay, extracted from a .overlay.<name> section (see exe.ld)
+typedef struct {
+	char name[64];
+	unsigned int offset;
+	unsigned int size;
+	unsigned char *data;
+} OVERLAY;
+
 typedef struct {
 	char header[8];
 	char pad[8];
@@ -40,18 +51,365 @@ typedef struct {
 	char pad2[1908];
 } PSEXE;
 
+// Decompression stub for compressed executables, assembled from elf2x_stub.s.
+// It is preceded in the executable by a parameter block (see pack_binary()).
+static const unsigned int stub_code[] = {
+	0x03e0c825, 0x04110001, 0x00000000, 0x8fe8ffe4, 0x8fe9ffe8, 0x8feaffec,
+	0x8ff8fff0, 0x240f000f, 0x240e00ff, 0x25080001, 0x0109082b, 0x10200045,
+	0x00000000, 0x910b0000, 0x25080001, 0x000b6102, 0x158f0005, 0x00000000,
+	0x910d0000, 0x25080001, 0x11aefffd, 0x018d6021, 0x2d810004, 0x1420000a,
+	0x00000000, 0x890d0003, 0x990d0000, 0x258cfffc, 0xa94d0003, 0xb94d0000,
+	0x25080004, 0x2d810004, 0x1020fff8, 0x254a0004, 0x11800007, 0x00000000,
+	0x910d0000, 0x25080001, 0x258cffff, 0xa14d0000, 0x1580fffb, 0x254a0001,
+	0x0109082b, 0x10200025, 0x00000000, 0x910c0000, 0x910d0001, 0x25080002,
+	0x000d6a00, 0x018d6025, 0x014c6023, 0x316b000f, 0x156f0005, 0x00000000,
+	0x910d0000, 0x25080001, 0x11aefffd, 0x016d5821, 0x014c6823, 0x2da10004,
+	0x1420000c, 0x256b0004, 0x898d0003, 0x998d0000, 0x256bfffc, 0xa94d0003,
+	0xb94d0000, 0x258c0004, 0x2d610004, 0x1020fff8, 0x254a0004, 0x1160ffc2,
+	0x00000000, 0x918d0000, 0x258c0001, 0x256bffff, 0xa14d0000, 0x1560fffb,
+	0x254a0001, 0x1000ffba, 0x00000000, 0x27bdfff0, 0xafa40000, 0xafa50004,
+	0xafb80008, 0xafb9000c, 0x240a00a0, 0x0140f809, 0x24090044, 0x8fa40000,
+	0x8fa50004, 0x8fb80008, 0x8fbf000c, 0x03000008, 0x27bd0010
+};
+
+#define STUB_PARAMS_SIZE	16
+#define STUB_SIZE			(STUB_PARAMS_SIZE+sizeof(stub_code))
+
+// Timings used for the boot time estimates printed when compressing. The BIOS
+// reads executables at double speed (150 sectors per second), while the stub's
+// run time is estimated from the number of instructions it executes, plus a
+// stall of a few cycles for each load from main RAM (unaligned word copies
+// take two loads, lwl and lwr).
+#define CPU_CLOCK			33868800
+#define SECTORS_PER_SEC		150
+#define RAM_LOAD_STALL		5
+
+static void put_word(unsigned char *ptr, unsigned int value) {
+
+	ptr[0] = value;
+	ptr[1] = value>>8;
+	ptr[2] = value>>16;
+	ptr[3] = value>>24;
+
+}
+
+// Reads a length extension of the fast LZ format, adding it to len. Returns the
+// number of bytes read.
+static int read_length(const unsigned char *in, int *len) {
+
+	int c, count = 0;
+
+	do {
+		c = in[count++];
+		*len += c;
+	} while( c == 255 );
+
+	return count;
+
+}
+
+// Walks a stream compressed with lzCompressFast() the same way the stub does,
+// returning the largest amount of bytes the output ever gets ahead of the input
+// and the estimated number of CPU cycles the stub takes to decompress it.
+static int scan_stream(const unsigned char *in, int size, unsigned int *cycles) {
+
+	int pos = 1, out = 0, lead = 0, token, len, ext, offset;
+	int insns = 0, loads = 0;
+
+	while( pos < size ) {
+
+		token = in[pos++];
+		insns += 8;
+		loads++;
+
+		// Literals, copied a word at a time, then a byte at a time
+		len = token>>4;
+		if( len == 15 ) {
+			ext = read_length(&in[pos], &len);
+			pos += ext;
+			insns += 4*ext;
+			loads += ext;
+		}
+
+		pos += len;
+		out += len;
+		insns += 5+9*(len/4)+6*(len%4);
+		loads += 2*(len/4)+(len%4);
+
+		if( (out-pos) > lead )
+			lead = out-pos;
+
+		if( pos >= size ) {
+			insns += 3;
+			break;
+		}
+
+		// Matches are written after the offset and length have been read
+		offset = in[pos]|(in[pos+1]<<8);
+		pos += 2;
+		insns += 16;
+		loads += 2;
+
+		len = token&15;
+		if( len == 15 ) {
+			ext = read_length(&in[pos], &len);
+			pos += ext;
+			insns += 4*ext;
+			loads += ext;
+		}
+
+		len += 4;
+
+		// Overlapping matches (offset<4) are copied a byte at a time
+		if( offset < 4 ) {
+			insns += 6*len+2;
+			loads += len;
+		} else {
+			insns += 9*(len/4)+2+((len%4) ? (6*(len%4)+2) : 0);
+			loads += 2*(len/4)+(len%4);
+		}
+
+		out += len;
+
+		if( (out-pos) > lead )
+			lead = out-pos;
+
+	}
+
+	*cycles = insns+RAM_LOAD_STALL*loads;
+
+	return lead;
+
+}
+
+// Compresses the program and turns it into a self-extracting one. The
+// compressed data is loaded past the program's load address by the largest
+// amount the output ever gets ahead of the input, so the stub can decompress it
+// in-place, and is followed by the stub. Updates the load address, size and
+// entry point to those of the new executable. Returns NULL if memory could
+// not be allocated.
+static unsigned char *pack_binary(
+	unsigned char *binary, unsigned int *addr, unsigned int *size,
+	unsigned int *entry, int quiet
+) {
+
+	unsigned char	*comp, *packed, *stub;
+	unsigned int	comp_addr, stub_addr, packed_size, end, cycles;
+	int				comp_size, lead, i;
+
+	comp		= (unsigned char*)malloc( LZP_FAST_BOUND(*size) );
+	if( !comp ) {
+		printf( "Out of memory while compressing executable.\n" );
+		return NULL;
+	}
+
+	comp_size	= lzCompressFast( comp, binary, *size, LZP_COMPRESS_MAX );
+	if( comp_size < 0 ) {
+		printf( "Out of memory while compressing executable.\n" );
+		free( comp );
+		return NULL;
+	}
+
+	lead = scan_stream( comp, comp_size, &cycles );
+	if( lead < 0 )
+		lead = 0;
+
+	comp_addr	= *addr + ((lead + 3) & ~3);
+	stub_addr	= (comp_addr + comp_size + 3) & ~3;
+	end			= stub_addr + STUB_SIZE;
+	packed_size	= (((end - comp_addr) + 2047) / 2048) * 2048;
+
+	packed = (unsigned char*)malloc( packed_size );
+	memset( packed, 0x0, packed_size );
+	memcpy( packed, comp, comp_size );
+
+	stub = &packed[stub_addr - comp_addr];
+
+	put_word( &stub[0],  comp_addr );
+	put_word( &stub[4],  comp_addr + comp_size );
+	put_word( &stub[8],  *addr );
+	put_word( &stub[12], *entry );
+
+	for( i=0; i<(int)(sizeof(stub_code)/4); i++ )
+		put_word( &stub[STUB_PARAMS_SIZE + i*4], stub_code[i] );
+
+	if( !quiet ) {
+		printf(
+			"compressed: t_addr:%08x t_size:%d (%d%%) stub:%08x\n",
+			comp_addr,
+			packed_size,
+			(int)(((long long) packed_size * 100) / *size),
+			stub_addr + STUB_PARAMS_SIZE
+		);
+
+		// Sector counts include the 2 KB header
+		printf(
+			"boot time: %d -> %d sectors, est. %d -> %d ms read + %d ms decompression\n",
+			(*size / 2048) + 1,
+			(packed_size / 2048) + 1,
+			((*size / 2048) + 1) * 1000 / SECTORS_PER_SEC,
+			((packed_size / 2048) + 1) * 1000 / SECTORS_PER_SEC,
+			(int)(((long long) cycles * 1000) / CPU_CLOCK)
+		);
+	}
+
+	// Leave some room for the stack, which the BIOS places at the end of RAM
+	if( (end & 0x1fffffff) > 0x1ff000 )
+		printf("WARNING: compressed executable overlaps the stack!\n");
+
+	free( comp );
+	free( binary );
+
+	*addr	= comp_addr;
+	*size	= packed_size;
+	*entry	= stub_addr + STUB_PARAMS_SIZE;
+
+	return packed;
+
+}
+
+// Finds all static overlay sections and loads their contents. Returns the
+// number of overlays found.
+static int load_overlays(FILE *fp, const ELF_HEADER *head, OVERLAY *overlays) {
+
+	SEC_HEADER	sec, names;
+	char		name[64];
+	int			prefix_len = strlen(OVERLAY_PREFIX);
+	int			i, count = 0;
+
+	if( !head->sec_head_pos || (head->sec_names_index >= head->sec_entry_count) )
+		return 0;
+
+	fseek( fp, head->sec_head_pos + head->sec_names_index*head->sec_entry_size, SEEK_SET );
+	fread( &names, 1, sizeof(SEC_HEADER), fp );
+
+	for( i=0; i<head->sec_entry_count; i++ ) {
+
+		fseek( fp, head->sec_head_pos + i*head->sec_entry_size, SEEK_SET );
+		fread( &sec, 1, sizeof(SEC_HEADER), fp );
+
+		// Only look at non-empty PROGBITS sections
+		if( (sec.sh_type != 1) || !sec.sh_size )
+			continue;
+
+		memset( name, 0, sizeof(name) );
+		fseek( fp, names.sh_offset + sec.sh_name, SEEK_SET );
+		fread( name, 1, sizeof(name) - 1, fp );
+
+		if( strncmp( name, OVERLAY_PREFIX, prefix_len ) != 0 )
+			continue;
+
+		if( count == MAX_overlay_count ) {
+			printf( "WARNING: too many overlays, skipping %s.\n", name );
+			continue;
+		}
+
+		strcpy( overlays[count].name, &name[prefix_len] );
+		overlays[count].offset	= sec.sh_offset;
+		overlays[count].size	= sec.sh_size;
+		overlays[count].data	= (unsigned char*)malloc( sec.sh_size );
+
+		fseek( fp, sec.sh_offset, SEEK_SET );
+		fread( overlays[count].data, 1, sec.sh_size, fp );
+
+		count++;
+
+	}
+
+	return count;
+
+}
+
+// Returns true if the segment holds an overlay, in which case it shall be left
+// out of the executable (all overlays share the same address).
+static int is_overlay_segment(
+	const PRG_HEADER *prg, const OVERLAY *overlays, int count
+) {
+
+	int i;
+
+	for( i=0; i<count; i++ ) {
+		if(
+			(overlays[i].offset >= prg->p_offset) &&
+			(overlays[i].offset < (prg->p_offset + prg->p_filesz))
+		)
+			return true;
+	}
+
+	return false;
+
+}
+
+// Writes each overlay to <name>.ovl in the executable's directory, padded to a
+// multiple of 2 KB so it can be read from the CD directly into the overlay
+// region.
+static int write_overlays(
+	const char *exe_name, OVERLAY *overlays, int count, int quiet
+) {
+
+	char			path[1024];
+	const char		*ptr;
+	unsigned int	size;
+	int				dir_len, i;
+	FILE			*fp;
+
+	dir_len = 0;
+	for( ptr=exe_name; *ptr; ptr++ ) {
+		if( (*ptr == '/') || (*ptr == '\\') )
+			dir_len = (ptr - exe_name) + 1;
+	}
+
+	for( i=0; i<count; i++ ) {
+
+		if( snprintf( path, sizeof(path), "%.*s%s.ovl",
+			dir_len, exe_name, overlays[i].name ) >= (int)sizeof(path) ) {
+			printf( "Overlay path too long: %.*s%s.ovl\n",
+				dir_len, exe_name, overlays[i].name );
+			return false;
+		}
+
+		size = ((overlays[i].size + 2047) / 2048) * 2048;
+
+		if( !quiet )
+			printf( "overlay %s: size:%d\n", overlays[i].name, size );
+
+		fp = fopen( path, "wb" );
+
+		if( !fp ) {
+			printf( "Cannot write overlay: %s\n", path );
+			return false;
+		}
+
+		fwrite( overlays[i].data, 1, overlays[i].size, fp );
+
+		for( ; size>overlays[i].size; size-- )
+			fputc( 0, fp );
+
+		fclose( fp );
+		free( overlays[i].data );
+
+	}
+
+	return true;
+
+}
+
 int main(int argc, char** argv) {
 
 	char* in_file = NULL;
 	char* out_file = NULL;
 	int quiet = false;
+	int compress = false;
 	int	i;
 	FILE* fp;
 	ELF_HEADER head;
 	PRG_HEADER prg_heads[MAX_prg_entry_count];
+	OVERLAY overlays[MAX_overlay_count];
+	int overlay_count;
 	unsigned int exe_taddr = 0xffffffff;
 	unsigned int exe_haddr = 0;
 	unsigned int exe_tsize = 0;
+	unsigned int exe_pc0;
 	unsigned char* binary;
 	PSEXE exe;
 	char *output_name;
@@ -62,6 +420,10 @@ int main(int argc, char** argv) {
 
 			quiet = true;
 
+		} else if( strcasecmp( "-c", argv[i] ) == 0 ) {
+
+			compress = true;
+
 		} else {
 
 			if( in_file == NULL ) {
@@ -81,7 +443,9 @@ int main(int argc, char** argv) {
 
 	if( argc == 1 ) {
 		printf( "Usage:\n" );
-		printf( "  elf2x [-q] <elf_file> [exe_file]\n" );
+		printf( "  elf2x [-q] [-c] <elf_file> [exe_file]\n\n" );
+		printf( "  -q  Suppress output\n" );
+		printf( "  -c  Compress the executable, adding a stub that unpacks it on boot\n" );
 		return 0;
 	}
 
@@ -133,6 +497,8 @@ int main(int argc, char** argv) {
 	}
 
 
+	overlay_count = load_overlays( fp, &head, overlays );
+
 	// Load program headers and determine binary size and load address
 
 	fseek( fp, head.prg_head_pos, SEEK_SET );
@@ -144,18 +510,23 @@ int main(int argc, char** argv) {
 			continue;
 		}
 
+		if( is_overlay_segment( &prg_heads[i], overlays, overlay_count ) ) {
+			continue;
+		}
+
 		if( prg_heads[i].p_vaddr < exe_taddr ) {
 			exe_taddr = prg_heads[i].p_vaddr;
 		}
 
-		if( prg_heads[i].p_vaddr > exe_haddr ) {
-			exe_haddr = prg_heads[i].p_vaddr;
+		// Overlay segments may come after the last segment of the program, so
+		// the end address is tracked rather than assuming it's the last one
+		if( (prg_heads[i].p_vaddr + prg_heads[i].p_filesz) > exe_haddr ) {
+			exe_haddr = prg_heads[i].p_vaddr + prg_heads[i].p_filesz;
 		}
 
 	}
 
-	exe_tsize  = (exe_haddr - exe_taddr);
-	exe_tsize += prg_heads[head.prg_entry_count - 1].p_filesz;
+	exe_tsize = (exe_haddr - exe_taddr);
 
 	if (!quiet)
 		printf(
@@ -190,6 +561,10 @@ int main(int argc, char** argv) {
 			continue;
 		}
 
+		if( is_overlay_segment( &prg_heads[i], overlays, overlay_count ) ) {
+			continue;
+		}
+
 		fseek( fp, prg_heads[i].p_offset, SEEK_SET );
 		fread( &binary[(int)(prg_heads[i].p_vaddr-exe_taddr)],
 			1, prg_heads[i].p_filesz, fp );
@@ -198,6 +573,14 @@ int main(int argc, char** argv) {
 
 	fclose( fp );
 
+	exe_pc0 = head.prg_entry_addr;
+
+	if( compress ) {
+		binary = pack_binary( binary, &exe_taddr, &exe_tsize, &exe_pc0, quiet );
+		if( !binary )
+			return EXIT_FAILURE;
+	}
+
 
 	if( out_file ) {
 
@@ -235,7 +618,7 @@ int main(int argc, char** argv) {
 	//exe.params.sp_addr = 0x801FFFF0;
 	exe.params.t_addr = exe_taddr;
 	exe.params.t_size = exe_tsize;
-	exe.params.pc0 = head.prg_entry_addr;
+	exe.params.pc0 = exe_pc0;
 
 	// Some later PAL BIOS versions seem to actually verify the license string
 	// in the executable (despite what the nocash docs claim) and display the
@@ -263,6 +646,9 @@ int main(int argc, char** argv) {
 
 	free( binary );
 
+	if( !write_overlays( output_name, overlays, overlay_count, quiet ) )
+		return EXIT_FAILURE;
+
 	return 0;
 }
 
@@ -0,0 +1,150 @@
+# PSn00bSDK elf2x decompression stub
+# (C) 2022 PSn00bSDK contributors - MPL licensed
+#
+# Entry point of compressed executables generated by elf2x -c. Unpacks the
+# program (compressed with lzCompressFast()) to its load address and jumps to
+# its entry point, leaving $a0, $a1, $ra and $sp as the BIOS set them. elf2x
+# places the compressed data right before this stub, far enough past the load
+# address for the output to never catch up with the input, and fills in the
+# parameter block at its beginning (the executable's entry point is _stub).
+#
+# elf2x embeds this stub as a prebuilt array (stub_code[] in elf2x.c), which
+# must be updated whenever this file is changed. To rebuild it, run:
+#   mipsel-none-elf-as -march=r3000 -o stub.o elf2x_stub.s
+#   mipsel-none-elf-objcopy -O binary -j .text stub.o stub.bin
+
+.set noreorder
+.set noat
+
+.section .text
+
+# Filled in by elf2x
+.global _stub_params
+_stub_params:
+	.word 0		# Compressed data
+	.word 0		# End of compressed data
+	.word 0		# Load address
+	.word 0		# Entry point
+
+.global _stub
+.type _stub, @function
+_stub:
+	move  $t9, $ra
+	bal   .Lbase
+	nop
+.Lbase:
+	lw    $t0, -28($ra)						# Read _stub_params
+	lw    $t1, -24($ra)
+	lw    $t2, -20($ra)
+	lw    $t8, -16($ra)
+	li    $t7, 15
+	li    $t6, 255
+	addiu $t0, 1								# Skip LZP_FAST_ID
+
+.Lsequence:
+	sltu  $at, $t0, $t1
+	beqz  $at, .Ldone
+	nop
+
+	lbu   $t3, 0($t0)						# Token
+	addiu $t0, 1
+	srl   $t4, $t3, 4						# Literal count
+	bne   $t4, $t7, .Lliterals
+	nop
+.Lliteral_ext:
+	lbu   $t5, 0($t0)
+	addiu $t0, 1
+	beq   $t5, $t6, .Lliteral_ext
+	addu  $t4, $t5
+
+.Lliterals:
+	sltiu $at, $t4, 4
+	bnez  $at, .Lliteral_bytes
+	nop
+.Lliteral_words:
+	lwl   $t5, 3($t0)
+	lwr   $t5, 0($t0)
+	addiu $t4, -4
+	swl   $t5, 3($t2)
+	swr   $t5, 0($t2)
+	addiu $t0, 4
+	sltiu $at, $t4, 4
+	beqz  $at, .Lliteral_words
+	addiu $t2, 4
+.Lliteral_bytes:
+	beqz  $t4, .Lliterals_done
+	nop
+.Lliteral_byte:
+	lbu   $t5, 0($t0)
+	addiu $t0, 1
+	addiu $t4, -1
+	sb    $t5, 0($t2)
+	bnez  $t4, .Lliteral_byte
+	addiu $t2, 1
+
+.Lliterals_done:
+	sltu  $at, $t0, $t1
+	beqz  $at, .Ldone
+	nop
+
+	lbu   $t4, 0($t0)						# Match offset
+	lbu   $t5, 1($t0)
+	addiu $t0, 2
+	sll   $t5, 8
+	or    $t4, $t5
+	subu  $t4, $t2, $t4						# Match source
+	andi  $t3, 15							# Match length-4
+	bne   $t3, $t7, .Lmatch
+	nop
+.Lmatch_ext:
+	lbu   $t5, 0($t0)
+	addiu $t0, 1
+	beq   $t5, $t6, .Lmatch_ext
+	addu  $t3, $t5
+
+.Lmatch:
+	# Whole words can only be copied if the match doesn't overlap the word
+	# being written
+	subu  $t5, $t2, $t4
+	sltiu $at, $t5, 4
+	bnez  $at, .Lmatch_byte
+	addiu $t3, 4
+.Lmatch_words:
+	lwl   $t5, 3($t4)
+	lwr   $t5, 0($t4)
+	addiu $t3, -4
+	swl   $t5, 3($t2)
+	swr   $t5, 0($t2)
+	addiu $t4, 4
+	sltiu $at, $t3, 4
+	beqz  $at, .Lmatch_words
+	addiu $t2, 4
+	beqz  $t3, .Lsequence
+	nop
+.Lmatch_byte:
+	lbu   $t5, 0($t4)
+	addiu $t4, 1
+	addiu $t3, -1
+	sb    $t5, 0($t2)
+	bnez  $t3, .Lmatch_byte
+	addiu $t2, 1
+	b     .Lsequence
+	nop
+
+.Ldone:
+	# Flush the instruction cache through the BIOS, as it may still hold code
+	# from the previous program, then jump to the entry point
+	addiu $sp, -16
+	sw    $a0, 0($sp)
+	sw    $a1, 4($sp)
+	sw    $t8, 8($sp)
+	sw    $t9, 12($sp)
+	li    $t2, 0xa0
+	jalr  $t2
+	li    $t1, 0x44							# FlushCache()
+	lw    $a0, 0($sp)
+	lw    $a1, 4($sp)
+	lw    $t8, 8($sp)
+	lw    $ra, 12($sp)
+	jr    $t8
+	addiu $sp, 16